@@ -0,0 +1,60 @@
+# Host builds: the simulator and the tools in tools/, built with the host compiler against tools/sim/ in place of
+# PROS and okapi. Included by the Makefile; the robot's own build is untouched.
+#
+#   make sim    bin/host/sim, which runs initialize() and autonomous() on a simulated robot
+#   make tools  bin/host/<tool> for every tools/<tool>.cpp
+
+HOSTCXX?=g++
+HOSTCXXFLAGS?=-O2 -g
+HOSTBINDIR=$(BINDIR)/host
+HOST_FLAGS=-std=gnu++17 -pthread -I$(INCDIR) -I$(ROOT)/tools -D_POSIX_THREADS $(HOSTCXXFLAGS)
+
+HOST_SRC=$(shell find $(SRCDIR) -name '*.cpp')
+HOST_SIM_SRC=$(filter-out $(ROOT)/tools/sim/main.cpp,$(wildcard $(ROOT)/tools/sim/*.cpp))
+HOST_TOOLS=$(patsubst $(ROOT)/tools/%.cpp,$(HOSTBINDIR)/%,$(wildcard $(ROOT)/tools/*.cpp))
+
+# objects are named %.o, not %.cpp.o, to stay clear of the robot's rules
+host_obj=$(patsubst $(ROOT)/%.cpp,$(HOSTBINDIR)/%.o,$1)
+
+.PHONY: sim tools
+
+sim: $(HOSTBINDIR)/sim
+
+tools: $(HOST_TOOLS)
+
+$(HOSTBINDIR)/%.o: $(ROOT)/%.cpp
+	@mkdir -p $(dir $@)
+	$(HOSTCXX) $(HOST_FLAGS) -MMD -MP -c $< -o $@
+
+$(HOSTBINDIR)/src.a: $(call host_obj,$(HOST_SRC))
+	@rm -f $@
+	ar rcs $@ $^
+
+$(HOSTBINDIR)/sim.a: $(call host_obj,$(HOST_SIM_SRC))
+	@rm -f $@
+	ar rcs $@ $^
+
+$(HOSTBINDIR)/sim: $(call host_obj,$(ROOT)/tools/sim/main.cpp) $(HOSTBINDIR)/src.a $(HOSTBINDIR)/sim.a
+	$(HOSTCXX) $(HOST_FLAGS) $^ -o $@
+
+$(HOSTBINDIR)/%: $(HOSTBINDIR)/tools/%.o $(HOSTBINDIR)/src.a $(HOSTBINDIR)/sim.a
+	$(HOSTCXX) $(HOST_FLAGS) $^ -o $@
+
+# tune_gains sets the feedback gains of each trial, so it links a copy of the robot code built with TUNE_GAINS,
+# which makes the gains in include/controller_gains.hpp variables
+tune_obj=$(patsubst $(ROOT)/%.cpp,$(HOSTBINDIR)/tune/%.o,$1)
+
+$(HOSTBINDIR)/tune/%.o: $(ROOT)/%.cpp
+	@mkdir -p $(dir $@)
+	$(HOSTCXX) $(HOST_FLAGS) -DTUNE_GAINS -MMD -MP -c $< -o $@
+
+$(HOSTBINDIR)/tune/src.a: $(call tune_obj,$(HOST_SRC))
+	@rm -f $@
+	ar rcs $@ $^
+
+$(HOSTBINDIR)/tune_gains: $(call tune_obj,$(ROOT)/tools/tune_gains.cpp) $(HOSTBINDIR)/tune/src.a $(HOSTBINDIR)/sim.a
+	$(HOSTCXX) $(HOST_FLAGS) $^ -o $@
+
+.PRECIOUS: $(HOSTBINDIR)/%.o
+
+-include $(shell find $(HOSTBINDIR) -name '*.d' 2>/dev/null)
@@ -0,0 +1,29 @@
+#pragma once
+
+// Generated by tools/tune_gains.cpp; do not edit.
+// tune_gains builds the robot code with TUNE_GAINS, which makes these variables it sets for each trial.
+
+#ifdef TUNE_GAINS
+#define CONTROLLER_GAIN inline double
+#else
+#define CONTROLLER_GAIN inline constexpr double
+#endif
+
+namespace controller_gains {
+
+  // hand-tuned starting point
+  CONTROLLER_GAIN TILTER_KP = 180;
+  CONTROLLER_GAIN TILTER_KD = 5;
+
+  // hand-tuned starting point
+  CONTROLLER_GAIN HOLD_KP = 400;
+  CONTROLLER_GAIN HOLD_KD = 0;
+
+  // hand-tuned starting point
+  CONTROLLER_GAIN LIFT_KP = 400;
+  CONTROLLER_GAIN LIFT_KD = 10;
+  CONTROLLER_GAIN SYNC_KP = 100;
+  CONTROLLER_GAIN SYNC_KD = 2;
+}
+
+#undef CONTROLLER_GAIN
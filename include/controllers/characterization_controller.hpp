@@ -0,0 +1,192 @@
+#pragma once
+
+#include "main.h"
+#include "subsystems/chassis.hpp"
+#include "subsystems/transmission.hpp"
+#include "subsystems/tilter.hpp"
+#include "subsystems/lift.hpp"
+#include "subsystems/intake.hpp"
+#include <limits>
+
+/**
+ * Characterization controller.
+ * Runs open-loop voltage tests on a mechanism and logs its response to the SD card,
+ * so tools/fit_feedforward.py can fit its feedforward constants.
+ *
+ * A quasi-static test ramps the voltage slowly, so the mechanism is never far from steady state and the voltage
+ * is explained by friction, velocity and gravity alone; a step test applies a constant voltage, so the mechanism
+ * accelerates hard and the acceleration term can be fitted.
+ * Tests stop early when the mechanism reaches the end of its travel.
+ */
+class CharacterizationController {
+
+  public:
+
+  /**
+   * Mechanisms that can be characterized.
+   */
+  enum class Mechanism {
+    DRIVE,  ///< Both sides of the chassis together; position in m
+    TILTER, ///< Through the transmission's LOCKED_PASSTHROUGH state; position in deg, positive extends
+    LIFT,   ///< Mean of both sides; position in deg
+    INTAKE  ///< Mean of both rollers; position in deg
+  };
+
+  /**
+   * Test types.
+   */
+  enum class Test {
+    QUASISTATIC, ///< Slow voltage ramp
+    STEP         ///< Constant voltage
+  };
+
+  /**
+   * Test settings of a mechanism.
+   */
+  struct Settings {
+    double m_ramp_rate;      ///< Quasi-static ramp rate, in mV/s
+    uint32_t m_ramp_time;    ///< Longest quasi-static test, in ms
+    int m_step_voltage;      ///< Step test voltage, in mV
+    uint32_t m_step_time;    ///< Longest step test, in ms
+    double m_min_position;   ///< Tests moving backwards stop here
+    double m_max_position;   ///< Tests moving forwards stop here
+    double m_max_travel;     ///< Tests stop after moving this far from where they started
+  };
+
+  /**
+   * Settings of each mechanism, indexed by Mechanism.
+   * The drive needs about a metre of clear field in each direction.
+   */
+  static constexpr Settings SETTINGS[] = {
+    {500, 10000, 6000, 2000, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), 1.2},
+    {1000, 10000, 6000, 1500, 3, 85, std::numeric_limits<double>::infinity()},
+    {1500, 8000, 8000, 1000, 2, 78, std::numeric_limits<double>::infinity()},
+    {1500, 8000, 8000, 2000, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()}
+  };
+
+  /**
+   * Samples are taken at this rate.
+   */
+  static constexpr QFrequency SAMPLE_RATE = 100_Hz;
+
+  /**
+   * The most samples a test can log; enough for the longest test.
+   */
+  static constexpr size_t MAX_SAMPLES = 1500;
+
+  /**
+   * How long run_all() lets a mechanism come to rest between tests, in ms.
+   */
+  static constexpr uint32_t REST_TIME = 1000;
+
+  /**
+   * Voltage that holds the lift down during tilter tests, so the tilter stays locked, in mV.
+   */
+  static constexpr int LIFT_HOLD_VOLTAGE = -4500;
+
+  /**
+   * Constructor.
+   *
+   * \param chassis
+   *        A reference to the chassis
+   * \param transmission
+   *        A reference to the transmission driving the chassis and tilter
+   * \param tilter
+   *        A reference to the tilter
+   * \param lift
+   *        A reference to the lift
+   * \param intake
+   *        A reference to the intake
+   */
+  CharacterizationController(std::shared_ptr<Chassis> chassis, std::shared_ptr<Transmission> transmission, std::shared_ptr<Tilter> tilter, std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake);
+
+  /**
+   * Run a test and write its log to /usd/characterize_<mechanism>_<test>_<direction>.csv.
+   * Blocks until the test is over. Interrupts any macro driving the mechanism, and cannot be interrupted.
+   *
+   * \param mechanism
+   *        The mechanism to test
+   * \param test
+   *        The type of test
+   * \param reverse
+   *        Drive the mechanism backwards
+   *
+   * \return True if the log was written, false if a driver override held the mechanism or there is no SD card
+   */
+  bool run(Mechanism mechanism, Test test, bool reverse);
+
+  /**
+   * Run both tests in both directions on every mechanism.
+   * Forward tests end where reverse tests start, so the arms only need to start lowered and the tray retracted.
+   *
+   * \return The number of logs written
+   */
+  int run_all();
+
+  private:
+
+  /**
+   * A logged sample.
+   */
+  struct Sample {
+    uint32_t m_time;   ///< ms since the start of the test
+    int32_t m_voltage; ///< mV
+    float m_position;
+    float m_velocity;
+  };
+
+  /**
+   * Reference to the subsystems being characterized.
+   */
+  std::shared_ptr<Chassis> m_chassis;
+  std::shared_ptr<Transmission> m_transmission;
+  std::shared_ptr<Tilter> m_tilter;
+  std::shared_ptr<Lift> m_lift;
+  std::shared_ptr<Intake> m_intake;
+
+  /**
+   * Samples of the current test.
+   * Kept in memory and written once the test is over, so SD writes do not delay sampling.
+   */
+  std::unique_ptr<Sample[]> m_samples;
+
+  /**
+   * Measure a mechanism.
+   *
+   * \param mechanism
+   *        The mechanism
+   *
+   * \return The position and velocity, in the mechanism's units
+   */
+  std::pair<double, double> measure(Mechanism mechanism);
+
+  /**
+   * Apply a voltage to a mechanism.
+   *
+   * \param mechanism
+   *        The mechanism
+   * \param voltage
+   *        The voltage, in mV; positive moves the position forwards
+   */
+  void apply(Mechanism mechanism, int voltage);
+
+  /**
+   * Stop a mechanism at the end of a test.
+   *
+   * \param mechanism
+   *        The mechanism
+   */
+  void stop(Mechanism mechanism);
+
+  /**
+   * Write the samples of a test to the SD card.
+   *
+   * \param path
+   *        The path of the log
+   * \param count
+   *        The number of samples
+   *
+   * \return True if the log was written
+   */
+  bool write_log(const char* path, size_t count);
+};
@@ -3,6 +3,8 @@
 #include "controllers/tilter_controller.hpp"
 #include "controllers/pull_out_controler.hpp"
 #include "controllers/lift_controller.hpp"
+#include "controllers/trajectory_controller.hpp"
+#include "controllers/characterization_controller.hpp"
 
 namespace subsystem_controllers {
 
@@ -13,7 +15,9 @@ namespace subsystem_controllers {
    */
   extern std::shared_ptr<TilterController> tilter_controller;
   extern std::shared_ptr<PullOutController> pull_out_controller;
-  // extern std::shared_ptr<LiftController> lift_controller;
+  extern std::shared_ptr<LiftController> lift_controller;
+  extern std::shared_ptr<TrajectoryController> trajectory_controller;
+  extern std::shared_ptr<CharacterizationController> characterization_controller;
 
   /**
    * Initialize all subsystems.
@@ -3,9 +3,17 @@
 #include "main.h"
 #include "subsystems/lift.hpp"
 #include "subsystems/intake.hpp"
+#include "lib/snapshot.hpp"
+#include "lib/telemetry.hpp"
+#include "lib/arbiter.hpp"
+#include "lib/cpu_meter.hpp"
+#include <atomic>
 
 /**
  * Lift controller.
+ * Moves the lift between preset heights along motion profiles from its own task.
+ * Owns the lift only while a move is active or a raised height is held, and releases it once the lift has settled at the bottom.
+ * Its moves have the lowest priority, so deposits and manual control interrupt them.
  */
 class LiftController {
 
@@ -16,6 +24,46 @@ class LiftController {
    */
   static constexpr QAngle LOWER_BY = 5_deg;
 
+  /**
+   * The longest the controller will wait for a pose update before running anyway, in ms.
+   */
+  static constexpr uint32_t POSE_TIMEOUT = 20;
+
+  /**
+   * A handle to a requested move.
+   * Never blocks unless wait() is called.
+   */
+  class Move {
+
+    public:
+
+    /**
+     * Whether the move, or a later one, has settled.
+     * 
+     * \return True if settled
+     */
+    bool is_settled() const;
+
+    /**
+     * Wait for the move to settle.
+     * 
+     * \param timeout
+     *        The longest to wait, in ms
+     * 
+     * \return True if the move settled, false if the timeout passed first
+     */
+    bool wait(uint32_t timeout = TIMEOUT_MAX) const;
+
+    private:
+
+    friend class LiftController;
+
+    Move(const LiftController* controller, uint32_t generation);
+
+    const LiftController* m_controller;
+    uint32_t m_generation;
+  };
+
   /**
    * Constructor.
    * 
@@ -24,26 +72,82 @@ class LiftController {
    * \param intake
    *        A reference to the intake being controlled
    */
-  LiftController(std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake, double kp, double ki, double kd);
-
+  LiftController(std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake);
 
   /**
-   * Enable the controller.
+   * Move to an angle and hold it.
+   * If a command that cannot be interrupted owns the lift, the move is refused and never settles.
+   * 
+   * \param target
+   *        The angle to move to
+   * 
+   * \return A handle to the move
    */
-  void set_target(QAngle target);
+  Move set_target(QAngle target);
 
-  bool lowered;
+  /**
+   * Move to a preset height and hold it.
+   * If a command that cannot be interrupted owns the lift, the move is refused and never settles.
+   * 
+   * \param preset
+   *        The preset to move to
+   * 
+   * \return A handle to the move
+   */
+  Move move_to(Lift::Preset preset);
 
+  /**
+   * Lower the target by LOWER_BY, for intaking cubes.
+   * Moves the lift only if the controller is active; otherwise applies to the next move.
+   */
   void lower();
 
+  /**
+   * Undo lower().
+   */
   void raise();
 
+  /**
+   * Stop moving and release the lift.
+   */
+  void disable();
+
+  /**
+   * Get the CPU time of the controller task.
+   * The task is parked while the lift is idle, so it only runs during moves and while a raised height is held.
+   *
+   * \return The task's totals
+   */
+  CpuMeter::Stats get_cpu_stats() const;
+
   private:
 
   /**
-   * Should the controller be enabled?
+   * A requested target.
+   * Written only by the task requesting moves, and read by the controller task.
    */
-  QAngle m_actual_target = 0_deg;
+  struct Target {
+    QAngle m_angle;         ///< The requested angle
+    bool m_lowered;         ///< Whether the target is lowered by LOWER_BY
+    uint32_t m_generation;  ///< Incremented for every request
+  };
+  Snapshot<Target> m_target;
+
+  /**
+   * Moving or holding the lift; requires the lift.
+   */
+  Command m_command;
+
+  /**
+   * The generation of the target being moved to.
+   * Only used under the arbiter's mutex.
+   */
+  uint32_t m_generation;
+
+  /**
+   * The generation of the last settled target.
+   */
+  std::atomic<uint32_t> m_settled_generation;
 
   /**
    * Reference to the subsystems being controlled.
@@ -52,13 +156,35 @@ class LiftController {
   std::shared_ptr<Intake> m_intake;
 
   /**
-   * Controller.
+   * Telemetry buffer of the controller task.
+   * Null if telemetry has no room for another producer.
+   */
+  TelemetryBuffer* m_telemetry;
+
+  /**
+   * CPU time of the controller task.
    */
-  std::unique_ptr<IterativePosPIDController> m_controller;
+  CpuMeter m_cpu;
 
   /**
    * The controller task.
    */
   std::unique_ptr<pros::Task> m_task;
 
-};
\ No newline at end of file
+  /**
+   * Run one tick of the move.
+   *
+   * \return False once the lift has settled at the bottom
+   */
+  bool update();
+
+  /**
+   * Publish a new target and enable the controller.
+   */
+  Move request(QAngle angle, bool lowered);
+
+  /**
+   * Set whether the target is lowered.
+   */
+  void set_lowered(bool lowered);
+};
@@ -5,6 +5,8 @@
 #include "subsystems/chassis.hpp"
 #include "subsystems/transmission.hpp"
 #include "subsystems/intake.hpp"
+#include "lib/arbiter.hpp"
+#include "lib/cpu_meter.hpp"
 
 /**
  * Tilter controller.
@@ -14,6 +16,11 @@ class PullOutController {
 
   public:
 
+  /**
+   * The longest the controller will wait for a pose update before running anyway, in ms.
+   */
+  static constexpr uint32_t POSE_TIMEOUT = 20;
+
   /**
    * Constructor.
    * 
@@ -31,20 +38,32 @@ class PullOutController {
 
   /**
    * Enable the controller.
+   * Interrupts whatever else is driving the transmission or intake, unless a higher priority command holds them.
+   *
+   * \return True if the pull out started, false if it was refused
    */
-  void enable();
+  bool enable();
 
   /**
    * Disable the controller.
+   * Stops the chassis and intake and releases the tilter.
    */
   void disable();
 
+  /**
+   * Get the CPU time of the controller task.
+   * The task is parked while the controller is disabled, so it only runs while a command is active.
+   *
+   * \return The task's totals
+   */
+  CpuMeter::Stats get_cpu_stats() const;
+
   private:
 
   /**
-   * Should the controller be enabled?
+   * The pull out; requires the transmission and intake.
    */
-  bool m_enabled;
+  Command m_command;
 
   /**
    * Reference to the subsystems being controlled.
@@ -54,6 +73,11 @@ class PullOutController {
   std::shared_ptr<Transmission> m_transmission;
   std::shared_ptr<Intake> m_intake;
 
+  /**
+   * CPU time of the controller task.
+   */
+  CpuMeter m_cpu;
+
   /**
    * The controller task.
    */
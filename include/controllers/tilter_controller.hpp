@@ -3,15 +3,75 @@
 #include "main.h"
 #include "subsystems/tilter.hpp"
 #include "subsystems/lift.hpp"
+#include "lib/telemetry.hpp"
+#include "lib/motion_profile.hpp"
+#include "lib/arbiter.hpp"
+#include "lib/cpu_meter.hpp"
+#include "feedforward_gains.hpp"
+#include "controller_gains.hpp"
+#include <atomic>
 
 /**
  * Tilter controller.
  * Use when depositing.
+ * Extends the tray along a jerk-limited profile that moves quickly at first and slowly near vertical,
+ * no faster there than a stack of its size can stop without tipping, driving the tilter through the transmission's LOCKED_PASSTHROUGH state.
  */
 class TilterController {
 
   public:
 
+  /**
+   * The longest the controller will wait for a pose update before running anyway, in ms.
+   */
+  static constexpr uint32_t POSE_TIMEOUT = 20;
+
+  /**
+   * Deposit profile limits.
+   * The tray moves as fast as the motors allow until DEPOSIT_SLOW_FROM, where the stack stands up on its own base,
+   * then no faster than the stack can stop without tipping (see get_tip_velocity()), scaled by TIP_MARGIN.
+   */
+  static constexpr QAngularSpeed DEPOSIT_VELOCITY = 90_deg / second;                        ///< Fast phase
+  static constexpr QAngle DEPOSIT_SLOW_FROM = 75_deg;                                       ///< Where the slow phase starts
+  static constexpr QAngularAcceleration DEPOSIT_ACCELERATION = 300_deg / second / second;
+  static constexpr QAngularJerk DEPOSIT_JERK = 3000_deg / second / second / second;
+
+  /**
+   * The side of a cube; a stack is this wide and this tall per cube.
+   */
+  static constexpr QLength CUBE_SIZE = 5.5_in;
+
+  /**
+   * The fraction of the tipping energy (see get_tip_velocity()) the stack may carry near vertical;
+   * the slow phase's velocity is the tip velocity times the square root of this.
+   */
+  static constexpr double TIP_MARGIN = .25;
+
+  /**
+   * How much heavier the tray gets per cube, relative to the empty tray.
+   * Only scales the feedforward, as an estimate of the load; it does not limit the profile.
+   */
+  static constexpr double CUBE_MASS_RATIO = .08;
+
+  /**
+   * The deposit is abandoned this long after the profile ends if the tray has not reached the extend threshold.
+   */
+  static constexpr QTime DEPOSIT_TIMEOUT = 1_s;
+
+  /**
+   * Feedforward of the empty tray, with positive voltage extending it.
+   * Hand-tuned until characterization logs are fitted; see CharacterizationController and tools/fit_feedforward.py.
+   * The acceleration and gravity terms are scaled by the mass ratio.
+   */
+  static constexpr Feedforward FEEDFORWARD = feedforward_gains::TILTER;
+
+  /**
+   * Feedback gains, in mV.
+   * Hand-tuned; tools/tune_gains.cpp can search for better ones.
+   */
+  static constexpr const double& KP = controller_gains::TILTER_KP; ///< Per deg of angle error
+  static constexpr const double& KD = controller_gains::TILTER_KD; ///< Per deg/s of velocity error
+
   /**
    * Constructor.
    * 
@@ -19,32 +79,82 @@ class TilterController {
    *        A reference to the tilter being controlled
    * \param transmission
    *        A reference to the transmission the tilter belongs to
-   * \param kp
-   *        The kP constant of the PID controller
-   * \param ki
-   *        The kI constant of the PID controller
-   * \param kd
-   *        The kD constant of the PID controller
+   * \param lift
+   *        A reference to the lift, which is held down while depositing
    */
-  TilterController(std::shared_ptr<Tilter> tilter, std::shared_ptr<Transmission> transmission, std::shared_ptr<Lift> lift, double kp, double ki, double kd);
+  TilterController(std::shared_ptr<Tilter> tilter, std::shared_ptr<Transmission> transmission, std::shared_ptr<Lift> lift);
 
 
   /**
    * Enable the controller.
+   * Interrupts whatever else is driving the transmission or lift, unless a higher priority command holds them.
+   *
+   * \return True if the deposit started, false if it was refused
    */
-  void enable();
+  bool enable();
 
   /**
    * Disable the controller.
+   * The tilter is held where it stopped.
    */
   void disable();
 
+  /**
+   * Get the CPU time of the controller task.
+   * The task is parked while the controller is disabled, so it only runs while a command is active.
+   *
+   * \return The task's totals
+   */
+  CpuMeter::Stats get_cpu_stats() const;
+
+  /**
+   * Set the number of cubes in the stack.
+   * Applies to the next deposit.
+   * 
+   * \param cubes
+   *        The number of cubes on the tray
+   */
+  void set_stack_size(size_t cubes);
+
+  /**
+   * Get the speed at which a stack tips over if the tray stops dead under it near vertical.
+   * The stack is a rigid block CUBE_SIZE wide and cubes * CUBE_SIZE tall, turning with the tray about its front
+   * base edge. It tips if its kinetic energy about that edge, (h^2 + b^2) / 3 * m * w^2 / 2, exceeds the work needed
+   * to lift its centre of mass over the edge, m * g * (sqrt(h^2 + b^2) - h) / 2.
+   * 
+   * \param cubes
+   *        The number of cubes on the tray
+   * 
+   * \return The tray's angular velocity at which the stack tips; infinite for an empty tray
+   */
+  static QAngularSpeed get_tip_velocity(size_t cubes);
+
+  /**
+   * Plan a deposit.
+   * 
+   * \param start
+   *        The angle of the tray
+   * \param cubes
+   *        The number of cubes on the tray
+   * 
+   * \return The deposit profile
+   */
+  static SCurveProfile plan(QAngle start, size_t cubes);
+
   private:
 
   /**
-   * Should the controller be enabled?
+   * The deposit; requires the transmission and lift.
+   */
+  Command m_command;
+
+  /**
+   * The running deposit, planned when the command starts.
+   * Only used under the arbiter's mutex.
    */
-  bool m_enabled;
+  SCurveProfile m_profile;
+  double m_mass_ratio;
+  uint32_t m_start;
 
   /**
    * Reference to the subsystems being controlled.
@@ -54,13 +164,31 @@ class TilterController {
   std::shared_ptr<Lift> m_lift;
 
   /**
-   * The PID controller.
+   * The number of cubes on the tray.
+   */
+  std::atomic<size_t> m_stack_size;
+
+  /**
+   * Telemetry buffer of the controller task.
+   * Null if telemetry has no room for another producer.
    */
-  std::unique_ptr<IterativePosPIDController> m_controller;
+  TelemetryBuffer* m_telemetry;
+
+  /**
+   * CPU time of the controller task.
+   */
+  CpuMeter m_cpu;
 
   /**
    * The controller task.
    */
   std::unique_ptr<pros::Task> m_task;
 
+  /**
+   * Run one tick of the deposit.
+   *
+   * \return False once the tray is vertical
+   */
+  bool update();
+
 };
\ No newline at end of file
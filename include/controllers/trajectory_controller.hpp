@@ -0,0 +1,136 @@
+#pragma once
+
+#include "main.h"
+#include "lib/trajectory.hpp"
+#include "subsystems/chassis.hpp"
+#include "subsystems/transmission.hpp"
+#include "lib/arbiter.hpp"
+
+/**
+ * Trajectory controller.
+ * Drives the chassis along a trajectory with feedforward and RAMSETE pose feedback.
+ * Use in autonomous instead of timed voltages.
+ */
+class TrajectoryController {
+
+  public:
+
+  /**
+   * Counts of trajectories followed.
+   */
+  struct FollowStats {
+    uint32_t m_follows; ///< Calls to follow() that got the transmission
+    uint32_t m_settled; ///< Of those, the ones that settled
+  };
+
+  /**
+   * Feedforward and feedback constants.
+   */
+  struct Gains {
+    double m_ks; ///< Voltage to overcome static friction, in mV
+    double m_kv; ///< Voltage per unit of velocity, in mV per m/s
+    double m_ka; ///< Voltage per unit of acceleration, in mV per m/s^2
+    double m_b;  ///< RAMSETE aggressiveness, in rad^2/m^2
+    double m_zeta; ///< RAMSETE damping
+    double m_min_gain; ///< Least RAMSETE gain, which holds the chassis at the end of the trajectory, in 1/s
+  };
+
+  /**
+   * Constructor.
+   * 
+   * \param chassis
+   *        A reference to the chassis being controlled
+   * \param transmission
+   *        A reference to the transmission driving the chassis
+   * \param track_width
+   *        The distance between the left and right drive wheels
+   * \param gains
+   *        The feedforward and feedback constants
+   */
+  TrajectoryController(std::shared_ptr<Chassis> chassis, std::shared_ptr<Transmission> transmission, QLength track_width, Gains gains);
+
+  /**
+   * Follow a trajectory, starting from the chassis' current pose.
+   * Blocks until the chassis settles at the end of the trajectory, or the timeout passes.
+   * Interrupts whatever else is driving the transmission; stops early if interrupted in turn.
+   * 
+   * \param trajectory
+   *        The trajectory to follow
+   * \param settle_timeout
+   *        How long past the end of the trajectory to wait for the chassis to settle
+   * 
+   * \return True if the chassis settled, false if it timed out, was refused the transmission or was interrupted
+   */
+  bool follow(const Trajectory& trajectory, QTime settle_timeout = 500_ms);
+
+  /**
+   * Drive straight from the current pose.
+   * Blocks until settled; see follow().
+   * 
+   * \param distance
+   *        The distance to drive; negative drives backwards
+   * 
+   * \return True if the chassis settled, false if it timed out
+   */
+  bool drive(QLength distance);
+
+  /**
+   * Get the counts of trajectories followed.
+   *
+   * \return The counts
+   */
+  FollowStats get_follow_stats() const;
+
+  /**
+   * The chassis is settled when within these of the final setpoint.
+   */
+  static constexpr QLength SETTLE_DISTANCE = 1_in;
+  static constexpr QAngle SETTLE_ANGLE = 2_deg;
+  static constexpr QSpeed SETTLE_SPEED = 2_in / second;
+
+  /**
+   * Profile limits used by drive().
+   */
+  static constexpr QSpeed MAX_VELOCITY = .45_mps;
+  static constexpr QAcceleration MAX_ACCELERATION = 1_mps2;
+
+  private:
+
+  /**
+   * Following a trajectory; requires the transmission.
+   */
+  Command m_command;
+
+  /**
+   * Reference to the subsystems being controlled.
+   */
+  std::shared_ptr<Chassis> m_chassis;
+  std::shared_ptr<Transmission> m_transmission;
+
+  /**
+   * The distance between the left and right drive wheels.
+   */
+  QLength m_track_width;
+
+  /**
+   * The feedforward and feedback constants.
+   */
+  Gains m_gains;
+
+  /**
+   * Counts of trajectories followed.
+   */
+  FollowStats m_stats;
+
+  /**
+   * Calculate the feedforward voltage of one side of the chassis.
+   * 
+   * \param velocity
+   *        The desired velocity of the side, in m/s
+   * \param acceleration
+   *        The desired acceleration of the side, in m/s^2
+   * 
+   * \return The voltage, in mV
+   */
+  double feedforward(double velocity, double acceleration) const;
+};
@@ -24,4 +24,6 @@ namespace controls {
   // lift
   inline ControllerButton btn_lift_up  (ControllerDigital::L1);
   inline ControllerButton btn_lift_down(ControllerDigital::L2);
+  inline ControllerButton btn_lift_low_tower(ControllerDigital::down);
+  inline ControllerButton btn_lift_mid_tower(ControllerDigital::right);
 }
\ No newline at end of file
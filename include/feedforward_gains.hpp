@@ -0,0 +1,20 @@
+#pragma once
+
+// Generated by tools/fit_feedforward.py; do not edit.
+
+#include "lib/feedforward.hpp"
+
+namespace feedforward_gains {
+
+  // hand-tuned; not characterized
+  inline constexpr Feedforward DRIVE = {800, 22000, 3000, 0, 0};
+
+  // hand-tuned; not characterized
+  inline constexpr Feedforward TILTER = {0, 60, 3, 0, 0};
+
+  // hand-tuned; not characterized
+  inline constexpr Feedforward LIFT = {0, 50, 4, 1500, 35};
+
+  // hand-tuned; not characterized
+  inline constexpr Feedforward INTAKE = {0, 10, 0, 0, 0};
+}
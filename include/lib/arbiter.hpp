@@ -0,0 +1,285 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+/**
+ * Subsystems a command requires.
+ * These are bits, so a command can require several.
+ */
+using ResourceSet = uint32_t;
+
+/**
+ * Something that drives subsystems for a while, such as a macro, a preset move or a driver override.
+ * A command declares the subsystems it requires up front, and only runs while an Arbiter has given it all of them.
+ * Commands are not copyable and must not be destroyed while active.
+ */
+class Command {
+
+public:
+
+  /**
+   * Counters kept by the arbiter, for measuring how commands contend for subsystems.
+   */
+  struct Stats {
+    uint32_t m_scheduled;   ///< Times the command was given its subsystems
+    uint32_t m_denied;      ///< Times the command asked for its subsystems and was refused
+    uint32_t m_interrupted; ///< Times the command lost its subsystems before finishing
+    uint32_t m_ticks;       ///< Ticks run as the owner of its subsystems
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param name
+   *        Name for logs and statistics
+   * \param requirements
+   *        The subsystems the command drives
+   * \param priority
+   *        Commands interrupt interruptible commands of equal or lower priority, and are refused otherwise
+   * \param interruptible
+   *        Whether other commands may take the subsystems while the command is active
+   * \param start
+   *        Called when the command is given its subsystems, before its first tick
+   * \param end
+   *        Called when the command loses its subsystems, with true if it was interrupted or cancelled
+   *        rather than finishing on its own
+   */
+  Command(
+    const char* name, ResourceSet requirements, int priority, bool interruptible,
+    std::function<void()> start = nullptr, std::function<void(bool)> end = nullptr
+  ):
+    m_name(name),
+    m_requirements(requirements),
+    m_priority(priority),
+    m_interruptible(interruptible),
+    m_start(std::move(start)),
+    m_end(std::move(end)),
+    m_active(false),
+    m_stats{0, 0, 0, 0}
+  {}
+
+  Command(const Command&) = delete;
+  Command& operator=(const Command&) = delete;
+
+  /**
+   * Get the name of the command.
+   *
+   * \return The name
+   */
+  const char* get_name() const {
+    return m_name;
+  }
+
+  /**
+   * Get the subsystems the command requires.
+   *
+   * \return The required subsystems
+   */
+  ResourceSet get_requirements() const {
+    return m_requirements;
+  }
+
+  /**
+   * Check whether the command owns its subsystems.
+   * Safe to call from any task, but the answer may change before the caller acts on it;
+   * only Arbiter::run() guarantees ownership for the length of a tick.
+   *
+   * \return True if the command is active
+   */
+  bool is_active() const {
+    return m_active;
+  }
+
+private:
+
+  template <typename TMutex> friend class Arbiter;
+
+  const char* m_name;
+  ResourceSet m_requirements;
+  int m_priority;
+  bool m_interruptible;
+  std::function<void()> m_start;
+  std::function<void(bool)> m_end;
+
+  /**
+   * Written under the arbiter's mutex, read by anyone.
+   */
+  std::atomic<bool> m_active;
+
+  /**
+   * Written and read under the arbiter's mutex.
+   */
+  Stats m_stats;
+};
+
+/**
+ * Gives each subsystem to at most one command at a time.
+ *
+ * Scheduling is all or nothing: a command gets every subsystem it requires, or none and is refused.
+ * It is refused if any of them is owned by a command that is not interruptible or has a higher priority;
+ * otherwise the owners are interrupted, losing all of their subsystems, and the newest command wins ties.
+ * Commands write subsystem outputs only inside run(), and the default behaviour of a subsystem only inside run_default(),
+ * both under the arbiter's mutex, so exactly one of them drives each subsystem in a tick.
+ * Nothing is polled: an idle command costs nothing until it is scheduled.
+ *
+ * The start and end callbacks and the ticks run under the arbiter's mutex,
+ * so they must be short and must not call back into the arbiter.
+ *
+ * \tparam TMutex
+ *         A mutex with lock() and unlock(); std::mutex on the host, RtosMutex on the robot
+ */
+template <typename TMutex>
+class Arbiter {
+
+public:
+
+  /**
+   * The number of distinct subsystems; one per bit of ResourceSet.
+   */
+  static constexpr size_t MAX_RESOURCES = 32;
+
+  Arbiter(): m_owners{} {}
+
+  Arbiter(const Arbiter&) = delete;
+  Arbiter& operator=(const Arbiter&) = delete;
+
+  /**
+   * Give a command its subsystems, interrupting their owners if allowed.
+   * Does nothing if the command is already active.
+   *
+   * \param command
+   *        The command to schedule
+   *
+   * \return True if the command is active, false if it was refused
+   */
+  bool schedule(Command& command) {
+    std::lock_guard<TMutex> lock(m_mutex);
+    if (command.m_active) return true;
+
+    // refuse without side effects if any owner cannot be interrupted
+    for (size_t i = 0; i < MAX_RESOURCES; ++i) {
+      if (!(command.m_requirements & (ResourceSet(1) << i))) continue;
+      const Command* owner = m_owners[i];
+      if (owner && (!owner->m_interruptible || owner->m_priority > command.m_priority)) {
+        ++command.m_stats.m_denied;
+        return false;
+      }
+    }
+
+    for (size_t i = 0; i < MAX_RESOURCES; ++i) {
+      if (!(command.m_requirements & (ResourceSet(1) << i))) continue;
+      if (m_owners[i]) end(*m_owners[i], true);
+      m_owners[i] = &command;
+    }
+    command.m_active = true;
+    ++command.m_stats.m_scheduled;
+    if (command.m_start) command.m_start();
+    return true;
+  }
+
+  /**
+   * Take a command's subsystems away.
+   * Its end callback is told it was interrupted. Does nothing if the command is not active.
+   *
+   * \param command
+   *        The command to cancel
+   */
+  void cancel(Command& command) {
+    std::lock_guard<TMutex> lock(m_mutex);
+    if (command.m_active) end(command, true);
+  }
+
+  /**
+   * Run one tick of a command, if it still owns its subsystems.
+   *
+   * \param command
+   *        The command
+   * \param tick
+   *        Drives the subsystems; returns false once the command has finished, which releases them
+   *
+   * \return True if the tick ran and the command is still active
+   */
+  template <typename F>
+  bool run(Command& command, F&& tick) {
+    std::lock_guard<TMutex> lock(m_mutex);
+    if (!command.m_active) return false;
+    ++command.m_stats.m_ticks;
+    if (tick()) return true;
+    end(command, false);
+    return false;
+  }
+
+  /**
+   * Run the default behaviour of subsystems, if no command owns any of them.
+   *
+   * \param resources
+   *        The subsystems
+   * \param tick
+   *        Drives the subsystems
+   *
+   * \return True if the tick ran
+   */
+  template <typename F>
+  bool run_default(ResourceSet resources, F&& tick) {
+    std::lock_guard<TMutex> lock(m_mutex);
+    for (size_t i = 0; i < MAX_RESOURCES; ++i) {
+      if ((resources & (ResourceSet(1) << i)) && m_owners[i]) return false;
+    }
+    tick();
+    return true;
+  }
+
+  /**
+   * Get the name of the command that owns a subsystem.
+   *
+   * \param resource
+   *        A single subsystem bit
+   *
+   * \return The owner's name, or nullptr if the subsystem is idle
+   */
+  const char* get_owner(ResourceSet resource) const {
+    std::lock_guard<TMutex> lock(m_mutex);
+    for (size_t i = 0; i < MAX_RESOURCES; ++i) {
+      if (resource & (ResourceSet(1) << i)) return m_owners[i] ? m_owners[i]->m_name : nullptr;
+    }
+    return nullptr;
+  }
+
+  /**
+   * Get the counters of a command.
+   *
+   * \param command
+   *        The command
+   *
+   * \return A consistent copy of its counters
+   */
+  Command::Stats get_stats(const Command& command) const {
+    std::lock_guard<TMutex> lock(m_mutex);
+    return command.m_stats;
+  }
+
+private:
+
+  /**
+   * Guards the owners and every command's state.
+   */
+  mutable TMutex m_mutex;
+
+  /**
+   * The command owning each subsystem, or nullptr.
+   */
+  Command* m_owners[MAX_RESOURCES];
+
+  // release all of a command's subsystems; the mutex must be held
+  void end(Command& command, bool interrupted) {
+    for (size_t i = 0; i < MAX_RESOURCES; ++i) {
+      if (m_owners[i] == &command) m_owners[i] = nullptr;
+    }
+    command.m_active = false;
+    if (interrupted) ++command.m_stats.m_interrupted;
+    if (command.m_end) command.m_end(interrupted);
+  }
+};
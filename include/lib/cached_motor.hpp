@@ -0,0 +1,134 @@
+#pragma once
+
+#include "main.h"
+
+/**
+ * CachedMotor class.
+ * A Motor that only sends a command to the smart port when it differs from the last command sent,
+ * or when the keep-alive interval has passed since it was last sent.
+ * A command is only cached once the port accepts it, so one that failed is sent again on the next call.
+ */
+class CachedMotor : public Motor {
+
+public:
+
+  /**
+   * Counts of commands sent to and withheld from the motor.
+   */
+  struct WriteStats {
+    uint32_t m_issued;     ///< Commands sent to the motor
+    uint32_t m_suppressed; ///< Commands withheld because they matched the last command
+  };
+
+  /**
+   * Constructor.
+   * 
+   * \param port
+   *        The port of the motor
+   * \param reverse
+   *        Whether the motor is reversed
+   * \param gearset
+   *        The motor's gearset
+   * \param encoder_units
+   *        The motor's encoder units
+   * \param keep_alive
+   *        Unchanged commands are resent after this long
+   */
+  CachedMotor(
+    std::uint8_t port, bool reverse, AbstractMotor::gearset gearset, AbstractMotor::encoderUnits encoder_units,
+    QTime keep_alive = 100_ms
+  );
+
+  /**
+   * Set the voltage of the motor.
+   * Sent only if the motor is not already at this voltage.
+   * 
+   * \param ivoltage
+   *        The desired voltage, in mV
+   */
+  std::int32_t moveVoltage(std::int16_t ivoltage) override;
+
+  /**
+   * Set the velocity of the motor.
+   * Sent only if the motor is not already at this velocity.
+   * 
+   * \param ivelocity
+   *        The desired velocity, in RPM
+   */
+  std::int32_t moveVelocity(std::int16_t ivelocity) override;
+
+  /**
+   * Set the brake mode of the motor.
+   * Sent only if the motor is not already in this mode.
+   * 
+   * \param imode
+   *        The desired brake mode
+   */
+  std::int32_t setBrakeMode(AbstractMotor::brakeMode imode) override;
+
+  /**
+   * Get the counts of sent and withheld commands.
+   * 
+   * \return The counts
+   */
+  WriteStats get_write_stats() const;
+
+  /**
+   * Get the voltage the motor was last told to apply, whether it was sent or withheld.
+   * Reads nothing from the motor.
+   * 
+   * \return The voltage, in mV; 0 if the last command was a velocity
+   */
+  std::int16_t get_commanded_voltage() const;
+
+private:
+
+  /**
+   * The kind of the last movement command.
+   */
+  enum class Command {
+    NONE,
+    VOLTAGE,
+    VELOCITY
+  };
+
+  /**
+   * Unchanged commands are resent after this many ms.
+   */
+  uint32_t m_keep_alive;
+
+  /**
+   * The last movement command sent.
+   */
+  Command m_command;
+  std::int16_t m_command_value;
+  uint32_t m_command_time;
+
+  /**
+   * The last voltage asked for, sent or not.
+   */
+  std::int16_t m_commanded_voltage;
+
+  /**
+   * The last brake mode sent.
+   */
+  bool m_brake_mode_valid;
+  AbstractMotor::brakeMode m_brake_mode;
+  uint32_t m_brake_mode_time;
+
+  /**
+   * Write counts.
+   */
+  WriteStats m_stats;
+
+  /**
+   * Whether a command should be sent.
+   * Updates the counts.
+   */
+  bool should_send(bool changed, uint32_t last_time, uint32_t now);
+
+  /**
+   * Cache a movement command, or forget the last one if the write failed.
+   */
+  void remember_command(std::int32_t result, Command command, std::int16_t value, uint32_t now);
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "lib/feedforward.hpp"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Control laws shared by the robot and the host tools (tools/tune_gains.cpp, tools/evaluate_autonomous.cpp).
+ * Do not depend on PROS, so the tools simulate the same code the robot runs.
+ * Voltages are in mV; joint positions are in deg and velocities in deg/s.
+ */
+namespace control_laws {
+
+  /**
+   * Voltage that follows a profile setpoint.
+   *
+   * \param feedforward
+   *        The feedforward of the unloaded mechanism
+   * \param kp
+   *        Gain per deg of position error
+   * \param kd
+   *        Gain per deg/s of velocity error
+   * \param mass_ratio
+   *        How much heavier the load is than the unloaded mechanism; scales acceleration and gravity
+   * \param position_setpoint
+   *        The setpoint's position
+   * \param velocity_setpoint
+   *        The setpoint's velocity
+   * \param acceleration_setpoint
+   *        The setpoint's acceleration
+   * \param position
+   *        The measured position
+   * \param velocity
+   *        The measured velocity
+   *
+   * \return The voltage
+   */
+  inline double follow(
+    const Feedforward& feedforward, double kp, double kd, double mass_ratio,
+    double position_setpoint, double velocity_setpoint, double acceleration_setpoint,
+    double position, double velocity
+  ) {
+    return
+      feedforward.calculate(velocity_setpoint, mass_ratio * acceleration_setpoint, position) +
+      (mass_ratio - 1) * feedforward.gravity(position) +
+      kp * (position_setpoint - position) +
+      kd * (velocity_setpoint - velocity);
+  }
+
+  /**
+   * Voltage that holds a position.
+   *
+   * \param kp
+   *        Gain per deg of position error
+   * \param kd
+   *        Gain per deg/s of velocity
+   * \param limit
+   *        The largest voltage applied
+   * \param target
+   *        The position to hold
+   * \param position
+   *        The measured position
+   * \param velocity
+   *        The measured velocity
+   *
+   * \return The voltage
+   */
+  inline double hold(double kp, double kd, double limit, double target, double position, double velocity) {
+    return std::max(-limit, std::min(limit, kp * (target - position) - kd * velocity));
+  }
+
+  /**
+   * Correction that keeps two sides of a mechanism together.
+   * Added to the trailing side and subtracted from the leading side.
+   *
+   * \param kp
+   *        Gain per deg of difference between the sides
+   * \param kd
+   *        Gain per deg/s of difference between the sides
+   * \param difference
+   *        How far the second side leads the first
+   * \param velocity_difference
+   *        How much faster the second side moves than the first
+   *
+   * \return The correction to add to the first side and subtract from the second
+   */
+  inline double sync(double kp, double kd, double difference, double velocity_difference) {
+    return kp * difference + kd * velocity_difference;
+  }
+
+  /**
+   * Wheel velocities of a differential drive, in m/s.
+   */
+  struct WheelSpeeds {
+    double m_left;
+    double m_right;
+  };
+
+  /**
+   * RAMSETE trajectory tracking.
+   * Poses are in a counterclockwise frame: m, m and rad.
+   *
+   * \param b
+   *        Aggressiveness, in rad^2/m^2
+   * \param zeta
+   *        Damping
+   * \param min_gain
+   *        Least feedback gain, in 1/s; RAMSETE's own gain falls to zero with the setpoint's velocity,
+   *        which would leave any error at the end of a trajectory uncorrected
+   * \param half_track
+   *        Half the distance between the wheels, in m
+   * \param x, y, theta
+   *        The measured pose
+   * \param x_d, y_d, theta_d
+   *        The setpoint's pose
+   * \param v_d
+   *        The setpoint's forward velocity, in m/s
+   * \param omega_d
+   *        The setpoint's angular velocity, in rad/s
+   *
+   * \return The wheel velocities that bring the chassis back onto the trajectory
+   */
+  inline WheelSpeeds ramsete(
+    double b, double zeta, double min_gain, double half_track,
+    double x, double y, double theta,
+    double x_d, double y_d, double theta_d, double v_d, double omega_d
+  ) {
+
+    // error in the robot's frame
+    double cos_theta = std::cos(theta), sin_theta = std::sin(theta);
+    double e_x = cos_theta * (x_d - x) + sin_theta * (y_d - y);
+    double e_y = -sin_theta * (x_d - x) + cos_theta * (y_d - y);
+    double e_theta = std::remainder(theta_d - theta, 2 * M_PI);
+
+    double k = std::max(min_gain, 2 * zeta * std::sqrt(omega_d * omega_d + b * v_d * v_d));
+    double sinc = std::abs(e_theta) < 1e-6 ? 1 - e_theta * e_theta / 6 : std::sin(e_theta) / e_theta;
+    double v = v_d * std::cos(e_theta) + k * e_x;
+    double omega = omega_d + k * e_theta + b * v_d * sinc * e_y;
+    return {v - omega * half_track, v + omega * half_track};
+  }
+}
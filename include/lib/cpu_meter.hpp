@@ -0,0 +1,68 @@
+#pragma once
+
+#include "main.h"
+#include "lib/snapshot.hpp"
+
+/**
+ * CpuMeter class.
+ * Measures how long a task runs between blocking calls, and how often it wakes.
+ * The task calls begin() when it wakes and end() before it blocks; any task can read the totals.
+ *
+ * Time is measured with the brain's microsecond clock from wake to block,
+ * so it also counts time the task spent preempted by higher priority tasks; treat it as an upper bound.
+ */
+class CpuMeter {
+
+public:
+
+  /**
+   * Totals since the meter was created.
+   */
+  struct Stats {
+    uint64_t m_busy;    ///< Time spent awake, in us
+    uint32_t m_wakeups; ///< Number of times the task woke
+  };
+
+  /**
+   * Constructor.
+   * The task counts as awake until its first end().
+   */
+  CpuMeter();
+
+  /**
+   * Record that the task woke.
+   * Must only be called from the measured task.
+   */
+  void begin();
+
+  /**
+   * Record that the task is about to block.
+   * Must only be called from the measured task.
+   */
+  void end();
+
+  /**
+   * Get the totals.
+   *
+   * \return The totals, as of the task's last end()
+   */
+  Stats get_stats() const;
+
+private:
+
+  /**
+   * When the task last woke, in us.
+   */
+  uint64_t m_start;
+
+  /**
+   * Totals, written only by the measured task.
+   */
+  Stats m_totals;
+  Snapshot<Stats> m_stats;
+
+  /**
+   * The clock, in us.
+   */
+  static uint64_t now();
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * An event recognized by a CubeDetector, or a change to its count.
+ */
+enum class CubeEvent {
+  NONE, ///< Nothing happened
+  IN,   ///< A cube was taken in
+  OUT,  ///< A cube was pushed out
+  SET   ///< The count was set, such as after a deposit; never returned by CubeDetector::step()
+};
+
+/**
+ * CubeDetector class.
+ * Recognizes cubes passing through the intake from a stream of roller samples.
+ *
+ * While the rollers are driven, they run at a steady free speed and current, which are tracked as a baseline.
+ * A cube squeezed between the rollers slows them and raises their current draw at the same time;
+ * when both last long enough, the cube is counted as in or out depending on the direction of the rollers.
+ * Samples just after the rollers start or change direction are ignored, as they spin up with the same signature.
+ * Does not depend on PROS, so recorded traces can be replayed on a host.
+ */
+class CubeDetector {
+
+public:
+
+  /**
+   * The rollers are driven when the magnitude of their voltage is above this, in mV.
+   */
+  static constexpr int ACTIVE_VOLTAGE = 3000;
+
+  /**
+   * Samples this long after the rollers start or change direction are ignored, in ms.
+   */
+  static constexpr uint32_t SPIN_UP_TIME = 300;
+
+  /**
+   * A cube slows the rollers below this fraction of their free speed.
+   */
+  static constexpr double VELOCITY_DIP = .7;
+
+  /**
+   * A cube raises the current by at least this much above the free current, in mA.
+   */
+  static constexpr double CURRENT_RISE = 400;
+
+  /**
+   * Both must last this long to count as a cube, in ms.
+   */
+  static constexpr uint32_t MIN_DURATION = 40;
+
+  /**
+   * How quickly the baseline follows the free speed and current, per sample.
+   */
+  static constexpr double BASELINE_RATE = .05;
+
+  /**
+   * Constructor.
+   */
+  CubeDetector();
+
+  /**
+   * Add a sample.
+   *
+   * \param time
+   *        The time of the sample, in ms
+   * \param voltage
+   *        The voltage commanded to the rollers, in mV; positive takes cubes in
+   * \param velocity
+   *        The velocity of the rollers, in any unit; positive takes cubes in
+   * \param current
+   *        The current drawn by the rollers, in mA
+   *
+   * \return The event completed by this sample, if any
+   */
+  CubeEvent step(uint32_t time, int voltage, double velocity, double current);
+
+  /**
+   * Get the number of cubes held: cubes in minus cubes out, never below zero.
+   *
+   * \return The number of cubes
+   */
+  size_t get_count() const;
+
+  /**
+   * Set the number of cubes held, such as after a deposit.
+   *
+   * \param count
+   *        The number of cubes
+   */
+  void set_count(size_t count);
+
+private:
+
+  /**
+   * The direction the rollers were last driven: 1 in, -1 out, 0 not driven.
+   */
+  int m_direction;
+
+  /**
+   * When the rollers last started or changed direction, in ms.
+   */
+  uint32_t m_direction_time;
+
+  /**
+   * Free speed and current while driven.
+   */
+  double m_baseline_velocity;
+  double m_baseline_current;
+  bool m_baseline_valid;
+
+  /**
+   * When the current dip started, in ms, and whether it has already been counted.
+   */
+  bool m_in_dip;
+  uint32_t m_dip_start;
+  bool m_dip_counted;
+
+  /**
+   * The number of cubes held.
+   */
+  size_t m_count;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * DerivativeEstimator class.
+ * Estimates the velocity and acceleration of a position from timestamped samples,
+ * by fitting a quadratic to the most recent samples with least squares.
+ *
+ * Samples may arrive at any interval; each is weighted by its own timestamp, so a caller that steps
+ * irregularly (or from several tasks in turn) still gets unbiased estimates.
+ * Nothing is allocated, and a step costs a few dozen multiplications.
+ * Does not depend on PROS, so it can also be built on a host.
+ */
+class DerivativeEstimator {
+
+public:
+
+  /**
+   * The largest window, in samples.
+   */
+  static constexpr size_t MAX_WINDOW = 16;
+
+  /**
+   * Constructor.
+   *
+   * \param window
+   *        The number of samples fitted; longer windows are smoother but lag more. Between 3 and MAX_WINDOW
+   * \param max_age
+   *        Samples older than this, in ms, are ignored, so estimates recover quickly after a pause
+   */
+  DerivativeEstimator(size_t window = 12, uint32_t max_age = 150);
+
+  /**
+   * Add a sample.
+   * A sample with the same time as the previous one replaces it.
+   *
+   * \param position
+   *        The position, in any unit
+   * \param time
+   *        The time the position was read, in ms
+   */
+  void step(double position, uint32_t time);
+
+  /**
+   * Forget all samples.
+   */
+  void reset();
+
+  /**
+   * Get the estimated velocity at the most recent sample.
+   *
+   * \return The velocity, in position units per second
+   */
+  double get_velocity() const;
+
+  /**
+   * Get the estimated acceleration at the most recent sample.
+   *
+   * \return The acceleration, in position units per second squared
+   */
+  double get_acceleration() const;
+
+private:
+
+  /**
+   * Settings.
+   */
+  size_t m_window;
+  uint32_t m_max_age;
+
+  /**
+   * The samples, as a ring buffer.
+   */
+  double m_positions[MAX_WINDOW];
+  uint32_t m_times[MAX_WINDOW];
+  size_t m_count;
+  size_t m_next;
+
+  /**
+   * The latest estimates.
+   */
+  double m_velocity;
+  double m_acceleration;
+
+  /**
+   * Refit the estimates to the samples.
+   */
+  void fit();
+};
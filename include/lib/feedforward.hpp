@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cmath>
+
+/**
+ * Feedforward constants of a mechanism driven by voltage.
+ * Fitted from characterization logs by tools/fit_feedforward.py into include/feedforward_gains.hpp, whose values are
+ * hand-tuned until it is run.
+ *
+ * Units follow the mechanism's position: m for the drive, deg for everything else.
+ * Gravity pulls hardest at m_horizontal and scales with the cosine of the position from there.
+ */
+struct Feedforward {
+  double m_ks;         ///< Voltage to overcome static friction, in mV
+  double m_kv;         ///< Voltage per unit/s of velocity, in mV
+  double m_ka;         ///< Voltage per unit/s^2 of acceleration, in mV
+  double m_kg;         ///< Voltage to hold against gravity at m_horizontal, in mV; 0 if gravity does not act
+  double m_horizontal; ///< Position at which gravity pulls hardest, in deg
+
+  /**
+   * Calculate the feedforward voltage.
+   *
+   * \param velocity
+   *        The desired velocity
+   * \param acceleration
+   *        The desired acceleration
+   * \param position
+   *        The current position, in deg; only used for gravity
+   *
+   * \return The voltage, in mV
+   */
+  double calculate(double velocity, double acceleration, double position = 0) const {
+    double voltage = m_kv * velocity + m_ka * acceleration;
+    if (std::abs(velocity) > 1e-3) voltage += std::copysign(m_ks, velocity);
+    return voltage + gravity(position);
+  }
+
+  /**
+   * Calculate the voltage that holds the mechanism against gravity.
+   *
+   * \param position
+   *        The current position, in deg
+   *
+   * \return The voltage, in mV
+   */
+  double gravity(double position) const {
+    return m_kg * std::cos((position - m_horizontal) * M_PI / 180);
+  }
+};
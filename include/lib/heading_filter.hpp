@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Fuses the heading change measured by the tracking wheels with the rotation of an IMU.
+ * Shared by Odom and the host tools (tools/validate_heading.cpp); does not depend on PROS.
+ * Angles are in rad, clockwise positive; times are in s; wheel travel is in in.
+ *
+ * Between IMU samples the heading follows the tracking wheels, which update faster than the IMU.
+ * Every time the IMU reports a new rotation, the wheels' heading change since its last sample is fused with the IMU's:
+ * - the IMU's change, less its estimated bias, is weighted against the wheels' change by their variances;
+ *   wheel variance grows with wheel travel, so the IMU dominates while the wheels may be slipping;
+ * - wheel changes too far from the IMU's to be noise are treated as slip (wall contact, tilter deposits) and dropped;
+ * - once the wheels have been still for a moment the robot is not turning, so the IMU's change over the still period
+ *   is its bias, which is tracked with a scalar Kalman filter.
+ * The heading variance grows with every fused change, and is reset when the heading is known.
+ * Runs in constant time and does not allocate.
+ */
+class HeadingFilter {
+
+public:
+
+  /**
+   * Noise of the sensors.
+   */
+  struct Noise {
+    double m_wheel;       ///< Variance of the wheels' heading change over one update, in rad²
+    double m_wheel_slip;  ///< Variance of the wheels' heading change per in of wheel travel, in rad²/in
+    double m_imu;         ///< Variance of the IMU's rotation per s, in rad²/s
+    double m_imu_noise;   ///< Variance of each reading of the IMU's rotation, in rad²
+    double m_imu_scale;   ///< Relative scale error of the IMU's rotation
+    double m_bias_drift;  ///< Growth of the variance of the IMU's bias, in rad²/s³
+    double m_bias_prior;  ///< Variance of the IMU's bias before it has been measured, in rad²/s²
+    double m_gate;        ///< Wheel changes further than this many standard deviations from the IMU's are slip
+    double m_settle;      ///< The wheels must be still this long before the IMU's change is taken as bias, in s
+    double m_max_window;  ///< An unchanged IMU rotation is taken as no rotation after this long, in s
+  };
+
+  /**
+   * Noise of the tracking wheels and the V5 inertial sensor; see tools/validate_heading.cpp.
+   */
+  static constexpr Noise DEFAULT_NOISE = {
+    1e-6,   // about .06 deg per update from encoder quantization
+    2.5e-5, // about .3 deg of slip per in of travel
+    1e-6,   // about .06 deg of random walk per root s
+    1e-7,   // about .02 deg of noise
+    .01,    // 1% scale error
+    1e-7,
+    1e-4,   // .6 deg/s of bias
+    3,
+    .25,
+    .03     // the IMU reports every 10ms
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param noise
+   *        The noise of the sensors
+   */
+  HeadingFilter(const Noise& noise = DEFAULT_NOISE):
+    m_noise(noise),
+    m_heading(0), m_variance(0), m_reset_heading(0),
+    m_bias(0), m_bias_variance(noise.m_bias_prior),
+    m_last_imu(NAN),
+    m_window_wheels(0), m_window_travel(0), m_window_time(0), m_window_updates(0),
+    m_window_variance(0),
+    m_still_time(0), m_still_imu(0), m_still_span(0),
+    m_fused(0), m_rejected(0)
+  {}
+
+  /**
+   * Update the heading.
+   *
+   * \param wheels
+   *        The change in heading measured by the tracking wheels since the last update
+   * \param travel
+   *        The distance travelled by the left and right tracking wheels since the last update, summed
+   * \param dt
+   *        The time since the last update
+   * \param imu
+   *        The IMU's rotation, or NAN if it is calibrating, missing or failed to read
+   *
+   * \return The change in heading since the last update
+   */
+  double update(double wheels, double travel, double dt, double imu) {
+    double last_heading = get_heading();
+
+    // the wheels carry the heading until the IMU reports
+    m_window_wheels += wheels;
+    m_window_travel += std::abs(travel);
+    m_window_time += dt;
+    ++m_window_updates;
+
+    if (std::isnan(imu)) {
+
+      // without an IMU the wheels are all there is
+      m_last_imu = NAN;
+      close_window(m_window_wheels, wheel_variance());
+    }
+    else if (std::isnan(m_last_imu)) {
+
+      // the first IMU reading only starts a window
+      m_last_imu = imu;
+      close_window(m_window_wheels, wheel_variance());
+    }
+    else if (imu != m_last_imu || m_window_time >= m_noise.m_max_window) {
+      fuse(imu - m_last_imu);
+      m_last_imu = imu;
+    }
+    else {
+      m_window_variance = wheel_variance();
+    }
+
+    return get_heading() - last_heading;
+  }
+
+  /**
+   * Get the heading.
+   * Starts at zero, so only its changes are meaningful.
+   *
+   * \return The heading
+   */
+  double get_heading() const {
+    return m_heading + m_window_wheels;
+  }
+
+  /**
+   * Get the variance of the heading.
+   * The heading is known exactly after reset_variance(); this is how far it may have drifted since.
+   *
+   * \return The variance, in rad²
+   */
+  double get_variance() const {
+
+    // the IMU's scale error is the same for every window, so it grows with the heading rather than adding up
+    double scale = m_noise.m_imu_scale * (get_heading() - m_reset_heading);
+    return m_variance + m_window_variance + scale * scale;
+  }
+
+  /**
+   * Get the estimated bias of the IMU.
+   *
+   * \return The bias, in rad/s
+   */
+  double get_bias() const {
+    return m_bias;
+  }
+
+  /**
+   * Get the variance of the estimated bias of the IMU.
+   *
+   * \return The variance, in rad²/s²
+   */
+  double get_bias_variance() const {
+    return m_bias_variance;
+  }
+
+  /**
+   * Get the number of IMU samples fused with the wheels.
+   *
+   * \return The count
+   */
+  uint32_t get_fused_count() const {
+    return m_fused;
+  }
+
+  /**
+   * Get the number of IMU samples whose wheel changes were dropped as slip.
+   *
+   * \return The count
+   */
+  uint32_t get_rejected_count() const {
+    return m_rejected;
+  }
+
+  /**
+   * Declare the current heading known exactly, such as when it is tared.
+   */
+  void reset_variance() {
+    m_variance = -m_window_variance;
+    m_reset_heading = get_heading();
+  }
+
+private:
+
+  Noise m_noise;
+
+  /**
+   * The heading at the end of the last window, and its variance less the IMU's scale error.
+   */
+  double m_heading;
+  double m_variance;
+
+  /**
+   * The heading when the variance was last reset.
+   */
+  double m_reset_heading;
+
+  /**
+   * The IMU's bias, and its variance.
+   */
+  double m_bias;
+  double m_bias_variance;
+
+  /**
+   * The IMU's rotation at the end of the last window, or NAN.
+   */
+  double m_last_imu;
+
+  /**
+   * The wheels since the end of the last window.
+   */
+  double m_window_wheels;
+  double m_window_travel;
+  double m_window_time;
+  uint32_t m_window_updates;
+  double m_window_variance;
+
+  /**
+   * How long the wheels have been still, and the IMU's change and the time since they settled.
+   */
+  double m_still_time;
+  double m_still_imu;
+  double m_still_span;
+
+  /**
+   * The bias is updated at least this often while the wheels are still, in s.
+   */
+  static constexpr double BIAS_SPAN = 1;
+
+  /**
+   * Counts of windows fused and of windows whose wheel changes were dropped.
+   */
+  uint32_t m_fused;
+  uint32_t m_rejected;
+
+  // variance of the wheels' heading change over the window
+  double wheel_variance() const {
+    return m_noise.m_wheel * m_window_updates + m_noise.m_wheel_slip * m_window_travel;
+  }
+
+  // update the bias from the IMU's change while the wheels were still
+  void update_bias() {
+    if (m_still_span <= 0) return;
+    double bias = m_still_imu / m_still_span;
+    double variance = (m_noise.m_imu * m_still_span + 2 * m_noise.m_imu_noise) / (m_still_span * m_still_span);
+    double gain = m_bias_variance / (m_bias_variance + variance);
+    m_bias += gain * (bias - m_bias);
+    m_bias_variance -= gain * m_bias_variance;
+    m_still_imu = 0;
+    m_still_span = 0;
+  }
+
+  // add a change of heading and start a new window
+  void close_window(double change, double variance) {
+    m_heading += change;
+    m_variance += variance;
+    m_bias_variance += m_noise.m_bias_drift * m_window_time;
+    m_window_wheels = 0;
+    m_window_travel = 0;
+    m_window_time = 0;
+    m_window_updates = 0;
+    m_window_variance = 0;
+  }
+
+  // fuse the IMU's change over the window with the wheels'
+  void fuse(double imu_change) {
+    double dt = m_window_time;
+    double wheels = m_window_wheels;
+    double wheels_variance = wheel_variance();
+
+    // the whole still period measures the bias at once, so the IMU's noise cancels between its readings;
+    // moving wheels have systematic errors (scale, scrub) that must not leak into it
+    if (m_window_travel == 0) {
+      m_still_time += dt;
+      if (m_still_time > m_noise.m_settle) {
+        m_still_imu += imu_change;
+        m_still_span += dt;
+      }
+      if (m_still_span >= BIAS_SPAN) update_bias();
+    }
+    else {
+      update_bias();
+      m_still_time = 0;
+    }
+
+    // the IMU's change less its bias
+    double imu = imu_change - m_bias * dt;
+    double scale = m_noise.m_imu_scale * imu_change;
+    double imu_variance = m_noise.m_imu * dt + 2 * m_noise.m_imu_noise + scale * scale + m_bias_variance * dt * dt;
+
+    // drop the wheels if they disagree by more than noise
+    double innovation = wheels - imu;
+    double innovation_variance = wheels_variance + imu_variance;
+    if (innovation * innovation > m_noise.m_gate * m_noise.m_gate * innovation_variance) {
+      ++m_rejected;
+      close_window(imu, imu_variance);
+      return;
+    }
+    ++m_fused;
+
+    // weight the changes by their variances
+    double gain = imu_variance / innovation_variance;
+    close_window(imu + gain * innovation, imu_variance * wheels_variance / innovation_variance);
+  }
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "okapi/api/units/QAngle.hpp"
+#include "okapi/api/units/QAngularAcceleration.hpp"
+#include "okapi/api/units/QAngularJerk.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QTime.hpp"
+
+using namespace okapi;
+
+/**
+ * A setpoint of a joint's motion profile.
+ */
+struct ProfilePoint {
+  QAngle m_position;                   ///< Angle of the joint
+  QAngularSpeed m_velocity;            ///< Angular velocity of the joint
+  QAngularAcceleration m_acceleration; ///< Angular acceleration of the joint
+};
+
+/**
+ * TrapezoidProfile class.
+ * A time-optimal move of a joint to a target under velocity and acceleration limits, ending at rest.
+ */
+class TrapezoidProfile {
+
+public:
+
+  /**
+   * Constructor.
+   * An initial velocity away from the target, or too fast to stop in time, is clamped.
+   * 
+   * \param start
+   *        The angle to start from
+   * \param target
+   *        The angle to end at
+   * \param max_velocity
+   *        The maximum angular velocity
+   * \param max_acceleration
+   *        The maximum angular acceleration and deceleration
+   * \param start_velocity
+   *        The angular velocity to start from
+   */
+  TrapezoidProfile(
+    QAngle start, QAngle target, QAngularSpeed max_velocity, QAngularAcceleration max_acceleration,
+    QAngularSpeed start_velocity = 0_rpm
+  );
+
+  /**
+   * Sample the profile.
+   * 
+   * \param time
+   *        Time since the start of the profile; clamped to the profile
+   * 
+   * \return The setpoint
+   */
+  ProfilePoint sample(QTime time) const;
+
+  /**
+   * Get the duration of the profile.
+   * 
+   * \return The duration
+   */
+  QTime duration() const;
+
+  /**
+   * Get the angle the profile ends at.
+   * 
+   * \return The target angle
+   */
+  QAngle get_target() const;
+
+private:
+
+  /**
+   * Endpoints, and the direction of travel (1 or -1).
+   */
+  QAngle m_start;
+  QAngle m_target;
+  double m_direction;
+
+  /**
+   * Speeds and acceleration, in the direction of travel.
+   */
+  QAngularSpeed m_start_velocity;
+  QAngularSpeed m_peak_velocity;
+  QAngularAcceleration m_acceleration;
+
+  /**
+   * Durations of the accelerating, cruising and decelerating phases.
+   */
+  QTime m_accel_time;
+  QTime m_cruise_time;
+  QTime m_decel_time;
+};
+
+/**
+ * SCurveProfile class.
+ * A jerk-limited move of a joint to a target, starting and ending at rest.
+ * The joint may be slowed to a lower cruising velocity from a given angle onwards,
+ * so it can move quickly at first and gently near the end.
+ */
+class SCurveProfile {
+
+public:
+
+  /**
+   * Constructor.
+   * Velocities are lowered where the distance is too short to reach them.
+   * 
+   * \param start
+   *        The angle to start from
+   * \param target
+   *        The angle to end at
+   * \param max_velocity
+   *        The maximum angular velocity
+   * \param max_acceleration
+   *        The maximum angular acceleration and deceleration
+   * \param max_jerk
+   *        The maximum rate of change of acceleration
+   * \param slow_from
+   *        The angle from which the joint moves no faster than slow_velocity
+   * \param slow_velocity
+   *        The maximum angular velocity beyond slow_from
+   */
+  SCurveProfile(
+    QAngle start, QAngle target, QAngularSpeed max_velocity, QAngularAcceleration max_acceleration, QAngularJerk max_jerk,
+    QAngle slow_from, QAngularSpeed slow_velocity
+  );
+
+  /**
+   * Sample the profile.
+   * 
+   * \param time
+   *        Time since the start of the profile; clamped to the profile
+   * 
+   * \return The setpoint
+   */
+  ProfilePoint sample(QTime time) const;
+
+  /**
+   * Get the duration of the profile.
+   * 
+   * \return The duration
+   */
+  QTime duration() const;
+
+  /**
+   * Get the angle the profile ends at.
+   * 
+   * \return The target angle
+   */
+  QAngle get_target() const;
+
+private:
+
+  /**
+   * A phase of the profile: a jerk-limited change of velocity, or a cruise when the velocities are equal.
+   * Distances are in degrees along the direction of travel, and times in seconds.
+   */
+  struct Phase {
+    double m_duration;
+    double m_start_distance;
+    double m_start_velocity;
+    double m_end_velocity;
+  };
+
+  /**
+   * The number of phases: speed up, cruise, slow down, cruise slowly, stop.
+   */
+  static constexpr size_t NUM_PHASES = 5;
+
+  /**
+   * Endpoints, and the direction of travel (1 or -1).
+   */
+  QAngle m_start;
+  QAngle m_target;
+  double m_direction;
+
+  /**
+   * Limits, in degrees and seconds.
+   */
+  double m_acceleration;
+  double m_jerk;
+
+  /**
+   * The phases.
+   */
+  Phase m_phases[NUM_PHASES];
+
+  /**
+   * Duration of a jerk-limited change of velocity, in seconds.
+   */
+  double ramp_time(double from, double to) const;
+
+  /**
+   * Distance covered by a jerk-limited change of velocity, in degrees.
+   */
+  double ramp_distance(double from, double to) const;
+
+  /**
+   * Sample a phase.
+   * 
+   * \param phase
+   *        The phase
+   * \param time
+   *        Time since the start of the phase, in seconds
+   * \param distance
+   *        Set to the distance travelled since the start of the profile
+   * \param velocity
+   *        Set to the velocity
+   * \param acceleration
+   *        Set to the acceleration
+   */
+  void sample_phase(const Phase& phase, double time, double& distance, double& velocity, double& acceleration) const;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "main.h"
+#include "lib/snapshot.hpp"
+#include "lib/heading_filter.hpp"
+#include <atomic>
 #include <memory>
 
 /**
@@ -11,6 +14,8 @@ class Odom {
 
   friend class Chassis;
 
+  public:
+
   /**
    * A struct storing the pose of the chassis.
    */
@@ -38,7 +43,7 @@ class Odom {
      * \param enc_s
      *        Distance that the sideways encoder has travelled
      */
-    ChassisPose(QLength x, QLength y, QAngle heading, QLength enc_l = 0_in, QLength enc_r = 0_in, QLength enc_s = 0_in):
+    ChassisPose(QLength x = 0_in, QLength y = 0_in, QAngle heading = 0_deg, QLength enc_l = 0_in, QLength enc_r = 0_in, QLength enc_s = 0_in):
       m_x(x), m_y(y), m_heading(heading), m_encoder_dist_left(enc_l), m_encoder_dist_right(enc_r), m_encoder_dist_side(enc_s) {}
 
     /**
@@ -103,87 +108,109 @@ class Odom {
      * \param enc_s
      *        Distance that the sideways encoder has travelled
      */
-    ChassisDeriv(QSpeed x, QSpeed y, QAngularSpeed heading, QSpeed enc_l = 0_mps, QSpeed enc_r = 0_mps, QSpeed enc_s = 0_mps):
+    ChassisDeriv(QSpeed x = 0_mps, QSpeed y = 0_mps, QAngularSpeed heading = 0_rpm, QSpeed enc_l = 0_mps, QSpeed enc_r = 0_mps, QSpeed enc_s = 0_mps):
       m_x(x), m_y(y), m_heading(heading), m_encoder_dist_left(enc_l), m_encoder_dist_right(enc_r), m_encoder_dist_side(enc_s) {}
   };
 
-  public:
+  /**
+   * A struct storing the pose of the chassis and its derivative from the same update.
+   */
+  struct ChassisState {
+    ChassisPose m_pose;        ///< Pose of chassis
+    ChassisDeriv m_deriv;      ///< Derivative of the pose of chassis
+    double m_heading_variance; ///< Variance of the heading since it was last tared, in rad²
+  };
+
+  /**
+   * Sensor readings for one update, in degrees.
+   * A reading is PROS_ERR if the sensor failed to read, is missing or, for the IMU, is calibrating.
+   */
+  struct Readings {
+    uint32_t m_time;       ///< Time the encoders were read, in ms
+    double m_left;         ///< Left tracking wheel
+    double m_right;        ///< Right tracking wheel
+    double m_side;         ///< Sideways tracking wheel
+    double m_left_backup;  ///< Backup encoder on the left of the drive
+    double m_right_backup; ///< Backup encoder on the right of the drive
+    double m_imu_rotation; ///< IMU rotation, clockwise positive
+  };
 
   /**
    * Constructor.
    * 
-   * \param enc_left
-   *        The encoder associated with the left of the drive
-   * \param enc_right
-   *        The encoder associated with the right of the drive
-   * \param enc_side
-   *        The encoder associated with the sideways tracking wheel
-   * \param enc_left_backup
-   *        A second encoder associated with the left of the drive
-   * \param enc_right_backup
-   *        A second encoder associated with the right of the drive
    * \param track_width
    *        The distance between the left and right tracking wheels
-   * \param side_wheel_dist
-   *        The distance from the side wheel to the tracking center
+   * \param secondary_track_width
+   *        The distance between the left and right backup encoders' wheels
+   * \param side_dist
+   *        The distance from the side wheel to the tracking center; positive if the wheel is behind the center
    * \param wheel_radius
    *        The radius of the tracking wheels
+   * \param secondary_wheel_radius
+   *        The radius of the wheels the backup encoders are attached to
    */
   Odom(
-    std::unique_ptr<ContinuousRotarySensor> enc_left,
-    std::unique_ptr<ContinuousRotarySensor> enc_right,
-    std::unique_ptr<ContinuousRotarySensor> enc_side,
-    std::shared_ptr<ContinuousRotarySensor> enc_left_backup = nullptr,
-    std::shared_ptr<ContinuousRotarySensor> enc_right_backup = nullptr,
-    std::unique_ptr<pros::Imu> imu = nullptr,
-    QLength track_width = 16_in, QLength secondary_track_width = 16_in, QLength side_dist = 0_in, QLength wheel_radius = 1.375_in
+    QLength track_width = 16_in, QLength secondary_track_width = 16_in, QLength side_dist = 0_in, QLength wheel_radius = 1.375_in,
+    QLength secondary_wheel_radius = 2_in
   );
 
   /**
-   * Update the odom calculations.
+   * Update the odom calculations from new encoder readings.
    * Shoul be run frequently; a 10ms interval is recommended.
+   * Runs in constant time and does not allocate.
+   * If either the left or right encoder failed to read, the backup encoders are used for that update;
+   * after a failure, a source takes over again once it has read twice in a row.
+   * The heading is fused with the IMU whenever it has a reading; see HeadingFilter.
+   * 
+   * \param readings
+   *        The encoder readings, taken together
    */
-  void update();
+  void update(const Readings& readings);
 
   /**
    * Get the current pose of the robot.
-   * Should be run after update() to ensure up-to-date calculations.
+   * Safe to call from any task; never blocks update().
    * 
-   * \return The current pose of the bot
+   * \return A copy of the pose published by the last update()
    */
-  ChassisPose* get_pose();
+  ChassisPose get_pose() const;
 
   /**
    * Get the rate of change of the current pose of the robot.
-   * Should be run after update() to ensure up-to-date calculations.
+   * Safe to call from any task; never blocks update().
    * 
-   * \return The rate of change of the current pose of the bot
+   * \return A copy of the rate of change published by the last update()
    */
-  ChassisDeriv* get_speed();
+  ChassisDeriv get_speed() const;
 
   /**
-   * Tare the pose so that the current pose reads as the value provided.
+   * Get the current pose of the robot and its rate of change.
+   * Both values are guaranteed to come from the same update().
    * 
-   * \param new_pose
-   *        The pose that the current pose will be tared to
+   * \return A copy of the state published by the last update()
    */
-  void tare(ChassisPose* new_pose);
-
-  private:
+  ChassisState get_state() const;
 
   /**
-   * The encoders used to calculate pose.
+   * Get the fused heading's filter, for its bias and slip counts.
+   * Only safe to call from the task running update().
+   * 
+   * \return The filter
    */
-  std::unique_ptr<ContinuousRotarySensor> m_enc_left;
-  std::unique_ptr<ContinuousRotarySensor> m_enc_right;
-  std::unique_ptr<ContinuousRotarySensor> m_enc_side;
-  std::shared_ptr<ContinuousRotarySensor> m_enc_left_backup;
-  std::shared_ptr<ContinuousRotarySensor> m_enc_right_backup;
+  const HeadingFilter& get_heading_filter() const;
 
   /**
-   * An IMU used to supplement the encoders for theta calculation.
+   * Tare the pose so that the current pose reads as the value provided.
+   * Takes effect on the next update(): until then, get_pose() still returns the untared pose.
+   * Safe to call from any task, but not from two at once; if called again before the next update(), only the last
+   * pose is applied.
+   * 
+   * \param new_pose
+   *        The pose that the current pose will be tared to
    */
-    std::unique_ptr<pros::Imu> m_imu;
+  void tare(ChassisPose* new_pose);
+
+  private:
 
   /**
    * The reference pose of the chassis.
@@ -209,6 +236,24 @@ class Odom {
    */
   std::shared_ptr<ChassisDeriv> m_deriv;
 
+  /**
+   * The pose and derivative as published to other tasks.
+   * m_pose and m_deriv are only touched by the task running update().
+   */
+  Snapshot<ChassisState> m_state;
+
+  /**
+   * The last pose requested by tare(), applied by the next update().
+   * tare() publishes the pose before counting the request, so update() never sees a pose from an older request.
+   */
+  Snapshot<ChassisPose> m_pending_tare;
+  std::atomic<uint32_t> m_tare_requests;
+
+  /**
+   * The value of m_tare_requests when update() last applied a tare.
+   */
+  uint32_t m_tares_applied;
+
   /**
    * Physical characteristics.
    */
@@ -216,4 +261,57 @@ class Odom {
   QLength m_secondary_track_width;
   QLength m_side_dist;
   QLength m_wheel_radius;
+  QLength m_secondary_wheel_radius;
+
+  /**
+   * The last encoder readings, in degrees.
+   * Backup readings are tracked even while unused, so switching to them costs no update.
+   */
+  double m_last_left;
+  double m_last_right;
+  double m_last_side;
+  double m_last_left_backup;
+  double m_last_right_backup;
+
+  /**
+   * Fuses the tracking wheels' heading with the IMU's.
+   */
+  HeadingFilter m_heading_filter;
+
+  /**
+   * The absolute heading as a unit vector.
+   * Rotated by small-angle approximations every update so that no trig functions are needed.
+   */
+  double m_heading_cos;
+  double m_heading_sin;
+
+  /**
+   * The rotation of m_reference_pose, cached on tare.
+   */
+  double m_reference_cos;
+  double m_reference_sin;
+
+  /**
+   * The time of the last update, in milliseconds.
+   */
+  uint32_t m_last_update_time;
+
+  /**
+   * Whether each source's last reading was good.
+   * A source is re-seeded from its first good reading after a failure, including on the first update,
+   * and that reading's delta is dropped: the other source has already counted the travel since.
+   */
+  bool m_primary_seeded;
+  bool m_backup_seeded;
+  bool m_side_seeded;
+
+  /**
+   * Calculate the visible pose from the absolute pose and the reference pose, and publish it.
+   */
+  void update_pose_from_reference();
+
+  /**
+   * Set the reference pose so that the current pose reads as the value provided.
+   */
+  void apply_tare(const ChassisPose& new_pose);
 };
\ No newline at end of file
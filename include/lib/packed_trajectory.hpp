@@ -0,0 +1,55 @@
+#pragma once
+
+#include "lib/trajectory.hpp"
+#include <cstdint>
+
+/**
+ * A trajectory setpoint quantized to 16-bit integers.
+ * Generated ahead of time by tools/pack_trajectories.py and compiled in, so nothing is parsed at runtime.
+ * In the odom frame; see TrajectoryPoint.
+ */
+struct PackedSegment {
+
+  /**
+   * The size of one step of each field.
+   * Must match tools/pack_trajectories.py.
+   */
+  static constexpr QLength POSITION_STEP = .125_mm;                 ///< Range of ±4.1m
+  static constexpr QAngle HEADING_STEP = .001_rad;                  ///< Range of ±32.8rad
+  static constexpr QSpeed VELOCITY_STEP = .0001_mps;                ///< Range of ±3.3m/s
+  static constexpr QAcceleration ACCELERATION_STEP = .001_mps2;     ///< Range of ±32.8m/s^2
+  static constexpr QAngularSpeed ANGULAR_VELOCITY_STEP = .001 * radps; ///< Range of ±32.8rad/s
+
+  int16_t m_x;
+  int16_t m_y;
+  int16_t m_heading;
+  int16_t m_velocity;
+  int16_t m_acceleration;
+  int16_t m_angular_velocity;
+
+  /**
+   * Convert to a setpoint.
+   * 
+   * \return The setpoint
+   */
+  TrajectoryPoint unpack() const {
+    return {
+      m_x * POSITION_STEP,
+      m_y * POSITION_STEP,
+      m_heading * HEADING_STEP,
+      m_velocity * VELOCITY_STEP,
+      m_acceleration * ACCELERATION_STEP,
+      m_angular_velocity * ANGULAR_VELOCITY_STEP
+    };
+  }
+};
+
+/**
+ * A precompiled trajectory.
+ * Refers to a constant table of segments; see include/trajectories.hpp.
+ */
+struct PackedTrajectory {
+  const PackedSegment* m_segments; ///< The segments, one per interval
+  uint16_t m_length;               ///< The number of segments
+  uint16_t m_dt;                   ///< The time between segments, in ms
+};
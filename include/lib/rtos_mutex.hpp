@@ -0,0 +1,24 @@
+#pragma once
+
+#include "main.h"
+
+/**
+ * A pros::Mutex with the lock() and unlock() of std::mutex,
+ * so std::lock_guard and the templates shared with the host tools can use it.
+ */
+class RtosMutex {
+
+public:
+
+  void lock() {
+    m_mutex.take(TIMEOUT_MAX);
+  }
+
+  void unlock() {
+    m_mutex.give();
+  }
+
+private:
+
+  pros::Mutex m_mutex;
+};
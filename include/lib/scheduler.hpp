@@ -0,0 +1,160 @@
+#pragma once
+
+#include "main.h"
+#include "lib/cpu_meter.hpp"
+#include <functional>
+
+/**
+ * Scheduler class.
+ * Runs jobs at the rates they declare against absolute deadlines, so periods do not drift.
+ * Records how late each job starts and how long it runs.
+ */
+class Scheduler {
+
+public:
+
+  /**
+   * The maximum number of jobs a scheduler can hold.
+   */
+  static constexpr size_t MAX_JOBS = 8;
+
+  /**
+   * The number of 1ms bins in each histogram.
+   * The last bin also counts everything beyond it.
+   */
+  static constexpr size_t HISTOGRAM_BINS = 8;
+
+  /**
+   * Timing statistics of a job.
+   */
+  struct JobStats {
+    uint32_t m_runs;                               ///< Number of times the job has run
+    uint32_t m_overruns;                           ///< Number of runs that finished after the job's next deadline
+    uint32_t m_skipped;                            ///< Number of deadlines skipped because of overruns
+    uint32_t m_max_jitter;                         ///< Latest the job has started after its deadline, in ms
+    uint32_t m_jitter_histogram[HISTOGRAM_BINS];   ///< How late the job started after its deadline, in 1ms bins
+    uint32_t m_duration_histogram[HISTOGRAM_BINS]; ///< How long the job ran, in 1ms bins
+  };
+
+  /**
+   * Add a job to the scheduler.
+   * Should only be called before run().
+   * 
+   * \param name
+   *        The name of the job
+   * \param rate
+   *        The rate at which the job should run; rounded to a whole number of milliseconds
+   * \param job
+   *        The job
+   * 
+   * \return The index of the job, or -1 if the scheduler is full
+   */
+  int add(const char* name, QFrequency rate, std::function<void()> job);
+
+  /**
+   * Make a job due immediately.
+   * Its following deadlines are a period after this run.
+   * 
+   * \param index
+   *        The index of the job
+   */
+  void trigger(int index);
+
+  /**
+   * Set a function to handle notifications sent to the task running the scheduler.
+   * Called with the notification bits before due jobs are run.
+   * 
+   * \param handler
+   *        The handler
+   */
+  void on_notify(std::function<void(uint32_t)> handler);
+
+  /**
+   * Run every job whose deadline has passed.
+   * Each job's lateness is measured when it starts, after the jobs before it have run.
+   */
+  void tick();
+
+  /**
+   * Get the earliest deadline of all jobs.
+   * 
+   * \return The earliest deadline, in ms
+   */
+  uint32_t next_deadline() const;
+
+  /**
+   * Run the scheduler forever.
+   * Should be run in its own task.
+   * Sleeps until the next deadline or until the task is notified.
+   */
+  void run();
+
+  /**
+   * Get the timing statistics of a job.
+   * 
+   * \param index
+   *        The index of the job
+   * 
+   * \return The job's statistics
+   */
+  JobStats get_stats(int index) const;
+
+  /**
+   * Get the CPU time of the task running the scheduler.
+   * Includes notification handling and the time between jobs, not only the jobs themselves.
+   *
+   * \return The task's totals
+   */
+  CpuMeter::Stats get_cpu_stats() const;
+
+  /**
+   * Get the name of a job.
+   * 
+   * \param index
+   *        The index of the job
+   * 
+   * \return The job's name
+   */
+  const char* get_name(int index) const;
+
+  /**
+   * Get the number of jobs.
+   * 
+   * \return The number of jobs
+   */
+  size_t size() const;
+
+private:
+
+  /**
+   * A job and its timing.
+   */
+  struct Job {
+    const char* m_name;
+    std::function<void()> m_job;
+    uint32_t m_period;   ///< Period, in ms
+    uint32_t m_deadline; ///< Next deadline, in ms
+    JobStats m_stats;
+  };
+
+  /**
+   * The jobs.
+   */
+  Job m_jobs[MAX_JOBS];
+  size_t m_size = 0;
+
+  /**
+   * Handles task notifications.
+   */
+  std::function<void(uint32_t)> m_notification_handler;
+
+  /**
+   * CPU time of the task in run().
+   */
+  CpuMeter m_cpu;
+
+  /**
+   * The clock used by the scheduler, in ms; always pros::millis().
+   */
+  static uint32_t now();
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * A lock-free, double-buffered snapshot of a value.
+ * Written by a single task and read by any number of tasks.
+ *
+ * The writer alternates between two copies of the value, and a sequence counter tells readers which copy is stable.
+ * Readers never block the writer, and the writer never waits for readers.
+ * A reader only retries if the writer finished publishing while it was copying,
+ * so a reader that preempts the writer mid-write still makes progress.
+ * The copies are stored as relaxed atomic words and ordered by release fences after each sequence bump, as in a
+ * seqlock, so a reader racing the writer reads stale words rather than racing it, and always notices.
+ *
+ * \tparam T
+ *         The type of the value; must be trivially copyable
+ */
+template <typename T>
+class Snapshot {
+
+  static_assert(std::is_trivially_copyable<T>::value, "Snapshot values must be trivially copyable");
+
+public:
+
+  /**
+   * Constructor.
+   *
+   * \param initial
+   *        The value readers will see until the first write
+   */
+  Snapshot(const T& initial = T()): m_sequence(0) {
+    store(m_buffers[0], initial);
+    store(m_buffers[1], initial);
+  }
+
+  /**
+   * Publish a new value.
+   * Must only be called from a single task.
+   *
+   * \param value
+   *        The new value
+   */
+  void write(const T& value) {
+    uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+    // readers move to the second buffer while the first is written;
+    // the release store publishes the second buffer, and the fence keeps the first's writes after the bump
+    m_sequence.store(sequence + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    store(m_buffers[0], value);
+
+    // readers move back to the first buffer while the second is written
+    m_sequence.store(sequence + 2, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    store(m_buffers[1], value);
+  }
+
+  /**
+   * Read a consistent copy of the most recent value.
+   *
+   * \return The value
+   */
+  T read() const {
+    Words words;
+    uint32_t sequence;
+    do {
+      sequence = m_sequence.load(std::memory_order_acquire);
+      for (size_t i = 0; i < NUM_WORDS; ++i) words[i] = m_buffers[sequence & 1][i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (m_sequence.load(std::memory_order_relaxed) != sequence);
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+private:
+
+  /**
+   * The value, as words.
+   */
+  static constexpr size_t NUM_WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  using Words = uint32_t[NUM_WORDS];
+
+  /**
+   * The two copies of the value.
+   * The copy at index (m_sequence & 1) is never being written.
+   */
+  std::atomic<uint32_t> m_buffers[2][NUM_WORDS];
+
+  /**
+   * Incremented before each buffer is written.
+   */
+  std::atomic<uint32_t> m_sequence;
+
+  /**
+   * Write a value into a buffer, a word at a time.
+   */
+  static void store(std::atomic<uint32_t> (&buffer)[NUM_WORDS], const T& value) {
+    Words words = {};
+    std::memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < NUM_WORDS; ++i) buffer[i].store(words[i], std::memory_order_relaxed);
+  }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "main.h"
+#include <atomic>
+#include <cstdio>
+
+/**
+ * A fixed-size binary telemetry record.
+ * Written to the output as-is, so the layout is part of the stream format (see tools/decode_telemetry.py).
+ */
+struct TelemetryRecord {
+
+  /**
+   * Marks the start of every record, so a decoder can find its place in the stream.
+   */
+  static constexpr uint16_t SYNC = 0xA55A;
+
+  /**
+   * The number of values in a record.
+   */
+  static constexpr size_t MAX_VALUES = 4;
+
+  uint16_t m_sync;                 ///< Always SYNC
+  uint8_t m_channel;               ///< What the values describe
+  uint8_t m_count;                 ///< The number of values used
+  uint32_t m_time;                 ///< Time the record was pushed, in ms
+  float m_values[MAX_VALUES];      ///< The values; unused values are 0
+};
+
+static_assert(sizeof(TelemetryRecord) == 24, "TelemetryRecord must have no padding");
+
+/**
+ * TelemetryBuffer class.
+ * A lock-free ring buffer of telemetry records with a single producer and a single consumer.
+ * Pushing never blocks; when the buffer is full, the record is dropped and counted.
+ */
+class TelemetryBuffer {
+
+public:
+
+  /**
+   * The number of records the buffer holds.
+   * Must be a power of two.
+   */
+  static constexpr size_t CAPACITY = 64;
+
+  /**
+   * Constructor.
+   */
+  TelemetryBuffer();
+
+  /**
+   * Push a record.
+   * Must only be called from the producer task.
+   *
+   * \param channel
+   *        What the values describe
+   * \param values
+   *        Up to MAX_VALUES values
+   *
+   * \return True if the record was pushed, false if it was dropped
+   */
+  bool push(uint8_t channel, std::initializer_list<float> values);
+
+  /**
+   * Pop the oldest record.
+   * Must only be called from the consumer task.
+   *
+   * \param record
+   *        Set to the record, if there is one
+   *
+   * \return True if a record was popped, false if the buffer is empty
+   */
+  bool pop(TelemetryRecord& record);
+
+  /**
+   * Get the number of records dropped because the buffer was full.
+   *
+   * \return The number of dropped records
+   */
+  uint32_t get_dropped() const;
+
+private:
+
+  /**
+   * The records.
+   */
+  TelemetryRecord m_records[CAPACITY];
+
+  /**
+   * Number of records pushed and popped.
+   * Only the producer writes m_head and only the consumer writes m_tail.
+   */
+  std::atomic<uint32_t> m_head;
+  std::atomic<uint32_t> m_tail;
+
+  /**
+   * Number of records dropped.
+   */
+  std::atomic<uint32_t> m_dropped;
+
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "TelemetryBuffer capacity must be a power of two");
+};
+
+/**
+ * Telemetry class.
+ * Owns one TelemetryBuffer per producer, and drains them all to an output stream from a low-priority task.
+ */
+class Telemetry {
+
+public:
+
+  /**
+   * The maximum number of producers.
+   */
+  static constexpr size_t MAX_BUFFERS = 8;
+
+  /**
+   * Channel of the records the drain task writes about itself.
+   * Its value is the total number of dropped records.
+   */
+  static constexpr uint8_t CHANNEL_DROPPED = 0;
+
+  /**
+   * Constructor.
+   * Starts the drain task.
+   *
+   * \param output
+   *        The stream records are written to, such as stdout (serial) or a file on the SD card
+   * \param period
+   *        How often the buffers are drained
+   */
+  Telemetry(FILE* output, QTime period = 20_ms);
+
+  /**
+   * Get a buffer for a producer.
+   * Each producer task should get its own buffer, once.
+   *
+   * \return The buffer, or nullptr if there are already MAX_BUFFERS producers
+   */
+  TelemetryBuffer* add_buffer();
+
+  /**
+   * Get the number of records dropped by all producers.
+   *
+   * \return The number of dropped records
+   */
+  uint32_t get_dropped() const;
+
+private:
+
+  /**
+   * The buffers.
+   * Only the first m_num_buffers are in use.
+   */
+  TelemetryBuffer m_buffers[MAX_BUFFERS];
+  std::atomic<size_t> m_num_buffers;
+
+  /**
+   * The output stream.
+   */
+  FILE* m_output;
+
+  /**
+   * Drain period, in ms.
+   */
+  uint32_t m_period;
+
+  /**
+   * The dropped count last written to the output.
+   */
+  uint32_t m_reported_dropped;
+
+  /**
+   * The drain task.
+   */
+  std::unique_ptr<pros::Task> m_task;
+
+  /**
+   * Write every record in the buffers to the output.
+   */
+  void drain();
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "main.h"
+
+/**
+ * TelemetryLink class.
+ * Sends frames of integer fields over a smart port serial link, within a fixed bytes-per-second budget.
+ *
+ * Each frame is, before framing:
+ *   - flags (1 byte; bit 0 set on keyframes)
+ *   - sequence number (1 byte)
+ *   - time, then every field, as zigzag varints; keyframes carry the values, other frames the change since the last frame sent
+ *   - CRC-16/CCITT-FALSE of the above (2 bytes, little-endian)
+ * and is then COBS-encoded and terminated by a zero byte, so a receiver can always find the next frame.
+ * Frames that would exceed the budget are skipped; the next frame sent is still a delta against the last one sent.
+ * tools/telemetry_link.py decodes the stream.
+ */
+class TelemetryLink {
+
+public:
+
+  /**
+   * The maximum number of fields in a frame.
+   */
+  static constexpr size_t MAX_FIELDS = 16;
+
+  /**
+   * A keyframe is sent at least this often, in frames, so a receiver can recover from lost frames.
+   */
+  static constexpr uint32_t KEYFRAME_INTERVAL = 50;
+
+  /**
+   * The largest a frame can be once encoded, in bytes.
+   */
+  static constexpr size_t MAX_FRAME_SIZE = 2 + 5 * (MAX_FIELDS + 1) + 2;
+  static constexpr size_t MAX_ENCODED_SIZE = MAX_FRAME_SIZE + MAX_FRAME_SIZE / 254 + 2;
+
+  /**
+   * Counts of frames and bytes.
+   */
+  struct LinkStats {
+    uint32_t m_sent;    ///< Frames sent
+    uint32_t m_skipped; ///< Frames skipped because of the budget or a full serial buffer
+    uint32_t m_bytes;   ///< Bytes sent
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param serial
+   *        The serial link
+   * \param num_fields
+   *        The number of fields in every frame; at most MAX_FIELDS
+   * \param budget
+   *        The most bytes that will be sent per second
+   */
+  TelemetryLink(std::unique_ptr<pros::Serial> serial, size_t num_fields, uint32_t budget);
+
+  /**
+   * Send a frame, if the budget allows.
+   *
+   * \param time
+   *        The time of the frame, in ms
+   * \param fields
+   *        The fields; there must be as many as given to the constructor
+   *
+   * \return True if the frame was sent, false if it was skipped
+   */
+  bool send(uint32_t time, const int32_t* fields);
+
+  /**
+   * Get the counts of frames and bytes.
+   *
+   * \return The counts
+   */
+  LinkStats get_stats() const;
+
+  /**
+   * Encode a frame.
+   * Exposed so the format can be checked against the host decoder.
+   *
+   * \param keyframe
+   *        Whether values should be sent in full instead of as changes
+   * \param sequence
+   *        The sequence number
+   * \param time
+   *        The time, or its change
+   * \param fields
+   *        The fields, or their changes
+   * \param num_fields
+   *        The number of fields
+   * \param out
+   *        Set to the COBS-encoded frame, including the terminating zero; must hold MAX_ENCODED_SIZE bytes
+   *
+   * \return The number of bytes written to out
+   */
+  static size_t encode(bool keyframe, uint8_t sequence, int32_t time, const int32_t* fields, size_t num_fields, uint8_t* out);
+
+private:
+
+  /**
+   * The serial link.
+   */
+  std::unique_ptr<pros::Serial> m_serial;
+
+  /**
+   * The number of fields in every frame.
+   */
+  size_t m_num_fields;
+
+  /**
+   * The budget, in bytes per second.
+   */
+  uint32_t m_budget;
+
+  /**
+   * Bytes that may be sent now, in thousandths of a byte.
+   * Refilled at m_budget bytes per second, up to one second's worth.
+   */
+  uint32_t m_allowance;
+
+  /**
+   * The last frame sent.
+   */
+  int32_t m_last_fields[MAX_FIELDS];
+  uint32_t m_last_time;
+  uint32_t m_last_refill;
+
+  /**
+   * Frames since the last keyframe; a keyframe is due when this reaches KEYFRAME_INTERVAL.
+   */
+  uint32_t m_since_keyframe;
+
+  /**
+   * Sequence number of the next frame.
+   */
+  uint8_t m_sequence;
+
+  /**
+   * Frame and byte counts.
+   */
+  LinkStats m_stats;
+};
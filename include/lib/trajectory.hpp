@@ -0,0 +1,141 @@
+#pragma once
+
+#include "okapi/api/units/QAcceleration.hpp"
+#include "okapi/api/units/QAngle.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/pathfinder/include/pathfinder/structs.h"
+#include <vector>
+
+using namespace okapi;
+
+struct PackedSegment;
+struct PackedTrajectory;
+
+/**
+ * A single setpoint of a trajectory.
+ * In the odom frame: x is forward, y is to the right, and heading is clockwise.
+ */
+struct TrajectoryPoint {
+  QLength m_x;                       ///< X coordinate of chassis
+  QLength m_y;                       ///< Y coordinate of chassis
+  QAngle m_heading;                  ///< Orientation of chassis
+  QSpeed m_velocity;                 ///< Forward velocity of chassis
+  QAcceleration m_acceleration;      ///< Forward acceleration of chassis
+  QAngularSpeed m_angular_velocity;  ///< Rotational velocity of chassis (clockwise)
+};
+
+/**
+ * Trajectory class.
+ * A time-parameterized path sampled at a fixed interval.
+ */
+class Trajectory {
+
+public:
+
+  /**
+   * Constructor.
+   * 
+   * \param points
+   *        The setpoints, one per interval
+   * \param dt
+   *        The time between setpoints
+   */
+  Trajectory(std::vector<TrajectoryPoint> points, QTime dt);
+
+  /**
+   * Constructor.
+   * Reads a precompiled trajectory in place; segments are unpacked as they are sampled.
+   * 
+   * \param packed
+   *        The precompiled trajectory
+   */
+  Trajectory(const PackedTrajectory& packed);
+
+  /**
+   * Create a straight trajectory with a trapezoidal velocity profile.
+   * Starts and ends at rest.
+   * 
+   * \param start
+   *        The setpoint to start from; only position and heading are used
+   * \param distance
+   *        The distance to drive; negative drives backwards
+   * \param max_velocity
+   *        The maximum velocity
+   * \param max_acceleration
+   *        The maximum acceleration and deceleration
+   * \param dt
+   *        The time between setpoints
+   * 
+   * \return The trajectory
+   */
+  static Trajectory straight(
+    TrajectoryPoint start, QLength distance, QSpeed max_velocity, QAcceleration max_acceleration, QTime dt = 10_ms
+  );
+
+  /**
+   * Create a trajectory from pathfinder segments.
+   * Segment positions are taken to be in meters, and headings in radians counterclockwise,
+   * as produced by pathfinder; they are converted to the odom frame.
+   * 
+   * \param segments
+   *        The segments
+   * \param length
+   *        The number of segments
+   * 
+   * \return The trajectory
+   */
+  static Trajectory from_pathfinder(const Segment* segments, int length);
+
+  /**
+   * Get the setpoint at a time.
+   * Linearly interpolates between setpoints; times past the end give the last setpoint.
+   * 
+   * \param time
+   *        The time since the start of the trajectory
+   * 
+   * \return The setpoint
+   */
+  TrajectoryPoint sample(QTime time) const;
+
+  /**
+   * Get the duration of the trajectory.
+   * 
+   * \return The time of the last setpoint
+   */
+  QTime duration() const;
+
+private:
+
+  /**
+   * The setpoints.
+   */
+  std::vector<TrajectoryPoint> m_points;
+
+  /**
+   * The precompiled setpoints, if constructed from a PackedTrajectory.
+   */
+  const PackedSegment* m_packed;
+
+  /**
+   * The number of setpoints.
+   */
+  size_t m_length;
+
+  /**
+   * The time between setpoints.
+   */
+  QTime m_dt;
+
+  /**
+   * Get a setpoint.
+   * 
+   * \param index
+   *        The index of the setpoint
+   * 
+   * \return The setpoint
+   */
+  TrajectoryPoint point(size_t index) const;
+};
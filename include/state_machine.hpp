@@ -1,197 +1,175 @@
-#if FALSE
+#pragma once
 
-#include <memory>
-#include <functional>
-#include <vector>
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 
 
 /**
- * A behavior that a state will possess.
- * Should be extended for each behavior in a machine.
+ * What a state does.
+ * Either function may be null.
  * 
- * \tparam T
- *         An enum describing all behaviors of a machine
+ * \tparam TContext
+ *         The object the machine controls
  */
-template <class T>
-class AbstractBehavior {
-
-public:
-
-  AbstractBehavior(T identifier);
-
-  virtual ~AbstractBehavior();
-
-  /**
-   * Identifies the behavior.
-   * Each behavior must have an identifier.
-   * Each identifier should only be used in a single behavior.
-   */
-  const T m_identifier;
-
-  /**
-   * Update the behavior.
-   * Should be run at a steady frequency.
-   * 50ms intervals or shorter are suggested.
-   */
-  virtual void update() = 0;
+template <typename TContext>
+struct StateBehavior {
+  void (*m_enter)(TContext&);  ///< Run once when the state is entered
+  void (*m_update)(TContext&); ///< Run every update while in the state
 };
 
 
 /**
- * A state the the state machine may be in.
+ * A transition between two states.
  * 
  * \tparam TState
  *         An enum describing all states of a machine
- * \tparam TBehavior
- *         An enum describing all behaviors of a machine
+ * \tparam TContext
+ *         The object the machine controls
  */
-template <typename TState, typename TBehavior>
-struct State {
-
-  /**
-   * Identifies the state.
-   * Each state must have an identifier.
-   * Each identifier should only be used in a single class.
-   */
-  const TState m_identifier;
-
-  /**
-   * The behavior taht will run when the machine is in the state.
-   * Each state must have a behavior.
-   * Behaviors may be reused across states.
-   */
-  std::shared_ptr<AbstractBehavior<TBehavior>> mp_behavior;
-
-  /**
-   * A function that is run as soon as the state is entered.
-   */
-  std::function<void()> m_enter;
-
-  /**
-   * The function that defines an exit from the state.
-   * This function is triggerred EVERY machine update, NOT after an event.
-   * This function should change the state (and run any exit functions) based on the desired state if conditions are meant.
-   * 
-   * \param T
-   *        The desired state
-   */
-  std::function<void(TState)> m_exit;
-
-  /**
-   * A constructor for a State.
-   * 
-   * \param identifier
-   *        The identifier for the state
-   * \param behavior
-   *        A pointer to the behavior of the state
-   * \param enter
-   *        The entry function of the state
-   * \param exit
-   *        The exit-check function of the state
-   */
-  State(TState identifier, std::shared_ptr<AbstractBehavior<TBehavior>> behavior = nullptr, std::function<void()> enter = [] {}, std::function<void(TState)> exit = [] (TState) {}): 
-    m_identifier(identifier), mp_behavior(behavior), m_enter(enter), m_exit(exit) {}
+template <typename TState, typename TContext>
+struct Transition {
+  TState m_from;                    ///< The state the transition leaves
+  TState m_to;                      ///< The state the transition enters
+  bool (*m_guard)(const TContext&); ///< The transition is taken when this returns true; null is always true
+  void (*m_action)(TContext&);      ///< Run when the transition is taken, before the new state is entered; may be null
 };
 
 
 /**
- * An instance of a state machine.
+ * A table-driven state machine.
+ * The states, behaviors and transitions are described at compile time by a traits struct,
+ * and transitions are indexed by state at compile time, so nothing is allocated and an update
+ * only checks the transitions leaving the current state.
  * 
- * \tparam TState
- *         An enum describing all states of the machine
- * \tparam TBehavior
- *         An enum describing all behaviors of the machine
+ * The traits struct must provide:
+ *   - State:       an enum class of states with values 0 to NUM_STATES - 1
+ *   - Context:     the object the machine controls
+ *   - NUM_STATES:  the number of states
+ *   - BEHAVIORS:   a constexpr array of StateBehavior<Context>, indexed by state
+ *   - TRANSITIONS: a constexpr array of Transition<State, Context>; earlier transitions take priority
+ * 
+ * \tparam TTraits
+ *         The traits struct describing the machine
  */
-template <typename TState, typename TBehavior>
+template <typename TTraits>
 class StateMachine {
 
 public:
 
+  using State = typename TTraits::State;
+  using Context = typename TTraits::Context;
 
   /**
-   * A constructor that simply defines the entry state.
+   * Constructor.
+   * The entry state's enter function is not run.
    * 
    * \param entry_state
    *        The state at which the machine should start
    */
-  StateMachine(TState entry_state);
+  constexpr StateMachine(State entry_state): m_state(entry_state) {}
 
   /**
-   * A constructor that defines the entry state and the machine's State objects.
+   * Get the current state of the machine.
    * 
-   * \param entry_state
-   *        The state at which the machine should start
-   * \param states
-   *        The `State`s to initialize the machine with
+   * \return The current state
    */
-  StateMachine(TState entry_state, std::vector<State<TState, TBehavior>> states);
+  constexpr State get_state() const {
+    return m_state;
+  }
 
   /**
-   * Set the desired state of the machine.
-   * Depending on the `m_exit` function of the current state, the machine may not instantly switch states.
+   * Force the machine into a state, regardless of transitions.
+   * Runs the state's enter function.
    * 
    * \param state
-   *        The new desired state
+   *        The new state
+   * \param context
+   *        The object the machine controls
    */
-  void change_state(TState state);
+  void set_state(State state, Context& context) {
+    m_state = state;
+    const StateBehavior<Context>& behavior = TTraits::BEHAVIORS[index(state)];
+    if (behavior.m_enter) behavior.m_enter(context);
+  }
 
   /**
-   * Get the current state of the machine.
+   * Update the machine.
+   * Takes at most one transition, then runs the (possibly new) state's update function.
    * 
-   * \return The current state's identifier
-   */
-  TState get_state();
-
-  /**
-   * Get the current behavior of the machine.
+   * \param context
+   *        The object the machine controls
    * 
-   * \return a pointer to the curret behavior
-   */
-  TBehavior get_behavior();
+   * \return The transition that was taken, or null if none was
+   */
+  const Transition<State, Context>* update(Context& context) {
+    const Transition<State, Context>* taken = nullptr;
+    size_t state = index(m_state);
+    for (size_t i = TABLE.m_first[state]; i < TABLE.m_first[state + 1]; ++i) {
+      const Transition<State, Context>& transition = TTraits::TRANSITIONS[TABLE.m_index[i]];
+      if (!transition.m_guard || transition.m_guard(context)) {
+        if (transition.m_action) transition.m_action(context);
+        set_state(transition.m_to, context);
+        taken = &transition;
+        break;
+      }
+    }
+    const StateBehavior<Context>& behavior = TTraits::BEHAVIORS[index(m_state)];
+    if (behavior.m_update) behavior.m_update(context);
+    return taken;
+  }
 
-  /**
-   * Add a state to the machine.
-   * 
-   * \param state
-   *        The state to add
-   * 
-   * \return True if the state was addedd successfully, false otherwise
-   */
-  bool add_state(State<TState, TBehavior> state);
+private:
 
-  /**
-   * Remove a state from the machine.
-   * 
-   * \param identifier
-   *        The identifier of the state that should be removed
-   */
-  void remove_state(TState identifier);
+  static constexpr size_t NUM_STATES = TTraits::NUM_STATES;
+  static constexpr size_t NUM_TRANSITIONS = std::size(TTraits::TRANSITIONS);
+
+  static_assert(std::size(TTraits::BEHAVIORS) == NUM_STATES, "There must be one behavior per state");
+  static_assert(NUM_TRANSITIONS < UINT8_MAX, "Too many transitions");
 
+  static constexpr size_t index(State state) {
+    return static_cast<size_t>(state);
+  }
 
   /**
-   * Update the machine.
-   * This will update the current state's exit function and then its behavior.
-   * If the active state is changed, the new state will be fully updated as soon as its enter function is finished (its exit function will run, then its behavior)
+   * Transitions grouped by the state they leave.
+   * The transitions leaving state s are m_index[m_first[s]] to m_index[m_first[s + 1] - 1], in priority order.
    */
-  void update();
-
-
-private:
+  struct Table {
+    uint8_t m_first[NUM_STATES + 1];
+    uint8_t m_index[NUM_TRANSITIONS];
+  };
 
   /**
-   * A map that maps identifiers to states in the machine.
+   * Check that every transition refers to real states.
    */
-  std::map<TState, State<TState, TBehavior>> m_map;
+  static constexpr bool valid() {
+    for (size_t i = 0; i < NUM_TRANSITIONS; ++i) {
+      if (index(TTraits::TRANSITIONS[i].m_from) >= NUM_STATES) return false;
+      if (index(TTraits::TRANSITIONS[i].m_to) >= NUM_STATES) return false;
+    }
+    return true;
+  }
+  static_assert(valid(), "Transitions must be between states 0 to NUM_STATES - 1");
 
   /**
-   * A pointer to the current state of the machine.
+   * Build the table.
    */
-  std::shared_ptr<State<TState, TBehavior>> m_current_state;
+  static constexpr Table make_table() {
+    Table table{};
+    for (size_t i = 0; i < NUM_TRANSITIONS; ++i) ++table.m_first[index(TTraits::TRANSITIONS[i].m_from) + 1];
+    for (size_t s = 0; s < NUM_STATES; ++s) table.m_first[s + 1] += table.m_first[s];
+    uint8_t next[NUM_STATES + 1] = {};
+    for (size_t i = 0; i < NUM_TRANSITIONS; ++i) {
+      size_t from = index(TTraits::TRANSITIONS[i].m_from);
+      table.m_index[table.m_first[from] + next[from]++] = i;
+    }
+    return table;
+  }
+  static constexpr Table TABLE = make_table();
 
   /**
-   * The identifier of the desired state of the machine.
+   * The current state of the machine.
    */
-  TState m_desired_state;
+  State m_state;
 };
-#endif
@@ -2,6 +2,7 @@
 
 #include "lib/odom.hpp"
 #include "subsystems/transmission.hpp"
+#include "subsystems/sensors.hpp"
 
 
 /**
@@ -43,19 +44,32 @@ public:
 
   /**
    * Get the current pose of the chassis.
+   * Safe to call from any task.
    * 
-   * \return The pose of the chassis
+   * \return A copy of the pose of the chassis
    */
-  Odom::ChassisPose* get_pose();
+  Odom::ChassisPose get_pose();
 
   /**
    * Get the current pose derivative.
    * This is the speed of translation, rotation, etc.
+   * Safe to call from any task.
+   * 
+   * \return A copy of the pose derivative
+   */
+  Odom::ChassisDeriv get_speed();
+
+  /**
+   * Get the current pose and its derivative from the same odom update.
+   * Safe to call from any task.
+   * 
+   * \return A copy of the pose and its derivative
    */
-  Odom::ChassisDeriv* get_speed();
+  Odom::ChassisState get_state();
 
   /**
    * Tare the chassis' pose to a new pose.
+   * Takes effect on the next odom update; see Odom::tare().
    * 
    * \param new_pose
    *        The pose at which the chassis will now be
@@ -66,8 +80,11 @@ public:
    * Update the chassis interface's pose calculation.
    * This will update the Odom object.
    * Should always be run before acting on the chassis.
+   * 
+   * \param frame
+   *        The sensor readings to update from; the tracking wheels are used, with the direct transmission motors as backups
    */
-  void update_pose();
+  void update_pose(const SensorFrame& frame);
 
 
 private:
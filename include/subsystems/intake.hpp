@@ -2,12 +2,30 @@
 
 #include "lib/odom.hpp"
 #include "subsystems/transmission.hpp"
+#include "subsystems/sensors.hpp"
+#include "lib/derivative_estimator.hpp"
+#include "lib/cube_detector.hpp"
+#include <atomic>
+#include <functional>
 
 
 class Intake {
 
+  friend class Sensors;
+
 public:
 
+  /**
+   * The maximum number of cube event listeners.
+   */
+  static constexpr size_t MAX_CUBE_LISTENERS = 4;
+
+  /**
+   * A function called with every cube event and the resulting cube count.
+   * Called from the task updating the intake, so it must return quickly and must not block.
+   */
+  using CubeListener = std::function<void(CubeEvent, size_t)>;
+
   /**
    * Constructor.
    * 
@@ -19,11 +37,11 @@ public:
   Intake(int8_t port_l, int8_t port_r);
 
   /**
-   * Control mutex.
-   * Take this when controlling the intake.
-   * You must update the pose and internal controller manualls if taken.
+   * IMEs associated with each motor, with the motors' reversal.
+   * Read them through a SensorFrame.
    */
-  pros::Mutex m_control_mutex;
+  std::shared_ptr<IntegratedEncoder> m_ime_left;
+  std::shared_ptr<IntegratedEncoder> m_ime_right;
 
   /**
    * Set the voltage of both motors.
@@ -88,18 +106,74 @@ public:
   void tare_angles(QAngle left, QAngle right);
 
   /**
-   * Update the pose calculation.
-   * Should always be run before acting on the tilter.
+   * Update the pose calculation and the cube detector.
+   * Should always be run before acting on the intake.
+   * 
+   * \param frame
+   *        The sensor readings to update from
+   */
+  void update_angles(const SensorFrame& frame);
+
+  /**
+   * Get the mean current drawn by the rollers.
+   * Should be run after update_pose() for up-to-date values.
+   * 
+   * \return The current, in mA
+   */
+  double get_current();
+
+  /**
+   * Listen for cubes passing through the intake.
+   * Listeners should all be added from one task, such as during initialization.
+   * 
+   * \param listener
+   *        The function to call with every event
+   * 
+   * \return True if the listener was added, false if there are too many listeners
+   */
+  bool on_cube_event(CubeListener listener);
+
+  /**
+   * Get the number of cubes held, as counted by the cube detector.
+   * 
+   * \return The number of cubes
+   */
+  size_t get_cube_count() const;
+
+  /**
+   * Set the number of cubes held, such as after a deposit.
+   * Applied at the next update, which publishes it to the listeners as CubeEvent::SET.
+   * 
+   * \param count
+   *        The number of cubes
    */
-  void update_angles();
+  void set_cube_count(size_t count);
+
+  /**
+   * Get the counts of commands sent to and withheld from the intake's motors.
+   * 
+   * \return The counts, summed over both motors
+   */
+  CachedMotor::WriteStats get_write_stats() const;
+
+  /**
+   * Get the voltages the intake's motors were last commanded, as cached by each CachedMotor.
+   * Reads nothing from the motors; a motor told to hold a velocity reports 0.
+   * 
+   * \return
+   *          The voltage of the left motor, in mV,
+   *          The voltage of the right motor, in mV
+   */
+  std::tuple<int, int> get_voltages() const;
 
 private:
 
   /**
-   * Motors associated with the intake
+   * Motors associated with the intake.
+   * Shared with Sensors, which reads their current draw.
    */
-  std::unique_ptr<Motor> m_motor_left;  ///< The motor on the left roller
-  std::unique_ptr<Motor> m_motor_right; ///< The motor on the right roller
+  std::shared_ptr<CachedMotor> m_motor_left;  ///< The motor on the left roller
+  std::shared_ptr<CachedMotor> m_motor_right; ///< The motor on the right roller
 
   /**
    * The reference pose.
@@ -123,9 +197,38 @@ private:
   QAngle m_pose_right;
 
   /**
-   * A VelMath object.
-   * Used to calculate velocity and acceleration of rollers.
+   * Velocity and acceleration estimators of each motor, in degrees.
+   */
+  DerivativeEstimator m_estimator_left;
+  DerivativeEstimator m_estimator_right;
+
+  /**
+   * The voltage last commanded to the rollers.
+   */
+  std::atomic<int> m_voltage;
+
+  /**
+   * The mean current drawn by the rollers, in mA.
+   */
+  double m_current;
+
+  /**
+   * The cube detector, and its count as seen by other tasks.
+   */
+  CubeDetector m_cube_detector;
+  std::atomic<size_t> m_cube_count;
+  std::atomic<bool> m_cube_count_pending;
+  size_t m_pending_cube_count;
+
+  /**
+   * Cube event listeners.
+   * Only the first m_num_cube_listeners are in use.
+   */
+  CubeListener m_cube_listeners[MAX_CUBE_LISTENERS];
+  std::atomic<size_t> m_num_cube_listeners;
+
+  /**
+   * Call every listener with an event and the current count.
    */
-  VelMath velmath_left;
-  VelMath velmath_right;
+  void publish_cube_event(CubeEvent event);
 };
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 #include "lib/odom.hpp"
 #include "subsystems/transmission.hpp"
+#include "subsystems/sensors.hpp"
+#include "lib/derivative_estimator.hpp"
+#include "lib/motion_profile.hpp"
+#include "feedforward_gains.hpp"
+#include "controller_gains.hpp"
 
 
 class Lift {
@@ -11,6 +16,49 @@ public:
   static constexpr QAngle MAX_LOCK = 20_deg;
   static constexpr QAngle MAX_ANGLE = 80_deg;
 
+  /**
+   * Preset heights.
+   */
+  enum class Preset {
+    DOWN,      ///< Fully lowered
+    LOCK,      ///< Highest angle that still locks the tilter (MAX_LOCK)
+    LOW_TOWER, ///< Scoring in a low tower
+    MID_TOWER, ///< Scoring in a mid tower
+    MAX        ///< Fully raised (MAX_ANGLE)
+  };
+
+  /**
+   * Profile limits of preset moves.
+   */
+  static constexpr QAngularSpeed PROFILE_VELOCITY = 150_deg / second;
+  static constexpr QAngularAcceleration PROFILE_ACCELERATION = 600_deg / second / second;
+
+  /**
+   * Feedforward of the position controller, including gravity.
+   * Hand-tuned until characterization logs are fitted; see CharacterizationController and tools/fit_feedforward.py.
+   */
+  static constexpr Feedforward FEEDFORWARD = feedforward_gains::LIFT;
+
+  /**
+   * Feedback gains of the position controller, in mV.
+   * Hand-tuned; tools/tune_gains.cpp can search for better ones.
+   */
+  static constexpr const double& KP = controller_gains::LIFT_KP; ///< Per deg of position error
+  static constexpr const double& KD = controller_gains::LIFT_KD; ///< Per deg/s of velocity error
+
+  /**
+   * Cross-coupled synchronization gains, in mV.
+   * The leading side is slowed and the trailing side sped up by the same amount.
+   */
+  static constexpr const double& SYNC_KP = controller_gains::SYNC_KP; ///< Per deg of difference between the sides
+  static constexpr const double& SYNC_KD = controller_gains::SYNC_KD; ///< Per deg/s of difference between the sides
+
+  /**
+   * A move is settled when within these of its target.
+   */
+  static constexpr QAngle SETTLE_ANGLE = 2_deg;
+  static constexpr QAngularSpeed SETTLE_SPEED = 5_deg / second;
+
   /**
    * Constructor.
    * 
@@ -22,24 +70,66 @@ public:
   Lift(int8_t port_l, int8_t port_r);
 
   /**
-   * Control mutex.
-   * Take this when controlling the lift.
-   * You must update the pose and internal controller manualls if taken.
+   * IMEs associated with each motor, with the motors' reversal.
+   * Read them through a SensorFrame.
    */
-  pros::Mutex m_control_mutex;
+  std::shared_ptr<IntegratedEncoder> m_ime_left;
+  std::shared_ptr<IntegratedEncoder> m_ime_right;
 
   /**
    * Set the voltage of both motors.
+   * The sides are kept level. Cancels any move.
    * 
    * \param val
    *        The desired voltage
    */
   void move_voltage(int val);
 
+  /**
+   * Move to an angle along a trapezoidal profile, then hold it.
+   * Followed by update(), starting from the current angle and velocity.
+   * 
+   * \param target
+   *        The angle to move to
+   */
+  void move_to(QAngle target);
+
+  /**
+   * Move to a preset height along a trapezoidal profile, then hold it.
+   * 
+   * \param preset
+   *        The preset to move to
+   */
+  void move_to(Preset preset);
+
+  /**
+   * Get the angle of a preset height.
+   * 
+   * \param preset
+   *        The preset
+   * 
+   * \return The angle of the preset
+   */
+  static QAngle get_preset(Preset preset);
+
+  /**
+   * Whether a move has reached its target and stopped.
+   * 
+   * \return True if the last move is settled, or there is no move
+   */
+  bool is_settled();
+
+  /**
+   * Follow the current move.
+   * Run after update_angles(); uses only the angles it read, so no motor is read twice in a tick.
+   * Does nothing when there is no move.
+   */
+  void update();
+
 
   /**
    * Lock both lift motors.
-   * Overriden by move_voltage().
+   * Overriden by move_voltage(). Cancels any move.
    */
   void lock();
 
@@ -92,17 +182,38 @@ public:
 
   /**
    * Update the pose calculation.
-   * Should always be run before acting on the tilter.
+   * Everything else in the tick uses the angles computed here, so no motor is read twice.
+   * Should always be run before acting on the lift.
+   * 
+   * \param frame
+   *        The sensor readings to update from
+   */
+  void update_angles(const SensorFrame& frame);
+
+  /**
+   * Get the counts of commands sent to and withheld from the lift's motors.
+   * 
+   * \return The counts, summed over both motors
    */
-  void update_angles();
+  CachedMotor::WriteStats get_write_stats() const;
+
+  /**
+   * Get the voltages the lift's motors were last commanded, as cached by each CachedMotor.
+   * Reads nothing from the motors; a motor told to hold a velocity reports 0.
+   * 
+   * \return
+   *          The voltage of the left motor, in mV,
+   *          The voltage of the right motor, in mV
+   */
+  std::tuple<int, int> get_voltages() const;
 
 private:
 
   /**
    * Motors associated with the intake
    */
-  std::unique_ptr<Motor> m_motor_left;  ///< The motor on the left roller
-  std::unique_ptr<Motor> m_motor_right; ///< The motor on the right roller
+  std::unique_ptr<CachedMotor> m_motor_left;  ///< The motor on the left roller
+  std::unique_ptr<CachedMotor> m_motor_right; ///< The motor on the right roller
 
   /**
    * The reference pose.
@@ -126,9 +237,25 @@ private:
   QAngle m_pose_right;
 
   /**
-   * A VelMath object.
-   * Used to calculate velocity and acceleration of rollers.
+   * Velocity and acceleration estimators of each motor, in degrees.
+   */
+  DerivativeEstimator m_estimator_left;
+  DerivativeEstimator m_estimator_right;
+
+  /**
+   * Move state.
+   * Guarded by m_move_mutex, as moves are started and followed from different tasks.
+   */
+  bool m_moving;
+  TrapezoidProfile m_profile;
+  uint32_t m_move_start;
+  pros::Mutex m_move_mutex;
+
+  /**
+   * Set the voltage of both motors, adding the cross-coupled correction that keeps the sides level.
+   * 
+   * \param val
+   *        The voltage both sides should get, in mV
    */
-  VelMath velmath_left;
-  VelMath velmath_right;
+  void apply_voltage(double val);
 };
\ No newline at end of file
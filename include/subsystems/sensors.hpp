@@ -0,0 +1,201 @@
+#pragma once
+
+#include "main.h"
+#include "lib/snapshot.hpp"
+#include <atomic>
+#include <memory>
+
+class Transmission;
+class Lift;
+class Intake;
+
+/**
+ * Groups of sensors that are sampled together.
+ * These are bits, so several groups can be sampled at once.
+ */
+enum SensorGroup : uint32_t {
+
+  SENSORS_DRIVE = 1 << 0,  ///< Tracking wheels, transmission motors and IMU; sampled at the odom rate
+  SENSORS_LIFT = 1 << 1,   ///< Lift motors; sampled at the lift rate
+  SENSORS_INTAKE = 1 << 2, ///< Intake motors' encoders and current draw; sampled at the intake rate
+  SENSORS_ALL = SENSORS_DRIVE | SENSORS_LIFT | SENSORS_INTAKE
+};
+
+/**
+ * One reading of every sensor on the robot.
+ * Readings are in degrees, with the same sign as the subsystems' motors, or PROS_ERR if the sensor failed to read or is missing.
+ * Each group is read back to back and stamped with the time it was read,
+ * so everything computed from one group (such as the chassis pose and tilter angle) describes the same instant.
+ */
+struct SensorFrame {
+  uint32_t m_sequence;     ///< Incremented every sample
+  uint32_t m_drive_time;   ///< Time the drive group was read, in ms
+  uint32_t m_lift_time;    ///< Time the lift group was read, in ms
+  uint32_t m_intake_time;  ///< Time the intake group was read, in ms
+  double m_tracking_left;  ///< Left tracking wheel
+  double m_tracking_right; ///< Right tracking wheel
+  double m_tracking_side;  ///< Sideways tracking wheel
+  double m_direct_left;    ///< Left transmission motor connected directly to the chassis
+  double m_direct_right;   ///< Right transmission motor connected directly to the chassis
+  double m_shared_left;    ///< Left transmission motor shared with the tilter
+  double m_shared_right;   ///< Right transmission motor shared with the tilter
+  double m_imu_rotation;   ///< IMU rotation, clockwise positive; PROS_ERR while it calibrates
+  double m_lift_left;      ///< Left lift motor
+  double m_lift_right;     ///< Right lift motor
+  double m_intake_left;    ///< Left intake motor
+  double m_intake_right;   ///< Right intake motor
+  double m_intake_current_left;  ///< Left intake motor current draw, in mA
+  double m_intake_current_right; ///< Right intake motor current draw, in mA
+};
+
+/**
+ * Sensors class.
+ * The only reader of the robot's encoders and IMU.
+ * Reads each sensor once per sample and publishes the readings as a SensorFrame, which the subsystems compute their poses from.
+ */
+class Sensors {
+
+public:
+
+  /**
+   * Counts of sensor reads.
+   */
+  struct ReadStats {
+    uint32_t m_samples; ///< Calls to sample()
+    uint32_t m_reads;   ///< Sensors read
+    uint32_t m_errors;  ///< Reads that failed
+  };
+
+  /**
+   * The IMU's status is only trusted this long after calibration starts, in ms,
+   * as it takes a moment to report that it is calibrating.
+   */
+  static constexpr uint32_t IMU_STATUS_DELAY = 100;
+
+  /**
+   * Constructor.
+   *
+   * \param tracking_left
+   *        The encoder of the left tracking wheel
+   * \param tracking_right
+   *        The encoder of the right tracking wheel
+   * \param tracking_side
+   *        The encoder of the sideways tracking wheel
+   * \param transmission
+   *        The transmission, whose motor encoders are read
+   * \param lift
+   *        The lift, whose motor encoders are read
+   * \param intake
+   *        The intake, whose motor encoders and current draw are read
+   * \param imu
+   *        An IMU, or nullptr
+   */
+  Sensors(
+    std::unique_ptr<ContinuousRotarySensor> tracking_left,
+    std::unique_ptr<ContinuousRotarySensor> tracking_right,
+    std::unique_ptr<ContinuousRotarySensor> tracking_side,
+    const std::shared_ptr<Transmission>& transmission,
+    const std::shared_ptr<Lift>& lift,
+    const std::shared_ptr<Intake>& intake,
+    std::unique_ptr<pros::Imu> imu = nullptr
+  );
+
+  /**
+   * Start calibrating the IMU.
+   * Returns immediately; calibration takes about 2s, during which the robot must be still
+   * and frames carry no IMU reading. Does nothing without an IMU.
+   */
+  void calibrate_imu();
+
+  /**
+   * Check whether the IMU has finished calibrating.
+   *
+   * \return True if there is an IMU and it is not calibrating
+   */
+  bool is_imu_ready() const;
+
+  /**
+   * Read the sensors of some groups and publish a new frame.
+   * Readings of the other groups are carried over from the last sample.
+   * Must only be called from a single task; the updater task does this.
+   *
+   * \param groups
+   *        The SensorGroup bits to read
+   *
+   * \return The new frame; valid until the next sample
+   */
+  const SensorFrame& sample(uint32_t groups);
+
+  /**
+   * Get the last frame.
+   * Safe to call from any task; never blocks sample().
+   *
+   * \return A copy of the frame published by the last sample()
+   */
+  SensorFrame get_frame() const;
+
+  /**
+   * Get the counts of sensor reads.
+   * Only exact while sample() is not running.
+   *
+   * \return The counts
+   */
+  ReadStats get_read_stats() const;
+
+private:
+
+  /**
+   * The sensors.
+   */
+  std::unique_ptr<ContinuousRotarySensor> m_tracking_left;
+  std::unique_ptr<ContinuousRotarySensor> m_tracking_right;
+  std::unique_ptr<ContinuousRotarySensor> m_tracking_side;
+  std::shared_ptr<IntegratedEncoder> m_direct_left;
+  std::shared_ptr<IntegratedEncoder> m_direct_right;
+  std::shared_ptr<IntegratedEncoder> m_shared_left;
+  std::shared_ptr<IntegratedEncoder> m_shared_right;
+  std::shared_ptr<IntegratedEncoder> m_lift_left;
+  std::shared_ptr<IntegratedEncoder> m_lift_right;
+  std::shared_ptr<IntegratedEncoder> m_intake_left;
+  std::shared_ptr<IntegratedEncoder> m_intake_right;
+  std::shared_ptr<Motor> m_intake_current_left;
+  std::shared_ptr<Motor> m_intake_current_right;
+  std::unique_ptr<pros::Imu> m_imu;
+
+  /**
+   * Whether the IMU is calibrating, and when it started, in ms.
+   * Polled by sample() until calibration finishes.
+   */
+  std::atomic<bool> m_imu_calibrating;
+  uint32_t m_imu_calibration_start;
+
+  /**
+   * The frame being sampled; only touched by the task running sample().
+   */
+  SensorFrame m_frame;
+
+  /**
+   * The frame as published to other tasks.
+   */
+  Snapshot<SensorFrame> m_published;
+
+  /**
+   * Read counts.
+   */
+  ReadStats m_stats;
+
+  /**
+   * Read a sensor once, counting the read.
+   *
+   * \return The reading, or PROS_ERR if it failed or the sensor is missing
+   */
+  double read(const ContinuousRotarySensor* sensor);
+  double read(const pros::Imu* imu);
+
+  /**
+   * Read a motor's current draw once, counting the read.
+   *
+   * \return The current draw in mA, or PROS_ERR if it failed or the motor is missing
+   */
+  double read_current(Motor* motor);
+};
@@ -5,36 +5,164 @@
 #include "subsystems/tilter.hpp"
 #include "subsystems/intake.hpp"
 #include "subsystems/lift.hpp"
+#include "subsystems/sensors.hpp"
+#include "lib/scheduler.hpp"
+#include "lib/arbiter.hpp"
+#include "lib/rtos_mutex.hpp"
+#include "lib/telemetry.hpp"
+#include "lib/telemetry_link.hpp"
 
 namespace subsystems {
 
   /**
    * Task notification types.
+   * These are bits, so several may be pending at once.
    */
   enum UpdaterNotification {
 
-    NOTIFY_UPDATE_POSE, ///< Update the poses of the subsystems
-    NOTIFY_UPDATE_CONT  ///< Update the controllers of the subsystems.
+    NOTIFY_UPDATE_POSE = 1 << 0, ///< Update the poses of the subsystems
+    NOTIFY_UPDATE_CONT = 1 << 1  ///< Update the controllers of the subsystems.
   };
 
   /**
-   * Send a notification to the updater task.
+   * The maximum number of tasks that can subscribe to pose updates.
+   */
+  constexpr size_t MAX_POSE_SUBSCRIBERS = 8;
+
+  /**
+   * Subscribe a task to pose updates.
+   * The task is notified every time the chassis and tilter poses are updated,
+   * so it can wait with pros::c::task_notify_take() instead of reading sensors itself.
+   * 
+   * \param task
+   *        The task to notify
+   * 
+   * \return True if the task was subscribed, false if there are too many subscribers
+   */
+  bool subscribe_poses(pros::task_t task);
+
+  /**
+   * Unsubscribe a task from pose updates.
+   * Once this returns, the task is not notified again, so it can be deleted.
    * 
-   * \param notification
-   *        The type of notification to send
+   * \param task
+   *        The task to stop notifying
    */
-  void notify_updater(UpdaterNotification notification);
+  void unsubscribe_poses(pros::task_t task);
 
   /**
    * Update task.
-   * When in autonomous, this will run automatically.
-   * When in opcontrol, send this task NOTIFY_UPDATE_POSE to update poses.
-   * Whe in opcontrol, send NOTIFY_UPDATE_CONT to update controllers.
-   * This will only update subsystems if their mutex is available.
-   * Some controllers may prefer to themselves handle updating.
+   * Runs the scheduler, which updates every subsystem at its own rate.
+   * This is the only task that reads subsystem sensors; poses are updated regardless of which command owns a subsystem.
+   * Internal controllers are only updated while no command owns their subsystem.
+   * Send this task NOTIFY_UPDATE_POSE or NOTIFY_UPDATE_CONT to update before the next deadline.
    */
   extern std::shared_ptr<pros::Task> updater_task;
 
+  /**
+   * Update rates.
+   */
+  constexpr QFrequency ODOM_RATE = 200_Hz;         ///< Rate of chassis and tilter pose updates
+  constexpr QFrequency TRANSMISSION_RATE = 100_Hz; ///< Rate of the transmission's controller (including tilter hold)
+  constexpr QFrequency LIFT_RATE = 100_Hz;         ///< Rate of lift pose updates and preset moves
+  constexpr QFrequency INTAKE_RATE = 50_Hz;        ///< Rate of intake pose updates
+
+  /**
+   * Scheduler run by the update task.
+   * Its job statistics show the real timing of each update.
+   */
+  extern std::shared_ptr<Scheduler> scheduler;
+
+  /**
+   * Subsystems that commands can require.
+   * These are bits, so a command can require several.
+   */
+  enum Resource : ResourceSet {
+
+    RESOURCE_TRANSMISSION = 1 << 0, ///< The transmission, and with it the chassis and tilter
+    RESOURCE_LIFT = 1 << 1,         ///< The lift
+    RESOURCE_INTAKE = 1 << 2        ///< The intake rollers
+  };
+
+  /**
+   * Command priorities.
+   * A command interrupts interruptible commands of equal or lower priority.
+   */
+  enum CommandPriority : int {
+
+    PRIORITY_PRESET = 0, ///< Background moves, such as lift presets
+    PRIORITY_MACRO = 1,  ///< Macros and autonomous motions
+    PRIORITY_DRIVER = 2, ///< Manual overrides
+    PRIORITY_TEST = 3    ///< Characterization runs
+  };
+
+  /**
+   * Gives each subsystem to at most one command at a time.
+   * Commands drive subsystems only inside arbiter->run(), and the updater and driver defaults only inside arbiter->run_default(),
+   * so exactly one of them drives each subsystem per tick.
+   */
+  extern std::shared_ptr<Arbiter<RtosMutex>> arbiter;
+
+  /**
+   * Telemetry channels.
+   * Values of each channel are listed in the order they are pushed.
+   */
+  enum TelemetryChannel : uint8_t {
+
+    TELEMETRY_TILTER = 1, ///< Tilter angle (deg), setpoint (deg), output (mV)
+    TELEMETRY_LIFT = 2,   ///< Lift angle (deg), target (deg)
+    TELEMETRY_INTAKE = 3  ///< Intake voltage (mV), velocity (deg/s), current (mA), cube count
+  };
+
+  /**
+   * Telemetry sink.
+   * Records are drained to the serial port by a low-priority task; decode them with tools/decode_telemetry.py.
+   */
+  extern std::shared_ptr<Telemetry> telemetry;
+
+  /**
+   * Fields of the serial telemetry link, in frame order.
+   */
+  enum TelemetryField {
+
+    FIELD_X,                     ///< Chassis x (mm)
+    FIELD_Y,                     ///< Chassis y (mm)
+    FIELD_HEADING,               ///< Chassis heading (mrad)
+    FIELD_TRANSMISSION_STATE,    ///< Transmission::State
+    FIELD_TILTER,                ///< Tilter angle (0.1 deg)
+    FIELD_LIFT,                  ///< Mean lift angle (0.1 deg)
+    FIELD_INTAKE,                ///< Mean intake angle (0.1 deg)
+    FIELD_VOLTAGE_DIRECT_LEFT,   ///< Commanded motor voltages (mV)
+    FIELD_VOLTAGE_DIRECT_RIGHT,
+    FIELD_VOLTAGE_SHARED_LEFT,
+    FIELD_VOLTAGE_SHARED_RIGHT,
+    FIELD_VOLTAGE_LIFT_LEFT,
+    FIELD_VOLTAGE_LIFT_RIGHT,
+    FIELD_VOLTAGE_INTAKE_LEFT,
+    FIELD_VOLTAGE_INTAKE_RIGHT,
+    NUM_TELEMETRY_FIELDS
+  };
+
+  /**
+   * Smart port of the inertial sensor.
+   * init() starts its calibration in the background; Odom fuses it into the heading once calibration finishes.
+   */
+  constexpr uint8_t IMU_PORT = 10;
+
+  /**
+   * Serial telemetry link settings.
+   */
+  constexpr uint8_t TELEMETRY_PORT = 21;         ///< Smart port of the link
+  constexpr int32_t TELEMETRY_BAUD = 115200;     ///< Baud rate of the link
+  constexpr uint32_t TELEMETRY_BUDGET = 6000;    ///< Most bytes per second sent over the link
+  constexpr QFrequency TELEMETRY_RATE = 100_Hz;  ///< Rate at which frames are sent
+
+  /**
+   * Serial telemetry link.
+   * Sends the state of every subsystem at TELEMETRY_RATE; decode it with tools/telemetry_link.py.
+   */
+  extern std::shared_ptr<TelemetryLink> telemetry_link;
+
   /**
    * Subsystem objects.
    * These should be the only objects created from the subsystem classes.
@@ -47,20 +175,14 @@ namespace subsystems {
   extern std::shared_ptr<Lift>    lift;    ///< Lift object
 
   /**
-   * Initialize all subsystems.
-   * Should be run before any references to them.
-   */
-  void init();
-
-  /**
-   * Update the pose of all subsystem objects.
-   * Should be run before operating on subsystems.
+   * The robot's encoders and IMU.
+   * Sampled once per update by the updater task; other tasks can read the last frame with get_frame().
    */
-  void update_poses();
+  extern std::shared_ptr<Sensors> sensors;
 
   /**
-   * Update the controllers of all subsystem objects.
-   * Should be run after operating on subsystems (not before).
+   * Initialize all subsystems.
+   * Should be run before any references to them.
    */
-  void update_controllers();
+  void init();
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "lib/odom.hpp"
 #include "subsystems/transmission.hpp"
+#include "subsystems/sensors.hpp"
+#include "lib/derivative_estimator.hpp"
 
 
 class Tilter {
@@ -31,8 +33,13 @@ static constexpr QAngle MAX_EXTENDED = 90_deg;
    * Hold the tray.
    * This will relieve all current controllers (EXTENDING, RETRACTING, LOCKED_PASSTHROUGH).
    * Will switch to HOLDING state unless locked, in which case the transmission will automatically switch to PASSIVE.
+   * 
+   * \param bias
+   *        Voltage added to the shared motors to push the tray forwards
+   * \param priority
+   *        Whether the tray or the chassis gets the shared motors' voltage first; by default, the tray while carrying a stack
    */
-  void hold(int bias = 0);
+  void hold(int bias = 0, Transmission::HoldPriority priority = Transmission::HoldPriority::STACK);
 
 
   /**
@@ -88,8 +95,11 @@ static constexpr QAngle MAX_EXTENDED = 90_deg;
   /**
    * Update the pose calculation.
    * Should always be run before acting on the tilter.
+   * 
+   * \param frame
+   *        The sensor readings to update from; the angle is the difference of the shared and direct transmission motors
    */
-  void update_angle();
+  void update_angle(const SensorFrame& frame);
 
 private:
 
@@ -117,9 +127,9 @@ private:
   QAngle m_pose;
 
   /**
-   * A VelMath object.
-   * Used to calculate velocity and acceleration of tilter.
+   * Velocity and acceleration estimator, in degrees.
+   * Stepped with every pose update, at the odom rate.
    */
-  VelMath velmath;
+  DerivativeEstimator m_estimator;
 
 };
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "main.h"
+#include "lib/cached_motor.hpp"
+#include "lib/rtos_mutex.hpp"
+#include "state_machine.hpp"
+#include "controller_gains.hpp"
+#include <atomic>
 #include <memory>
 
 class Chassis;
@@ -27,6 +32,9 @@ class Transmission {
   static constexpr QAngle TILTER_RETRACT_THRESHOLD = 3_deg; ///< Tilter is considered retracted when behind this value.
   static constexpr QAngle TILTER_EXTEND_THRESHOLD = 85_deg;  ///< Tilter is considered extended when in front of this value.
   static constexpr double TILTER_HOLD_STRENGTH = 4000;      ///< This is the maximum voltage that will be applied to correct the tilter.
+  static constexpr const double& HOLD_KP = controller_gains::HOLD_KP; ///< Hold voltage per deg of tilter error, in mV; hand-tuned
+  static constexpr const double& HOLD_KD = controller_gains::HOLD_KD; ///< Hold voltage per deg/s of tilter velocity, in mV; hand-tuned
+  static constexpr int MAX_VOLTAGE = 12000;                 ///< The voltage budget of each motor, in mV.
 
   /**
    * Constructor.
@@ -43,19 +51,13 @@ class Transmission {
 
   /**
    * IMEs associated with each motor.
+   * Read them through a SensorFrame.
    */
   std::shared_ptr<IntegratedEncoder> m_ime_left_direct;
   std::shared_ptr<IntegratedEncoder> m_ime_right_direct;
   std::shared_ptr<IntegratedEncoder> m_ime_left_shared;
   std::shared_ptr<IntegratedEncoder> m_ime_right_shared;
 
-  /**
-   * Control mutex.
-   * Take this when controlling the transmission.
-   * You must update the pose and internal controller manualls if taken.
-   */
-  pros::Mutex m_control_mutex;
-
   /**
    * Set the internal chassis reference.
    *
@@ -80,11 +82,176 @@ class Transmission {
    */
   void set_lift(std::shared_ptr<Lift> lift);
 
+  /**
+   * Describe a way for the transmission to reconcile the chassis and tilter.
+   */
+  enum class State {
+    PASSIVE,            ///< transmission motor copies dedicated motor; tilter should remain stationary but this is not enforced
+    HOLDING,            ///< tilter is held in place; drive speed may be modified
+    RETRACTING,         ///< transmission motor is locked at full reverse speed regardless of what the direct motor does
+    EXTENDING,          ///< transmission motor is locked at full forward speed regardless of the the direct motor does
+    LOCKED_PASSTHROUGH  ///< chassis motors lock, and tilter gets full feedforward signal
+  };
+
+  /**
+   * Which load gets the shared motors' voltage budget first while HOLDING.
+   */
+  enum class HoldPriority {
+    DRIVE,  ///< the chassis command is kept, and the tilter correction gets the remaining headroom
+    TILTER, ///< the tilter correction is kept, and the chassis command is scaled down to fit
+    STACK   ///< TILTER while carrying at least HOLD_STACK_CUBES cubes, DRIVE otherwise
+  };
+
+  /**
+   * HoldPriority::STACK holds the tray first with at least this many cubes on it.
+   */
+  static constexpr size_t HOLD_STACK_CUBES = 1;
+
+  /**
+   * Resolve a priority against the stack being carried.
+   *
+   * \param priority
+   *        The priority asked for
+   * \param cubes
+   *        The number of cubes on the tray
+   *
+   * \return DRIVE or TILTER
+   */
+  static HoldPriority resolve_priority(HoldPriority priority, size_t cubes);
+
+  /**
+   * Set the number of cubes being carried, which HoldPriority::STACK decides from.
+   * subsystems::init() calls this with the intake's count on every cube event.
+   *
+   * \param cubes
+   *        The number of cubes on the tray
+   */
+  void set_stack_size(size_t cubes);
+
+  /**
+   * How often and how hard the HOLDING allocator has saturated.
+   */
+  struct SaturationStats {
+    uint32_t m_updates;      ///< Number of HOLDING updates
+    uint32_t m_saturated;    ///< Number of HOLDING updates where the request exceeded the budget
+    uint32_t m_max_excess;   ///< Largest request over the budget, in mV
+    uint64_t m_total_excess; ///< Sum of requests over the budget, in mV
+  };
+
+  /**
+   * The voltages sent to the motors while HOLDING.
+   */
+  struct Allocation {
+    int m_direct_left;  ///< Voltage of the left direct motor
+    int m_direct_right; ///< Voltage of the right direct motor
+    int m_shared_left;  ///< Voltage of the left shared motor
+    int m_shared_right; ///< Voltage of the right shared motor
+    int m_excess;       ///< How far the request exceeded the budget, in mV; 0 if it fit
+  };
+
+  /**
+   * Split the shared motors' voltage budget between the chassis and the tilter.
+   * Both chassis sides are scaled together, so the ratio between them (and therefore the curvature) is kept.
+   * 
+   * \param drive_left
+   *        The desired voltage of the left chassis side
+   * \param drive_right
+   *        The desired voltage of the right chassis side
+   * \param tilter
+   *        The desired voltage added to both shared motors to hold the tilter
+   * \param priority
+   *        Which load is satisfied first; DRIVE or TILTER
+   * 
+   * \return The motor voltages, all within MAX_VOLTAGE
+   */
+  static Allocation allocate(int drive_left, int drive_right, int tilter, HoldPriority priority);
+
+  /**
+   * A change of state.
+   */
+  struct TransitionRecord {
+    uint32_t m_time; ///< Time of the transition, in ms
+    State m_from;    ///< The state left
+    State m_to;      ///< The state entered
+  };
+
+  /**
+   * The number of transitions kept in the trace.
+   */
+  static constexpr size_t TRACE_LENGTH = 32;
+
   /**
    * Update the internal controller and state manager.
+   * Takes at most one state transition, then updates the motors for the current state.
    */
   void update();
 
+  /**
+   * Get the current state.
+   * 
+   * \return The current state
+   */
+  State get_state() const;
+
+  /**
+   * Get a recent transition.
+   * Safe to call from any task, but another transition may be recorded between this and get_transition_count();
+   * use get_trace() for several at once.
+   * 
+   * \param age
+   *        How many transitions ago; 0 is the most recent
+   * 
+   * \return The transition; undefined if age is not less than get_transition_count() or TRACE_LENGTH
+   */
+  TransitionRecord get_transition(size_t age) const;
+
+  /**
+   * Get the number of transitions since construction.
+   * Safe to call from any task.
+   * 
+   * \return The number of transitions
+   */
+  uint32_t get_transition_count() const;
+
+  /**
+   * Copy the most recent transitions, all recorded by the time of the call.
+   * Safe to call from any task.
+   * 
+   * \param records
+   *        Filled with the transitions, most recent first
+   * \param max
+   *        The most transitions to copy
+   * 
+   * \return The number of transitions copied; at most max and TRACE_LENGTH
+   */
+  size_t get_trace(TransitionRecord* records, size_t max) const;
+
+  /**
+   * Get how often and how hard the HOLDING allocator has saturated.
+   * 
+   * \return The saturation counts
+   */
+  SaturationStats get_saturation_stats() const;
+
+  /**
+   * Get the counts of commands sent to and withheld from the transmission's motors.
+   * 
+   * \return The counts, summed over all motors
+   */
+  CachedMotor::WriteStats get_write_stats() const;
+
+  /**
+   * Get the voltages the transmission's motors were last commanded, as cached by each CachedMotor.
+   * Reads nothing from the motors; a motor told to hold a velocity reports 0.
+   * 
+   * \return
+   *          The voltage of the left direct motor, in mV,
+   *          The voltage of the right direct motor, in mV,
+   *          The voltage of the left shared motor, in mV,
+   *          The voltage of the right shared motor, in mV
+   */
+  std::tuple<int, int, int, int> get_voltages() const;
+
 private:
 
   /**
@@ -97,26 +264,10 @@ private:
   /**
    * Motors associated with the transmission.
    */
-  std::unique_ptr<Motor> m_motor_left_direct;  ///< The direct motor on the left of the chassis
-  std::unique_ptr<Motor> m_motor_right_direct; ///< The direct motor on the right of the chassis
-  std::unique_ptr<Motor> m_motor_left_shared;  ///< The shared motor on the left of the chassis
-  std::unique_ptr<Motor> m_motor_right_shared; ///< The shared motor on the right of the chassis
-
-  /**
-   * Describe a way for the transmission to reconcile the chassis and tilter.
-   */
-  enum class State {
-    PASSIVE,            ///< transmission motor copies dedicated motor; tilter should remain stationary but this is not enforced
-    HOLDING,            ///< tilter is held in place; drive speed may be modified
-    RETRACTING,         ///< transmission motor is locked at full reverse speed regardless of what the direct motor does
-    EXTENDING,          ///< transmission motor is locked at full forward speed regardless of the the direct motor does
-    LOCKED_PASSTHROUGH  ///< chassis motors lock, and tilter gets full feedforward signal
-  };
-
-  /***
-   * The current state of the transmission.
-   */
-  State m_state;
+  std::unique_ptr<CachedMotor> m_motor_left_direct;  ///< The direct motor on the left of the chassis
+  std::unique_ptr<CachedMotor> m_motor_right_direct; ///< The direct motor on the right of the chassis
+  std::unique_ptr<CachedMotor> m_motor_left_shared;  ///< The shared motor on the left of the chassis
+  std::unique_ptr<CachedMotor> m_motor_right_shared; ///< The shared motor on the right of the chassis
 
   /**
    * The desired voltages of the chassis.
@@ -136,7 +287,23 @@ private:
   int m_bias;
 
   /**
-   * Set the desired state of the transmission.
+   * Which load is satisfied first while holding.
+   */
+  HoldPriority m_hold_priority;
+
+  /**
+   * The number of cubes being carried; set from the task updating the intake.
+   */
+  std::atomic<size_t> m_stack_size;
+
+  /**
+   * Saturation counts of the holding behavior.
+   */
+  SaturationStats m_saturation_stats;
+
+  /**
+   * Set the state of the transmission, regardless of transitions.
+   * Recorded in the transition trace if the state changes.
    * 
    * \param state
    *        The desired state
@@ -144,8 +311,71 @@ private:
   void set_state(State state);
 
   /**
-   * PID controller.
-   * Used to hold tilter in place when in HOLD state.
+   * The angle the tilter is held at in the HOLDING state, in deg.
+   */
+  double m_hold_target;
+
+  /**
+   * Motor outputs of each state.
+   */
+  static void update_passive(Transmission& transmission);
+  static void update_holding(Transmission& transmission);
+  static void update_retracting(Transmission& transmission);
+  static void update_extending(Transmission& transmission);
+  static void update_locked_passthrough(Transmission& transmission);
+
+  /**
+   * Transition guards.
+   */
+  static bool retract_done(const Transmission& transmission);  ///< Tilter is retracted, or the lift is too low to move it
+  static bool extend_done(const Transmission& transmission);   ///< Tilter is extended, or the lift is too low to move it
+  static bool can_release(const Transmission& transmission);   ///< Tilter is retracted and the lift is high enough to lock it
+  static bool must_hold(const Transmission& transmission);     ///< The lift is too low to lock the tilter
+
+  /**
+   * Transition actions.
+   */
+  static void hold_retracted(Transmission& transmission); ///< Hold the tilter fully retracted with no bias, the tray first while carrying a stack
+  static void hold_at_threshold(Transmission& transmission); ///< Hold the tilter at the retract threshold with no bias, the tray first while carrying a stack
+
+  /**
+   * Describes the transmission's state machine.
+   * Earlier transitions take priority; at most one is taken per update.
+   */
+  struct StateTraits {
+    using State = Transmission::State;
+    using Context = Transmission;
+    static constexpr size_t NUM_STATES = 5;
+    static constexpr StateBehavior<Transmission> BEHAVIORS[] = {
+      {nullptr, &Transmission::update_passive},
+      {nullptr, &Transmission::update_holding},
+      {nullptr, &Transmission::update_retracting},
+      {nullptr, &Transmission::update_extending},
+      {nullptr, &Transmission::update_locked_passthrough}
+    };
+    static constexpr Transition<State, Transmission> TRANSITIONS[] = {
+      {State::RETRACTING, State::HOLDING, &Transmission::retract_done, &Transmission::hold_retracted},
+      {State::EXTENDING,  State::HOLDING, &Transmission::extend_done,  &Transmission::hold_at_threshold},
+      {State::HOLDING,    State::PASSIVE, &Transmission::can_release,  nullptr},
+      {State::PASSIVE,    State::HOLDING, &Transmission::must_hold,    &Transmission::hold_retracted}
+    };
+  };
+
+  /**
+   * The state machine.
+   */
+  StateMachine<StateTraits> m_machine;
+
+  /**
+   * The transition trace, as a ring buffer.
+   * Written by set_state() from commands and by update() from the updater, and read by anyone, so guarded by the mutex.
+   */
+  TransitionRecord m_trace[TRACE_LENGTH];
+  uint32_t m_trace_count;
+  mutable RtosMutex m_trace_mutex;
+
+  /**
+   * Add a transition to the trace.
    */
-  IterativePosPIDController m_hold_controller;
+  void record_transition(State from, State to);
 };
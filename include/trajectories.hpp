@@ -0,0 +1,222 @@
+#pragma once
+
+// Generated by tools/pack_trajectories.py; do not edit.
+
+#include "lib/packed_trajectory.hpp"
+
+namespace trajectories {
+
+  inline constexpr PackedSegment PUSH_CUBE_IN_SEGMENTS[] = {
+    {0, 0, 0, 0, 1000, 0},
+    {1, 0, 0, 100, 1000, 0},
+    {2, 0, 0, 200, 1000, 0},
+    {4, 0, 0, 300, 1000, 0},
+    {6, 0, 0, 400, 1000, 0},
+    {10, 0, 0, 500, 1000, 0},
+    {14, 0, 0, 600, 1000, 0},
+    {20, 0, 0, 700, 1000, 0},
+    {26, 0, 0, 800, 1000, 0},
+    {32, 0, 0, 900, 1000, 0},
+    {40, 0, 0, 1000, 1000, 0},
+    {48, 0, 0, 1100, 1000, 0},
+    {58, 0, 0, 1200, 1000, 0},
+    {68, 0, 0, 1300, 1000, 0},
+    {78, 0, 0, 1400, 1000, 0},
+    {90, 0, 0, 1500, 1000, 0},
+    {102, 0, 0, 1600, 1000, 0},
+    {116, 0, 0, 1700, 1000, 0},
+    {130, 0, 0, 1800, 1000, 0},
+    {144, 0, 0, 1900, 1000, 0},
+    {160, 0, 0, 2000, 1000, 0},
+    {176, 0, 0, 2100, 1000, 0},
+    {194, 0, 0, 2200, 1000, 0},
+    {212, 0, 0, 2300, 1000, 0},
+    {230, 0, 0, 2400, 1000, 0},
+    {250, 0, 0, 2500, 1000, 0},
+    {270, 0, 0, 2600, 1000, 0},
+    {292, 0, 0, 2700, 1000, 0},
+    {314, 0, 0, 2800, 1000, 0},
+    {336, 0, 0, 2900, 1000, 0},
+    {360, 0, 0, 3000, 1000, 0},
+    {384, 0, 0, 3100, 1000, 0},
+    {410, 0, 0, 3200, 1000, 0},
+    {436, 0, 0, 3300, 1000, 0},
+    {462, 0, 0, 3400, 1000, 0},
+    {490, 0, 0, 3500, 1000, 0},
+    {518, 0, 0, 3600, 1000, 0},
+    {548, 0, 0, 3700, 1000, 0},
+    {578, 0, 0, 3800, 1000, 0},
+    {608, 0, 0, 3900, 1000, 0},
+    {640, 0, 0, 4000, 1000, 0},
+    {672, 0, 0, 4100, 1000, 0},
+    {706, 0, 0, 4200, 1000, 0},
+    {740, 0, 0, 4300, 1000, 0},
+    {774, 0, 0, 4400, 1000, 0},
+    {810, 0, 0, 4500, 500, 0},
+    {846, 0, 0, 4500, 0, 0},
+    {882, 0, 0, 4500, 0, 0},
+    {918, 0, 0, 4500, 0, 0},
+    {954, 0, 0, 4500, 0, 0},
+    {990, 0, 0, 4500, 0, 0},
+    {1026, 0, 0, 4500, 0, 0},
+    {1062, 0, 0, 4500, 0, 0},
+    {1098, 0, 0, 4500, 0, 0},
+    {1134, 0, 0, 4500, 0, 0},
+    {1170, 0, 0, 4500, 0, 0},
+    {1206, 0, 0, 4500, -278, 0},
+    {1242, 0, 0, 4444, -778, 0},
+    {1277, 0, 0, 4344, -1000, 0},
+    {1311, 0, 0, 4244, -1000, 0},
+    {1345, 0, 0, 4144, -1000, 0},
+    {1378, 0, 0, 4044, -1000, 0},
+    {1410, 0, 0, 3944, -1000, 0},
+    {1441, 0, 0, 3844, -1000, 0},
+    {1471, 0, 0, 3744, -1000, 0},
+    {1501, 0, 0, 3644, -1000, 0},
+    {1529, 0, 0, 3544, -1000, 0},
+    {1557, 0, 0, 3444, -1000, 0},
+    {1585, 0, 0, 3344, -1000, 0},
+    {1611, 0, 0, 3244, -1000, 0},
+    {1636, 0, 0, 3144, -1000, 0},
+    {1661, 0, 0, 3044, -1000, 0},
+    {1685, 0, 0, 2944, -1000, 0},
+    {1708, 0, 0, 2844, -1000, 0},
+    {1731, 0, 0, 2744, -1000, 0},
+    {1752, 0, 0, 2644, -1000, 0},
+    {1773, 0, 0, 2544, -1000, 0},
+    {1793, 0, 0, 2444, -1000, 0},
+    {1812, 0, 0, 2344, -1000, 0},
+    {1830, 0, 0, 2244, -1000, 0},
+    {1848, 0, 0, 2144, -1000, 0},
+    {1865, 0, 0, 2044, -1000, 0},
+    {1881, 0, 0, 1944, -1000, 0},
+    {1896, 0, 0, 1844, -1000, 0},
+    {1910, 0, 0, 1744, -1000, 0},
+    {1924, 0, 0, 1644, -1000, 0},
+    {1937, 0, 0, 1544, -1000, 0},
+    {1949, 0, 0, 1444, -1000, 0},
+    {1960, 0, 0, 1344, -1000, 0},
+    {1970, 0, 0, 1244, -1000, 0},
+    {1980, 0, 0, 1144, -1000, 0},
+    {1988, 0, 0, 1044, -1000, 0},
+    {1996, 0, 0, 944, -1000, 0},
+    {2003, 0, 0, 844, -1000, 0},
+    {2010, 0, 0, 744, -1000, 0},
+    {2015, 0, 0, 644, -1000, 0},
+    {2020, 0, 0, 544, -1000, 0},
+    {2024, 0, 0, 444, -1000, 0},
+    {2027, 0, 0, 344, -1000, 0},
+    {2030, 0, 0, 244, -1000, 0},
+    {2031, 0, 0, 144, -1000, 0},
+    {2032, 0, 0, 44, -722, 0},
+    {2032, 0, 0, 0, 0, 0},
+  };
+  inline constexpr PackedTrajectory PUSH_CUBE_IN = {PUSH_CUBE_IN_SEGMENTS, 103, 10};
+
+  inline constexpr PackedSegment PUSH_CUBE_OUT_SEGMENTS[] = {
+    {2032, 0, 0, 0, -1000, 0},
+    {2031, 0, 0, -100, -1000, 0},
+    {2030, 0, 0, -200, -1000, 0},
+    {2028, 0, 0, -300, -1000, 0},
+    {2026, 0, 0, -400, -1000, 0},
+    {2022, 0, 0, -500, -1000, 0},
+    {2018, 0, 0, -600, -1000, 0},
+    {2012, 0, 0, -700, -1000, 0},
+    {2006, 0, 0, -800, -1000, 0},
+    {2000, 0, 0, -900, -1000, 0},
+    {1992, 0, 0, -1000, -1000, 0},
+    {1984, 0, 0, -1100, -1000, 0},
+    {1974, 0, 0, -1200, -1000, 0},
+    {1964, 0, 0, -1300, -1000, 0},
+    {1954, 0, 0, -1400, -1000, 0},
+    {1942, 0, 0, -1500, -1000, 0},
+    {1930, 0, 0, -1600, -1000, 0},
+    {1916, 0, 0, -1700, -1000, 0},
+    {1902, 0, 0, -1800, -1000, 0},
+    {1888, 0, 0, -1900, -1000, 0},
+    {1872, 0, 0, -2000, -1000, 0},
+    {1856, 0, 0, -2100, -1000, 0},
+    {1838, 0, 0, -2200, -1000, 0},
+    {1820, 0, 0, -2300, -1000, 0},
+    {1802, 0, 0, -2400, -1000, 0},
+    {1782, 0, 0, -2500, -1000, 0},
+    {1762, 0, 0, -2600, -1000, 0},
+    {1740, 0, 0, -2700, -1000, 0},
+    {1718, 0, 0, -2800, -1000, 0},
+    {1696, 0, 0, -2900, -1000, 0},
+    {1672, 0, 0, -3000, -1000, 0},
+    {1648, 0, 0, -3100, -1000, 0},
+    {1622, 0, 0, -3200, -1000, 0},
+    {1596, 0, 0, -3300, -1000, 0},
+    {1570, 0, 0, -3400, -1000, 0},
+    {1542, 0, 0, -3500, -1000, 0},
+    {1514, 0, 0, -3600, -1000, 0},
+    {1484, 0, 0, -3700, -1000, 0},
+    {1454, 0, 0, -3800, -1000, 0},
+    {1424, 0, 0, -3900, -1000, 0},
+    {1392, 0, 0, -4000, -1000, 0},
+    {1360, 0, 0, -4100, -1000, 0},
+    {1326, 0, 0, -4200, -1000, 0},
+    {1292, 0, 0, -4300, -1000, 0},
+    {1258, 0, 0, -4400, -1000, 0},
+    {1222, 0, 0, -4500, -500, 0},
+    {1186, 0, 0, -4500, 0, 0},
+    {1150, 0, 0, -4500, 0, 0},
+    {1114, 0, 0, -4500, 0, 0},
+    {1078, 0, 0, -4500, 0, 0},
+    {1042, 0, 0, -4500, 0, 0},
+    {1006, 0, 0, -4500, 0, 0},
+    {970, 0, 0, -4500, 0, 0},
+    {934, 0, 0, -4500, 0, 0},
+    {898, 0, 0, -4500, 0, 0},
+    {862, 0, 0, -4500, 0, 0},
+    {826, 0, 0, -4500, 278, 0},
+    {790, 0, 0, -4444, 778, 0},
+    {755, 0, 0, -4344, 1000, 0},
+    {721, 0, 0, -4244, 1000, 0},
+    {687, 0, 0, -4144, 1000, 0},
+    {654, 0, 0, -4044, 1000, 0},
+    {622, 0, 0, -3944, 1000, 0},
+    {591, 0, 0, -3844, 1000, 0},
+    {561, 0, 0, -3744, 1000, 0},
+    {531, 0, 0, -3644, 1000, 0},
+    {503, 0, 0, -3544, 1000, 0},
+    {475, 0, 0, -3444, 1000, 0},
+    {447, 0, 0, -3344, 1000, 0},
+    {421, 0, 0, -3244, 1000, 0},
+    {396, 0, 0, -3144, 1000, 0},
+    {371, 0, 0, -3044, 1000, 0},
+    {347, 0, 0, -2944, 1000, 0},
+    {324, 0, 0, -2844, 1000, 0},
+    {301, 0, 0, -2744, 1000, 0},
+    {280, 0, 0, -2644, 1000, 0},
+    {259, 0, 0, -2544, 1000, 0},
+    {239, 0, 0, -2444, 1000, 0},
+    {220, 0, 0, -2344, 1000, 0},
+    {202, 0, 0, -2244, 1000, 0},
+    {184, 0, 0, -2144, 1000, 0},
+    {167, 0, 0, -2044, 1000, 0},
+    {151, 0, 0, -1944, 1000, 0},
+    {136, 0, 0, -1844, 1000, 0},
+    {122, 0, 0, -1744, 1000, 0},
+    {108, 0, 0, -1644, 1000, 0},
+    {95, 0, 0, -1544, 1000, 0},
+    {83, 0, 0, -1444, 1000, 0},
+    {72, 0, 0, -1344, 1000, 0},
+    {62, 0, 0, -1244, 1000, 0},
+    {52, 0, 0, -1144, 1000, 0},
+    {44, 0, 0, -1044, 1000, 0},
+    {36, 0, 0, -944, 1000, 0},
+    {29, 0, 0, -844, 1000, 0},
+    {22, 0, 0, -744, 1000, 0},
+    {17, 0, 0, -644, 1000, 0},
+    {12, 0, 0, -544, 1000, 0},
+    {8, 0, 0, -444, 1000, 0},
+    {5, 0, 0, -344, 1000, 0},
+    {2, 0, 0, -244, 1000, 0},
+    {1, 0, 0, -144, 1000, 0},
+    {0, 0, 0, -44, 722, 0},
+    {0, 0, 0, 0, 0, 0},
+  };
+  inline constexpr PackedTrajectory PUSH_CUBE_OUT = {PUSH_CUBE_OUT_SEGMENTS, 103, 10};
+}
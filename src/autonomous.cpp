@@ -1,23 +1,38 @@
 #include "main.h"
 #include "subsystems/subsystems.hpp"
 #include "controllers/controllers.hpp"
+#include "trajectories.hpp"
 
 using namespace subsystems;
-// using namespace subsystem_controllers;
+using namespace subsystem_controllers;
 
+/**
+ * Run every characterization test instead of the routine.
+ * Logs are written to the SD card; fit them with tools/fit_feedforward.py.
+ */
+constexpr bool CHARACTERIZE = false;
+
+/**
+ * The routine.
+ * tools/evaluate_autonomous.cpp runs it on simulated robots; see tools/sim/.
+ */
 void autonomous() {
 
+  if (CHARACTERIZE) {
+    characterization_controller->run_all();
+    return;
+  }
   
-  // push cube in
-  chassis->move_voltage(8000);
-  pros::delay(750);
-  chassis->move_voltage(0);
-  pros::delay(500);
+  // trajectories start at the origin
+  Odom::ChassisPose start(0_in, 0_in, 0_deg);
+  chassis->tare_pose(&start);
+
+  // push cube in; PUSH_CUBE_IN's 10 in stands in for the old timed push (8000 mV for 750 ms), which carries the
+  // nominal simulated robot about 9.8 in; neither distance has been checked on the field
+  trajectory_controller->follow(trajectories::PUSH_CUBE_IN);
   intake->move_voltage(-12000);
   pros::delay(500);
-  chassis->move_voltage(-8000);
-  pros::delay(750);
-  chassis->move_voltage(0);
+  trajectory_controller->follow(trajectories::PUSH_CUBE_OUT);
 
   // // flip out
   // tilter_controller->enable();
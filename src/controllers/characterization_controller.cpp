@@ -0,0 +1,159 @@
+#include "controllers/characterization_controller.hpp"
+#include "subsystems/subsystems.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+  // names used in log paths, indexed by enum
+  const char* const MECHANISM_NAMES[] = {"drive", "tilter", "lift", "intake"};
+  const char* const TEST_NAMES[] = {"quasistatic", "step"};
+}
+
+// constructor
+CharacterizationController::CharacterizationController(std::shared_ptr<Chassis> chassis, std::shared_ptr<Transmission> transmission, std::shared_ptr<Tilter> tilter, std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake):
+  m_chassis(chassis),
+  m_transmission(transmission),
+  m_tilter(tilter),
+  m_lift(lift),
+  m_intake(intake),
+  m_samples(new Sample[MAX_SAMPLES])
+{}
+
+// run a test
+bool CharacterizationController::run(Mechanism mechanism, Test test, bool reverse) {
+  const Settings& settings = SETTINGS[int(mechanism)];
+
+  // the drive and tilter belong to the transmission; the lift also holds the tilter locked
+  bool uses_transmission = mechanism == Mechanism::DRIVE || mechanism == Mechanism::TILTER;
+  ResourceSet requirements =
+    (uses_transmission ? subsystems::RESOURCE_TRANSMISSION : ResourceSet(0)) |
+    (mechanism == Mechanism::TILTER || mechanism == Mechanism::LIFT ? subsystems::RESOURCE_LIFT : ResourceSet(0)) |
+    (mechanism == Mechanism::INTAKE ? subsystems::RESOURCE_INTAKE : ResourceSet(0));
+  Command command("characterize", requirements, subsystems::PRIORITY_TEST, false, nullptr, [&](bool) {
+    stop(mechanism);
+    if (uses_transmission) m_transmission->update();
+  });
+  if (!subsystems::arbiter->schedule(command)) return false;
+
+  double direction = reverse ? -1 : 1;
+  uint32_t duration = test == Test::QUASISTATIC ? settings.m_ramp_time : settings.m_step_time;
+  uint32_t period = (1 / SAMPLE_RATE).convert(millisecond);
+  double start_position = measure(mechanism).first;
+  size_t count = 0;
+
+  uint32_t start = pros::millis();
+  uint32_t now = start;
+  while (subsystems::arbiter->run(command, [&]() {
+    if (count >= MAX_SAMPLES) return false;
+    uint32_t time = pros::millis() - start;
+    if (time > duration) return false;
+
+    // stop at the end of travel
+    double position, velocity;
+    std::tie(position, velocity) = measure(mechanism);
+    if (reverse ? position < settings.m_min_position : position > settings.m_max_position) return false;
+    if (std::abs(position - start_position) > settings.m_max_travel) return false;
+
+    double voltage = test == Test::QUASISTATIC ? settings.m_ramp_rate * time / 1000 : settings.m_step_voltage;
+    int applied = direction * std::min(voltage, 12000.0);
+    if (mechanism == Mechanism::TILTER) m_lift->move_voltage(LIFT_HOLD_VOLTAGE);
+    apply(mechanism, applied);
+    if (uses_transmission) m_transmission->update();
+
+    m_samples[count++] = {time, applied, float(position), float(velocity)};
+    return true;
+  })) {
+    pros::Task::delay_until(&now, period);
+  }
+
+  char path[64];
+  std::snprintf(path, sizeof(path), "/usd/characterize_%s_%s_%s.csv",
+    MECHANISM_NAMES[int(mechanism)], TEST_NAMES[int(test)], reverse ? "reverse" : "forward"
+  );
+  return write_log(path, count);
+}
+
+// run every test
+int CharacterizationController::run_all() {
+  int written = 0;
+  for (Mechanism mechanism : {Mechanism::DRIVE, Mechanism::TILTER, Mechanism::LIFT, Mechanism::INTAKE}) {
+    for (Test test : {Test::QUASISTATIC, Test::STEP}) {
+      for (bool reverse : {false, true}) {
+        written += run(mechanism, test, reverse);
+        pros::delay(REST_TIME);
+      }
+    }
+  }
+  return written;
+}
+
+// measure a mechanism
+std::pair<double, double> CharacterizationController::measure(Mechanism mechanism) {
+  switch (mechanism) {
+    case Mechanism::DRIVE: {
+      auto state = m_chassis->get_state();
+      return {
+        (state.m_pose.m_encoder_dist_left + state.m_pose.m_encoder_dist_right).convert(meter) * .5,
+        (state.m_deriv.m_encoder_dist_left + state.m_deriv.m_encoder_dist_right).convert(mps) * .5
+      };
+    }
+    case Mechanism::TILTER:
+      return {m_tilter->get_angle().convert(degree), m_tilter->get_velocity().convert(degree / second)};
+    case Mechanism::LIFT:
+      return {std::get<2>(m_lift->get_angle()).convert(degree), std::get<2>(m_lift->get_velocity()).convert(degree / second)};
+    case Mechanism::INTAKE:
+      return {std::get<2>(m_intake->get_angle()).convert(degree), std::get<2>(m_intake->get_velocity()).convert(degree / second)};
+  }
+  return {0, 0};
+}
+
+// apply a voltage
+void CharacterizationController::apply(Mechanism mechanism, int voltage) {
+  switch (mechanism) {
+    case Mechanism::DRIVE:
+      m_chassis->move_voltage(voltage);
+      break;
+
+    // negative voltage extends the tray
+    case Mechanism::TILTER:
+      m_tilter->move_voltage(-voltage);
+      break;
+    case Mechanism::LIFT:
+      m_lift->move_voltage(voltage);
+      break;
+    case Mechanism::INTAKE:
+      m_intake->move_voltage(voltage);
+      break;
+  }
+}
+
+// stop a mechanism
+void CharacterizationController::stop(Mechanism mechanism) {
+  switch (mechanism) {
+    case Mechanism::DRIVE:
+      m_chassis->move_voltage(0);
+      break;
+    case Mechanism::TILTER:
+      m_tilter->hold(1000, Transmission::HoldPriority::TILTER);
+      break;
+    case Mechanism::LIFT:
+      m_lift->lock();
+      break;
+    case Mechanism::INTAKE:
+      m_intake->lock();
+      break;
+  }
+}
+
+// write a log
+bool CharacterizationController::write_log(const char* path, size_t count) {
+  FILE* file = std::fopen(path, "w");
+  if (!file) return false;
+  std::fputs("time,voltage,position,velocity\n", file);
+  for (size_t i = 0; i < count; ++i) {
+    const Sample& sample = m_samples[i];
+    std::fprintf(file, "%u,%d,%.4f,%.4f\n", unsigned(sample.m_time), int(sample.m_voltage), sample.m_position, sample.m_velocity);
+  }
+  return std::fclose(file) == 0;
+}
@@ -1,5 +1,6 @@
 #include "subsystems/subsystems.hpp"
 #include "controllers/controllers.hpp"
+#include "feedforward_gains.hpp"
 
 namespace subsystem_controllers {
 
@@ -10,15 +11,28 @@ namespace subsystem_controllers {
    */
   std::shared_ptr<TilterController> tilter_controller;
   std::shared_ptr<PullOutController> pull_out_controller;
-  // std::shared_ptr<LiftController> lift_controller;
+  std::shared_ptr<LiftController> lift_controller;
+  std::shared_ptr<TrajectoryController> trajectory_controller;
+  std::shared_ptr<CharacterizationController> characterization_controller;
 
   /**
    * Initialize all subsystems.
    * Should be run before any references to them.
    */
   void init() {
-    tilter_controller = std::make_shared<TilterController>(subsystems::tilter, subsystems::transmission, subsystems::lift, .015, 0, .005);
+    tilter_controller = std::make_shared<TilterController>(subsystems::tilter, subsystems::transmission, subsystems::lift);
     pull_out_controller = std::make_shared<PullOutController>(subsystems::tilter, subsystems::chassis, subsystems::transmission, subsystems::intake);
-    // lift_controller = std::make_shared<LiftController>(subsystems::lift, subsystems::intake, .01, 0, 0);
+    lift_controller = std::make_shared<LiftController>(subsystems::lift, subsystems::intake);
+    trajectory_controller = std::make_shared<TrajectoryController>(subsystems::chassis, subsystems::transmission, 14_in, TrajectoryController::Gains{
+      feedforward_gains::DRIVE.m_ks, feedforward_gains::DRIVE.m_kv, feedforward_gains::DRIVE.m_ka, 2, .7, 4
+    });
+    characterization_controller = std::make_shared<CharacterizationController>(
+      subsystems::chassis, subsystems::transmission, subsystems::tilter, subsystems::lift, subsystems::intake
+    );
+
+    // deposit gently enough for the stack being carried
+    subsystems::intake->on_cube_event([](CubeEvent, size_t count) {
+      tilter_controller->set_stack_size(count);
+    });
   }
 }
\ No newline at end of file
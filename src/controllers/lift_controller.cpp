@@ -1,37 +1,132 @@
 #include "controllers/lift_controller.hpp"
+#include "subsystems/subsystems.hpp"
 
 // constructor
-LiftController::LiftController(std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake, double kp, double ki, double kd):
-  m_lift(lift), m_intake(intake), m_controller(std::make_unique<IterativePosPIDController>(IterativeControllerFactory::posPID(kp, ki, kd)))
+LiftController::LiftController(std::shared_ptr<Lift> lift, std::shared_ptr<Intake> intake):
+  m_target({0_deg, false, 0}),
+  m_command("lift preset", subsystems::RESOURCE_LIFT, subsystems::PRIORITY_PRESET, true,
+    [=]() {
+      m_generation = m_settled_generation;
+      m_task->notify();
+    },
+    [=](bool) { m_lift->lock(); }
+  ),
+  m_generation(0),
+  m_settled_generation(0),
+  m_lift(lift),
+  m_intake(intake),
+  m_telemetry(subsystems::telemetry->add_buffer())
 {
 
-  m_controller->setTarget(m_actual_target.convert(degree));
+  // task
+  m_task = std::make_unique<pros::Task>([=]() {
 
-  while (m_lift->m_control_mutex.take(TIMEOUT_MAX)) {
+    pros::task_t task = pros::c::task_get_current();
     while (true) {
 
-      std::cout << std::get<2>(lift->get_angle()).convert(degree) << "\t" << m_controller->getOutput() << std::endl;
-      lift->update_angles();
-      lift->move_voltage(m_controller->step(std::get<2>(lift->get_angle()).convert(degree)) * 12000);
-      pros::delay(10);
+      // park until the command starts
+      m_cpu.end();
+      pros::c::task_notify_take(true, TIMEOUT_MAX);
+      m_cpu.begin();
+      if (!m_command.is_active()) continue;
 
+      // tick now, then on every fresh pose from the updater, until the command ends
+      subsystems::subscribe_poses(task);
+      while (subsystems::arbiter->run(m_command, [=]() { return update(); })) {
+        m_cpu.end();
+        pros::c::task_notify_take(true, POSE_TIMEOUT);
+        m_cpu.begin();
+      }
+      subsystems::unsubscribe_poses(task);
     }
-    m_lift->m_control_mutex.give();
+  });
+}
+
+// run one tick of the move
+bool LiftController::update() {
+
+  // start a new move when the target changes
+  Target target = m_target.read();
+  QAngle angle = target.m_lowered ? std::max(0_deg, target.m_angle - LOWER_BY) : target.m_angle;
+  if (target.m_generation != m_generation) {
+    m_lift->move_to(angle);
+    m_generation = target.m_generation;
+  }
+
+  m_lift->update();
+  if (m_telemetry) m_telemetry->push(subsystems::TELEMETRY_LIFT, {float(std::get<2>(m_lift->get_angle()).convert(degree)), float(angle.convert(degree))});
+
+  // release the lift once it rests at the bottom
+  if (m_lift->is_settled()) {
+    m_settled_generation = m_generation;
+    if (angle <= Lift::get_preset(Lift::Preset::DOWN)) return false;
   }
+  return true;
 }
 
-void LiftController::set_target(QAngle target) {
-  m_actual_target = target;
-  if (lowered) lower();
-  else raise();
+// request a target
+LiftController::Move LiftController::request(QAngle angle, bool lowered) {
+  Target target = m_target.read();
+  target.m_angle = angle;
+  target.m_lowered = lowered;
+  ++target.m_generation;
+  m_target.write(target);
+  subsystems::arbiter->schedule(m_command);
+  return Move(this, target.m_generation);
 }
 
-void LiftController::lower() {
-  m_controller->setTarget((m_actual_target - LOWER_BY).convert(degree));
-  lowered = true;
+// set target
+LiftController::Move LiftController::set_target(QAngle target) {
+  return request(target, m_target.read().m_lowered);
+}
+LiftController::Move LiftController::move_to(Lift::Preset preset) {
+  return set_target(Lift::get_preset(preset));
 }
 
+// offset for intaking; only moves the lift if the controller is holding it
+void LiftController::lower() {
+  set_lowered(true);
+}
 void LiftController::raise() {
-  m_controller->setTarget((m_actual_target).convert(degree));
-  lowered = false;
-}
\ No newline at end of file
+  set_lowered(false);
+}
+void LiftController::set_lowered(bool lowered) {
+  Target target = m_target.read();
+  if (target.m_lowered == lowered) return;
+  if (m_command.is_active()) {
+    request(target.m_angle, lowered);
+  } else {
+    target.m_lowered = lowered;
+    m_target.write(target);
+  }
+}
+
+// disable controller
+void LiftController::disable() {
+  subsystems::arbiter->cancel(m_command);
+}
+
+// get CPU time
+CpuMeter::Stats LiftController::get_cpu_stats() const {
+  return m_cpu.get_stats();
+}
+
+// move handle
+LiftController::Move::Move(const LiftController* controller, uint32_t generation):
+  m_controller(controller), m_generation(generation)
+{}
+
+// check move
+bool LiftController::Move::is_settled() const {
+  return int32_t(m_controller->m_settled_generation - m_generation) >= 0;
+}
+
+// wait for move
+bool LiftController::Move::wait(uint32_t timeout) const {
+  uint32_t start = pros::millis();
+  while (!is_settled()) {
+    if (pros::millis() - start >= timeout) return false;
+    pros::delay(10);
+  }
+  return true;
+}
@@ -3,47 +3,64 @@
 
 // constructor
 PullOutController::PullOutController(std::shared_ptr<Tilter> tilter, std::shared_ptr<Chassis> chassis, std::shared_ptr<Transmission> transmission, std::shared_ptr<Intake> intake):
+  m_command("pull out", subsystems::RESOURCE_TRANSMISSION | subsystems::RESOURCE_INTAKE, subsystems::PRIORITY_MACRO, true,
+    [=]() {
+      m_tilter->hold(1000, Transmission::HoldPriority::TILTER);
+      m_intake->move_voltage(-3000);
+      m_chassis->move_voltage(-6000, -6000);
+      m_task->notify();
+    },
+    [=](bool) {
+      m_tilter->hold(0);
+      m_chassis->move_voltage(0);
+      m_intake->lock();
+      m_intake->set_cube_count(0);
+    }
+  ),
   m_tilter(tilter),
   m_chassis(chassis),
   m_transmission(transmission),
-  m_intake(intake),
-  m_enabled(false)
+  m_intake(intake)
 {
 
   // task
   m_task = std::make_unique<pros::Task>([=]() {
 
+    pros::task_t task = pros::c::task_get_current();
     while (true) {
-      if (m_enabled && m_transmission->m_control_mutex.take(0)) {
-        if (m_intake->m_control_mutex.take(0)) {
-          m_tilter->hold(1000);
-          m_intake->move_voltage(-3000);
-          m_chassis->move_voltage(-6000, -6000);
-          while (m_enabled) {
-
-            tilter->update_angle();
-            chassis->update_pose();
-            m_transmission->update();
-            pros::delay(10);
-          }
-          m_tilter->hold(0);
-          m_chassis->move_voltage(0);
-          m_intake->lock();
-          m_intake->m_control_mutex.give();
-        }
-        m_transmission->m_control_mutex.give();
+
+      // park until the command starts
+      m_cpu.end();
+      pros::c::task_notify_take(true, TIMEOUT_MAX);
+      m_cpu.begin();
+      if (!m_command.is_active()) continue;
+
+      // tick now, then on every fresh pose from the updater, until the command ends
+      subsystems::subscribe_poses(task);
+      while (subsystems::arbiter->run(m_command, [=]() {
+        m_transmission->update();
+        return true;
+      })) {
+        m_cpu.end();
+        pros::c::task_notify_take(true, POSE_TIMEOUT);
+        m_cpu.begin();
       }
-      pros::delay(10);
+      subsystems::unsubscribe_poses(task);
     }
   });
 }
 
 // enable controller
-void PullOutController::enable() {
-  m_enabled = true;
+bool PullOutController::enable() {
+  return subsystems::arbiter->schedule(m_command);
 }
 
-// enable controller
+// disable controller
 void PullOutController::disable() {
-  m_enabled = false;
+  subsystems::arbiter->cancel(m_command);
+}
+
+// get CPU time
+CpuMeter::Stats PullOutController::get_cpu_stats() const {
+  return m_cpu.get_stats();
 }
@@ -1,59 +1,117 @@
 #include "controllers/tilter_controller.hpp"
 #include "subsystems/subsystems.hpp"
+#include "lib/control_laws.hpp"
+#include <cmath>
+#include <limits>
 
 // constructor
-TilterController::TilterController(std::shared_ptr<Tilter> tilter, std::shared_ptr<Transmission> transmission, std::shared_ptr<Lift> lift, double kp, double ki, double kd):
+TilterController::TilterController(std::shared_ptr<Tilter> tilter, std::shared_ptr<Transmission> transmission, std::shared_ptr<Lift> lift):
+  m_command("deposit", subsystems::RESOURCE_TRANSMISSION | subsystems::RESOURCE_LIFT, subsystems::PRIORITY_MACRO, true,
+    [=]() {
+      size_t cubes = m_stack_size;
+      m_mass_ratio = 1 + cubes * CUBE_MASS_RATIO;
+      m_profile = plan(m_tilter->get_angle(), cubes);
+      m_start = pros::millis();
+      m_task->notify();
+    },
+    [=](bool) { m_tilter->hold(1000, Transmission::HoldPriority::TILTER); }
+  ),
+  m_profile(plan(0_deg, 0)),
+  m_mass_ratio(1),
+  m_start(0),
   m_tilter(tilter),
   m_transmission(transmission),
   m_lift(lift),
-  m_controller(std::make_unique<IterativePosPIDController>(IterativeControllerFactory::posPID(kp, ki, kd))),
-  m_enabled(false)
+  m_stack_size(0),
+  m_telemetry(subsystems::telemetry->add_buffer())
 {
 
-  // target
-  m_controller->setTarget(Tilter::MAX_EXTENDED.convert(degree));
-
   // task
   m_task = std::make_unique<pros::Task>([=]() {
 
+    pros::task_t task = pros::c::task_get_current();
     while (true) {
-      if (m_enabled && m_transmission->m_control_mutex.take(0)) {
-        if (m_lift->m_control_mutex.take(0)) {
-          std::cout << "hi" << std::endl;
-          while (m_enabled) {
-
-            m_tilter->update_angle();
-            m_lift->update_angles();
-
-            std::cout << tilter->get_angle().convert(degree) << "\t" << m_controller->getOutput() << std::endl;
-            if (tilter->get_angle() >= Transmission::TILTER_EXTEND_THRESHOLD) {
-              m_enabled = false;
-              break;
-            }
-
-            lift->move_voltage(-4500);
-            tilter->move_voltage(m_controller->step(tilter->get_angle().convert(degree)) * -12000);
-            m_transmission->update();
-            pros::delay(10);
-          }
-          std::cout << "bye" << std::endl;
-          m_tilter->hold(1000);
-
-          m_lift->m_control_mutex.give();
-        }
-        m_transmission->m_control_mutex.give();
+
+      // park until the command starts
+      m_cpu.end();
+      pros::c::task_notify_take(true, TIMEOUT_MAX);
+      m_cpu.begin();
+      if (!m_command.is_active()) continue;
+
+      // tick now, then on every fresh pose from the updater, until the command ends
+      subsystems::subscribe_poses(task);
+      while (subsystems::arbiter->run(m_command, [=]() { return update(); })) {
+        m_cpu.end();
+        pros::c::task_notify_take(true, POSE_TIMEOUT);
+        m_cpu.begin();
       }
-      pros::delay(10);
+      subsystems::unsubscribe_poses(task);
     }
   });
 }
 
-// enable controller
-void TilterController::enable() {
-  m_enabled = true;
+// run one tick of the deposit
+bool TilterController::update() {
+  QTime time = (pros::millis() - m_start) * millisecond;
+  QAngle angle = m_tilter->get_angle();
+  if (time >= m_profile.duration() && (angle >= Transmission::TILTER_EXTEND_THRESHOLD || time >= m_profile.duration() + DEPOSIT_TIMEOUT)) {
+    return false;
+  }
+
+  // feedforward plus feedback; negative voltage extends the tray
+  ProfilePoint setpoint = m_profile.sample(time);
+  double voltage = control_laws::follow(
+    FEEDFORWARD, KP, KD, m_mass_ratio,
+    setpoint.m_position.convert(degree),
+    setpoint.m_velocity.convert(degree / second),
+    setpoint.m_acceleration.convert(degree / second / second),
+    angle.convert(degree),
+    m_tilter->get_velocity().convert(degree / second)
+  );
+  if (m_telemetry) m_telemetry->push(subsystems::TELEMETRY_TILTER, {float(angle.convert(degree)), float(setpoint.m_position.convert(degree)), float(voltage)});
+
+  m_lift->move_voltage(-4500);
+  m_tilter->move_voltage(std::max(-12000.0, std::min(12000.0, -voltage)));
+  m_transmission->update();
+  return true;
+}
+
+// get the speed at which a stack tips
+QAngularSpeed TilterController::get_tip_velocity(size_t cubes) {
+  if (cubes == 0) return std::numeric_limits<double>::infinity() * radian / second;
+  double width = CUBE_SIZE.convert(inch);
+  double height = cubes * width;
+  double diagonal = std::hypot(height, width);
+  double gravity = 9.80665 / .0254; // in/s^2
+  return std::sqrt(6 * gravity * (diagonal - height) / 2 / (diagonal * diagonal)) * radian / second;
+}
+
+// plan a deposit
+SCurveProfile TilterController::plan(QAngle start, size_t cubes) {
+  QAngularSpeed slow = std::sqrt(TIP_MARGIN) * get_tip_velocity(cubes);
+  return SCurveProfile(
+    start, Tilter::MAX_EXTENDED,
+    DEPOSIT_VELOCITY, DEPOSIT_ACCELERATION, DEPOSIT_JERK,
+    DEPOSIT_SLOW_FROM, std::min(DEPOSIT_VELOCITY.convert(degree / second), slow.convert(degree / second)) * degree / second
+  );
 }
 
 // enable controller
+bool TilterController::enable() {
+  return subsystems::arbiter->schedule(m_command);
+}
+
+// disable controller
 void TilterController::disable() {
-  m_enabled = false;
+  subsystems::arbiter->cancel(m_command);
+}
+
+// get CPU time
+CpuMeter::Stats TilterController::get_cpu_stats() const {
+  return m_cpu.get_stats();
+}
+
+// set stack size
+void TilterController::set_stack_size(size_t cubes) {
+  m_stack_size = cubes;
 }
@@ -0,0 +1,92 @@
+#include "controllers/trajectory_controller.hpp"
+#include "subsystems/subsystems.hpp"
+#include "lib/control_laws.hpp"
+
+// constructor
+TrajectoryController::TrajectoryController(std::shared_ptr<Chassis> chassis, std::shared_ptr<Transmission> transmission, QLength track_width, Gains gains):
+  m_command("trajectory", subsystems::RESOURCE_TRANSMISSION, subsystems::PRIORITY_MACRO, true,
+    nullptr,
+    [=](bool) { m_chassis->move_voltage(0); }
+  ),
+  m_chassis(chassis),
+  m_transmission(transmission),
+  m_track_width(track_width),
+  m_gains(gains),
+  m_stats{0, 0}
+{}
+
+// follow a trajectory
+bool TrajectoryController::follow(const Trajectory& trajectory, QTime settle_timeout) {
+  if (!subsystems::arbiter->schedule(m_command)) return false;
+  ++m_stats.m_follows;
+
+  // wait for pose updates instead of polling
+  pros::task_t task = pros::c::task_get_current();
+  pros::c::task_notify_clear(task);
+  subsystems::subscribe_poses(task);
+
+  uint32_t start = pros::millis();
+  QTime end = trajectory.duration();
+  double half_track = m_track_width.convert(meter) * .5;
+  bool settled = false;
+
+  do {
+
+    // wait for a fresh pose
+    pros::c::task_notify_take(true, 20);
+  } while (subsystems::arbiter->run(m_command, [&]() {
+    QTime time = (pros::millis() - start) * millisecond;
+    if (time > end + settle_timeout) return false;
+
+    // setpoint and pose, converted to a counterclockwise frame with y to the left
+    TrajectoryPoint setpoint = trajectory.sample(time);
+    auto state = m_chassis->get_state();
+    auto& pose = state.m_pose;
+    double x = pose.m_x.convert(meter), y = -pose.m_y.convert(meter), theta = -pose.m_heading.convert(radian);
+    double x_d = setpoint.m_x.convert(meter), y_d = -setpoint.m_y.convert(meter), theta_d = -setpoint.m_heading.convert(radian);
+    double v_d = setpoint.m_velocity.convert(mps), omega_d = -setpoint.m_angular_velocity.convert(radps);
+
+    // settled once the trajectory is over and the chassis is at rest at its end
+    if (time >= end &&
+      std::hypot(x_d - x, y_d - y) < SETTLE_DISTANCE.convert(meter) &&
+      std::abs(std::remainder(theta_d - theta, 2 * 1_pi)) < SETTLE_ANGLE.convert(radian) &&
+      std::abs(state.m_deriv.m_encoder_dist_left.convert(mps) + state.m_deriv.m_encoder_dist_right.convert(mps)) * .5 < SETTLE_SPEED.convert(mps)
+    ) {
+      settled = true;
+      return false;
+    }
+
+    // RAMSETE wheel speeds, with acceleration taken from the setpoint
+    control_laws::WheelSpeeds wheels = control_laws::ramsete(
+      m_gains.m_b, m_gains.m_zeta, m_gains.m_min_gain, half_track, x, y, theta, x_d, y_d, theta_d, v_d, omega_d
+    );
+    double accel = setpoint.m_acceleration.convert(mps2);
+    m_chassis->move_voltage(feedforward(wheels.m_left, accel), feedforward(wheels.m_right, accel));
+    m_transmission->update();
+    return true;
+  }));
+
+  subsystems::unsubscribe_poses(task);
+  if (settled) ++m_stats.m_settled;
+  return settled;
+}
+
+// drive straight
+bool TrajectoryController::drive(QLength distance) {
+  auto pose = m_chassis->get_pose();
+  return follow(Trajectory::straight(
+    {pose.m_x, pose.m_y, pose.m_heading, 0_mps, 0_mps2, 0_rpm}, distance, MAX_VELOCITY, MAX_ACCELERATION
+  ));
+}
+
+// get counts
+TrajectoryController::FollowStats TrajectoryController::get_follow_stats() const {
+  return m_stats;
+}
+
+// feedforward
+double TrajectoryController::feedforward(double velocity, double acceleration) const {
+  double voltage = m_gains.m_kv * velocity + m_gains.m_ka * acceleration;
+  if (std::abs(velocity) > 1e-3) voltage += std::copysign(m_gains.m_ks, velocity);
+  return std::max(-12000.0, std::min(12000.0, voltage));
+}
@@ -0,0 +1,80 @@
+#include "lib/cached_motor.hpp"
+
+// constructor
+CachedMotor::CachedMotor(
+  std::uint8_t port, bool reverse, AbstractMotor::gearset gearset, AbstractMotor::encoderUnits encoder_units,
+  QTime keep_alive
+):
+  Motor(port, reverse, gearset, encoder_units),
+  m_keep_alive(keep_alive.convert(millisecond)),
+  m_command(Command::NONE),
+  m_command_value(0),
+  m_command_time(0),
+  m_commanded_voltage(0),
+  m_brake_mode_valid(false),
+  m_brake_mode(AbstractMotor::brakeMode::coast),
+  m_brake_mode_time(0),
+  m_stats{0, 0}
+{}
+
+// move voltage
+std::int32_t CachedMotor::moveVoltage(std::int16_t ivoltage) {
+  uint32_t now = pros::millis();
+  m_commanded_voltage = ivoltage;
+  if (!should_send(m_command != Command::VOLTAGE || m_command_value != ivoltage, m_command_time, now)) return 1;
+  std::int32_t result = Motor::moveVoltage(ivoltage);
+  remember_command(result, Command::VOLTAGE, ivoltage, now);
+  return result;
+}
+
+// move velocity
+std::int32_t CachedMotor::moveVelocity(std::int16_t ivelocity) {
+  uint32_t now = pros::millis();
+  m_commanded_voltage = 0;
+  if (!should_send(m_command != Command::VELOCITY || m_command_value != ivelocity, m_command_time, now)) return 1;
+  std::int32_t result = Motor::moveVelocity(ivelocity);
+  remember_command(result, Command::VELOCITY, ivelocity, now);
+  return result;
+}
+
+// set brake mode
+std::int32_t CachedMotor::setBrakeMode(AbstractMotor::brakeMode imode) {
+  uint32_t now = pros::millis();
+  if (!should_send(!m_brake_mode_valid || m_brake_mode != imode, m_brake_mode_time, now)) return 1;
+  std::int32_t result = Motor::setBrakeMode(imode);
+
+  // a failed write leaves the motor's mode unknown, so the next one is always sent
+  m_brake_mode_valid = result != PROS_ERR;
+  m_brake_mode = imode;
+  m_brake_mode_time = now;
+  return result;
+}
+
+// get counts
+CachedMotor::WriteStats CachedMotor::get_write_stats() const {
+  return m_stats;
+}
+
+// get the last voltage asked for
+std::int16_t CachedMotor::get_commanded_voltage() const {
+  return m_commanded_voltage;
+}
+
+// decide whether to send
+bool CachedMotor::should_send(bool changed, uint32_t last_time, uint32_t now) {
+  if (changed || now - last_time >= m_keep_alive) {
+    ++m_stats.m_issued;
+    return true;
+  }
+  ++m_stats.m_suppressed;
+  return false;
+}
+
+// remember a movement command once written
+void CachedMotor::remember_command(std::int32_t result, Command command, std::int16_t value, uint32_t now) {
+
+  // a failed write leaves the motor's command unknown, so the next one is always sent
+  m_command = result == PROS_ERR ? Command::NONE : command;
+  m_command_value = value;
+  m_command_time = now;
+}
@@ -0,0 +1,29 @@
+#include "lib/cpu_meter.hpp"
+
+// microsecond clock of the V5 SDK; PROS 3.2 has no wrapper for it
+extern "C" uint64_t vexSystemHighResTimeGet(void);
+
+// constructor
+CpuMeter::CpuMeter(): m_start(now()), m_totals{0, 0}, m_stats(m_totals) {}
+
+// task woke
+void CpuMeter::begin() {
+  m_start = now();
+  ++m_totals.m_wakeups;
+}
+
+// task is about to block
+void CpuMeter::end() {
+  m_totals.m_busy += now() - m_start;
+  m_stats.write(m_totals);
+}
+
+// get totals
+CpuMeter::Stats CpuMeter::get_stats() const {
+  return m_stats.read();
+}
+
+// clock
+uint64_t CpuMeter::now() {
+  return vexSystemHighResTimeGet();
+}
@@ -0,0 +1,77 @@
+#include "lib/cube_detector.hpp"
+
+// constructor
+CubeDetector::CubeDetector():
+  m_direction(0),
+  m_direction_time(0),
+  m_baseline_velocity(0),
+  m_baseline_current(0),
+  m_baseline_valid(false),
+  m_in_dip(false),
+  m_dip_start(0),
+  m_dip_counted(false),
+  m_count(0)
+{}
+
+// add a sample
+CubeEvent CubeDetector::step(uint32_t time, int voltage, double velocity, double current) {
+
+  // restart whenever the rollers start, stop or change direction
+  int direction = voltage > ACTIVE_VOLTAGE ? 1 : voltage < -ACTIVE_VOLTAGE ? -1 : 0;
+  if (direction != m_direction) {
+    m_direction = direction;
+    m_direction_time = time;
+    m_baseline_valid = false;
+    m_in_dip = false;
+  }
+  if (direction == 0 || time - m_direction_time < SPIN_UP_TIME) return CubeEvent::NONE;
+
+  // speed in the direction of travel
+  double speed = velocity * direction;
+  if (!m_baseline_valid) {
+    m_baseline_velocity = speed;
+    m_baseline_current = current;
+    m_baseline_valid = true;
+    return CubeEvent::NONE;
+  }
+
+  // a dip needs the rollers slowed and loaded at once; it ends once they have nearly recovered
+  bool loaded = speed < m_baseline_velocity * VELOCITY_DIP && current > m_baseline_current + CURRENT_RISE;
+  bool recovered = speed > m_baseline_velocity * (1 + VELOCITY_DIP) * .5 && current < m_baseline_current + CURRENT_RISE * .5;
+  if (!m_in_dip && loaded) {
+    m_in_dip = true;
+    m_dip_start = time;
+    m_dip_counted = false;
+  } else if (m_in_dip && recovered) {
+    m_in_dip = false;
+  }
+
+  // the baseline only follows the rollers when they run free
+  if (!m_in_dip) {
+    m_baseline_velocity += (speed - m_baseline_velocity) * BASELINE_RATE;
+    m_baseline_current += (current - m_baseline_current) * BASELINE_RATE;
+    return CubeEvent::NONE;
+  }
+
+  // count each dip once, when it has lasted long enough
+  if (!m_dip_counted && time - m_dip_start >= MIN_DURATION) {
+    m_dip_counted = true;
+    if (direction > 0) {
+      ++m_count;
+      return CubeEvent::IN;
+    }
+    if (m_count > 0) --m_count;
+    return CubeEvent::OUT;
+  }
+  return CubeEvent::NONE;
+}
+
+// get count
+size_t CubeDetector::get_count() const {
+  return m_count;
+}
+
+// set count
+void CubeDetector::set_count(size_t count) {
+  m_count = count;
+}
@@ -0,0 +1,100 @@
+#include "lib/derivative_estimator.hpp"
+#include <algorithm>
+
+// constructor
+DerivativeEstimator::DerivativeEstimator(size_t window, uint32_t max_age):
+  m_window(std::max<size_t>(3, std::min(window, MAX_WINDOW))),
+  m_max_age(max_age),
+  m_count(0),
+  m_next(0),
+  m_velocity(0),
+  m_acceleration(0)
+{}
+
+// add a sample
+void DerivativeEstimator::step(double position, uint32_t time) {
+
+  // a repeated timestamp replaces the last sample
+  size_t last = (m_next + m_window - 1) % m_window;
+  if (m_count > 0 && m_times[last] == time) {
+    m_positions[last] = position;
+  } else {
+    m_positions[m_next] = position;
+    m_times[m_next] = time;
+    m_next = (m_next + 1) % m_window;
+    m_count = std::min(m_count + 1, m_window);
+  }
+  fit();
+}
+
+// forget samples
+void DerivativeEstimator::reset() {
+  m_count = 0;
+  m_next = 0;
+  m_velocity = 0;
+  m_acceleration = 0;
+}
+
+// get estimates
+double DerivativeEstimator::get_velocity() const {
+  return m_velocity;
+}
+double DerivativeEstimator::get_acceleration() const {
+  return m_acceleration;
+}
+
+// least-squares fit
+void DerivativeEstimator::fit() {
+
+  // sums over recent samples, with time in ms relative to the newest sample and position relative to its position
+  size_t newest = (m_next + m_window - 1) % m_window;
+  double s1 = 0, st = 0, st2 = 0, st3 = 0, st4 = 0, sx = 0, stx = 0, st2x = 0;
+  for (size_t i = 0; i < m_count; ++i) {
+    size_t index = (newest + m_window - i) % m_window;
+    uint32_t age = m_times[newest] - m_times[index];
+    if (age > m_max_age) break;
+    double t = -double(age);
+    double x = m_positions[index] - m_positions[newest];
+    double t2 = t * t;
+    s1 += 1;
+    st += t;
+    st2 += t2;
+    st3 += t2 * t;
+    st4 += t2 * t2;
+    sx += x;
+    stx += t * x;
+    st2x += t2 * x;
+  }
+
+  // too few samples for a slope
+  if (s1 < 2) {
+    m_velocity = 0;
+    m_acceleration = 0;
+    return;
+  }
+
+  // too few samples for a curve: fit a line
+  if (s1 < 3) {
+    double det = s1 * st2 - st * st;
+    m_velocity = det > 0 ? (s1 * stx - st * sx) / det * 1000 : 0;
+    m_acceleration = 0;
+    return;
+  }
+
+  // fit x = a + b t + c t^2 by solving the normal equations with Cramer's rule
+  double det =
+    s1 * (st2 * st4 - st3 * st3) -
+    st * (st * st4 - st3 * st2) +
+    st2 * (st * st3 - st2 * st2);
+  if (det <= 0) return;
+  double b =
+    s1 * (stx * st4 - st3 * st2x) -
+    sx * (st * st4 - st3 * st2) +
+    st2 * (st * st2x - stx * st2);
+  double c =
+    s1 * (st2 * st2x - stx * st3) -
+    st * (st * st2x - stx * st2) +
+    sx * (st * st3 - st2 * st2);
+  m_velocity = b / det * 1000;
+  m_acceleration = 2 * c / det * 1000000;
+}
@@ -0,0 +1,198 @@
+#include "lib/motion_profile.hpp"
+
+// constructor
+TrapezoidProfile::TrapezoidProfile(
+  QAngle start, QAngle target, QAngularSpeed max_velocity, QAngularAcceleration max_acceleration, QAngularSpeed start_velocity
+):
+  m_start(start),
+  m_target(target),
+  m_direction(target >= start ? 1 : -1),
+  m_acceleration(max_acceleration)
+{
+  QAngle distance = (target - start) * m_direction;
+
+  // clamp the initial velocity to one that can still stop at the target
+  QAngularSpeed stoppable = std::sqrt(2 * (max_acceleration * distance).convert(radps * radps)) * radps;
+  m_start_velocity = std::max(0_rpm, std::min(std::min(start_velocity * m_direction, max_velocity), stoppable));
+
+  // peak at the speed limit, or where the acceleration and deceleration phases meet
+  QAngularSpeed meet = std::sqrt((max_acceleration * distance + m_start_velocity * m_start_velocity * .5).convert(radps * radps)) * radps;
+  m_peak_velocity = std::min(max_velocity, meet);
+
+  m_accel_time = (m_peak_velocity - m_start_velocity) / max_acceleration;
+  m_decel_time = m_peak_velocity / max_acceleration;
+  QAngle cruise_distance = distance
+    - (m_peak_velocity * m_peak_velocity - m_start_velocity * m_start_velocity) / (2 * max_acceleration)
+    - m_peak_velocity * m_peak_velocity / (2 * max_acceleration);
+  m_cruise_time = m_peak_velocity > 0_rpm ? std::max(0_s, cruise_distance / m_peak_velocity) : 0_s;
+}
+
+// sample
+ProfilePoint TrapezoidProfile::sample(QTime time) const {
+  QAngle position;
+  QAngularSpeed velocity;
+  QAngularAcceleration acceleration;
+
+  if (time <= 0_s) {
+    return {m_start, m_start_velocity * m_direction, m_acceleration * m_direction};
+  } else if (time < m_accel_time) {
+    acceleration = m_acceleration;
+    velocity = m_start_velocity + m_acceleration * time;
+    position = (m_start_velocity + velocity) * .5 * time;
+  } else if (time < m_accel_time + m_cruise_time) {
+    QTime cruising = time - m_accel_time;
+    acceleration = 0 * radps / second;
+    velocity = m_peak_velocity;
+    position = (m_start_velocity + m_peak_velocity) * .5 * m_accel_time + m_peak_velocity * cruising;
+  } else if (time < duration()) {
+    QTime remaining = duration() - time;
+    acceleration = m_acceleration * -1;
+    velocity = m_acceleration * remaining;
+    return {m_target - velocity * .5 * remaining * m_direction, velocity * m_direction, acceleration * m_direction};
+  } else {
+    return {m_target, 0_rpm, 0 * radps / second};
+  }
+  return {m_start + position * m_direction, velocity * m_direction, acceleration * m_direction};
+}
+
+// get duration
+QTime TrapezoidProfile::duration() const {
+  return m_accel_time + m_cruise_time + m_decel_time;
+}
+
+// get target
+QAngle TrapezoidProfile::get_target() const {
+  return m_target;
+}
+
+// constructor
+SCurveProfile::SCurveProfile(
+  QAngle start, QAngle target, QAngularSpeed max_velocity, QAngularAcceleration max_acceleration, QAngularJerk max_jerk,
+  QAngle slow_from, QAngularSpeed slow_velocity
+):
+  m_start(start),
+  m_target(target),
+  m_direction(target >= start ? 1 : -1),
+  m_acceleration(max_acceleration.convert(degree / second / second)),
+  m_jerk(max_jerk.convert(degree / second / second / second))
+{
+  double distance = ((target - start) * m_direction).convert(degree);
+  double fast_distance = std::max(0.0, std::min(distance, ((slow_from - start) * m_direction).convert(degree)));
+  double fast = max_velocity.convert(degree / second);
+  double slow = std::min(fast, slow_velocity.convert(degree / second));
+
+  // lower the cruising velocities until the ramps fit, by bisection as ramp distances grow with velocity
+  auto fit = [](double low, double high, auto fits) {
+    if (fits(high)) return high;
+    for (int i = 0; i < 40; ++i) {
+      double middle = (low + high) * .5;
+      if (fits(middle)) low = middle;
+      else high = middle;
+    }
+    return low;
+  };
+  slow = fit(0, slow, [&](double v) {
+    return ramp_distance(0, v) + ramp_distance(v, 0) <= distance;
+  });
+  double peak = fit(slow, fast, [&](double v) {
+    double slowing = ramp_distance(0, v) + ramp_distance(v, slow);
+    return slowing <= std::max(fast_distance, ramp_distance(0, slow)) && slowing + ramp_distance(slow, 0) <= distance;
+  });
+
+  // cruise fast until the slowing ramp ends at slow_from, then slowly for the rest
+  double ramps = ramp_distance(0, peak) + ramp_distance(peak, slow) + ramp_distance(slow, 0);
+  double fast_cruise = std::max(0.0, fast_distance - ramp_distance(0, peak) - ramp_distance(peak, slow));
+  fast_cruise = std::min(fast_cruise, distance - ramps);
+  double slow_cruise = std::max(0.0, distance - ramps - fast_cruise);
+
+  double velocities[NUM_PHASES + 1] = {0, peak, peak, slow, slow, 0};
+  double cruises[NUM_PHASES] = {0, fast_cruise, 0, slow_cruise, 0};
+  double travelled = 0;
+  for (size_t i = 0; i < NUM_PHASES; ++i) {
+    double from = velocities[i];
+    double to = velocities[i + 1];
+    double time = from == to ? (from > 0 ? cruises[i] / from : 0) : ramp_time(from, to);
+    m_phases[i] = {time, travelled, from, to};
+    travelled += from == to ? cruises[i] : ramp_distance(from, to);
+  }
+}
+
+// ramp duration
+double SCurveProfile::ramp_time(double from, double to) const {
+  double change = std::abs(to - from);
+  if (change >= m_acceleration * m_acceleration / m_jerk) return change / m_acceleration + m_acceleration / m_jerk;
+  return 2 * std::sqrt(change / m_jerk);
+}
+
+// ramp distance; the acceleration is symmetric, so the mean velocity is the mean of the endpoints
+double SCurveProfile::ramp_distance(double from, double to) const {
+  return (from + to) * .5 * ramp_time(from, to);
+}
+
+// sample a phase
+void SCurveProfile::sample_phase(const Phase& phase, double time, double& distance, double& velocity, double& acceleration) const {
+  double from = phase.m_start_velocity;
+  if (phase.m_end_velocity == from) {
+    distance = phase.m_start_distance + from * time;
+    velocity = from;
+    acceleration = 0;
+    return;
+  }
+
+  // constant jerk up to the peak acceleration, constant acceleration, then constant jerk back down
+  double sign = phase.m_end_velocity > from ? 1 : -1;
+  double change = std::abs(phase.m_end_velocity - from);
+  double peak = std::min(m_acceleration, std::sqrt(change * m_jerk));
+  double jerk_time = peak / m_jerk;
+  double accel_time = phase.m_duration - 2 * jerk_time;
+
+  double t1 = std::min(time, jerk_time);
+  double d = from * t1 + sign * m_jerk * t1 * t1 * t1 / 6;
+  double v = from + sign * m_jerk * t1 * t1 * .5;
+  double a = sign * m_jerk * t1;
+  if (time > jerk_time) {
+    double t2 = std::min(time - jerk_time, accel_time);
+    d += v * t2 + sign * peak * t2 * t2 * .5;
+    v += sign * peak * t2;
+    a = sign * peak;
+  }
+  if (time > jerk_time + accel_time) {
+    double t3 = time - jerk_time - accel_time;
+    d += v * t3 + sign * (peak * t3 * t3 * .5 - m_jerk * t3 * t3 * t3 / 6);
+    v += sign * (peak * t3 - m_jerk * t3 * t3 * .5);
+    a = sign * (peak - m_jerk * t3);
+  }
+  distance = phase.m_start_distance + d;
+  velocity = v;
+  acceleration = a;
+}
+
+// sample
+ProfilePoint SCurveProfile::sample(QTime time) const {
+  double t = std::max(0.0, time.convert(second));
+  for (const Phase& phase : m_phases) {
+    if (t < phase.m_duration) {
+      double distance, velocity, acceleration;
+      sample_phase(phase, t, distance, velocity, acceleration);
+      return {
+        m_start + distance * m_direction * degree,
+        velocity * m_direction * degree / second,
+        acceleration * m_direction * degree / second / second
+      };
+    }
+    t -= phase.m_duration;
+  }
+  return {m_target, 0_rpm, 0 * radps / second};
+}
+
+// get duration
+QTime SCurveProfile::duration() const {
+  double total = 0;
+  for (const Phase& phase : m_phases) total += phase.m_duration;
+  return total * second;
+}
+
+// get target
+QAngle SCurveProfile::get_target() const {
+  return m_target;
+}
@@ -2,37 +2,193 @@
 
 // constructor
 Odom::Odom(
-  std::unique_ptr<ContinuousRotarySensor> enc_left,
-  std::unique_ptr<ContinuousRotarySensor> enc_right,
-  std::unique_ptr<ContinuousRotarySensor> enc_side,
-  std::shared_ptr<ContinuousRotarySensor> enc_left_backup,
-  std::shared_ptr<ContinuousRotarySensor> enc_right_backup ,
-  std::unique_ptr<pros::Imu> imu,
-  QLength track_width, QLength secondary_track_width, QLength side_dist, QLength wheel_radius
+  QLength track_width, QLength secondary_track_width, QLength side_dist, QLength wheel_radius,
+  QLength secondary_wheel_radius
 ):
-  m_enc_left(std::move(enc_left)),
-  m_enc_right(std::move(enc_right)),
-  m_enc_side(std::move(enc_side)),
-  m_enc_left_backup(enc_left_backup),
-  m_enc_right_backup(enc_right_backup),
-  m_imu(std::move(imu)),
+  m_reference_pose(std::make_unique<ChassisPose>(0_in, 0_in, 0_deg)),
+  m_absolute_pose(std::make_unique<ChassisPose>(0_in, 0_in, 0_deg)),
+  m_pose(std::make_shared<ChassisPose>(0_in, 0_in, 0_deg)),
+  m_deriv(std::make_shared<ChassisDeriv>(0_mps, 0_mps, 0_rpm)),
+  m_tare_requests(0),
+  m_tares_applied(0),
   m_track_width(track_width),
   m_secondary_track_width(secondary_track_width),
   m_side_dist(side_dist),
-  m_wheel_radius(wheel_radius)
+  m_wheel_radius(wheel_radius),
+  m_secondary_wheel_radius(secondary_wheel_radius),
+  m_last_left(0), m_last_right(0), m_last_side(0), m_last_left_backup(0), m_last_right_backup(0),
+  m_heading_filter(),
+  m_heading_cos(1), m_heading_sin(0),
+  m_reference_cos(1), m_reference_sin(0),
+  m_last_update_time(0),
+  m_primary_seeded(false), m_backup_seeded(false), m_side_seeded(false)
 {}
 
 // update
-void Odom::update() {
-  // TODO: odom
+void Odom::update(const Readings& readings) {
+
+  // readings
+  uint32_t now = readings.m_time;
+  double left = readings.m_left;
+  double right = readings.m_right;
+  double side = readings.m_side;
+  double left_backup = readings.m_left_backup;
+  double right_backup = readings.m_right_backup;
+  bool primary_ok = left != PROS_ERR && right != PROS_ERR;
+  bool backup_ok = left_backup != PROS_ERR && right_backup != PROS_ERR;
+  bool side_ok = side != PROS_ERR;
+
+  // apply a requested tare
+  uint32_t tare_requests = m_tare_requests.load(std::memory_order_acquire);
+  if (tare_requests != m_tares_applied) {
+    apply_tare(m_pending_tare.read());
+    m_tares_applied = tare_requests;
+  }
+
+  // a source is only used once its last reading is good; one that failed is re-seeded and its delta dropped,
+  // since the other source has already counted the travel in between
+  bool use_primary = primary_ok && m_primary_seeded;
+  bool use_backup = backup_ok && m_backup_seeded;
+  bool use_side = side_ok && m_side_seeded;
+
+  // encoder deltas in inches
+  constexpr double DEG_TO_RAD = 1_pi / 180.0;
+  double d_left = 0, d_right = 0, d_side = 0, width = 0;
+  if (use_primary) {
+    double scale = DEG_TO_RAD * m_wheel_radius.convert(inch);
+    d_left = (left - m_last_left) * scale;
+    d_right = (right - m_last_right) * scale;
+    width = m_track_width.convert(inch);
+  }
+  else if (use_backup) {
+    double scale = DEG_TO_RAD * m_secondary_wheel_radius.convert(inch);
+    d_left = (left_backup - m_last_left_backup) * scale;
+    d_right = (right_backup - m_last_right_backup) * scale;
+    width = m_secondary_track_width.convert(inch);
+  }
+  if (use_side) d_side = (side - m_last_side) * DEG_TO_RAD * m_wheel_radius.convert(inch);
+
+  // store readings
+  if (primary_ok) { m_last_left = left; m_last_right = right; }
+  if (backup_ok) { m_last_left_backup = left_backup; m_last_right_backup = right_backup; }
+  if (side_ok) m_last_side = side;
+  m_primary_seeded = primary_ok;
+  m_backup_seeded = backup_ok;
+  m_side_seeded = side_ok;
+
+  // nothing to move by, such as on the first update
+  if (!use_primary && !use_backup) {
+    m_last_update_time = now;
+    return;
+  }
+
+  // change in heading (clockwise positive), fused with the IMU
+  double imu = readings.m_imu_rotation == PROS_ERR ? NAN : readings.m_imu_rotation * DEG_TO_RAD;
+  double d_theta = m_heading_filter.update(
+    (d_left - d_right) / width, std::abs(d_left) + std::abs(d_right), (now - m_last_update_time) * .001, imu
+  );
+  double half = d_theta * .5;
+  double half_sq = half * half;
+
+  // local displacement along the arc
+  // 2sin(dθ/2)/dθ ≈ 1 - dθ²/24 and cos(dθ/2), sin(dθ/2) are expanded to low order;
+  // the error is far below encoder resolution at 10ms updates
+  double chord = 1 - half_sq / 6.0;
+  double local_forward = (d_left + d_right) * .5 * chord;
+  double local_side = (d_side + d_theta * m_side_dist.convert(inch)) * chord;
+  double half_cos = 1 - half_sq * .5;
+  double half_sin = half * (1 - half_sq / 6.0);
+
+  // rotate heading to the middle of the arc, and displace along it
+  double mid_cos = m_heading_cos * half_cos - m_heading_sin * half_sin;
+  double mid_sin = m_heading_sin * half_cos + m_heading_cos * half_sin;
+  double d_x = local_forward * mid_cos - local_side * mid_sin;
+  double d_y = local_forward * mid_sin + local_side * mid_cos;
+
+  // rotate heading to the end of the arc, and renormalize to stop drift from the approximations
+  double end_cos = mid_cos * half_cos - mid_sin * half_sin;
+  double end_sin = mid_sin * half_cos + mid_cos * half_sin;
+  double norm = 1.5 - .5 * (end_cos * end_cos + end_sin * end_sin);
+  m_heading_cos = end_cos * norm;
+  m_heading_sin = end_sin * norm;
+
+  // update absolute pose
+  m_absolute_pose->m_x += d_x * inch;
+  m_absolute_pose->m_y += d_y * inch;
+  m_absolute_pose->m_heading += d_theta * radian;
+  m_absolute_pose->m_encoder_dist_left += d_left * inch;
+  m_absolute_pose->m_encoder_dist_right += d_right * inch;
+  m_absolute_pose->m_encoder_dist_side += d_side * inch;
+
+  // update derivative, in the reference frame
+  QTime dt = (now - m_last_update_time) * millisecond;
+  m_last_update_time = now;
+  if (dt > 0_ms) {
+    m_deriv->m_x = (d_x * m_reference_cos - d_y * m_reference_sin) * inch / dt;
+    m_deriv->m_y = (d_y * m_reference_cos + d_x * m_reference_sin) * inch / dt;
+    m_deriv->m_heading = d_theta * radian / dt;
+    m_deriv->m_encoder_dist_left = d_left * inch / dt;
+    m_deriv->m_encoder_dist_right = d_right * inch / dt;
+    m_deriv->m_encoder_dist_side = d_side * inch / dt;
+  }
+
+  // update visible pose
+  update_pose_from_reference();
 }
 
 // get pose
-Odom::ChassisPose* Odom::get_pose() {
-  return m_pose.get();
+Odom::ChassisPose Odom::get_pose() const {
+  return m_state.read().m_pose;
 }
 
 // get rate of change
-Odom::ChassisDeriv* Odom::get_speed() {
-  return m_deriv.get();
+Odom::ChassisDeriv Odom::get_speed() const {
+  return m_state.read().m_deriv;
+}
+
+// get pose and rate of change
+Odom::ChassisState Odom::get_state() const {
+  return m_state.read();
+}
+
+// get heading filter
+const HeadingFilter& Odom::get_heading_filter() const {
+  return m_heading_filter;
+}
+
+// tare
+void Odom::tare(ChassisPose* new_pose) {
+  m_pending_tare.write(*new_pose);
+  m_tare_requests.fetch_add(1, std::memory_order_release);
+}
+
+// apply a tare
+void Odom::apply_tare(const ChassisPose& new_pose) {
+
+  // the reference is the transform taking the absolute pose to the new pose
+  QAngle rotation = new_pose.m_heading - m_absolute_pose->m_heading;
+  m_reference_cos = std::cos(rotation.convert(radian));
+  m_reference_sin = std::sin(rotation.convert(radian));
+  m_reference_pose->m_heading = rotation;
+  m_reference_pose->m_x = new_pose.m_x - (m_absolute_pose->m_x * m_reference_cos - m_absolute_pose->m_y * m_reference_sin);
+  m_reference_pose->m_y = new_pose.m_y - (m_absolute_pose->m_y * m_reference_cos + m_absolute_pose->m_x * m_reference_sin);
+  m_reference_pose->m_encoder_dist_left = new_pose.m_encoder_dist_left - m_absolute_pose->m_encoder_dist_left;
+  m_reference_pose->m_encoder_dist_right = new_pose.m_encoder_dist_right - m_absolute_pose->m_encoder_dist_right;
+  m_reference_pose->m_encoder_dist_side = new_pose.m_encoder_dist_side - m_absolute_pose->m_encoder_dist_side;
+  m_heading_filter.reset_variance();
+
+  update_pose_from_reference();
+}
+
+// apply the reference to the absolute pose
+void Odom::update_pose_from_reference() {
+  m_pose->m_x = m_absolute_pose->m_x * m_reference_cos - m_absolute_pose->m_y * m_reference_sin + m_reference_pose->m_x;
+  m_pose->m_y = m_absolute_pose->m_y * m_reference_cos + m_absolute_pose->m_x * m_reference_sin + m_reference_pose->m_y;
+  m_pose->m_heading = m_absolute_pose->m_heading + m_reference_pose->m_heading;
+  m_pose->m_encoder_dist_left = m_absolute_pose->m_encoder_dist_left + m_reference_pose->m_encoder_dist_left;
+  m_pose->m_encoder_dist_right = m_absolute_pose->m_encoder_dist_right + m_reference_pose->m_encoder_dist_right;
+  m_pose->m_encoder_dist_side = m_absolute_pose->m_encoder_dist_side + m_reference_pose->m_encoder_dist_side;
+
+  // publish
+  m_state.write({*m_pose, *m_deriv, m_heading_filter.get_variance()});
 }
@@ -0,0 +1,103 @@
+#include "lib/scheduler.hpp"
+
+// add a job
+int Scheduler::add(const char* name, QFrequency rate, std::function<void()> job) {
+  if (m_size >= MAX_JOBS) return -1;
+  uint32_t period = std::max(1.0, std::round((1 / rate).convert(millisecond)));
+  m_jobs[m_size] = Job{name, std::move(job), period, now(), {}};
+  return m_size++;
+}
+
+// make a job due
+void Scheduler::trigger(int index) {
+  m_jobs[index].m_deadline = now();
+}
+
+// set notification handler
+void Scheduler::on_notify(std::function<void(uint32_t)> handler) {
+  m_notification_handler = std::move(handler);
+}
+
+// run jobs that are due
+void Scheduler::tick() {
+  for (size_t i = 0; i < m_size; ++i) {
+    Job& job = m_jobs[i];
+
+    // deadlines are compared as a signed difference so that the clock can wrap;
+    // the clock is read per job, so a job waiting behind others counts the time they ran as lateness
+    uint32_t start = now();
+    if (static_cast<int32_t>(start - job.m_deadline) < 0) continue;
+
+    // record how late the job is
+    uint32_t jitter = start - job.m_deadline;
+    job.m_stats.m_max_jitter = std::max(job.m_stats.m_max_jitter, jitter);
+    ++job.m_stats.m_jitter_histogram[std::min<uint32_t>(jitter, HISTOGRAM_BINS - 1)];
+
+    // run the job
+    job.m_job();
+    uint32_t end = now();
+    ++job.m_stats.m_runs;
+    ++job.m_stats.m_duration_histogram[std::min<uint32_t>(end - start, HISTOGRAM_BINS - 1)];
+
+    // advance the deadline, skipping any that have already passed;
+    // a job that finishes exactly at its next deadline has not overrun, and runs again straight away
+    job.m_deadline += job.m_period;
+    if (static_cast<int32_t>(end - job.m_deadline) > 0) {
+      uint32_t missed = (end - job.m_deadline - 1) / job.m_period + 1;
+      ++job.m_stats.m_overruns;
+      job.m_stats.m_skipped += missed;
+      job.m_deadline += missed * job.m_period;
+    }
+  }
+}
+
+// get the earliest deadline
+uint32_t Scheduler::next_deadline() const {
+  uint32_t time = now();
+  uint32_t earliest = time + 1000;
+  for (size_t i = 0; i < m_size; ++i) {
+    if (static_cast<int32_t>(m_jobs[i].m_deadline - earliest) < 0) earliest = m_jobs[i].m_deadline;
+  }
+  return earliest;
+}
+
+// run forever
+void Scheduler::run() {
+  while (true) {
+    tick();
+
+    // sleep until the next deadline or a notification
+    uint32_t deadline = next_deadline();
+    uint32_t time = now();
+    uint32_t timeout = static_cast<int32_t>(deadline - time) > 0 ? deadline - time : 0;
+    m_cpu.end();
+    uint32_t notification = pros::c::task_notify_take(true, timeout);
+    m_cpu.begin();
+    if (notification && m_notification_handler) m_notification_handler(notification);
+  }
+}
+
+// get statistics
+Scheduler::JobStats Scheduler::get_stats(int index) const {
+  return m_jobs[index].m_stats;
+}
+
+// get CPU time
+CpuMeter::Stats Scheduler::get_cpu_stats() const {
+  return m_cpu.get_stats();
+}
+
+// get name
+const char* Scheduler::get_name(int index) const {
+  return m_jobs[index].m_name;
+}
+
+// get number of jobs
+size_t Scheduler::size() const {
+  return m_size;
+}
+
+// clock; the PROS clock, which add() and trigger() set deadlines by as well
+uint32_t Scheduler::now() {
+  return pros::millis();
+}
@@ -0,0 +1,95 @@
+#include "lib/telemetry.hpp"
+
+// constructor
+TelemetryBuffer::TelemetryBuffer(): m_head(0), m_tail(0), m_dropped(0) {}
+
+// push a record
+bool TelemetryBuffer::push(uint8_t channel, std::initializer_list<float> values) {
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+  if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // fill the record in place
+  TelemetryRecord& record = m_records[head & (CAPACITY - 1)];
+  record.m_sync = TelemetryRecord::SYNC;
+  record.m_channel = channel;
+  record.m_count = 0;
+  record.m_time = pros::millis();
+  for (float value : values) {
+    if (record.m_count == TelemetryRecord::MAX_VALUES) break;
+    record.m_values[record.m_count++] = value;
+  }
+  for (size_t i = record.m_count; i < TelemetryRecord::MAX_VALUES; ++i) record.m_values[i] = 0;
+
+  // publish
+  m_head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+// pop a record
+bool TelemetryBuffer::pop(TelemetryRecord& record) {
+  uint32_t tail = m_tail.load(std::memory_order_relaxed);
+  if (tail == m_head.load(std::memory_order_acquire)) return false;
+  record = m_records[tail & (CAPACITY - 1)];
+  m_tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+// get dropped count
+uint32_t TelemetryBuffer::get_dropped() const {
+  return m_dropped.load(std::memory_order_relaxed);
+}
+
+// constructor
+Telemetry::Telemetry(FILE* output, QTime period):
+  m_num_buffers(0),
+  m_output(output),
+  m_period(period.convert(millisecond)),
+  m_reported_dropped(0)
+{
+  m_task = std::make_unique<pros::Task>([this]() {
+    uint32_t time = pros::millis();
+    while (true) {
+      drain();
+      pros::Task::delay_until(&time, m_period);
+    }
+  }, TASK_PRIORITY_MIN, TASK_STACK_DEPTH_DEFAULT, "telemetry");
+}
+
+// add a producer
+TelemetryBuffer* Telemetry::add_buffer() {
+  size_t index = m_num_buffers.fetch_add(1);
+  if (index >= MAX_BUFFERS) {
+    m_num_buffers.store(MAX_BUFFERS);
+    return nullptr;
+  }
+  return &m_buffers[index];
+}
+
+// get dropped count
+uint32_t Telemetry::get_dropped() const {
+  uint32_t dropped = 0;
+  size_t num = std::min(m_num_buffers.load(), MAX_BUFFERS);
+  for (size_t i = 0; i < num; ++i) dropped += m_buffers[i].get_dropped();
+  return dropped;
+}
+
+// write buffered records
+void Telemetry::drain() {
+  size_t num = std::min(m_num_buffers.load(), MAX_BUFFERS);
+  TelemetryRecord record;
+  for (size_t i = 0; i < num; ++i) {
+    while (m_buffers[i].pop(record)) fwrite(&record, sizeof(record), 1, m_output);
+  }
+
+  // report drops whenever there are more
+  uint32_t dropped = get_dropped();
+  if (dropped != m_reported_dropped) {
+    m_reported_dropped = dropped;
+    record = {TelemetryRecord::SYNC, CHANNEL_DROPPED, 1, pros::millis(), {float(dropped), 0, 0, 0}};
+    fwrite(&record, sizeof(record), 1, m_output);
+  }
+  fflush(m_output);
+}
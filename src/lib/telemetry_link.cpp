@@ -0,0 +1,113 @@
+#include "lib/telemetry_link.hpp"
+
+namespace {
+
+  // append a zigzag varint
+  size_t put_varint(int32_t value, uint8_t* out) {
+    uint32_t zigzag = (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+    size_t size = 0;
+    while (zigzag >= 0x80) {
+      out[size++] = uint8_t(zigzag) | 0x80;
+      zigzag >>= 7;
+    }
+    out[size++] = uint8_t(zigzag);
+    return size;
+  }
+
+  // CRC-16/CCITT-FALSE
+  uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; ++i) {
+      crc ^= uint16_t(data[i]) << 8;
+      for (int bit = 0; bit < 8; ++bit) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+  // COBS-encode, including the terminating zero
+  size_t cobs(const uint8_t* data, size_t size, uint8_t* out) {
+    size_t code_index = 0;
+    size_t written = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < size; ++i) {
+      if (data[i] != 0) {
+        out[written++] = data[i];
+        ++code;
+      }
+      if (data[i] == 0 || code == 0xFF) {
+        out[code_index] = code;
+        code = 1;
+        code_index = written++;
+      }
+    }
+    out[code_index] = code;
+    out[written++] = 0;
+    return written;
+  }
+}
+
+// constructor
+TelemetryLink::TelemetryLink(std::unique_ptr<pros::Serial> serial, size_t num_fields, uint32_t budget):
+  m_serial(std::move(serial)),
+  m_num_fields(std::min(num_fields, MAX_FIELDS)),
+  m_budget(budget),
+  m_allowance(0),
+  m_last_fields{},
+  m_last_time(0),
+  m_last_refill(pros::millis()),
+  m_since_keyframe(KEYFRAME_INTERVAL),
+  m_sequence(0),
+  m_stats{0, 0, 0}
+{}
+
+// encode a frame
+size_t TelemetryLink::encode(bool keyframe, uint8_t sequence, int32_t time, const int32_t* fields, size_t num_fields, uint8_t* out) {
+  uint8_t frame[MAX_FRAME_SIZE];
+  size_t size = 0;
+  frame[size++] = keyframe ? 1 : 0;
+  frame[size++] = sequence;
+  size += put_varint(time, frame + size);
+  for (size_t i = 0; i < num_fields; ++i) size += put_varint(fields[i], frame + size);
+  uint16_t crc = crc16(frame, size);
+  frame[size++] = uint8_t(crc);
+  frame[size++] = uint8_t(crc >> 8);
+  return cobs(frame, size, out);
+}
+
+// send a frame
+bool TelemetryLink::send(uint32_t time, const int32_t* fields) {
+
+  // refill the allowance
+  uint32_t now = pros::millis();
+  m_allowance = std::min(m_allowance + (now - m_last_refill) * m_budget, m_budget * 1000);
+  m_last_refill = now;
+
+  // encode against the last frame sent
+  bool keyframe = m_since_keyframe >= KEYFRAME_INTERVAL;
+  int32_t values[MAX_FIELDS];
+  for (size_t i = 0; i < m_num_fields; ++i) values[i] = keyframe ? fields[i] : fields[i] - m_last_fields[i];
+  uint8_t encoded[MAX_ENCODED_SIZE];
+  size_t size = encode(keyframe, m_sequence, keyframe ? time : time - m_last_time, values, m_num_fields, encoded);
+
+  // skip if over budget or the serial buffer cannot take the whole frame
+  if (size * 1000 > m_allowance || m_serial->get_write_free() < int32_t(size)) {
+    ++m_stats.m_skipped;
+    return false;
+  }
+  m_serial->write(encoded, size);
+  m_allowance -= size * 1000;
+
+  // remember what the receiver has
+  std::copy(fields, fields + m_num_fields, m_last_fields);
+  m_last_time = time;
+  m_since_keyframe = keyframe ? 1 : m_since_keyframe + 1;
+  ++m_sequence;
+  ++m_stats.m_sent;
+  m_stats.m_bytes += size;
+  return true;
+}
+
+// get counts
+TelemetryLink::LinkStats TelemetryLink::get_stats() const {
+  return m_stats;
+}
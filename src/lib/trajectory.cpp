@@ -0,0 +1,132 @@
+#include "lib/trajectory.hpp"
+#include "lib/packed_trajectory.hpp"
+
+// constructor
+Trajectory::Trajectory(std::vector<TrajectoryPoint> points, QTime dt):
+  m_points(std::move(points)), m_packed(nullptr), m_length(m_points.size()), m_dt(dt)
+{}
+Trajectory::Trajectory(const PackedTrajectory& packed):
+  m_packed(packed.m_segments), m_length(packed.m_length), m_dt(packed.m_dt * millisecond)
+{}
+
+// straight trajectory
+Trajectory Trajectory::straight(
+  TrajectoryPoint start, QLength distance, QSpeed max_velocity, QAcceleration max_acceleration, QTime dt
+) {
+
+  // profile in absolute distance, with a triangle if max velocity is never reached
+  double length = std::abs(distance.convert(meter));
+  double v_max = max_velocity.convert(mps);
+  double a_max = max_acceleration.convert(mps2);
+  double t_accel = v_max / a_max;
+  if (a_max * t_accel * t_accel > length) {
+    t_accel = std::sqrt(length / a_max);
+    v_max = a_max * t_accel;
+  }
+  double t_cruise = v_max > 0 ? (length - a_max * t_accel * t_accel) / v_max : 0;
+  double t_total = 2 * t_accel + t_cruise;
+
+  // sample the profile
+  double step = dt.convert(second);
+  double direction = distance < 0_m ? -1 : 1;
+  double cos_heading = std::cos(start.m_heading.convert(radian));
+  double sin_heading = std::sin(start.m_heading.convert(radian));
+  size_t count = std::ceil(t_total / step) + 1;
+  std::vector<TrajectoryPoint> points;
+  points.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    double t = std::min(i * step, t_total);
+    double s, v, a;
+    if (t < t_accel) {
+      a = a_max;
+      v = a_max * t;
+      s = .5 * a_max * t * t;
+    }
+    else if (t < t_accel + t_cruise) {
+      a = 0;
+      v = v_max;
+      s = .5 * a_max * t_accel * t_accel + v_max * (t - t_accel);
+    }
+    else {
+      double t_left = t_total - t;
+      a = -a_max;
+      v = a_max * t_left;
+      s = length - .5 * a_max * t_left * t_left;
+    }
+    if (i == count - 1) a = 0;
+    points.push_back({
+      start.m_x + direction * s * cos_heading * meter,
+      start.m_y + direction * s * sin_heading * meter,
+      start.m_heading,
+      direction * v * mps,
+      direction * a * mps2,
+      0_rpm
+    });
+  }
+
+  return Trajectory(std::move(points), dt);
+}
+
+// trajectory from pathfinder
+Trajectory Trajectory::from_pathfinder(const Segment* segments, int length) {
+  std::vector<TrajectoryPoint> points;
+  points.reserve(length);
+  double heading = length ? segments[0].heading : 0;
+  for (int i = 0; i < length; ++i) {
+
+    // unwrap heading so that interpolation never crosses a wrap
+    if (i > 0) heading += std::remainder(segments[i].heading - segments[i - 1].heading, 2 * 1_pi);
+
+    // heading rate from neighbouring segments
+    double angular_velocity = 0;
+    if (length > 1) {
+      int next = std::min(i + 1, length - 1);
+      int prev = next - 1;
+      angular_velocity = std::remainder(segments[next].heading - segments[prev].heading, 2 * 1_pi) / segments[prev].dt;
+    }
+
+    // pathfinder is counterclockwise with y to the left
+    points.push_back({
+      segments[i].x * meter,
+      -segments[i].y * meter,
+      -heading * radian,
+      segments[i].velocity * mps,
+      segments[i].acceleration * mps2,
+      -angular_velocity * radps
+    });
+  }
+  return Trajectory(std::move(points), (length ? segments[0].dt : 0.01) * second);
+}
+
+// sample
+TrajectoryPoint Trajectory::sample(QTime time) const {
+  if (m_length == 0) return {0_m, 0_m, 0_deg, 0_mps, 0_mps2, 0_rpm};
+  double index = std::max(0.0, (time / m_dt).getValue());
+  size_t before = index;
+  if (before >= m_length - 1) return point(m_length - 1);
+
+  // interpolate
+  double k = index - before;
+  TrajectoryPoint a = point(before);
+  TrajectoryPoint b = point(before + 1);
+  return {
+    a.m_x + (b.m_x - a.m_x) * k,
+    a.m_y + (b.m_y - a.m_y) * k,
+    a.m_heading + (b.m_heading - a.m_heading) * k,
+    a.m_velocity + (b.m_velocity - a.m_velocity) * k,
+    a.m_acceleration + (b.m_acceleration - a.m_acceleration) * k,
+    a.m_angular_velocity + (b.m_angular_velocity - a.m_angular_velocity) * k
+  };
+}
+
+// duration
+QTime Trajectory::duration() const {
+  if (m_length == 0) return 0_ms;
+  return m_dt * (m_length - 1);
+}
+
+// get a setpoint
+TrajectoryPoint Trajectory::point(size_t index) const {
+  if (m_packed) return m_packed[index].unpack();
+  return m_points[index];
+}
@@ -5,12 +5,15 @@
 
 using namespace subsystems;
 
+namespace {
+
+  // manual lift control; overrides presets and cannot be interrupted while the buttons are held
+  Command manual_lift("manual lift", RESOURCE_LIFT, PRIORITY_DRIVER, false, nullptr, [](bool) { lift->lock(); });
+}
+
 void opcontrol() {
   while(true) {
 
-    // update poses
-    update_poses();
-
     // control transmission
     // if (controls::btn_tilter_slow.changedToPressed()) tilter->move_voltage(-6000);
     // else if (controls::btn_tilter_slow.changedToReleased()) tilter->hold();
@@ -19,42 +22,43 @@ void opcontrol() {
     // if (controls::btn_tilter_pull_out.changedToPressed()) subsystem_controllers::pull_out_controller->enable();
     // else if (controls::btn_tilter_pull_out.changedToReleased()) subsystem_controllers::pull_out_controller->disable();
 
-    if (transmission->m_control_mutex.take(0)) {
-
-      // drive chassis
-      int volt_left  = controls::controller_master.getAnalog(ControllerAnalog::leftY)  * 12000;
-      int volt_right = controls::controller_master.getAnalog(ControllerAnalog::rightY) * 12000;
+    // drive unless a macro owns the transmission
+    int volt_left  = controls::controller_master.getAnalog(ControllerAnalog::leftY)  * 12000;
+    int volt_right = controls::controller_master.getAnalog(ControllerAnalog::rightY) * 12000;
+    arbiter->run_default(RESOURCE_TRANSMISSION, [=]() {
       chassis->move_voltage(volt_left, volt_right);
 
       // control tilter
       // if (controls::btn_tilter_extend.isPressed())  tilter->extend_passive();
       // else if (controls::btn_tilter_retract.isPressed()) tilter->retract_passive();
+    });
 
-      transmission->m_control_mutex.give();
-    }
+    // control intake unless a macro owns it; the lift lowers while intaking
+    bool intake_in = controls::btn_intake_in.isPressed();
+    bool intake_out = controls::btn_intake_out.isPressed();
+    arbiter->run_default(RESOURCE_INTAKE, [=]() {
+      if (intake_in && intake_out) intake->move_voltage(-4000);
+      else if (intake_in) intake->move_voltage(12000);
+      else if (intake_out) intake->move_voltage(-12000);
+      else intake->lock();
+    });
+    if (intake_in != intake_out) subsystem_controllers::lift_controller->lower();
+    else if (!intake_in) subsystem_controllers::lift_controller->raise();
 
-    // control intake
-    if (controls::btn_intake_in.isPressed() && controls::btn_intake_out.isPressed()) intake->move_voltage(-4000);
-    else if (controls::btn_intake_in.isPressed()) {
-      intake->move_voltage(12000);
-      // subsystem_controllers::lift_controller->lower();
+    // control lift; manual control overrides presets
+    bool low_tower = controls::btn_lift_low_tower.changedToPressed();
+    bool mid_tower = controls::btn_lift_mid_tower.changedToPressed();
+    if (low_tower) subsystem_controllers::lift_controller->move_to(Lift::Preset::LOW_TOWER);
+    else if (mid_tower) subsystem_controllers::lift_controller->move_to(Lift::Preset::MID_TOWER);
+    if (controls::btn_lift_up.isPressed() || controls::btn_lift_down.isPressed()) {
+      int voltage = controls::btn_lift_up.isPressed() ? 12000 : -8000;
+      arbiter->schedule(manual_lift);
+      arbiter->run(manual_lift, [=]() {
+        lift->move_voltage(voltage);
+        return true;
+      });
     }
-    else if (controls::btn_intake_out.isPressed()) {
-      intake->move_voltage(-12000);
-      // subsystem_controllers::lift_controller->lower();
-    }
-    else {
-      intake->lock();
-      // subsystem_controllers::lift_controller->raise();
-    }
-
-    // control lift
-    if (controls::btn_lift_up.isPressed()) lift->move_voltage(12000);
-    else if (controls::btn_lift_down.isPressed()) lift->move_voltage(-8000);
-    else lift->lock();
-
-    // update controllers
-    update_controllers();
+    else arbiter->cancel(manual_lift);
 
     pros::delay(10);
   }
@@ -17,12 +17,15 @@ void Chassis::move_voltage(int val) {
 }
 
 // get pose
-Odom::ChassisPose* Chassis::get_pose() {
+Odom::ChassisPose Chassis::get_pose() {
   return m_odom->get_pose();
 }
-Odom::ChassisDeriv* Chassis::get_speed() {
+Odom::ChassisDeriv Chassis::get_speed() {
   return m_odom->get_speed();
 }
+Odom::ChassisState Chassis::get_state() {
+  return m_odom->get_state();
+}
 
 // tare the pose
 void Chassis::tare_pose(Odom::ChassisPose* new_pose) {
@@ -30,6 +33,11 @@ void Chassis::tare_pose(Odom::ChassisPose* new_pose) {
 }
 
 // update the pose
-void Chassis::update_pose() {
-  m_odom->update();
+void Chassis::update_pose(const SensorFrame& frame) {
+  m_odom->update({
+    frame.m_drive_time,
+    frame.m_tracking_left, frame.m_tracking_right, frame.m_tracking_side,
+    frame.m_direct_left, frame.m_direct_right,
+    frame.m_imu_rotation
+  });
 }
\ No newline at end of file
@@ -2,14 +2,23 @@
 
 // constructor
 Intake::Intake(int8_t port_l, int8_t port_r):
-  m_motor_left (std::make_unique<Motor>(port_l, false, Motor::gearset::green, Motor::encoderUnits::degrees)),
-  m_motor_right(std::make_unique<Motor>(port_r, true, Motor::gearset::green, Motor::encoderUnits::degrees)),
-  velmath_left(VelMathFactory::create(360, 5_ms)),
-  velmath_right(VelMathFactory::create(360, 5_ms))
+  m_ime_left (std::make_shared<IntegratedEncoder>(port_l, false)),
+  m_ime_right(std::make_shared<IntegratedEncoder>(port_r, true)),
+  m_motor_left (std::make_shared<CachedMotor>(port_l, false, Motor::gearset::green, Motor::encoderUnits::degrees)),
+  m_motor_right(std::make_shared<CachedMotor>(port_r, true, Motor::gearset::green, Motor::encoderUnits::degrees)),
+  m_estimator_left(8, 200),
+  m_estimator_right(8, 200),
+  m_voltage(0),
+  m_current(0),
+  m_cube_count(0),
+  m_cube_count_pending(false),
+  m_pending_cube_count(0),
+  m_num_cube_listeners(0)
 {}
 
 // move voltage
 void Intake::move_voltage(int val) {
+  m_voltage = val;
   m_motor_left ->setBrakeMode(Motor::brakeMode::coast);
   m_motor_right->setBrakeMode(Motor::brakeMode::coast);
   m_motor_left ->moveVoltage(val);
@@ -18,6 +27,7 @@ void Intake::move_voltage(int val) {
 
 // lock motors
 void Intake::lock() {
+  m_voltage = 0;
   m_motor_left ->setBrakeMode(Motor::brakeMode::hold);
   m_motor_right->setBrakeMode(Motor::brakeMode::hold);
   m_motor_left ->moveVelocity(0);
@@ -36,18 +46,18 @@ std::tuple<QAngle, QAngle, QAngle> Intake::get_angle() {
 // get velocity
 std::tuple<QAngularSpeed, QAngularSpeed, QAngularSpeed> Intake::get_velocity() {
   return std::tuple<QAngularSpeed, QAngularSpeed, QAngularSpeed>(
-    velmath_left.getVelocity(), 
-    velmath_right.getVelocity(), 
-    (velmath_left.getVelocity() + velmath_right.getVelocity()) * .5
+    m_estimator_left.get_velocity() * degree / second,
+    m_estimator_right.get_velocity() * degree / second,
+    (m_estimator_left.get_velocity() + m_estimator_right.get_velocity()) * .5 * degree / second
   );
 }
 
 // get acceleration
 std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration> Intake::get_acceleration() {
   return std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration>(
-    velmath_left.getAccel(), 
-    velmath_right.getAccel(), 
-    (velmath_left.getAccel() + velmath_right.getAccel()) * .5
+    m_estimator_left.get_acceleration() * degree / second / second,
+    m_estimator_right.get_acceleration() * degree / second / second,
+    (m_estimator_left.get_acceleration() + m_estimator_right.get_acceleration()) * .5 * degree / second / second
   );
 }
 
@@ -55,15 +65,75 @@ std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration> Int
 void Intake::tare_angles(QAngle left, QAngle right) {
   m_reference_pose_left =  left  - m_absolute_pose_left;
   m_reference_pose_right = right - m_absolute_pose_right;
-  update_angles();
+  m_pose_left = m_absolute_pose_left + m_reference_pose_left;
+  m_pose_right = m_absolute_pose_right + m_reference_pose_right;
 }
 
 // update angles
-void Intake::update_angles() {
-  m_absolute_pose_left = m_motor_left->getPosition() * 1_deg;
-  m_absolute_pose_right = m_motor_right->getPosition() * 1_deg;
-  velmath_left.step(m_absolute_pose_left.convert(degree));
-  velmath_right.step(m_absolute_pose_right.convert(degree));
+void Intake::update_angles(const SensorFrame& frame) {
+  if (frame.m_intake_left == PROS_ERR || frame.m_intake_right == PROS_ERR) return;
+  m_absolute_pose_left = frame.m_intake_left * 1_deg;
+  m_absolute_pose_right = frame.m_intake_right * 1_deg;
+  uint32_t time = frame.m_intake_time;
+  m_estimator_left.step(m_absolute_pose_left.convert(degree), time);
+  m_estimator_right.step(m_absolute_pose_right.convert(degree), time);
   m_pose_left = m_absolute_pose_left + m_reference_pose_left;
   m_pose_right = m_absolute_pose_right + m_reference_pose_right;
+
+  // detect cubes
+  if (frame.m_intake_current_left != PROS_ERR && frame.m_intake_current_right != PROS_ERR) {
+    m_current = (frame.m_intake_current_left + frame.m_intake_current_right) * .5;
+  }
+  if (m_cube_count_pending.exchange(false)) {
+    m_cube_detector.set_count(m_pending_cube_count);
+    publish_cube_event(CubeEvent::SET);
+  }
+  CubeEvent event = m_cube_detector.step(
+    time, m_voltage, (m_estimator_left.get_velocity() + m_estimator_right.get_velocity()) * .5, m_current
+  );
+  m_cube_count = m_cube_detector.get_count();
+  if (event != CubeEvent::NONE) publish_cube_event(event);
+}
+
+// publish a cube event
+void Intake::publish_cube_event(CubeEvent event) {
+  size_t num = m_num_cube_listeners.load();
+  for (size_t i = 0; i < num; ++i) m_cube_listeners[i](event, m_cube_detector.get_count());
+}
+
+// get current
+double Intake::get_current() {
+  return m_current;
+}
+
+// add a cube listener
+bool Intake::on_cube_event(CubeListener listener) {
+  size_t num = m_num_cube_listeners.load();
+  if (num >= MAX_CUBE_LISTENERS) return false;
+  m_cube_listeners[num] = std::move(listener);
+  m_num_cube_listeners.store(num + 1);
+  return true;
+}
+
+// get cube count
+size_t Intake::get_cube_count() const {
+  return m_cube_count;
+}
+
+// set cube count
+void Intake::set_cube_count(size_t count) {
+  m_pending_cube_count = count;
+  m_cube_count_pending = true;
+}
+
+// get write counts
+CachedMotor::WriteStats Intake::get_write_stats() const {
+  CachedMotor::WriteStats left = m_motor_left->get_write_stats();
+  CachedMotor::WriteStats right = m_motor_right->get_write_stats();
+  return {left.m_issued + right.m_issued, left.m_suppressed + right.m_suppressed};
+}
+
+// get voltages
+std::tuple<int, int> Intake::get_voltages() const {
+  return std::make_tuple(m_motor_left->get_commanded_voltage(), m_motor_right->get_commanded_voltage());
 }
\ No newline at end of file
@@ -1,23 +1,100 @@
 #include "subsystems/lift.hpp"
+#include "lib/control_laws.hpp"
 
 // constructor
 Lift::Lift(int8_t port_l, int8_t port_r):
-  m_motor_left (std::make_unique<Motor>(port_l, false, Motor::gearset::green, Motor::encoderUnits::degrees)),
-  m_motor_right(std::make_unique<Motor>(port_r, true, Motor::gearset::green, Motor::encoderUnits::degrees)),
-  velmath_left(VelMathFactory::create(360, 5_ms)),
-  velmath_right(VelMathFactory::create(360, 5_ms))
+  m_ime_left (std::make_shared<IntegratedEncoder>(port_l, false)),
+  m_ime_right(std::make_shared<IntegratedEncoder>(port_r, true)),
+  m_motor_left (std::make_unique<CachedMotor>(port_l, false, Motor::gearset::green, Motor::encoderUnits::degrees)),
+  m_motor_right(std::make_unique<CachedMotor>(port_r, true, Motor::gearset::green, Motor::encoderUnits::degrees)),
+  m_estimator_left(),
+  m_estimator_right(),
+  m_moving(false),
+  m_profile(0_deg, 0_deg, PROFILE_VELOCITY, PROFILE_ACCELERATION),
+  m_move_start(0)
 {}
 
 // move voltage
 void Lift::move_voltage(int val) {
+  m_move_mutex.take(TIMEOUT_MAX);
+  m_moving = false;
+  apply_voltage(val);
+  m_move_mutex.give();
+}
+
+// move along a profile
+void Lift::move_to(QAngle target) {
+  m_move_mutex.take(TIMEOUT_MAX);
+  m_profile = TrapezoidProfile(std::get<2>(get_angle()), target, PROFILE_VELOCITY, PROFILE_ACCELERATION, std::get<2>(get_velocity()));
+  m_move_start = pros::millis();
+  m_moving = true;
+  m_move_mutex.give();
+}
+void Lift::move_to(Preset preset) {
+  move_to(get_preset(preset));
+}
+
+// get preset angle
+QAngle Lift::get_preset(Preset preset) {
+  switch (preset) {
+    case Preset::DOWN:      return 0_deg;
+    case Preset::LOCK:      return MAX_LOCK;
+    case Preset::LOW_TOWER: return 45_deg;
+    case Preset::MID_TOWER: return 65_deg;
+    case Preset::MAX:       return MAX_ANGLE;
+  }
+  return 0_deg;
+}
+
+// check if settled
+bool Lift::is_settled() {
+  m_move_mutex.take(TIMEOUT_MAX);
+  bool settled = !m_moving || (
+    pros::millis() - m_move_start >= m_profile.duration().convert(millisecond) &&
+    (std::get<2>(get_angle()) - m_profile.get_target()).abs() < SETTLE_ANGLE &&
+    std::get<2>(get_velocity()).abs() < SETTLE_SPEED
+  );
+  m_move_mutex.give();
+  return settled;
+}
+
+// follow the move
+void Lift::update() {
+  m_move_mutex.take(TIMEOUT_MAX);
+  if (m_moving) {
+    ProfilePoint setpoint = m_profile.sample((pros::millis() - m_move_start) * millisecond);
+    QAngle angle = std::get<2>(get_angle());
+    QAngularSpeed velocity = std::get<2>(get_velocity());
+    apply_voltage(control_laws::follow(
+      FEEDFORWARD, KP, KD, 1,
+      setpoint.m_position.convert(degree),
+      setpoint.m_velocity.convert(degree / second),
+      setpoint.m_acceleration.convert(degree / second / second),
+      angle.convert(degree),
+      velocity.convert(degree / second)
+    ));
+  }
+  m_move_mutex.give();
+}
+
+// apply voltage with synchronization
+void Lift::apply_voltage(double val) {
+  double correction = control_laws::sync(
+    SYNC_KP, SYNC_KD,
+    (m_pose_right - m_pose_left).convert(degree),
+    m_estimator_right.get_velocity() - m_estimator_left.get_velocity()
+  );
   m_motor_left ->setBrakeMode(Motor::brakeMode::coast);
   m_motor_right->setBrakeMode(Motor::brakeMode::coast);
-  m_motor_left ->moveVoltage(val + (m_motor_right->getPosition() - m_motor_left->getPosition()) * 20);
-  m_motor_right->moveVoltage(val - (m_motor_right->getPosition() - m_motor_left->getPosition()) * 20);
+  m_motor_left ->moveVoltage(std::max(-12000.0, std::min(12000.0, val + correction)));
+  m_motor_right->moveVoltage(std::max(-12000.0, std::min(12000.0, val - correction)));
 }
 
 // lock motors
 void Lift::lock() {
+  m_move_mutex.take(TIMEOUT_MAX);
+  m_moving = false;
+  m_move_mutex.give();
   m_motor_left ->setBrakeMode(Motor::brakeMode::hold);
   m_motor_right->setBrakeMode(Motor::brakeMode::hold);
   m_motor_left ->moveVelocity(0);
@@ -36,18 +113,18 @@ std::tuple<QAngle, QAngle, QAngle> Lift::get_angle() {
 // get velocity
 std::tuple<QAngularSpeed, QAngularSpeed, QAngularSpeed> Lift::get_velocity() {
   return std::tuple<QAngularSpeed, QAngularSpeed, QAngularSpeed>(
-    velmath_left.getVelocity(), 
-    velmath_right.getVelocity(), 
-    (velmath_left.getVelocity() + velmath_right.getVelocity()) * .5
+    m_estimator_left.get_velocity() * degree / second,
+    m_estimator_right.get_velocity() * degree / second,
+    (m_estimator_left.get_velocity() + m_estimator_right.get_velocity()) * .5 * degree / second
   );
 }
 
 // get acceleration
 std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration> Lift::get_acceleration() {
   return std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration>(
-    velmath_left.getAccel(), 
-    velmath_right.getAccel(), 
-    (velmath_left.getAccel() + velmath_right.getAccel()) * .5
+    m_estimator_left.get_acceleration() * degree / second / second,
+    m_estimator_right.get_acceleration() * degree / second / second,
+    (m_estimator_left.get_acceleration() + m_estimator_right.get_acceleration()) * .5 * degree / second / second
   );
 }
 
@@ -55,15 +132,30 @@ std::tuple<QAngularAcceleration, QAngularAcceleration, QAngularAcceleration> Lif
 void Lift::tare_angle(QAngle val) {
   m_reference_pose_left =  val - m_absolute_pose_left;
   m_reference_pose_right = val - m_absolute_pose_right;
-  update_angles();
+  m_pose_left = m_absolute_pose_left + m_reference_pose_left;
+  m_pose_right = m_absolute_pose_right + m_reference_pose_right;
 }
 
 // update angles
-void Lift::update_angles() {
-  m_absolute_pose_left = m_motor_left ->getPosition()  * 1_deg / 5.0;
-  m_absolute_pose_right = m_motor_right->getPosition() * 1_deg / 5.0;
-  velmath_left.step(m_absolute_pose_left.convert(degree));
-  velmath_right.step(m_absolute_pose_right.convert(degree));
+void Lift::update_angles(const SensorFrame& frame) {
+  if (frame.m_lift_left == PROS_ERR || frame.m_lift_right == PROS_ERR) return;
+  m_absolute_pose_left = frame.m_lift_left * 1_deg / 5.0;
+  m_absolute_pose_right = frame.m_lift_right * 1_deg / 5.0;
+  uint32_t time = frame.m_lift_time;
+  m_estimator_left.step(m_absolute_pose_left.convert(degree), time);
+  m_estimator_right.step(m_absolute_pose_right.convert(degree), time);
   m_pose_left = m_absolute_pose_left + m_reference_pose_left;
   m_pose_right = m_absolute_pose_right + m_reference_pose_right;
+}
+
+// get write counts
+CachedMotor::WriteStats Lift::get_write_stats() const {
+  CachedMotor::WriteStats left = m_motor_left->get_write_stats();
+  CachedMotor::WriteStats right = m_motor_right->get_write_stats();
+  return {left.m_issued + right.m_issued, left.m_suppressed + right.m_suppressed};
+}
+
+// get voltages
+std::tuple<int, int> Lift::get_voltages() const {
+  return std::make_tuple(m_motor_left->get_commanded_voltage(), m_motor_right->get_commanded_voltage());
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "subsystems/sensors.hpp"
+#include "subsystems/transmission.hpp"
+#include "subsystems/lift.hpp"
+#include "subsystems/intake.hpp"
+#include <cmath>
+
+// constructor
+Sensors::Sensors(
+  std::unique_ptr<ContinuousRotarySensor> tracking_left,
+  std::unique_ptr<ContinuousRotarySensor> tracking_right,
+  std::unique_ptr<ContinuousRotarySensor> tracking_side,
+  const std::shared_ptr<Transmission>& transmission,
+  const std::shared_ptr<Lift>& lift,
+  const std::shared_ptr<Intake>& intake,
+  std::unique_ptr<pros::Imu> imu
+):
+  m_tracking_left(std::move(tracking_left)),
+  m_tracking_right(std::move(tracking_right)),
+  m_tracking_side(std::move(tracking_side)),
+  m_direct_left(transmission->m_ime_left_direct),
+  m_direct_right(transmission->m_ime_right_direct),
+  m_shared_left(transmission->m_ime_left_shared),
+  m_shared_right(transmission->m_ime_right_shared),
+  m_lift_left(lift->m_ime_left),
+  m_lift_right(lift->m_ime_right),
+  m_intake_left(intake->m_ime_left),
+  m_intake_right(intake->m_ime_right),
+  m_intake_current_left(intake->m_motor_left),
+  m_intake_current_right(intake->m_motor_right),
+  m_imu(std::move(imu)),
+  m_imu_calibrating(false),
+  m_imu_calibration_start(0),
+  m_frame{
+    0, 0, 0, 0,
+    PROS_ERR, PROS_ERR, PROS_ERR,
+    PROS_ERR, PROS_ERR, PROS_ERR, PROS_ERR,
+    PROS_ERR,
+    PROS_ERR, PROS_ERR,
+    PROS_ERR, PROS_ERR,
+    PROS_ERR, PROS_ERR
+  },
+  m_published(m_frame),
+  m_stats{0, 0, 0}
+{}
+
+// read an encoder
+double Sensors::read(const ContinuousRotarySensor* sensor) {
+  if (!sensor) return PROS_ERR;
+  ++m_stats.m_reads;
+  double value = sensor->get();
+
+  // ADI encoders fail with PROS_ERR and motors with PROS_ERR_F, which okapi may negate
+  if (value == PROS_ERR || !std::isfinite(value)) {
+    ++m_stats.m_errors;
+    return PROS_ERR;
+  }
+  return value;
+}
+
+// read an IMU; fails while it calibrates
+double Sensors::read(const pros::Imu* imu) {
+  if (!imu) return PROS_ERR;
+  ++m_stats.m_reads;
+  double value = imu->get_rotation();
+  if (value == PROS_ERR || !std::isfinite(value)) {
+    ++m_stats.m_errors;
+    return PROS_ERR;
+  }
+  return value;
+}
+
+// read a motor's current draw
+double Sensors::read_current(Motor* motor) {
+  if (!motor) return PROS_ERR;
+  ++m_stats.m_reads;
+  std::int32_t value = motor->getCurrentDraw();
+  if (value == PROS_ERR) {
+    ++m_stats.m_errors;
+    return PROS_ERR;
+  }
+  return value;
+}
+
+// calibrate IMU
+void Sensors::calibrate_imu() {
+  if (!m_imu) return;
+  m_imu_calibration_start = pros::millis();
+  m_imu->reset();
+  m_imu_calibrating.store(true, std::memory_order_release);
+}
+
+// check IMU
+bool Sensors::is_imu_ready() const {
+  return m_imu && !m_imu_calibrating.load(std::memory_order_acquire);
+}
+
+// sample
+const SensorFrame& Sensors::sample(uint32_t groups) {
+  ++m_stats.m_samples;
+  ++m_frame.m_sequence;
+
+  // drive: odom and tilter both come from these, so they are read back to back
+  if (groups & SENSORS_DRIVE) {
+    m_frame.m_drive_time = pros::millis();
+    m_frame.m_tracking_left = read(m_tracking_left.get());
+    m_frame.m_tracking_right = read(m_tracking_right.get());
+    m_frame.m_tracking_side = read(m_tracking_side.get());
+    m_frame.m_direct_left = read(m_direct_left.get());
+    m_frame.m_direct_right = read(m_direct_right.get());
+    m_frame.m_shared_left = read(m_shared_left.get());
+    m_frame.m_shared_right = read(m_shared_right.get());
+
+    // poll the IMU's status instead of its rotation until it has calibrated
+    if (m_imu && m_imu_calibrating.load(std::memory_order_acquire)) {
+      m_frame.m_imu_rotation = PROS_ERR;
+      if (m_frame.m_drive_time - m_imu_calibration_start >= IMU_STATUS_DELAY) {
+        ++m_stats.m_reads;
+        if (!m_imu->is_calibrating()) m_imu_calibrating.store(false, std::memory_order_release);
+      }
+    }
+    else m_frame.m_imu_rotation = read(m_imu.get());
+  }
+
+  // lift
+  if (groups & SENSORS_LIFT) {
+    m_frame.m_lift_time = pros::millis();
+    m_frame.m_lift_left = read(m_lift_left.get());
+    m_frame.m_lift_right = read(m_lift_right.get());
+  }
+
+  // intake
+  if (groups & SENSORS_INTAKE) {
+    m_frame.m_intake_time = pros::millis();
+    m_frame.m_intake_left = read(m_intake_left.get());
+    m_frame.m_intake_right = read(m_intake_right.get());
+    m_frame.m_intake_current_left = read_current(m_intake_current_left.get());
+    m_frame.m_intake_current_right = read_current(m_intake_current_right.get());
+  }
+
+  // publish
+  m_published.write(m_frame);
+  return m_frame;
+}
+
+// get frame
+SensorFrame Sensors::get_frame() const {
+  return m_published.read();
+}
+
+// get read counts
+Sensors::ReadStats Sensors::get_read_stats() const {
+  return m_stats;
+}
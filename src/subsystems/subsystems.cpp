@@ -2,25 +2,77 @@
 
 namespace subsystems {
 
-  // notify updater task
-  void notify_updater(UpdaterNotification notification) {
-    updater_task->notify_ext(notification, pros::E_NOTIFY_ACTION_OWRITE, nullptr);
+  // pose subscribers, only touched under the mutex
+  pros::task_t pose_subscribers[MAX_POSE_SUBSCRIBERS];
+  size_t num_pose_subscribers = 0;
+  pros::Mutex pose_subscribers_mutex;
+
+  // subscribe to pose updates
+  bool subscribe_poses(pros::task_t task) {
+    pose_subscribers_mutex.take(TIMEOUT_MAX);
+    bool subscribed = num_pose_subscribers < MAX_POSE_SUBSCRIBERS;
+    if (subscribed) pose_subscribers[num_pose_subscribers++] = task;
+    pose_subscribers_mutex.give();
+    return subscribed;
+  }
+
+  // unsubscribe from pose updates
+  void unsubscribe_poses(pros::task_t task) {
+    pose_subscribers_mutex.take(TIMEOUT_MAX);
+    for (size_t i = 0; i < num_pose_subscribers; ++i) {
+      if (pose_subscribers[i] == task) {
+        pose_subscribers[i] = pose_subscribers[--num_pose_subscribers];
+        break;
+      }
+    }
+    pose_subscribers_mutex.give();
+  }
+
+  // notify pose subscribers
+  // under the mutex, so a task is never notified after unsubscribe_poses() has returned, when it may be gone
+  void notify_pose_subscribers() {
+    pose_subscribers_mutex.take(TIMEOUT_MAX);
+    for (size_t i = 0; i < num_pose_subscribers; ++i) pros::c::task_notify(pose_subscribers[i]);
+    pose_subscribers_mutex.give();
   }
 
   // updater task
   std::shared_ptr<pros::Task> updater_task;
 
+  // scheduler
+  std::shared_ptr<Scheduler> scheduler = std::make_shared<Scheduler>();
+
+  // arbiter
+  std::shared_ptr<Arbiter<RtosMutex>> arbiter = std::make_shared<Arbiter<RtosMutex>>();
+
+  // telemetry
+  std::shared_ptr<Telemetry> telemetry;
+  TelemetryBuffer* updater_telemetry = nullptr;
+  std::shared_ptr<TelemetryLink> telemetry_link;
+
+  // send the state of every subsystem over the telemetry link
+  void send_telemetry() {
+    Odom::ChassisPose pose = chassis->get_pose();
+    int32_t fields[NUM_TELEMETRY_FIELDS];
+    fields[FIELD_X] = pose.m_x.convert(millimeter);
+    fields[FIELD_Y] = pose.m_y.convert(millimeter);
+    fields[FIELD_HEADING] = pose.m_heading.convert(radian) * 1000;
+    fields[FIELD_TRANSMISSION_STATE] = int32_t(transmission->get_state());
+    fields[FIELD_TILTER] = tilter->get_angle().convert(degree) * 10;
+    fields[FIELD_LIFT] = std::get<2>(lift->get_angle()).convert(degree) * 10;
+    fields[FIELD_INTAKE] = std::get<2>(intake->get_angle()).convert(degree) * 10;
+    std::tie(
+      fields[FIELD_VOLTAGE_DIRECT_LEFT], fields[FIELD_VOLTAGE_DIRECT_RIGHT],
+      fields[FIELD_VOLTAGE_SHARED_LEFT], fields[FIELD_VOLTAGE_SHARED_RIGHT]
+    ) = transmission->get_voltages();
+    std::tie(fields[FIELD_VOLTAGE_LIFT_LEFT], fields[FIELD_VOLTAGE_LIFT_RIGHT]) = lift->get_voltages();
+    std::tie(fields[FIELD_VOLTAGE_INTAKE_LEFT], fields[FIELD_VOLTAGE_INTAKE_RIGHT]) = intake->get_voltages();
+    telemetry_link->send(pros::millis(), fields);
+  }
+
   // transmission
   std::shared_ptr<Transmission> transmission = std::make_shared<Transmission>(11, 20, 15, 16);
-  auto odom = std::make_unique<Odom>(
-    std::make_unique<ADIEncoder>('G', 'H', false),
-    std::make_unique<ADIEncoder>('C', 'D', false),
-    std::make_unique<ADIEncoder>('E', 'F', false),
-    transmission->m_ime_left_direct,
-    transmission->m_ime_right_direct,
-    nullptr,
-    8_in, 14_in, 0_in
-  );
+  auto odom = std::make_unique<Odom>(8_in, 14_in, 0_in);
 
   // chassis
   std::shared_ptr<Chassis> chassis = std::make_shared<Chassis>(transmission, std::move(odom));
@@ -34,51 +86,78 @@ namespace subsystems {
   // lift
   std::shared_ptr<Lift> lift = std::make_shared<Lift>(1, 18);
 
+  // sensors
+  std::shared_ptr<Sensors> sensors = std::make_shared<Sensors>(
+    std::make_unique<ADIEncoder>('G', 'H', false),
+    std::make_unique<ADIEncoder>('C', 'D', false),
+    std::make_unique<ADIEncoder>('E', 'F', false),
+    transmission, lift, intake,
+    std::make_unique<pros::Imu>(IMU_PORT)
+  );
+
   // initialize
   void init() {
+    telemetry = std::make_shared<Telemetry>(stdout);
+    updater_telemetry = telemetry->add_buffer();
+    telemetry_link = std::make_shared<TelemetryLink>(
+      std::make_unique<pros::Serial>(TELEMETRY_PORT, TELEMETRY_BAUD), NUM_TELEMETRY_FIELDS, TELEMETRY_BUDGET
+    );
+
     transmission->set_chassis(chassis);
     transmission->set_tilter(tilter);
     transmission->set_lift(lift);
-    updater_task = std::make_shared<pros::Task>([]() {
-      while (true) {
+    sensors->calibrate_imu();
 
-        update_poses();
-        update_controllers();
-        pros::delay(10);
-      }
+    // hold the tray first while carrying a stack
+    intake->on_cube_event([](CubeEvent, size_t count) {
+      transmission->set_stack_size(count);
     });
-  }
 
-  // update poses
-  void update_poses() {
+    // transmission poses
+    int odom_job = scheduler->add("odom", ODOM_RATE, []() {
+      const SensorFrame& frame = sensors->sample(SENSORS_DRIVE);
+      chassis->update_pose(frame);
+      tilter->update_angle(frame);
+      notify_pose_subscribers();
+    });
 
-    // transmission
-    if (transmission->m_control_mutex.take(0)) {
-      chassis->update_pose();
-      tilter->update_angle();
-      transmission->m_control_mutex.give();
-    }
+    // transmission controller
+    int transmission_job = scheduler->add("transmission", TRANSMISSION_RATE, []() {
+      arbiter->run_default(RESOURCE_TRANSMISSION, []() { transmission->update(); });
+    });
+
+    // lift
+    int lift_job = scheduler->add("lift", LIFT_RATE, []() {
+      lift->update_angles(sensors->sample(SENSORS_LIFT));
+      arbiter->run_default(RESOURCE_LIFT, []() { lift->update(); });
+    });
 
     // intake
-    if (intake->m_control_mutex.take(0)) {
-      intake->update_angles();
-      intake->m_control_mutex.give();
-    }
+    int intake_job = scheduler->add("intake", INTAKE_RATE, []() {
+      intake->update_angles(sensors->sample(SENSORS_INTAKE));
+      if (updater_telemetry) updater_telemetry->push(TELEMETRY_INTAKE, {
+        float(std::get<0>(intake->get_voltages())),
+        float(std::get<2>(intake->get_velocity()).convert(degree / second)),
+        float(intake->get_current()),
+        float(intake->get_cube_count())
+      });
+    });
 
-    // lift
-    if (lift->m_control_mutex.take(0)) {
-      lift->update_angles();
-      lift->m_control_mutex.give();
-    }
-  }
+    // telemetry link
+    scheduler->add("telemetry", TELEMETRY_RATE, send_telemetry);
 
-  // update controllers
-  void update_controllers() {
+    // notifications make jobs due immediately
+    scheduler->on_notify([=](uint32_t notification) {
+      if (notification & NOTIFY_UPDATE_POSE) {
+        scheduler->trigger(odom_job);
+        scheduler->trigger(lift_job);
+        scheduler->trigger(intake_job);
+      }
+      if (notification & NOTIFY_UPDATE_CONT) scheduler->trigger(transmission_job);
+    });
 
-    // transmission
-    if (transmission->m_control_mutex.take(0)) {
-      transmission->update();
-      transmission->m_control_mutex.give();
-    }
+    updater_task = std::make_shared<pros::Task>([]() {
+      scheduler->run();
+    });
   }
 }
\ No newline at end of file
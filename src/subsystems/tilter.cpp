@@ -3,28 +3,29 @@
 
 // constructor
 Tilter::Tilter(std::shared_ptr<Transmission> transmission):
-  m_transmission(std::move(transmission)), velmath(VelMath(VelMathFactory::create(360, 5_ms))), m_pose(0_deg) 
+  m_transmission(std::move(transmission)), m_pose(0_deg), m_estimator(16, 100)
 {}
 
 // move voltage
 void Tilter::move_voltage(int val) {
-  m_transmission->m_state = Transmission::State::LOCKED_PASSTHROUGH;
+  m_transmission->set_state(Transmission::State::LOCKED_PASSTHROUGH);
   m_transmission->m_desired_tilter_voltage = val;
 }
 
 // hold the tray
-void Tilter::hold(int bias) {
+void Tilter::hold(int bias, Transmission::HoldPriority priority) {
   m_transmission->m_bias = bias;
-  m_transmission->m_hold_controller.setTarget(get_angle().convert(degree));
-  m_transmission->m_state = Transmission::State::HOLDING;
+  m_transmission->m_hold_priority = priority;
+  m_transmission->m_hold_target = get_angle().convert(degree);
+  m_transmission->set_state(Transmission::State::HOLDING);
 }
 
 // extend/retract tray
 void Tilter::extend_passive() {
-  m_transmission->m_state = Transmission::State::EXTENDING;
+  m_transmission->set_state(Transmission::State::EXTENDING);
 }
 void Tilter::retract_passive() {
-  m_transmission->m_state = Transmission::State::RETRACTING;
+  m_transmission->set_state(Transmission::State::RETRACTING);
 }
 
 // get pose
@@ -32,29 +33,35 @@ QAngle Tilter::get_angle() {
   return m_pose;
 }
 QAngularSpeed Tilter::get_velocity() {
-  return velmath.getVelocity();
+  return m_estimator.get_velocity() * degree / second;
 }
 QAngularAcceleration Tilter::get_acceleration() {
-  return velmath.getAccel();
+  return m_estimator.get_acceleration() * degree / second / second;
 }
 
 // tare pose
 void Tilter::tare_angle(QAngle new_pose) {
   m_reference_pose = new_pose - m_absolute_pose;
-  update_angle();
+  m_pose = m_absolute_pose + m_reference_pose;
 }
 
 // update pose
-void Tilter::update_angle() {
+void Tilter::update_angle(const SensorFrame& frame) {
+
+  // keep the last angle if any motor failed to read
+  if (
+    frame.m_shared_left == PROS_ERR || frame.m_direct_left == PROS_ERR ||
+    frame.m_shared_right == PROS_ERR || frame.m_direct_right == PROS_ERR
+  ) return;
 
   // calculate new absolute pose
   m_absolute_pose = -(
-    m_transmission->m_ime_left_shared->get() - m_transmission->m_ime_left_direct->get() +
-    m_transmission->m_ime_right_shared->get() - m_transmission->m_ime_right_direct->get()
+    frame.m_shared_left - frame.m_direct_left +
+    frame.m_shared_right - frame.m_direct_right
   ) * .5_deg / 5.0;
 
-  // update velmath
-  velmath.step(m_absolute_pose.convert(degree));
+  // update estimator
+  m_estimator.step(m_absolute_pose.convert(degree), frame.m_drive_time);
   
   // update pose
   m_pose = m_absolute_pose + m_reference_pose;
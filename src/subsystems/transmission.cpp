@@ -2,7 +2,11 @@
 #include "subsystems/chassis.hpp"
 #include "subsystems/tilter.hpp"
 #include "subsystems/lift.hpp"
+#include "lib/control_laws.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
 
 Transmission::Transmission(
   int8_t mtr_direct_left,
@@ -12,10 +16,10 @@ Transmission::Transmission(
 ):
 
   // init motors
-  m_motor_left_direct  (std::make_unique<Motor>(mtr_direct_left,  true,  Motor::gearset::red, Motor::encoderUnits::degrees)),
-  m_motor_right_direct (std::make_unique<Motor>(mtr_direct_right, false, Motor::gearset::red, Motor::encoderUnits::degrees)),
-  m_motor_left_shared  (std::make_unique<Motor>(mtr_shared_left,  true,  Motor::gearset::red, Motor::encoderUnits::degrees)),
-  m_motor_right_shared (std::make_unique<Motor>(mtr_shared_right, false, Motor::gearset::red, Motor::encoderUnits::degrees)),
+  m_motor_left_direct  (std::make_unique<CachedMotor>(mtr_direct_left,  true,  Motor::gearset::red, Motor::encoderUnits::degrees)),
+  m_motor_right_direct (std::make_unique<CachedMotor>(mtr_direct_right, false, Motor::gearset::red, Motor::encoderUnits::degrees)),
+  m_motor_left_shared  (std::make_unique<CachedMotor>(mtr_shared_left,  true,  Motor::gearset::red, Motor::encoderUnits::degrees)),
+  m_motor_right_shared (std::make_unique<CachedMotor>(mtr_shared_right, false, Motor::gearset::red, Motor::encoderUnits::degrees)),
 
   // init IMEs
   m_ime_left_direct  (std::make_shared<IntegratedEncoder>(mtr_direct_left,  true)),
@@ -23,19 +27,23 @@ Transmission::Transmission(
   m_ime_left_shared  (std::make_shared<IntegratedEncoder>(mtr_shared_left,  true)),
   m_ime_right_shared (std::make_shared<IntegratedEncoder>(mtr_shared_right, false)),
 
-  // init state
-  m_state(State::PASSIVE),
-
   // init voltages
   m_desired_chassis_voltage_left(0),
   m_desired_chassis_voltage_right(0),
   m_desired_tilter_voltage(0),
 
+  // init holding allocator
+  m_hold_priority(HoldPriority::STACK),
+  m_stack_size(0),
+  m_saturation_stats{0, 0, 0, 0},
+
   // transmission holding controller
-  m_hold_controller(IterativeControllerFactory::posPID(.1, 0, 0))
-{
-  m_hold_controller.setTarget(0);
-}
+  m_hold_target(0),
+
+  // init state
+  m_machine(State::PASSIVE),
+  m_trace_count(0)
+{}
 
 
 // set chassis reference
@@ -55,84 +63,205 @@ void Transmission::set_lift(std::shared_ptr<Lift> lift) {
 
 // set the state
 void Transmission::set_state(State state) {
-  m_state = state;
+  State from = m_machine.get_state();
+  m_machine.set_state(state, *this);
+  if (from != state) record_transition(from, state);
+}
+
+// get the state
+Transmission::State Transmission::get_state() const {
+  return m_machine.get_state();
+}
+
+// get a recent transition
+Transmission::TransitionRecord Transmission::get_transition(size_t age) const {
+  std::lock_guard<RtosMutex> lock(m_trace_mutex);
+  return m_trace[(m_trace_count - 1 - age) % TRACE_LENGTH];
+}
+
+// get the number of transitions
+uint32_t Transmission::get_transition_count() const {
+  std::lock_guard<RtosMutex> lock(m_trace_mutex);
+  return m_trace_count;
+}
+
+// copy recent transitions
+size_t Transmission::get_trace(TransitionRecord* records, size_t max) const {
+  std::lock_guard<RtosMutex> lock(m_trace_mutex);
+  size_t count = std::min<size_t>({max, TRACE_LENGTH, m_trace_count});
+  for (size_t age = 0; age < count; ++age) records[age] = m_trace[(m_trace_count - 1 - age) % TRACE_LENGTH];
+  return count;
+}
+
+// add a transition to the trace
+void Transmission::record_transition(State from, State to) {
+  std::lock_guard<RtosMutex> lock(m_trace_mutex);
+  m_trace[m_trace_count % TRACE_LENGTH] = {pros::millis(), from, to};
+  ++m_trace_count;
+}
+
+// get saturation counts
+Transmission::SaturationStats Transmission::get_saturation_stats() const {
+  return m_saturation_stats;
+}
+
+// get write counts
+CachedMotor::WriteStats Transmission::get_write_stats() const {
+  CachedMotor::WriteStats stats{0, 0};
+  for (CachedMotor* motor : {m_motor_left_direct.get(), m_motor_right_direct.get(), m_motor_left_shared.get(), m_motor_right_shared.get()}) {
+    stats.m_issued += motor->get_write_stats().m_issued;
+    stats.m_suppressed += motor->get_write_stats().m_suppressed;
+  }
+  return stats;
+}
+
+// get voltages
+std::tuple<int, int, int, int> Transmission::get_voltages() const {
+  return std::make_tuple(
+    m_motor_left_direct->get_commanded_voltage(), m_motor_right_direct->get_commanded_voltage(),
+    m_motor_left_shared->get_commanded_voltage(), m_motor_right_shared->get_commanded_voltage()
+  );
 }
 
 // update the controllers
 void Transmission::update() {
+  State from = m_machine.get_state();
+  if (const Transition<State, Transmission>* taken = m_machine.update(*this)) record_transition(from, taken->m_to);
+}
 
-  // update state
-  if (m_state == State::RETRACTING && (m_tilter->get_angle() <= TILTER_RETRACT_THRESHOLD || std::get<2>(m_lift->get_angle()) < Lift::MAX_LOCK)) {
-    m_bias = 0;
-    m_state = State::HOLDING;
-    m_hold_controller.setTarget(0);
-  }
-  if (m_state == State::EXTENDING  && (m_tilter->get_angle() >= TILTER_EXTEND_THRESHOLD || std::get<2>(m_lift->get_angle()) < Lift::MAX_LOCK)) {
-    m_bias = 0;
-    m_state = State::HOLDING;
-    m_hold_controller.setTarget(TILTER_RETRACT_THRESHOLD.convert(degree));
-  }
-  if (m_state == State::HOLDING && m_tilter->get_angle() <= TILTER_RETRACT_THRESHOLD && std::get<2>(m_lift->get_angle()) > Lift::MAX_LOCK) m_state = State::PASSIVE;
-  if (m_state == State::PASSIVE && std::get<2>(m_lift->get_angle()) <= Lift::MAX_LOCK) {
-    m_bias = 0;
-    m_state = State::HOLDING;
-    m_hold_controller.setTarget(0);
+// transition guards
+bool Transmission::retract_done(const Transmission& transmission) {
+  return transmission.m_tilter->get_angle() <= TILTER_RETRACT_THRESHOLD || std::get<2>(transmission.m_lift->get_angle()) < Lift::MAX_LOCK;
+}
+bool Transmission::extend_done(const Transmission& transmission) {
+  return transmission.m_tilter->get_angle() >= TILTER_EXTEND_THRESHOLD || std::get<2>(transmission.m_lift->get_angle()) < Lift::MAX_LOCK;
+}
+bool Transmission::can_release(const Transmission& transmission) {
+  return transmission.m_tilter->get_angle() <= TILTER_RETRACT_THRESHOLD && std::get<2>(transmission.m_lift->get_angle()) > Lift::MAX_LOCK;
+}
+bool Transmission::must_hold(const Transmission& transmission) {
+  return std::get<2>(transmission.m_lift->get_angle()) <= Lift::MAX_LOCK;
+}
+
+// transition actions
+void Transmission::hold_retracted(Transmission& transmission) {
+  transmission.m_bias = 0;
+  transmission.m_hold_priority = HoldPriority::STACK;
+  transmission.m_hold_target = 0;
+}
+void Transmission::hold_at_threshold(Transmission& transmission) {
+  transmission.m_bias = 0;
+  transmission.m_hold_priority = HoldPriority::STACK;
+  transmission.m_hold_target = TILTER_RETRACT_THRESHOLD.convert(degree);
+}
+
+// state outputs
+void Transmission::update_passive(Transmission& transmission) {
+  transmission.m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_left_direct->moveVoltage(transmission.m_desired_chassis_voltage_left);
+  transmission.m_motor_right_direct->moveVoltage(transmission.m_desired_chassis_voltage_right);
+  transmission.m_motor_left_shared->moveVoltage(transmission.m_desired_chassis_voltage_left);
+  transmission.m_motor_right_shared->moveVoltage(transmission.m_desired_chassis_voltage_right);
+}
+
+void Transmission::update_extending(Transmission& transmission) {
+  transmission.m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_left_direct->moveVoltage(transmission.m_desired_chassis_voltage_left);
+  transmission.m_motor_right_direct->moveVoltage(transmission.m_desired_chassis_voltage_right);
+  transmission.m_motor_left_shared->moveVoltage(-12000);
+  transmission.m_motor_right_shared->moveVoltage(-12000);
+}
+
+void Transmission::update_retracting(Transmission& transmission) {
+  transmission.m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_left_direct->moveVoltage(transmission.m_desired_chassis_voltage_left);
+  transmission.m_motor_right_direct->moveVoltage(transmission.m_desired_chassis_voltage_right);
+  transmission.m_motor_left_shared->moveVoltage(12000);
+  transmission.m_motor_right_shared->moveVoltage(12000);
+}
+
+void Transmission::update_locked_passthrough(Transmission& transmission) {
+  transmission.m_motor_left_direct->setBrakeMode(Motor::brakeMode::hold);
+  transmission.m_motor_right_direct->setBrakeMode(Motor::brakeMode::hold);
+  transmission.m_motor_left_direct->moveVelocity(0);
+  transmission.m_motor_right_direct->moveVelocity(0);
+  transmission.m_motor_left_shared->moveVoltage(transmission.m_desired_tilter_voltage);
+  transmission.m_motor_right_shared->moveVoltage(transmission.m_desired_tilter_voltage);
+}
+
+void Transmission::update_holding(Transmission& transmission) {
+  double correct = control_laws::hold(
+    HOLD_KP, HOLD_KD, TILTER_HOLD_STRENGTH,
+    transmission.m_hold_target,
+    transmission.m_tilter->get_angle().convert(degree),
+    transmission.m_tilter->get_velocity().convert(degree / second)
+  );
+  Allocation allocation = allocate(
+    transmission.m_desired_chassis_voltage_left,
+    transmission.m_desired_chassis_voltage_right,
+    -correct + transmission.m_bias,
+    resolve_priority(transmission.m_hold_priority, transmission.m_stack_size.load(std::memory_order_relaxed))
+  );
+
+  // record saturation
+  SaturationStats& stats = transmission.m_saturation_stats;
+  ++stats.m_updates;
+  if (allocation.m_excess > 0) {
+    ++stats.m_saturated;
+    stats.m_max_excess = std::max<uint32_t>(stats.m_max_excess, allocation.m_excess);
+    stats.m_total_excess += allocation.m_excess;
   }
 
-  // update motors
-  switch (State::PASSIVE) {
-
-    case (State::PASSIVE): 
-      m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_left_direct->moveVoltage(m_desired_chassis_voltage_left);
-      m_motor_right_direct->moveVoltage(m_desired_chassis_voltage_right);
-      m_motor_left_shared->moveVoltage(m_desired_chassis_voltage_left);
-      m_motor_right_shared->moveVoltage(m_desired_chassis_voltage_right);
-      break;
-
-    case (State::EXTENDING):
-      m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_left_direct->moveVoltage(m_desired_chassis_voltage_left);
-      m_motor_right_direct->moveVoltage(m_desired_chassis_voltage_right);
-      m_motor_left_shared->moveVoltage(-12000);
-      m_motor_right_shared->moveVoltage(-12000);
-      break;
-
-    case (State::RETRACTING):
-      m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_left_direct->moveVoltage(m_desired_chassis_voltage_left);
-      m_motor_right_direct->moveVoltage(m_desired_chassis_voltage_right);
-      m_motor_left_shared->moveVoltage(12000);
-      m_motor_right_shared->moveVoltage(12000);
-      break;
-
-    case (State::LOCKED_PASSTHROUGH):
-      m_motor_left_direct->setBrakeMode(Motor::brakeMode::hold);
-      m_motor_right_direct->setBrakeMode(Motor::brakeMode::hold);
-      m_motor_left_direct->moveVelocity(0);
-      m_motor_right_direct->moveVelocity(0);
-      m_motor_left_shared->moveVoltage(m_desired_tilter_voltage);
-      m_motor_right_shared->moveVoltage(m_desired_tilter_voltage);
-      break;
-
-    case (State::HOLDING): {
-      double correct = m_hold_controller.step(m_tilter->get_angle().convert(degree));
-      int shared_voltage_left =  m_desired_chassis_voltage_left  - correct * TILTER_HOLD_STRENGTH + m_bias;
-      int shared_voltage_right = m_desired_chassis_voltage_right - correct * TILTER_HOLD_STRENGTH + m_bias;
-
-      double scale = 1;
-      // if (std::abs(shared_voltage_left) > 12000 || std::abs(shared_voltage_right) > 12000) 
-      //   scale = std::min(12000.0 / std::abs(shared_voltage_left), 12000.0 / std::abs(shared_voltage_right));
-      
-      m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
-      m_motor_left_direct->moveVoltage(m_desired_chassis_voltage_left * scale);
-      m_motor_right_direct->moveVoltage(m_desired_chassis_voltage_right * scale);
-      m_motor_left_shared->moveVoltage(shared_voltage_left * scale);
-      m_motor_right_shared->moveVoltage(shared_voltage_right * scale);
-    } break;
+  transmission.m_motor_left_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_right_direct->setBrakeMode(Motor::brakeMode::coast);
+  transmission.m_motor_left_direct->moveVoltage(allocation.m_direct_left);
+  transmission.m_motor_right_direct->moveVoltage(allocation.m_direct_right);
+  transmission.m_motor_left_shared->moveVoltage(allocation.m_shared_left);
+  transmission.m_motor_right_shared->moveVoltage(allocation.m_shared_right);
+}
+
+// resolve a hold priority
+Transmission::HoldPriority Transmission::resolve_priority(HoldPriority priority, size_t cubes) {
+  if (priority != HoldPriority::STACK) return priority;
+  return cubes >= HOLD_STACK_CUBES ? HoldPriority::TILTER : HoldPriority::DRIVE;
+}
+
+// set the stack size
+void Transmission::set_stack_size(size_t cubes) {
+  m_stack_size.store(cubes, std::memory_order_relaxed);
+}
+
+// split the shared motors' budget
+Transmission::Allocation Transmission::allocate(int drive_left, int drive_right, int tilter, HoldPriority priority) {
+  int excess = std::max({
+    std::abs(drive_left), std::abs(drive_right), std::abs(drive_left + tilter), std::abs(drive_right + tilter)
+  }) - MAX_VOLTAGE;
+
+  // scale down the chassis so it fits by itself
+  double scale = 1;
+  int largest = std::max(std::abs(drive_left), std::abs(drive_right));
+  if (largest > MAX_VOLTAGE) scale = double(MAX_VOLTAGE) / largest;
+
+  if (priority == HoldPriority::TILTER) {
+
+    // keep the correction, and scale the chassis until the shared motors fit around it
+    tilter = std::max(-MAX_VOLTAGE, std::min(MAX_VOLTAGE, tilter));
+    for (int drive : {drive_left, drive_right}) {
+      if (drive * scale + tilter > MAX_VOLTAGE) scale = double(MAX_VOLTAGE - tilter) / drive;
+      if (drive * scale + tilter < -MAX_VOLTAGE) scale = double(-MAX_VOLTAGE - tilter) / drive;
+    }
+  } else {
+
+    // keep the chassis, and limit the correction to the headroom left on both shared motors
+    int high = MAX_VOLTAGE - std::max(drive_left, drive_right) * scale;
+    int low = -MAX_VOLTAGE - std::min(drive_left, drive_right) * scale;
+    tilter = std::max(low, std::min(high, tilter));
   }
-}
\ No newline at end of file
+
+  int left = drive_left * scale;
+  int right = drive_right * scale;
+  return {left, right, left + tilter, right + tilter, std::max(excess, 0)};
+}
@@ -0,0 +1,575 @@
+/**
+ * Checks and measures the arbiter that gives subsystems to commands (include/lib/arbiter.hpp).
+ *
+ * First checks the arbitration rules on the same arbiter the robot runs, including from several threads at once,
+ * and exits with 1 if any check fails.
+ *
+ * Then plays random driver scripts (lift presets, a deposit, a pull out and manual lift bursts) through models of the robot's tasks
+ * at 1 ms resolution: the control mutexes that controllers polled with take(0), the arbiter with controller tasks still polling
+ * every 10 ms while idle, and the arbiter with idle controller tasks parked until their command starts.
+ * All use the real task periods: poses every 5 ms, updater jobs every 10 ms, and opcontrol every 10 ms with random phases. It counts
+ *   skipped ticks: pose ticks in which an enabled controller did not drive its subsystems, without being told
+ *   wakeups: times a controller task ran, whether or not it had anything to do
+ *   double drives: writes to a subsystem by someone other than its owner
+ *   refusals and interruptions: what the arbiter reports to callers instead of skipping
+ *
+ * Build: make tools
+ * Usage: bin/host/bench_arbiter [--runs N] [--seed S]
+ */
+#include "lib/arbiter.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  /**
+   * Subsystems, as on the robot.
+   */
+  enum Resource : ResourceSet {
+    TRANSMISSION = 1 << 0,
+    LIFT = 1 << 1,
+    INTAKE = 1 << 2,
+    NUM_RESOURCES = 3
+  };
+
+  /**
+   * Priorities, as on the robot.
+   */
+  enum Priority : int { PRESET, MACRO, DRIVER, TEST };
+
+  // a mutex for single-threaded simulation
+  struct NullMutex {
+    void lock() {}
+    void unlock() {}
+  };
+
+  // ---------------------------------------------------------------- checks
+
+  int failures = 0;
+
+  void check(bool passed, const char* what) {
+    std::printf("  %s  %s\n", passed ? "ok  " : "FAIL", what);
+    if (!passed) ++failures;
+  }
+
+  void check_rules() {
+    std::printf("arbitration rules\n");
+    Arbiter<std::mutex> arbiter;
+    int starts = 0, ends = 0;
+    bool last_interrupted = false;
+    auto end = [&](bool interrupted) {
+      ++ends;
+      last_interrupted = interrupted;
+    };
+    Command preset("preset", LIFT, PRESET, true, [&]() { ++starts; }, end);
+    Command deposit("deposit", TRANSMISSION | LIFT, MACRO, true, nullptr, end);
+    Command pull_out("pull out", TRANSMISSION | INTAKE, MACRO, true, nullptr, end);
+    Command manual("manual", LIFT, DRIVER, false, nullptr, end);
+    Command test("test", TRANSMISSION | LIFT, TEST, false, nullptr, end);
+
+    check(arbiter.schedule(preset) && arbiter.get_owner(LIFT) == preset.get_name(), "a free subsystem is granted");
+    check(starts == 1, "start runs when granted");
+    check(arbiter.schedule(preset) && starts == 1, "scheduling an active command does not restart it");
+    bool ran = false;
+    check(!arbiter.run_default(LIFT, [&]() { ran = true; }) && !ran, "the default does not run while a command owns the subsystem");
+    check(arbiter.run_default(INTAKE, [&]() { ran = true; }) && ran, "the default runs while the subsystem is idle");
+
+    check(arbiter.schedule(deposit) && !preset.is_active() && ends == 1 && last_interrupted, "a higher priority command interrupts");
+    check(arbiter.get_owner(TRANSMISSION) == deposit.get_name() && arbiter.get_owner(LIFT) == deposit.get_name(), "every requirement is granted");
+    check(!arbiter.schedule(preset) && deposit.is_active() && arbiter.get_stats(preset).m_denied == 1, "a lower priority command is refused");
+
+    check(arbiter.schedule(pull_out) && !deposit.is_active(), "an equal priority command interrupts; the newest wins");
+    check(arbiter.get_owner(LIFT) == nullptr, "an interrupted command loses all of its subsystems");
+
+    check(arbiter.schedule(manual), "an unrelated subsystem is granted alongside");
+    int before = ends;
+    check(!arbiter.schedule(test) && pull_out.is_active() && manual.is_active() && ends == before,
+      "a refusal has no side effects, even on subsystems that could be interrupted");
+    check(arbiter.get_owner(TRANSMISSION) == pull_out.get_name(), "scheduling is all or nothing");
+    check(!arbiter.schedule(deposit) && pull_out.is_active(), "a command that cannot be interrupted blocks even higher priorities");
+
+    int ticks = 0;
+    check(!arbiter.run(deposit, [&]() { ++ticks; return true; }) && ticks == 0, "an inactive command does not tick");
+    check(arbiter.run(manual, [&]() { ++ticks; return true; }) && ticks == 1, "an active command ticks");
+    check(!arbiter.run(manual, [&]() { ++ticks; return false; }) && !manual.is_active() && !last_interrupted,
+      "a command that finishes releases its subsystems and is not interrupted");
+    check(arbiter.get_owner(LIFT) == nullptr && arbiter.get_stats(manual).m_interrupted == 0, "finishing frees the subsystems");
+
+    arbiter.cancel(pull_out);
+    check(!pull_out.is_active() && last_interrupted && arbiter.get_owner(TRANSMISSION) == nullptr, "cancelling ends as interrupted");
+    before = ends;
+    arbiter.cancel(pull_out);
+    check(ends == before, "cancelling an inactive command does nothing");
+
+    Command::Stats stats = arbiter.get_stats(deposit);
+    check(stats.m_scheduled == 1 && stats.m_denied == 1 && stats.m_interrupted == 1 && stats.m_ticks == 0, "statistics count every outcome");
+  }
+
+  // commands scheduled, ticked and cancelled from several threads; every tick checks it is alone on its subsystems
+  void check_threads() {
+    std::printf("threads\n");
+    constexpr size_t THREADS = 4;
+    constexpr size_t OPERATIONS = 50000;
+    Arbiter<std::mutex> arbiter;
+    std::vector<std::unique_ptr<Command>> commands;
+    const ResourceSet requirements[] = {TRANSMISSION, LIFT, INTAKE, TRANSMISSION | LIFT, TRANSMISSION | INTAKE, LIFT | INTAKE};
+    for (size_t i = 0; i < 12; ++i) {
+      commands.push_back(std::make_unique<Command>("command", requirements[i % 6], int(i % 3), i % 4 != 0));
+    }
+    int users[NUM_RESOURCES] = {};
+    size_t overlaps = 0, defaults = 0;
+    auto enter = [&](ResourceSet resources) {
+      for (size_t i = 0; i < NUM_RESOURCES; ++i) {
+        if (resources & (1 << i) && users[i]++) ++overlaps;
+      }
+    };
+    auto leave = [&](ResourceSet resources) {
+      for (size_t i = 0; i < NUM_RESOURCES; ++i) {
+        if (resources & (1 << i)) --users[i];
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+      threads.emplace_back([&, t]() {
+        std::mt19937 rng(t);
+        for (size_t i = 0; i < OPERATIONS; ++i) {
+          Command& command = *commands[rng() % commands.size()];
+          switch (rng() % 4) {
+            case 0: arbiter.schedule(command); break;
+            case 1: arbiter.cancel(command); break;
+            case 2: arbiter.run(command, [&]() {
+              enter(command.get_requirements());
+              std::this_thread::yield();
+              leave(command.get_requirements());
+              return rng() % 16 != 0;
+            }); break;
+            case 3: arbiter.run_default(requirements[rng() % 6], [&]() { ++defaults; }); break;
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    check(overlaps == 0, "no two commands tick on the same subsystem at once");
+    check(defaults > 0, "defaults run while subsystems are idle");
+  }
+
+  // ---------------------------------------------------------------- simulation
+
+  constexpr uint32_t RUN_TIME = 12000;      ///< Length of a script, in ms
+  constexpr uint32_t POSE_PERIOD = 5;       ///< Pose notifications, in ms
+  constexpr uint32_t UPDATE_PERIOD = 10;    ///< Updater transmission and lift jobs, in ms
+  constexpr uint32_t LOOP_PERIOD = 10;      ///< Opcontrol loop, and controller tasks while idle, in ms
+  constexpr uint32_t LIFT_MOVE_TIME = 700;  ///< Driven time for a preset move to settle, in ms
+  constexpr uint32_t DEPOSIT_TIME = 1500;   ///< Driven time for a deposit to finish, in ms
+
+  /**
+   * Controllers whose ticks are counted.
+   */
+  enum Controller { DEPOSIT, PULL_OUT, LIFT_PRESET, MANUAL_LIFT, NUM_CONTROLLERS };
+  const char* const CONTROLLER_NAMES[] = {"deposit", "pull out", "lift preset", "manual lift"};
+  const ResourceSet REQUIREMENTS[] = {TRANSMISSION | LIFT, TRANSMISSION | INTAKE, LIFT, LIFT};
+
+  /**
+   * Driver inputs, read by opcontrol.
+   */
+  enum class Input { PRESET_UP, PRESET_DOWN, DEPOSIT_PRESS, DEPOSIT_RELEASE, PULL_OUT_PRESS, PULL_OUT_RELEASE, MANUAL_PRESS, MANUAL_RELEASE };
+
+  struct Event {
+    uint32_t m_time;
+    Input m_input;
+  };
+
+  struct Script {
+    std::vector<Event> m_events;                ///< Sorted by time
+    uint32_t m_loop_phase;                      ///< First opcontrol loop, in ms
+    uint32_t m_poll_phase[NUM_CONTROLLERS];     ///< First poll of each controller task, in ms
+  };
+
+  struct Counts {
+    uint64_t m_enabled[NUM_CONTROLLERS];
+    uint64_t m_skipped[NUM_CONTROLLERS];
+    uint64_t m_wakeups;
+    uint64_t m_double_drives;
+    uint64_t m_refused;
+    uint64_t m_interrupted;
+  };
+
+  // a random driver
+  Script make_script(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    auto uniform = [&](uint32_t low, uint32_t high) {
+      return std::uniform_int_distribution<uint32_t>(low, high)(rng);
+    };
+    Script script;
+    std::vector<Event>& events = script.m_events;
+    uint32_t up = uniform(200, 800);
+    events.push_back({up, Input::PRESET_UP});
+    if (uniform(0, 1)) events.push_back({uniform(up + 1000, up + 2000), Input::PRESET_DOWN});
+    uint32_t deposit = uniform(2500, 3500);
+    events.push_back({deposit, Input::DEPOSIT_PRESS});
+    events.push_back({deposit + 2000, Input::DEPOSIT_RELEASE});
+    uint32_t pull_out = deposit + 2200 + uniform(0, 500);
+    events.push_back({pull_out, Input::PULL_OUT_PRESS});
+    events.push_back({pull_out + 800, Input::PULL_OUT_RELEASE});
+    for (int i = 0; i < 2; ++i) {
+      uint32_t manual = uniform(0, 10000);
+      events.push_back({manual, Input::MANUAL_PRESS});
+      events.push_back({manual + uniform(150, 400), Input::MANUAL_RELEASE});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.m_time < b.m_time; });
+    script.m_loop_phase = uniform(0, LOOP_PERIOD - 1);
+    for (uint32_t& phase : script.m_poll_phase) phase = uniform(0, LOOP_PERIOD - 1);
+    return script;
+  }
+
+  /**
+   * State shared by both models: the mechanisms' progress and the driver's buttons.
+   */
+  struct Plant {
+    bool m_lift_up = false;           ///< Target of the last preset move
+    uint32_t m_lift_progress = LIFT_MOVE_TIME;
+    uint32_t m_deposit_progress = 0;
+    bool m_manual_pressed = false;
+  };
+
+  // the old scheme: controllers poll the subsystems' control mutexes with take(0)
+  class MutexModel {
+
+  public:
+
+    MutexModel(const Script& script): m_script(script) {
+      for (size_t c = 0; c < NUM_CONTROLLERS; ++c) m_tasks[c].m_next_poll = script.m_poll_phase[c];
+    }
+
+    Counts run() {
+      Counts counts = {};
+      size_t next_event = 0;
+      for (uint32_t now = 0; now < RUN_TIME; ++now) {
+        bool pose_tick = now % POSE_PERIOD == 0;
+
+        // updater
+        if (now % UPDATE_PERIOD == 0) {
+          if (m_owners[0] < 0) write(counts, TRANSMISSION, -1);
+          if (m_owners[1] < 0) write(counts, LIFT, -1);
+        }
+
+        // controller tasks
+        for (Controller c : {DEPOSIT, PULL_OUT, LIFT_PRESET}) {
+          Task& task = m_tasks[c];
+          bool enabled = task.m_enabled;
+          bool drove = false;
+          if (!task.m_holding && now >= task.m_next_poll) {
+            task.m_next_poll = now + LOOP_PERIOD;
+            ++counts.m_wakeups;
+            if (task.m_enabled && take(c)) {
+              task.m_holding = true;
+              if (c == DEPOSIT) m_plant.m_deposit_progress = 0;
+            }
+          }
+          if (task.m_holding && pose_tick) {
+            ++counts.m_wakeups;
+            if (task.m_enabled) {
+              drove = true;
+              tick(counts, c);
+            }
+            if (!task.m_enabled) {
+              give(c);
+              task.m_holding = false;
+              task.m_next_poll = now + LOOP_PERIOD;
+            }
+          }
+          if (pose_tick && enabled) {
+            ++counts.m_enabled[c];
+            if (!drove) ++counts.m_skipped[c];
+          }
+        }
+
+        // opcontrol
+        if (now % LOOP_PERIOD == m_script.m_loop_phase) {
+          while (next_event < m_script.m_events.size() && m_script.m_events[next_event].m_time <= now) {
+            input(m_script.m_events[next_event++].m_input);
+          }
+          if (m_owners[0] < 0) write(counts, TRANSMISSION, -1);
+          write(counts, INTAKE, -1);
+          if (m_plant.m_manual_pressed) {
+            m_tasks[LIFT_PRESET].m_enabled = false;
+            ++counts.m_enabled[MANUAL_LIFT];
+            if (m_owners[1] < 0) write(counts, LIFT, MANUAL_LIFT);
+            else ++counts.m_skipped[MANUAL_LIFT];
+          }
+        }
+      }
+      return counts;
+    }
+
+  private:
+
+    struct Task {
+      bool m_enabled = false;
+      bool m_holding = false;
+      uint32_t m_next_poll = 0;
+    };
+
+    const Script& m_script;
+    Plant m_plant;
+    Task m_tasks[NUM_CONTROLLERS];
+    int m_owners[NUM_RESOURCES] = {-1, -1, -1};
+
+    // take every mutex, or none
+    bool take(Controller c) {
+      for (size_t i = 0; i < NUM_RESOURCES; ++i) {
+        if (REQUIREMENTS[c] & (1 << i) && m_owners[i] >= 0) return false;
+      }
+      for (size_t i = 0; i < NUM_RESOURCES; ++i) {
+        if (REQUIREMENTS[c] & (1 << i)) m_owners[i] = c;
+      }
+      return true;
+    }
+
+    void give(Controller c) {
+      for (size_t i = 0; i < NUM_RESOURCES; ++i) {
+        if (m_owners[i] == c) m_owners[i] = -1;
+      }
+    }
+
+    void write(Counts& counts, Resource resource, int writer) {
+      int owner = m_owners[resource == TRANSMISSION ? 0 : resource == LIFT ? 1 : 2];
+      if (owner >= 0 && owner != writer) ++counts.m_double_drives;
+    }
+
+    void tick(Counts& counts, Controller c) {
+      for (Resource resource : {TRANSMISSION, LIFT, INTAKE}) {
+        if (REQUIREMENTS[c] & resource) write(counts, resource, c);
+      }
+      if (c == DEPOSIT && (m_plant.m_deposit_progress += POSE_PERIOD) >= DEPOSIT_TIME) m_tasks[c].m_enabled = false;
+      if (c == LIFT_PRESET && (m_plant.m_lift_progress += POSE_PERIOD) >= LIFT_MOVE_TIME && !m_plant.m_lift_up) m_tasks[c].m_enabled = false;
+    }
+
+    void input(Input input) {
+      switch (input) {
+        case Input::PRESET_UP:
+        case Input::PRESET_DOWN:
+          m_plant.m_lift_up = input == Input::PRESET_UP;
+          m_plant.m_lift_progress = 0;
+          m_tasks[LIFT_PRESET].m_enabled = true;
+          break;
+        case Input::DEPOSIT_PRESS: m_tasks[DEPOSIT].m_enabled = true; break;
+        case Input::DEPOSIT_RELEASE: m_tasks[DEPOSIT].m_enabled = false; break;
+        case Input::PULL_OUT_PRESS: m_tasks[PULL_OUT].m_enabled = true; break;
+        case Input::PULL_OUT_RELEASE: m_tasks[PULL_OUT].m_enabled = false; break;
+        case Input::MANUAL_PRESS: m_plant.m_manual_pressed = true; break;
+        case Input::MANUAL_RELEASE: m_plant.m_manual_pressed = false; break;
+      }
+    }
+  };
+
+  // the new scheme: controllers are commands given their subsystems by the arbiter
+  class ArbiterModel {
+
+  public:
+
+    ArbiterModel(const Script& script, bool parked):
+      m_script(script),
+      m_parked(parked),
+      m_commands{
+        {CONTROLLER_NAMES[DEPOSIT], REQUIREMENTS[DEPOSIT], MACRO, true, [this]() { m_plant.m_deposit_progress = 0; }},
+        {CONTROLLER_NAMES[PULL_OUT], REQUIREMENTS[PULL_OUT], MACRO, true},
+        {CONTROLLER_NAMES[LIFT_PRESET], REQUIREMENTS[LIFT_PRESET], PRESET, true},
+        {CONTROLLER_NAMES[MANUAL_LIFT], REQUIREMENTS[MANUAL_LIFT], DRIVER, false}
+      }
+    {
+      for (size_t c = 0; c < NUM_CONTROLLERS; ++c) m_tasks[c].m_next_poll = script.m_poll_phase[c];
+    }
+
+    Counts run() {
+      Counts counts = {};
+      size_t next_event = 0;
+      for (uint32_t now = 0; now < RUN_TIME; ++now) {
+        bool pose_tick = now % POSE_PERIOD == 0;
+
+        // updater
+        if (now % UPDATE_PERIOD == 0) {
+          m_arbiter.run_default(TRANSMISSION, [&]() { write(counts, TRANSMISSION, nullptr); });
+          m_arbiter.run_default(LIFT, [&]() { write(counts, LIFT, nullptr); });
+        }
+
+        // controller tasks
+        for (Controller c : {DEPOSIT, PULL_OUT, LIFT_PRESET}) {
+          Task& task = m_tasks[c];
+          Command& command = m_commands[c];
+          bool active = command.is_active();
+          bool drove = false;
+          bool woken = false;
+          if (m_parked) {
+
+            // parked until the command starts, then ticks at once
+            woken = !task.m_ticking && command.is_active();
+            if (woken) task.m_ticking = true;
+          }
+          else if (!task.m_ticking && now >= task.m_next_poll) {
+            task.m_next_poll = now + LOOP_PERIOD;
+            ++counts.m_wakeups;
+            task.m_ticking = command.is_active();
+          }
+          if (task.m_ticking && (pose_tick || woken)) {
+            ++counts.m_wakeups;
+            m_arbiter.run(command, [&]() {
+              drove = true;
+              return tick(counts, c);
+            });
+            if (!command.is_active()) {
+              task.m_ticking = false;
+              task.m_next_poll = now + LOOP_PERIOD;
+            }
+          }
+          if (pose_tick && active) {
+            ++counts.m_enabled[c];
+            if (!drove) ++counts.m_skipped[c];
+          }
+        }
+
+        // opcontrol
+        if (now % LOOP_PERIOD == m_script.m_loop_phase) {
+          while (next_event < m_script.m_events.size() && m_script.m_events[next_event].m_time <= now) {
+            input(m_script.m_events[next_event++].m_input);
+          }
+          m_arbiter.run_default(TRANSMISSION, [&]() { write(counts, TRANSMISSION, nullptr); });
+          m_arbiter.run_default(INTAKE, [&]() { write(counts, INTAKE, nullptr); });
+          Command& manual = m_commands[MANUAL_LIFT];
+          if (m_plant.m_manual_pressed) {
+            m_arbiter.schedule(manual);
+            if (manual.is_active()) {
+              ++counts.m_enabled[MANUAL_LIFT];
+              if (!m_arbiter.run(manual, [&]() { write(counts, LIFT, manual.get_name()); return true; })) ++counts.m_skipped[MANUAL_LIFT];
+            }
+          }
+          else m_arbiter.cancel(manual);
+        }
+      }
+      for (const Command& command : m_commands) {
+        Command::Stats stats = m_arbiter.get_stats(command);
+        counts.m_refused += stats.m_denied;
+        counts.m_interrupted += stats.m_interrupted;
+      }
+      return counts;
+    }
+
+  private:
+
+    struct Task {
+      bool m_ticking = false;
+      uint32_t m_next_poll = 0;
+    };
+
+    const Script& m_script;
+    bool m_parked;
+    Plant m_plant;
+    Arbiter<NullMutex> m_arbiter;
+    Command m_commands[NUM_CONTROLLERS];
+    Task m_tasks[NUM_CONTROLLERS];
+
+    // the null mutex lets this ask the arbiter from inside its ticks
+    void write(Counts& counts, Resource resource, const char* writer) {
+      const char* owner = m_arbiter.get_owner(resource);
+      if (owner && owner != writer) ++counts.m_double_drives;
+    }
+
+    bool tick(Counts& counts, Controller c) {
+      for (Resource resource : {TRANSMISSION, LIFT, INTAKE}) {
+        if (REQUIREMENTS[c] & resource) write(counts, resource, m_commands[c].get_name());
+      }
+      if (c == DEPOSIT) return (m_plant.m_deposit_progress += POSE_PERIOD) < DEPOSIT_TIME;
+      if (c == LIFT_PRESET) return (m_plant.m_lift_progress += POSE_PERIOD) < LIFT_MOVE_TIME || m_plant.m_lift_up;
+      return true;
+    }
+
+    void input(Input input) {
+      switch (input) {
+        case Input::PRESET_UP:
+        case Input::PRESET_DOWN:
+          m_plant.m_lift_up = input == Input::PRESET_UP;
+          m_plant.m_lift_progress = 0;
+          m_arbiter.schedule(m_commands[LIFT_PRESET]);
+          break;
+        case Input::DEPOSIT_PRESS: m_arbiter.schedule(m_commands[DEPOSIT]); break;
+        case Input::DEPOSIT_RELEASE: m_arbiter.cancel(m_commands[DEPOSIT]); break;
+        case Input::PULL_OUT_PRESS: m_arbiter.schedule(m_commands[PULL_OUT]); break;
+        case Input::PULL_OUT_RELEASE: m_arbiter.cancel(m_commands[PULL_OUT]); break;
+        case Input::MANUAL_PRESS: m_plant.m_manual_pressed = true; break;
+        case Input::MANUAL_RELEASE: m_plant.m_manual_pressed = false; break;
+      }
+    }
+  };
+
+  void report(const char* name, const Counts& counts, size_t runs) {
+    std::printf("%s\n", name);
+    uint64_t enabled = 0, skipped = 0;
+    for (size_t c = 0; c < NUM_CONTROLLERS; ++c) {
+      enabled += counts.m_enabled[c];
+      skipped += counts.m_skipped[c];
+      std::printf("  %-12s %10llu enabled ticks %9llu skipped (%5.2f%%)\n", CONTROLLER_NAMES[c],
+        (unsigned long long)counts.m_enabled[c], (unsigned long long)counts.m_skipped[c],
+        counts.m_enabled[c] ? 100.0 * counts.m_skipped[c] / counts.m_enabled[c] : 0.0
+      );
+    }
+    std::printf("  %-12s %10llu enabled ticks %9llu skipped (%5.2f%%), %.1f per run\n", "total",
+      (unsigned long long)enabled, (unsigned long long)skipped, enabled ? 100.0 * skipped / enabled : 0.0, double(skipped) / runs
+    );
+    std::printf("  controller task wakeups %.0f per run\n", double(counts.m_wakeups) / runs);
+    std::printf("  double drives %llu, refusals %llu, interruptions %llu\n",
+      (unsigned long long)counts.m_double_drives, (unsigned long long)counts.m_refused, (unsigned long long)counts.m_interrupted
+    );
+  }
+
+  void add(Counts& total, const Counts& counts) {
+    for (size_t c = 0; c < NUM_CONTROLLERS; ++c) {
+      total.m_enabled[c] += counts.m_enabled[c];
+      total.m_skipped[c] += counts.m_skipped[c];
+    }
+    total.m_wakeups += counts.m_wakeups;
+    total.m_double_drives += counts.m_double_drives;
+    total.m_refused += counts.m_refused;
+    total.m_interrupted += counts.m_interrupted;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 1000;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "--runs") && i + 1 < argc) runs = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed S]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  check_rules();
+  check_threads();
+  if (failures) {
+    std::printf("%d checks failed\n", failures);
+    return 1;
+  }
+
+  Counts mutexes = {}, polled = {}, parked = {};
+  for (size_t run = 0; run < runs; ++run) {
+    Script script = make_script(seed * 1000003 + run);
+    add(mutexes, MutexModel(script).run());
+    add(polled, ArbiterModel(script, false).run());
+    add(parked, ArbiterModel(script, true).run());
+  }
+  std::printf("\n%zu scripts of %u ms\n", runs, RUN_TIME);
+  report("control mutexes polled with take(0)", mutexes, runs);
+  report("arbiter, idle tasks polling every 10 ms", polled, runs);
+  report("arbiter, idle tasks parked until their command starts", parked, runs);
+  return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * Host benchmark of CachedMotor (lib/cached_motor.hpp) against a plain okapi Motor, on a motor that drops out.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_cached_motor [--runs N] [--seed N]
+ *
+ * Each run is a minute of a 10 ms control loop commanding two simulated motors (tools/sim/) the same voltages:
+ * held setpoints, ramps that change every tick, and stops. Both motors are unplugged now and then, as a loose cable
+ * does; writes to them fail while they are, and they come back stopped. The plain Motor writes every command, the
+ * CachedMotor only changed ones and keep-alives, so the report compares writes against the time each motor spends
+ * plugged in but not doing what it was last told.
+ */
+
+#include "sim/sim.hpp"
+#include "lib/cached_motor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // the loop's period and each run's length, in ms
+  constexpr uint32_t PERIOD = 10;
+  constexpr uint32_t RUN = 60000;
+
+  // unplugged with this chance per tick, for up to this many ticks
+  constexpr double DROPOUT = .002;
+  constexpr int DROPOUT_TICKS = 50;
+
+  // ports no mechanism of the simulated robot uses
+  constexpr uint8_t CACHED_PORT = 3;
+  constexpr uint8_t PLAIN_PORT = 4;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // what one motor did over a run
+  struct Outcome {
+    uint32_t m_writes;  ///< Writes that reached the port, failed or not
+    uint32_t m_stale;   ///< ms plugged in with a command other than the last one given
+  };
+
+  // a command stream: holds, ramps and stops
+  class Commands {
+  public:
+    explicit Commands(uint64_t seed): m_rng(seed) {}
+
+    int16_t next() {
+      std::uniform_real_distribution<double> uniform(0, 1);
+      if (m_left-- == 0) {
+        double kind = uniform(m_rng);
+        m_left = 20 + int(180 * uniform(m_rng));
+        m_target = kind < .3 ? 0 : std::lround((uniform(m_rng) * 24000 - 12000) / 100) * 100;
+        m_ramp = kind > .7;
+      }
+      if (!m_ramp) m_value = m_target;
+      else m_value += std::max<int32_t>(-400, std::min<int32_t>(400, m_target - m_value));
+      return m_value;
+    }
+
+  private:
+    std::mt19937_64 m_rng;
+    int m_left = 0;
+    int32_t m_target = 0;
+    int32_t m_value = 0;
+    bool m_ramp = false;
+  };
+
+  // one run on the simulated clock
+  void run(uint64_t seed, Outcome& cached_outcome, Outcome& plain_outcome) {
+    sim::Motor& cached_port = sim::robot().motor(CACHED_PORT);
+    sim::Motor& plain_port = sim::robot().motor(PLAIN_PORT);
+    cached_port = plain_port = sim::Motor();
+    CachedMotor cached(CACHED_PORT, false, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees);
+    Motor plain(PLAIN_PORT, false, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees);
+    Commands commands(seed);
+    std::mt19937_64 rng(mix(seed));
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    int unplugged = 0;
+    int16_t command = 0;
+    cached_outcome = plain_outcome = {0, 0};
+    for (uint32_t time = 0; time < RUN; time += PERIOD) {
+
+      // a dropout; the motors come back stopped
+      if (!unplugged && uniform(rng) < DROPOUT) unplugged = 1 + int(uniform(rng) * DROPOUT_TICKS);
+      bool connected = !unplugged;
+      if (unplugged && !--unplugged) {
+        for (sim::Motor* port : {&cached_port, &plain_port}) port->m_command = 0, port->m_mode = sim::Motor::Mode::VOLTAGE;
+      }
+      cached_port.m_connected = plain_port.m_connected = connected;
+
+      command = commands.next();
+      cached.moveVoltage(command);
+      plain.moveVoltage(command);
+
+      // what each motor acts on until the next tick
+      if (connected) {
+        cached_outcome.m_stale += cached_port.m_command != command ? PERIOD : 0;
+        plain_outcome.m_stale += plain_port.m_command != command ? PERIOD : 0;
+      }
+      pros::delay(PERIOD);
+    }
+    cached_outcome.m_writes = cached_port.m_writes;
+    plain_outcome.m_writes = plain_port.m_writes;
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, double scale, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-16s mean %8.2f  sd %7.2f  p5 %8.2f  p50 %8.2f  p95 %8.2f  max %8.2f %s\n", name,
+      mean * scale, deviation * scale, percentile(values, .05) * scale, percentile(values, .5) * scale,
+      percentile(values, .95) * scale, values.back() * scale, unit
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 100;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  // runs follow each other on one simulated clock
+  std::vector<Outcome> cached(runs), plain(runs);
+  auto begin = std::chrono::steady_clock::now();
+  sim::run([&]() {
+    for (size_t i = 0; i < runs; ++i) run(mix(seed ^ mix(i)), cached[i], plain[i]);
+  }, uint32_t(runs * RUN + 1000));
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::vector<double> cached_writes, plain_writes, cached_stale, plain_stale;
+  for (size_t i = 0; i < runs; ++i) {
+    cached_writes.push_back(cached[i].m_writes);
+    plain_writes.push_back(plain[i].m_writes);
+    cached_stale.push_back(cached[i].m_stale);
+    plain_stale.push_back(plain[i].m_stale);
+  }
+  std::printf("%zu runs of %u s, seed %llu\n", runs, RUN / 1000, (unsigned long long)seed);
+  report("plain writes", plain_writes, 1000.0 / RUN, "per s");
+  report("cached writes", cached_writes, 1000.0 / RUN, "per s");
+  report("plain stale", plain_stale, 1000.0 / RUN, "ms per s");
+  report("cached stale", cached_stale, 1000.0 / RUN, "ms per s");
+  std::fprintf(stderr, "%.2f s (%.0f runs/s)\n", seconds, runs / seconds);
+
+  // the cost of a call that is withheld, and of one that is sent, outside the simulated clock
+  CachedMotor motor(CACHED_PORT, false, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees);
+  sim::robot().motor(CACHED_PORT).m_connected = true;
+  constexpr size_t CALLS = 10000000;
+  begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < CALLS; ++i) motor.moveVoltage(6000);
+  double withheld = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / CALLS;
+  begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < CALLS; ++i) motor.moveVoltage(int16_t(i & 1023));
+  double sent = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / CALLS;
+  std::fprintf(stderr, "%.1f ns per withheld command, %.1f ns per sent command\n", withheld * 1e9, sent * 1e9);
+
+  std::fflush(stdout);
+  std::_Exit(0);
+}
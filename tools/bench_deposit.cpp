@@ -0,0 +1,241 @@
+/**
+ * Host benchmark of the deposit (TilterController) against the PID it replaced, by stack size, on a simulated robot.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_deposit [--runs N] [--seed N] [--threads N]
+ *
+ * Each run is a fresh robot (tools/sim/) with its own disturbances: initialize(), a stack pulled in by the intake,
+ * then one deposit from the retracted tray, with the lift driven down as both controllers drive it. The deposit is
+ * either TilterController, after the intake's count is set to the true stack size, or a model of the old controller copied from its last version:
+ * okapi's IterativePosPIDController (kP .015, kI 0, kD .005, 10 ms samples, output clamped to +-1) toward
+ * Tilter::MAX_EXTENDED, times -12000 mV, until the tray passes Transmission::TILTER_EXTEND_THRESHOLD.
+ * The simulator has no model of a stack toppling, so the report gives the tray's fastest speed from
+ * TilterController::DEPOSIT_SLOW_FROM on, and its speed as it reaches the threshold, as measures of how gently the
+ * stack arrives, with the time to reach it, for every stack size. Speeds are shown next to the speed at which the stack
+ * would tip if the tray stopped dead (TilterController::get_tip_velocity()).
+ *
+ * The robot code keeps its state in globals, so every run is a child process, as in evaluate_autonomous.cpp.
+ */
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "controllers/controllers.hpp"
+#include "subsystems/subsystems.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // the robot settles this long after initialize(), each cube takes this long to pull in, and a deposit that takes
+  // longer than this fails, in ms
+  constexpr uint32_t SETTLE = 500;
+  constexpr uint32_t CUBE_LOAD = 350;
+  constexpr uint32_t DEPOSIT_LIMIT = 10000;
+
+  // the stack sizes benchmarked
+  constexpr size_t STACKS[] = {0, 2, 4, 6, 8, 10, 12};
+  constexpr size_t NUM_STACKS = sizeof(STACKS) / sizeof(STACKS[0]);
+
+  // the old controller's gains and sample time, from its last version
+  constexpr double OLD_KP = .015;
+  constexpr double OLD_KD = .005;
+  constexpr double OLD_SAMPLE = .01;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // the result of one deposit
+  struct Outcome {
+    bool m_ran;         ///< The child reported back
+    bool m_loaded;      ///< The intake pulled in the whole stack
+    bool m_finished;    ///< The tray passed the threshold within DEPOSIT_LIMIT
+    double m_time;      ///< ms until it did
+    double m_arrival;   ///< deg/s as it did
+    double m_late_peak; ///< deg/s at most, from TilterController::DEPOSIT_SLOW_FROM to the threshold
+  };
+
+  // the old controller's tick: a position PID on the tray angle
+  class OldPid {
+  public:
+    double step(double angle) {
+      double error = Tilter::MAX_EXTENDED.convert(degree) - angle;
+      double derivative = m_first ? 0 : angle - m_last;
+      m_first = false;
+      m_last = angle;
+      return std::max(-1.0, std::min(1.0, OLD_KP * error - OLD_KD / OLD_SAMPLE * derivative));
+    }
+
+  private:
+    bool m_first = true;
+    double m_last = 0;
+  };
+
+  // initialize(), the stack, and one deposit on a fresh robot; only call once per process
+  Outcome simulate(uint64_t seed, size_t cubes, bool old) {
+    using namespace subsystems;
+    sim::robot().reset(seed);
+    Outcome outcome{true, false, false, double(DEPOSIT_LIMIT), 0, 0};
+    double slow_from = TilterController::DEPOSIT_SLOW_FROM.convert(degree);
+    double threshold = Transmission::TILTER_EXTEND_THRESHOLD.convert(degree);
+    uint32_t start = 0;
+    double last_angle = 0;
+    sim::run([&]() {
+      initialize();
+      pros::delay(SETTLE);
+
+      // pull the stack in
+      for (size_t i = 0; i < cubes; ++i) sim::robot().feed_cube();
+      intake->move_voltage(12000);
+      pros::delay(cubes * CUBE_LOAD + SETTLE);
+      intake->lock();
+      outcome.m_loaded = sim::robot().get_cube_count() == cubes;
+      intake->set_cube_count(cubes);
+      pros::delay(SETTLE);
+
+      // deposit
+      start = pros::millis();
+      if (old) {
+        OldPid pid;
+        Command deposit("old deposit", RESOURCE_TRANSMISSION | RESOURCE_LIFT, PRIORITY_MACRO, true);
+        arbiter->schedule(deposit);
+        while (pros::millis() - start < DEPOSIT_LIMIT && tilter->get_angle().convert(degree) < threshold) {
+          arbiter->run(deposit, [&]() {
+            lift->move_voltage(-4500);
+            tilter->move_voltage(pid.step(tilter->get_angle().convert(degree)) * -12000);
+            transmission->update();
+            return true;
+          });
+          pros::delay(10);
+        }
+        arbiter->cancel(deposit);
+      }
+      else {
+        subsystem_controllers::tilter_controller->enable();
+        pros::delay(DEPOSIT_LIMIT);
+      }
+    }, SETTLE * 3 + cubes * CUBE_LOAD + DEPOSIT_LIMIT + 100, [&]() {
+
+      // the true tray, until it first passes the threshold
+      double angle = sim::robot().get_tilter_angle();
+      if (start && !outcome.m_finished && angle >= slow_from) {
+        outcome.m_late_peak = std::max(outcome.m_late_peak, (angle - last_angle) * 1000);
+      }
+      if (start && !outcome.m_finished && angle >= threshold) {
+        outcome.m_finished = true;
+        outcome.m_time = pros::millis() - start;
+        outcome.m_arrival = (angle - last_angle) * 1000;
+      }
+      last_angle = angle;
+    });
+    return outcome;
+  }
+
+  // one run in a child process
+  Outcome run(uint64_t seed, size_t cubes, bool old) {
+    Outcome outcome{};
+    int fds[2];
+    if (pipe(fds)) return outcome;
+    pid_t pid = fork();
+    if (pid == 0) {
+
+      // the robot's telemetry goes to stdout
+      int null = open("/dev/null", O_WRONLY);
+      dup2(null, STDOUT_FILENO);
+      close(fds[0]);
+      outcome = simulate(seed, cubes, old);
+      ssize_t written = write(fds[1], &outcome, sizeof(outcome));
+      _exit(written == sizeof(outcome) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+      if (read(fds[0], &outcome, sizeof(outcome)) != sizeof(outcome)) outcome = Outcome{};
+      waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return outcome;
+  }
+
+  // mean of the finished deposits' values
+  double mean(const std::vector<Outcome>& outcomes, double Outcome::* value) {
+    double sum = 0;
+    size_t count = 0;
+    for (const Outcome& outcome : outcomes) {
+      if (!outcome.m_finished) continue;
+      sum += outcome.*value;
+      ++count;
+    }
+    return count ? sum / count : NAN;
+  }
+
+  size_t count(const std::vector<Outcome>& outcomes, bool Outcome::* flag) {
+    size_t total = 0;
+    for (const Outcome& outcome : outcomes) total += outcome.*flag;
+    return total;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 10;
+  uint64_t seed = 1;
+  size_t threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--threads") && has_value) threads = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N] [--threads N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  // children inherit unflushed output
+  std::fflush(stdout);
+  std::fflush(stderr);
+
+  // every stack size on the same robots, with each controller
+  WorkStealingPool pool(threads);
+  std::vector<Outcome> outcomes(NUM_STACKS * 2 * runs);
+  auto begin = std::chrono::steady_clock::now();
+  pool.run(outcomes.size(), [&](size_t index) {
+    size_t stack = index / (2 * runs), old = index / runs % 2, robot = index % runs;
+    outcomes[index] = run(mix(seed ^ mix(robot)), STACKS[stack], old);
+  });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::printf("%zu robots per stack, seed %llu; means over the deposits that reached %.0f deg, speeds in deg/s\n",
+    runs, (unsigned long long)seed, Transmission::TILTER_EXTEND_THRESHOLD.convert(degree));
+  std::printf("%6s %6s  %10s %9s %9s %9s  %10s %9s %9s %9s\n",
+    "cubes", "tip", "profile ms", "late peak", "arrival", "reached", "PID ms", "late peak", "arrival", "reached");
+  for (size_t stack = 0; stack < NUM_STACKS; ++stack) {
+    std::vector<Outcome> profile(&outcomes[stack * 2 * runs], &outcomes[stack * 2 * runs + runs]);
+    std::vector<Outcome> pid(&outcomes[stack * 2 * runs + runs], &outcomes[stack * 2 * runs + 2 * runs]);
+    std::printf("%6zu %6.1f  %10.0f %9.1f %9.1f %5zu/%-3zu  %10.0f %9.1f %9.1f %5zu/%-3zu\n", STACKS[stack],
+      TilterController::get_tip_velocity(STACKS[stack]).convert(degree / second),
+      mean(profile, &Outcome::m_time), mean(profile, &Outcome::m_late_peak), mean(profile, &Outcome::m_arrival),
+      count(profile, &Outcome::m_finished), runs,
+      mean(pid, &Outcome::m_time), mean(pid, &Outcome::m_late_peak), mean(pid, &Outcome::m_arrival),
+      count(pid, &Outcome::m_finished), runs
+    );
+  }
+  size_t unloaded = outcomes.size() - count(outcomes, &Outcome::m_loaded);
+  if (unloaded) std::printf("%zu runs did not pull in their whole stack\n", unloaded);
+  std::fprintf(stderr, "%.2f s on %zu threads\n", seconds, pool.size());
+}
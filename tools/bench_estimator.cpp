@@ -0,0 +1,139 @@
+/**
+ * Host benchmark of DerivativeEstimator against okapi's VelMath.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_estimator [trace.csv ...]
+ *
+ * Synthetic traces are generated with the sampling the subsystems really see: a 10 ms loop with jitter
+ * and occasional extra steps from other tasks, and positions quantized to encoder ticks.
+ * Recorded traces are CSV files of "time_ms,position" rows (for example a column of tools/telemetry_link.py output);
+ * as they have no ground truth, they are compared against a centred fit over the whole neighbourhood of each sample.
+ */
+
+#include "lib/derivative_estimator.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+  struct Sample {
+    uint32_t m_time;
+    double m_position;
+    double m_velocity;
+    double m_acceleration;
+  };
+
+  /**
+   * Model of okapi::VelMath as built by VelMathFactory::create(360, 5_ms):
+   * a finite difference over the time since the last accepted step, averaged over two steps,
+   * with steps closer than the sample time ignored.
+   */
+  class VelMathModel {
+  public:
+    void step(double position, uint32_t time) {
+      if (m_started && time - m_last_time < 5) return;
+      if (m_started) {
+        double dt = (time - m_last_time) * .001;
+        double raw = (position - m_last_position) / dt;
+        double velocity = (raw + m_last_raw) * .5;
+        m_acceleration = (velocity - m_velocity) / dt;
+        m_velocity = velocity;
+        m_last_raw = raw;
+      }
+      m_started = true;
+      m_last_position = position;
+      m_last_time = time;
+    }
+    double m_velocity = 0;
+    double m_acceleration = 0;
+  private:
+    bool m_started = false;
+    double m_last_position = 0;
+    double m_last_raw = 0;
+    uint32_t m_last_time = 0;
+  };
+
+  // synthetic trace: a lift moving between presets, with jittered, irregular sampling and quantization
+  std::vector<Sample> synthetic(unsigned seed, double tick) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(-2, 2);
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::vector<Sample> samples;
+    uint32_t time = 0;
+    while (time < 10000) {
+      double t = time * .001;
+      double position = 40 * std::sin(1.3 * t) + 15 * std::sin(3.1 * t + 1);
+      double velocity = 52 * std::cos(1.3 * t) + 46.5 * std::cos(3.1 * t + 1);
+      double acceleration = -67.6 * std::sin(1.3 * t) - 144.15 * std::sin(3.1 * t + 1);
+      samples.push_back({time, tick > 0 ? std::round(position / tick) * tick : position, velocity, acceleration});
+      time += chance(rng) < .2 ? 1 + rng() % 4 : 10 + jitter(rng);
+    }
+    return samples;
+  }
+
+  // reference derivatives of a recorded trace from a centred quadratic fit
+  void reference(std::vector<Sample>& samples) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+      DerivativeEstimator centred(DerivativeEstimator::MAX_WINDOW, 1000);
+      size_t begin = i >= 7 ? i - 7 : 0;
+      size_t end = std::min(samples.size(), i + 8);
+      for (size_t j = begin; j < end; ++j) centred.step(samples[j].m_position, samples[j].m_time);
+
+      // the fit is at the newest sample; extrapolate back to sample i
+      double dt = (samples[end - 1].m_time - samples[i].m_time) * .001;
+      samples[i].m_acceleration = centred.get_acceleration();
+      samples[i].m_velocity = centred.get_velocity() - centred.get_acceleration() * dt;
+    }
+  }
+
+  void compare(const char* name, const std::vector<Sample>& samples) {
+    VelMathModel velmath;
+    DerivativeEstimator estimator;
+    double velmath_velocity = 0, velmath_acceleration = 0, estimator_velocity = 0, estimator_acceleration = 0;
+    size_t count = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const Sample& sample = samples[i];
+      velmath.step(sample.m_position, sample.m_time);
+      estimator.step(sample.m_position, sample.m_time);
+      if (i < 20) continue;
+      velmath_velocity += std::pow(velmath.m_velocity - sample.m_velocity, 2);
+      velmath_acceleration += std::pow(velmath.m_acceleration - sample.m_acceleration, 2);
+      estimator_velocity += std::pow(estimator.get_velocity() - sample.m_velocity, 2);
+      estimator_acceleration += std::pow(estimator.get_acceleration() - sample.m_acceleration, 2);
+      ++count;
+    }
+    std::printf("%-28s RMS velocity error: VelMath %9.2f, estimator %9.2f   RMS acceleration error: VelMath %10.1f, estimator %10.1f\n",
+      name,
+      std::sqrt(velmath_velocity / count), std::sqrt(estimator_velocity / count),
+      std::sqrt(velmath_acceleration / count), std::sqrt(estimator_acceleration / count)
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  compare("synthetic, 1 deg ticks", synthetic(1, 1));
+  compare("synthetic, 0.2 deg ticks", synthetic(2, .2));
+  compare("synthetic, exact", synthetic(3, 0));
+
+  for (int i = 1; i < argc; ++i) {
+    FILE* file = std::fopen(argv[i], "r");
+    if (!file) {
+      std::perror(argv[i]);
+      return 1;
+    }
+    std::vector<Sample> samples;
+    unsigned time;
+    double position;
+    char line[256];
+    while (std::fgets(line, sizeof(line), file)) {
+      if (std::sscanf(line, "%u,%lf", &time, &position) == 2) samples.push_back({time, position, 0, 0});
+    }
+    std::fclose(file);
+    reference(samples);
+    compare(argv[i], samples);
+  }
+}
@@ -0,0 +1,285 @@
+/**
+ * Host benchmark of how the transmission splits the shared motors while it holds the tray (Transmission::allocate()),
+ * against plain clipping, on a simulated robot.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_hold_allocation [--runs N] [--seed N]
+ *
+ * Each run pulls a stack into the tray (or none), raises the tray to a hold target with the lift down, so the tray is
+ * free, then drives a scripted
+ * sequence of full voltage drives, arcs, turns on the spot and stops for a few seconds while a 10 ms loop holds the
+ * tray with the transmission's hold law (control_laws::hold() with Transmission's gains). The same run is repeated
+ * with each way of fitting the chassis and the correction into the shared motors' budget:
+ *   clip     each shared motor gets its side's voltage plus the correction, clipped to the budget
+ *   drive    allocate() with HoldPriority::DRIVE, as the transmission holds by default
+ *   tilter   allocate() with HoldPriority::TILTER, as the tilter holds after a deposit
+ *   stack    allocate() with the priority HoldPriority::STACK resolves to for the tray's stack, as the transmission
+ *            holds by default: drive with an empty tray, tilter with a loaded one
+ * and once with the shared motors driving alone, as in PASSIVE, for the path every strategy is compared against.
+ * Every robot runs all of them with an empty tray and with a LOADED-cube stack, which the simulator makes the tray
+ * heavier with.
+ * Reports the chassis command lost (mean |commanded - requested| per side, once the correction common to both
+ * shared motors is taken out), how far the robot ends from the free run's position and heading, and the tray's error
+ * from its target. The hold reads the true tray angle, not the encoders.
+ */
+
+#include "sim/sim.hpp"
+#include "lib/control_laws.hpp"
+#include "subsystems/transmission.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+  // the loop's period, the time given to raise the tray, and the length of the driving script, in ms
+  constexpr uint32_t PERIOD = 10;
+  constexpr uint32_t RAISE = 1500;
+  constexpr uint32_t DRIVE = 6000;
+
+  // the tray is held here, in deg
+  constexpr double TARGET = 30;
+
+  // the loaded tray's stack, and how long each cube takes to pull in, in ms
+  constexpr size_t LOADED = 8;
+  constexpr uint32_t CUBE_LOAD = 350;
+
+  enum class Strategy { FREE, CLIP, DRIVE_PRIORITY, TILTER_PRIORITY, STACK_PRIORITY };
+  constexpr Strategy STRATEGIES[] = {
+    Strategy::FREE, Strategy::CLIP, Strategy::DRIVE_PRIORITY, Strategy::TILTER_PRIORITY, Strategy::STACK_PRIORITY
+  };
+  constexpr const char* NAMES[] = {"free", "clip", "drive", "tilter", "stack"};
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // what one run did
+  struct Outcome {
+    bool m_loaded;        ///< The tray held the whole stack
+    double m_drive_lost;  ///< mV per side, averaged over the script
+    double m_tray_rms;    ///< deg
+    double m_tray_max;    ///< deg
+    sim::Robot::Pose m_end;
+  };
+
+  // the motors, wired as Transmission wires them
+  struct Motors {
+    Motor m_left_direct{11, true, AbstractMotor::gearset::red, AbstractMotor::encoderUnits::degrees};
+    Motor m_right_direct{20, false, AbstractMotor::gearset::red, AbstractMotor::encoderUnits::degrees};
+    Motor m_left_shared{15, true, AbstractMotor::gearset::red, AbstractMotor::encoderUnits::degrees};
+    Motor m_right_shared{16, false, AbstractMotor::gearset::red, AbstractMotor::encoderUnits::degrees};
+    Motor m_intake_left{12, false, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees};
+    Motor m_intake_right{19, true, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees};
+  };
+
+  // the driving script: full voltage drives, arcs and turns on the spot, with stops between them
+  struct Segment {
+    int m_left;
+    int m_right;
+    uint32_t m_length;
+  };
+
+  std::vector<Segment> make_script(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> kind(0, 6);
+    std::uniform_int_distribution<uint32_t> length(300, 1200);
+    constexpr int FULL = Transmission::MAX_VOLTAGE;
+    std::vector<Segment> script;
+    for (uint32_t time = 0; time < DRIVE;) {
+      Segment segment{0, 0, length(rng)};
+      switch (kind(rng)) {
+        case 0: segment.m_left = segment.m_right = FULL; break;
+        case 1: segment.m_left = segment.m_right = -FULL; break;
+        case 2: segment.m_left = FULL, segment.m_right = FULL / 2; break;
+        case 3: segment.m_left = -FULL / 2, segment.m_right = -FULL; break;
+        case 4: segment.m_left = FULL, segment.m_right = -FULL; break;
+        case 5: segment.m_left = -FULL, segment.m_right = FULL; break;
+        default: break;
+      }
+      script.push_back(segment);
+      time += segment.m_length;
+    }
+    return script;
+  }
+
+  // the shared motors' budget split by a strategy
+  Transmission::Allocation split(Strategy strategy, int left, int right, int tilter, size_t cubes) {
+    constexpr int MAX = Transmission::MAX_VOLTAGE;
+    switch (strategy) {
+      case Strategy::FREE:
+        return {left, right, left, right, 0};
+      case Strategy::CLIP:
+        return {left, right, std::max(-MAX, std::min(MAX, left + tilter)), std::max(-MAX, std::min(MAX, right + tilter)), 0};
+      case Strategy::DRIVE_PRIORITY:
+        return Transmission::allocate(left, right, tilter, Transmission::HoldPriority::DRIVE);
+      case Strategy::TILTER_PRIORITY:
+        return Transmission::allocate(left, right, tilter, Transmission::HoldPriority::TILTER);
+      default:
+        return Transmission::allocate(
+          left, right, tilter, Transmission::resolve_priority(Transmission::HoldPriority::STACK, cubes)
+        );
+    }
+  }
+
+  // one run on the simulated clock
+  Outcome run(Motors& motors, uint64_t seed, Strategy strategy, size_t cubes) {
+    sim::robot().reset(seed);
+    Outcome outcome{};
+    std::vector<Segment> script = make_script(mix(seed));
+    auto command = [&](const Transmission::Allocation& allocation) {
+      motors.m_left_direct.moveVoltage(allocation.m_direct_left);
+      motors.m_right_direct.moveVoltage(allocation.m_direct_right);
+      motors.m_left_shared.moveVoltage(allocation.m_shared_left);
+      motors.m_right_shared.moveVoltage(allocation.m_shared_right);
+    };
+
+    // pull the stack in
+    for (size_t i = 0; i < cubes; ++i) sim::robot().feed_cube();
+    if (cubes) {
+      motors.m_intake_left.moveVoltage(12000);
+      motors.m_intake_right.moveVoltage(12000);
+      pros::delay(cubes * CUBE_LOAD + RAISE);
+      motors.m_intake_left.moveVoltage(0);
+      motors.m_intake_right.moveVoltage(0);
+    }
+    outcome.m_loaded = sim::robot().get_cube_count() == cubes;
+
+    // raise the tray with the chassis still
+    double last = sim::robot().get_tilter_angle();
+    auto correction = [&]() {
+      double angle = sim::robot().get_tilter_angle();
+      double velocity = (angle - last) * 1000 / PERIOD;
+      last = angle;
+      return -control_laws::hold(
+        Transmission::HOLD_KP, Transmission::HOLD_KD, Transmission::TILTER_HOLD_STRENGTH, TARGET, angle, velocity
+      );
+    };
+    for (uint32_t time = 0; time < RAISE; time += PERIOD) {
+      double angle = sim::robot().get_tilter_angle();
+      int tilter = -int(std::max(-8000.0, std::min(8000.0, 400 * (TARGET - angle))));
+      command({0, 0, tilter, tilter, 0});
+      last = angle;
+      pros::delay(PERIOD);
+    }
+
+    // drive the script while holding
+    double squared = 0;
+    uint32_t ticks = 0;
+    for (const Segment& segment : script) {
+      for (uint32_t time = 0; time < segment.m_length; time += PERIOD, ++ticks) {
+        Transmission::Allocation allocation = split(strategy, segment.m_left, segment.m_right, int(correction()), cubes);
+        command(allocation);
+
+        // the chassis gets each side's direct and shared motors, less the correction both shared motors carry
+        double tilter = (
+          allocation.m_shared_left - allocation.m_direct_left + allocation.m_shared_right - allocation.m_direct_right
+        ) * .5;
+        double left = (allocation.m_direct_left + allocation.m_shared_left - tilter) * .5;
+        double right = (allocation.m_direct_right + allocation.m_shared_right - tilter) * .5;
+        outcome.m_drive_lost += (std::abs(left - segment.m_left) + std::abs(right - segment.m_right)) * .5;
+        double error = std::abs(sim::robot().get_tilter_angle() - TARGET);
+        squared += error * error;
+        outcome.m_tray_max = std::max(outcome.m_tray_max, error);
+        pros::delay(PERIOD);
+      }
+    }
+    command({0, 0, 0, 0, 0});
+    outcome.m_drive_lost /= ticks;
+    outcome.m_tray_rms = std::sqrt(squared / ticks);
+    outcome.m_end = sim::robot().get_pose();
+    return outcome;
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-22s mean %8.2f  sd %7.2f  p5 %8.2f  p50 %8.2f  p95 %8.2f  max %8.2f %s\n", name,
+      mean, deviation, percentile(values, .05), percentile(values, .5), percentile(values, .95), values.back(), unit
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 50;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  // runs follow each other on one simulated clock, each on its own robot, with each tray
+  constexpr size_t COUNT = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+  constexpr size_t TRAYS[] = {0, LOADED};
+  std::vector<Outcome> outcomes[2][COUNT];
+  for (auto& tray_outcomes : outcomes) for (std::vector<Outcome>& strategy_outcomes : tray_outcomes) strategy_outcomes.resize(runs);
+  auto begin = std::chrono::steady_clock::now();
+  sim::run([&]() {
+    Motors motors;
+    for (size_t i = 0; i < runs; ++i) {
+      uint64_t run_seed = mix(seed ^ mix(i));
+      for (size_t tray = 0; tray < 2; ++tray) {
+        for (size_t j = 0; j < COUNT; ++j) outcomes[tray][j][i] = run(motors, run_seed, STRATEGIES[j], TRAYS[tray]);
+      }
+    }
+  }, uint32_t(runs * COUNT * (2 * (RAISE + DRIVE + 1200) + LOADED * CUBE_LOAD + RAISE) + 1000));
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::printf("%zu runs of %u s, tray held at %.0f deg, seed %llu\n", runs, DRIVE / 1000, TARGET, (unsigned long long)seed);
+  for (size_t tray = 0; tray < 2; ++tray) {
+    size_t unloaded = 0;
+    for (const Outcome& outcome : outcomes[tray][0]) unloaded += !outcome.m_loaded;
+    std::printf("%zu cubes on the tray; stack holds with %s priority\n", TRAYS[tray],
+      Transmission::resolve_priority(Transmission::HoldPriority::STACK, TRAYS[tray]) == Transmission::HoldPriority::TILTER ?
+      "tilter" : "drive"
+    );
+    if (unloaded) std::printf("%zu runs did not pull in the whole stack\n", unloaded);
+    for (size_t j = 1; j < COUNT; ++j) {
+      std::vector<double> lost, path, heading, rms, max;
+      for (size_t i = 0; i < runs; ++i) {
+        const Outcome& outcome = outcomes[tray][j][i];
+        const sim::Robot::Pose& free = outcomes[tray][0][i].m_end;
+        lost.push_back(outcome.m_drive_lost);
+        path.push_back(std::hypot(outcome.m_end.m_x - free.m_x, outcome.m_end.m_y - free.m_y));
+        heading.push_back(std::abs(outcome.m_end.m_heading - free.m_heading));
+        rms.push_back(outcome.m_tray_rms);
+        max.push_back(outcome.m_tray_max);
+      }
+      std::string prefix = NAMES[j];
+      report((prefix + " drive lost").c_str(), lost, "mV");
+      report((prefix + " off path").c_str(), path, "in");
+      report((prefix + " off heading").c_str(), heading, "deg");
+      report((prefix + " tray rms").c_str(), rms, "deg");
+      report((prefix + " tray max").c_str(), max, "deg");
+    }
+  }
+  std::fprintf(stderr, "%.2f s (%.0f runs/s)\n", seconds, runs * COUNT * 2 / seconds);
+
+  std::fflush(stdout);
+  std::_Exit(0);
+}
@@ -0,0 +1,261 @@
+/**
+ * Host benchmark of the lift's preset moves (Lift::move_to()) against the lift as it was driven before them,
+ * on a simulated robot.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_lift [--runs N] [--seed N]
+ *
+ * Each run builds a robot with its own disturbances (tools/sim/), including a different load on each side of the
+ * lift, and moves the lift between every ordered pair of presets, twice over: once with Lift, whose 10 ms job reads
+ * both motors once into a SensorFrame (as Sensors does), then follows a profile with synchronized sides; and once
+ * with a model of the old Lift, copied from its last version, driven as opcontrol drove it: 12000 mV up or
+ * -8000 mV down until the lift passes the target, then lock(). The old driver lets go on the exact tick, which no
+ * driver does, so its times are a best case.
+ * Reports the time each move takes to settle within Lift::SETTLE_ANGLE and Lift::SETTLE_SPEED (the old lift often
+ * locks outside them, and counts as the timeout), its error at the end, the largest difference between the sides
+ * during it, and the motor reads per tick.
+ */
+
+#include "sim/sim.hpp"
+#include "subsystems/lift.hpp"
+#include "subsystems/sensors.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+  // the lift job's period, and the longest a move may take, in ms
+  constexpr uint32_t PERIOD = 10;
+  constexpr uint32_t TIMEOUT = 3000;
+
+  // the lift's motors, as subsystems.cpp wires them
+  constexpr uint8_t LEFT_PORT = 1;
+  constexpr uint8_t RIGHT_PORT = 18;
+
+  constexpr Lift::Preset PRESETS[] = {
+    Lift::Preset::DOWN, Lift::Preset::LOCK, Lift::Preset::LOW_TOWER, Lift::Preset::MID_TOWER, Lift::Preset::MAX
+  };
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * Model of the old Lift: every move_voltage() read both motors twice to keep the sides level with a bare P term,
+   * on top of the reads in update_angles().
+   */
+  class OldLift {
+  public:
+    void move_voltage(int val) {
+      m_motor_left.setBrakeMode(Motor::brakeMode::coast);
+      m_motor_right.setBrakeMode(Motor::brakeMode::coast);
+      m_motor_left.moveVoltage(val + (m_motor_right.getPosition() - m_motor_left.getPosition()) * 20);
+      m_motor_right.moveVoltage(val - (m_motor_right.getPosition() - m_motor_left.getPosition()) * 20);
+    }
+
+    void lock() {
+      m_motor_left.setBrakeMode(Motor::brakeMode::hold);
+      m_motor_right.setBrakeMode(Motor::brakeMode::hold);
+      m_motor_left.moveVelocity(0);
+      m_motor_right.moveVelocity(0);
+    }
+
+    double update_angle() {
+      return (m_motor_left.getPosition() + m_motor_right.getPosition()) * .5 / 5.0;
+    }
+
+  private:
+    CachedMotor m_motor_left{LEFT_PORT, false, Motor::gearset::green, Motor::encoderUnits::degrees};
+    CachedMotor m_motor_right{RIGHT_PORT, true, Motor::gearset::green, Motor::encoderUnits::degrees};
+  };
+
+  // what one move did
+  struct Outcome {
+    double m_time;      ///< ms to settle; TIMEOUT if it never did
+    double m_error;     ///< deg from the target where it settled, or stopped trying
+    double m_level;     ///< deg between the sides, at most
+    double m_reads;     ///< motor reads per tick
+  };
+
+  // the lift's true state
+  struct Truth {
+    double m_angle;
+    double m_speed;
+    double m_level;
+  };
+
+  Truth truth() {
+    sim::Robot& robot = sim::robot();
+    double left = robot.motor(LEFT_PORT).m_position / 5.0, right = -robot.motor(RIGHT_PORT).m_position / 5.0;
+    double speed = (robot.motor(LEFT_PORT).m_velocity - robot.motor(RIGHT_PORT).m_velocity) * .5 / 5.0;
+    return {robot.get_lift_angle(), std::abs(speed), std::abs(left - right)};
+  }
+
+  // one move, ticking until it settles; step() runs the lift for a tick
+  template <typename Step>
+  Outcome move(double target, Step&& step) {
+    Outcome outcome{double(TIMEOUT), 0, 0, 0};
+    uint32_t reads = sim::robot().get_traffic().m_motor_reads;
+    uint32_t ticks = 0;
+    for (uint32_t time = 0; time < TIMEOUT; time += PERIOD, ++ticks) {
+      step();
+      pros::delay(PERIOD);
+      Truth now = truth();
+      outcome.m_level = std::max(outcome.m_level, now.m_level);
+      bool settled =
+        std::abs(now.m_angle - target) < Lift::SETTLE_ANGLE.convert(degree) &&
+        now.m_speed < Lift::SETTLE_SPEED.convert(degree / second);
+      outcome.m_error = std::abs(now.m_angle - target);
+      if (settled) {
+        outcome.m_time = time + PERIOD;
+        ++ticks;
+        break;
+      }
+    }
+    outcome.m_reads = double(sim::robot().get_traffic().m_motor_reads - reads) / ticks;
+    return outcome;
+  }
+
+  // every ordered pair of presets with Lift
+  void run_new(uint64_t seed, std::vector<Outcome>& outcomes) {
+    sim::robot().reset(seed);
+    Lift lift(LEFT_PORT, RIGHT_PORT);
+    Motor left(LEFT_PORT, false, Motor::gearset::green, Motor::encoderUnits::degrees);
+    Motor right(RIGHT_PORT, true, Motor::gearset::green, Motor::encoderUnits::degrees);
+    SensorFrame frame{};
+    auto sample = [&]() {
+      frame.m_lift_left = left.getPosition();
+      frame.m_lift_right = right.getPosition();
+      frame.m_lift_time = pros::millis();
+      lift.update_angles(frame);
+    };
+    sample();
+    lift.tare_angle(0_deg);
+    lift.lock();
+    pros::delay(PERIOD);
+    Lift::Preset from = Lift::Preset::DOWN;
+    for (Lift::Preset to : PRESETS) {
+      for (Lift::Preset via : PRESETS) {
+        if (via == to) continue;
+        for (Lift::Preset target : {via, to}) {
+          if (target == from) continue;
+          sample();
+          lift.move_to(target);
+          outcomes.push_back(move(Lift::get_preset(target).convert(degree), [&]() {
+            sample();
+            lift.update();
+          }));
+          from = target;
+        }
+      }
+    }
+  }
+
+  // the same moves with the old Lift, driven as opcontrol drove it
+  void run_old(uint64_t seed, std::vector<Outcome>& outcomes) {
+    sim::robot().reset(seed);
+    OldLift lift;
+    double zero = lift.update_angle();
+    lift.lock();
+    pros::delay(PERIOD);
+    Lift::Preset from = Lift::Preset::DOWN;
+    for (Lift::Preset to : PRESETS) {
+      for (Lift::Preset via : PRESETS) {
+        if (via == to) continue;
+        for (Lift::Preset target : {via, to}) {
+          if (target == from) continue;
+          double goal = Lift::get_preset(target).convert(degree);
+          bool up = goal > Lift::get_preset(from).convert(degree);
+          bool released = false;
+          outcomes.push_back(move(goal, [&]() {
+            double angle = lift.update_angle() - zero;
+            released = released || (up ? angle >= goal : angle <= goal);
+            if (released) lift.lock();
+            else lift.move_voltage(up ? 12000 : -8000);
+          }));
+          from = target;
+        }
+      }
+    }
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-16s mean %8.2f  sd %7.2f  p5 %8.2f  p50 %8.2f  p95 %8.2f  max %8.2f %s\n", name,
+      mean, deviation, percentile(values, .05), percentile(values, .5), percentile(values, .95), values.back(), unit
+    );
+  }
+
+  void report(const char* name, const std::vector<Outcome>& outcomes) {
+    std::vector<double> time, error, level, reads;
+    size_t timeouts = 0;
+    for (const Outcome& outcome : outcomes) {
+      time.push_back(outcome.m_time);
+      level.push_back(outcome.m_level);
+      reads.push_back(outcome.m_reads);
+      error.push_back(outcome.m_error);
+      timeouts += outcome.m_time >= TIMEOUT;
+    }
+    std::string prefix = name;
+    report((prefix + " time").c_str(), time, "ms");
+    report((prefix + " error").c_str(), error, "deg");
+    report((prefix + " level").c_str(), level, "deg");
+    report((prefix + " reads").c_str(), reads, "per tick");
+    std::printf("%-16s %zu of %zu moves did not settle in %u ms\n", (prefix + " timeouts").c_str(), timeouts, outcomes.size(), TIMEOUT);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 20;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  // runs follow each other on one simulated clock, each on its own robot
+  std::vector<Outcome> profiled, old;
+  auto begin = std::chrono::steady_clock::now();
+  sim::run([&]() {
+    for (size_t i = 0; i < runs; ++i) {
+      uint64_t run_seed = mix(seed ^ mix(i));
+      run_new(run_seed, profiled);
+      run_old(run_seed, old);
+    }
+  }, uint32_t(runs * 2 * 40 * (TIMEOUT + PERIOD) + 1000));
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::printf("%zu runs of %zu moves between presets, seed %llu\n", runs, profiled.size() / runs, (unsigned long long)seed);
+  report("profiled", profiled);
+  report("old", old);
+  std::fprintf(stderr, "%.2f s\n", seconds);
+
+  std::fflush(stdout);
+  std::_Exit(0);
+}
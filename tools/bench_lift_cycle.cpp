@@ -0,0 +1,250 @@
+/**
+ * Host benchmark of the scoring cycle with the lift's preset buttons (LiftController) against manual L1/L2 control,
+ * on a simulated robot in driver control.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_lift_cycle [--cycles N] [--seed N]
+ *
+ * Runs initialize() and opcontrol() on the host simulator (tools/sim/) while a simulated driver presses the
+ * controller's buttons. Each cycle raises the lift from the bottom to the low or mid tower, keeps it within
+ * Lift::SETTLE_ANGLE of the tower's height for DROP ms while a cube is placed, then lowers it with L2 until it is
+ * back at the bottom. Each cycle is run twice, to the same tower with the same reaction times:
+ *   preset   the driver taps down or right, and waits for the lift to stop
+ *   manual   the driver holds L1, letting go where they judge the lift will coast to the height, then taps L1 or L2
+ *            to correct until it stops within Lift::SETTLE_ANGLE
+ * The driver watches the true lift and acts after a reaction time drawn for every decision; the manual driver judges
+ * the coast from the lift's speed as well as a practised driver could. Lowering is the same in both.
+ * Reports the time from the first press to the cube placed, and to the lift back at the bottom, and the corrections
+ * the manual driver made.
+ */
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "subsystems/subsystems.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // the robot sits still this long after initialize() while the IMU calibrates, in ms
+  constexpr uint32_t IDLE = 3000;
+
+  // the driver's loop, the range of their reaction times, and how long a cube takes to place, in ms
+  constexpr uint32_t PERIOD = 10;
+  constexpr uint32_t MIN_REACTION = 150;
+  constexpr uint32_t MAX_REACTION = 250;
+  constexpr uint32_t DROP = 200;
+
+  // the manual driver taps for this long per deg off the height, within limits, in ms; of the taps tried, these let
+  // the manual driver settle fastest, and longer ones chase the height back and forth
+  constexpr uint32_t TAP_PER_DEG = 10;
+  constexpr uint32_t MIN_TAP = 50;
+  constexpr uint32_t MAX_TAP = 400;
+
+  // the lift is back at the bottom below this, in deg
+  constexpr double BOTTOM = 3;
+
+  // a cycle that takes longer than this fails, and is cut short once it places the cube, in ms
+  constexpr uint32_t TIMEOUT = 8000;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // what one cycle took
+  struct Outcome {
+    double m_placed;      ///< ms from the first press until the cube is placed
+    double m_cycle;       ///< ms from the first press until the lift is back at the bottom
+    double m_corrections; ///< taps the manual driver made after letting go
+    bool m_finished;
+  };
+
+  // the driver's hands on the controller
+  void press(pros::controller_digital_e_t button, bool pressed) {
+    sim::robot().m_digital[button] = pressed;
+  }
+
+  void release_all() {
+    for (auto button : {pros::E_CONTROLLER_DIGITAL_L1, pros::E_CONTROLLER_DIGITAL_L2,
+      pros::E_CONTROLLER_DIGITAL_DOWN, pros::E_CONTROLLER_DIGITAL_RIGHT}) press(button, false);
+  }
+
+  // the lift as the driver sees it
+  double lift_angle() {
+    return sim::robot().get_lift_angle();
+  }
+
+  double lift_speed() {
+    sim::Robot& robot = sim::robot();
+    return (robot.motor(1).m_velocity - robot.motor(18).m_velocity) * .5 / 5.0;
+  }
+
+  class Driver {
+  public:
+    explicit Driver(uint64_t seed): m_rng(seed) {}
+
+    // wait a reaction time
+    void react() {
+      pros::delay(std::uniform_int_distribution<uint32_t>(MIN_REACTION, MAX_REACTION)(m_rng));
+    }
+
+    // one cycle to a tower height
+    Outcome cycle(bool preset, Lift::Preset tower) {
+      Outcome outcome{double(TIMEOUT), double(TIMEOUT), 0, false};
+      double target = Lift::get_preset(tower).convert(degree);
+      double tolerance = Lift::SETTLE_ANGLE.convert(degree);
+      double still = Lift::SETTLE_SPEED.convert(degree / second);
+      uint32_t start = pros::millis();
+      auto elapsed = [&]() { return pros::millis() - start; };
+
+      if (preset) {
+
+        // tap the preset's button, and wait for the lift to stop
+        auto button = tower == Lift::Preset::LOW_TOWER ? pros::E_CONTROLLER_DIGITAL_DOWN : pros::E_CONTROLLER_DIGITAL_RIGHT;
+        press(button, true);
+        pros::delay(2 * PERIOD);
+        press(button, false);
+        while (elapsed() < TIMEOUT && (std::abs(lift_angle() - target) > tolerance || std::abs(lift_speed()) > still)) {
+          pros::delay(PERIOD);
+        }
+        react();
+      }
+      else {
+
+        // hold L1 until the lift would coast to the height over a reaction time; the release takes that long
+        double reaction = (MIN_REACTION + MAX_REACTION) * .5 / 1000;
+        press(pros::E_CONTROLLER_DIGITAL_L1, true);
+        while (elapsed() < TIMEOUT && lift_angle() + lift_speed() * reaction < target) pros::delay(PERIOD);
+        react();
+        press(pros::E_CONTROLLER_DIGITAL_L1, false);
+
+        // once it stops, tap towards the height until it is there
+        while (elapsed() < TIMEOUT) {
+          while (elapsed() < TIMEOUT && std::abs(lift_speed()) > still) pros::delay(PERIOD);
+          react();
+          double error = target - lift_angle();
+          if (std::abs(error) <= tolerance) break;
+          auto button = error > 0 ? pros::E_CONTROLLER_DIGITAL_L1 : pros::E_CONTROLLER_DIGITAL_L2;
+          uint32_t tap = std::max(MIN_TAP, std::min(MAX_TAP, uint32_t(std::abs(error) * TAP_PER_DEG)));
+          press(button, true);
+          pros::delay(tap);
+          press(button, false);
+          ++outcome.m_corrections;
+        }
+      }
+      release_all();
+
+      // place the cube; the lift must stay at the height
+      uint32_t held = 0;
+      while (elapsed() < TIMEOUT && held < DROP) {
+        held = std::abs(lift_angle() - target) <= tolerance ? held + PERIOD : 0;
+        pros::delay(PERIOD);
+      }
+      outcome.m_placed = elapsed();
+
+      // lower it, even after giving up, so the next cycle starts at the bottom
+      react();
+      press(pros::E_CONTROLLER_DIGITAL_L2, true);
+      while (lift_angle() > BOTTOM) pros::delay(PERIOD);
+      press(pros::E_CONTROLLER_DIGITAL_L2, false);
+      outcome.m_finished = elapsed() < TIMEOUT;
+      if (outcome.m_finished) outcome.m_cycle = elapsed();
+      else outcome.m_placed = TIMEOUT;
+
+      // let the lift settle before the next cycle
+      pros::delay(500);
+      return outcome;
+    }
+
+  private:
+    std::mt19937_64 m_rng;
+  };
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(FILE* out, const char* name, std::vector<double> values, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::fprintf(out, "%-20s mean %8.2f  sd %7.2f  p5 %8.2f  p50 %8.2f  p95 %8.2f  max %8.2f %s\n", name,
+      mean, deviation, percentile(values, .05), percentile(values, .5), percentile(values, .95), values.back(), unit
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t cycles = 100;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--cycles") && has_value) cycles = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--cycles N] [--seed N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (cycles == 0) return 0;
+
+  // the robot's stdout is the telemetry stream
+  FILE* report_file = fdopen(dup(STDOUT_FILENO), "w");
+  std::freopen("/dev/null", "w", stdout);
+
+  // each cycle is run with both, to the same tower and with the same reactions
+  std::vector<Outcome> outcomes[2];
+  std::unique_ptr<pros::Task> driver_control;
+  sim::robot().reset(seed);
+  sim::run([&]() {
+    initialize();
+    pros::delay(IDLE);
+    driver_control = std::make_unique<pros::Task>([]() { opcontrol(); });
+    for (size_t i = 0; i < cycles; ++i) {
+      uint64_t cycle_seed = mix(seed ^ mix(i));
+      Lift::Preset tower = cycle_seed & 1 ? Lift::Preset::MID_TOWER : Lift::Preset::LOW_TOWER;
+      for (int preset = 0; preset < 2; ++preset) {
+        Driver driver(cycle_seed);
+        outcomes[preset].push_back(driver.cycle(preset, tower));
+      }
+    }
+  }, uint32_t(IDLE + cycles * 2 * (TIMEOUT + 1000) + 1000));
+
+  std::fprintf(report_file, "%zu cycles each, seed %llu\n", cycles, (unsigned long long)seed);
+  const char* names[] = {"manual", "preset"};
+  for (int preset = 0; preset < 2; ++preset) {
+    std::vector<double> placed, cycle, corrections;
+    size_t failed = 0;
+    for (const Outcome& outcome : outcomes[preset]) {
+      placed.push_back(outcome.m_placed);
+      cycle.push_back(outcome.m_cycle);
+      corrections.push_back(outcome.m_corrections);
+      failed += !outcome.m_finished;
+    }
+    std::string name = names[preset];
+    report(report_file, (name + " placed").c_str(), placed, "ms");
+    report(report_file, (name + " cycle").c_str(), cycle, "ms");
+    if (!preset) report(report_file, (name + " corrections").c_str(), corrections, "taps");
+    std::fprintf(report_file, "%-20s %zu of %zu cycles did not finish in %u ms\n", (name + " timeouts").c_str(), failed, cycles, TIMEOUT);
+  }
+
+  // the robot's tasks are still parked, so skip static destructors
+  std::fflush(report_file);
+  std::_Exit(0);
+}
@@ -0,0 +1,258 @@
+/**
+ * Host microbenchmark of StateMachine (state_machine.hpp) against the std::map design it replaced.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/bench_state_machine [--updates N]
+ *
+ * Both machines run the transmission's states and transitions (include/subsystems/transmission.hpp) over the same
+ * context, whose tilter and lift angles follow a fixed script that takes every transition. The old design is
+ * modelled from its last header: a std::map of states, std::function enter and exit hooks, where the exit hook runs
+ * every update and changes the state itself, and a virtual behavior behind a std::shared_ptr.
+ * Reports the time per update and the heap allocations made building and running each machine; both machines
+ * must visit the same states.
+ */
+
+#include "state_machine.hpp"
+#include "subsystems/lift.hpp"
+#include "subsystems/transmission.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+
+// heap allocations, counted for the report; every form of new and delete is replaced, and all of them share one
+// allocator kept out of line, so the compiler never sees a pointer from one form freed by another
+namespace {
+  size_t g_allocations = 0;
+
+  __attribute__((noinline)) void* allocate(size_t size) {
+    ++g_allocations;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+  }
+
+  __attribute__((noinline)) void release(void* memory) noexcept {
+    std::free(memory);
+  }
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* memory) noexcept { release(memory); }
+void operator delete[](void* memory) noexcept { release(memory); }
+void operator delete(void* memory, size_t) noexcept { release(memory); }
+void operator delete[](void* memory, size_t) noexcept { release(memory); }
+
+namespace {
+
+  // the transmission's states, and the angles its guards read, in deg
+  enum class State { PASSIVE, HOLDING, RETRACTING, EXTENDING, LOCKED_PASSTHROUGH };
+  const double TILTER_RETRACT_THRESHOLD = Transmission::TILTER_RETRACT_THRESHOLD.convert(degree);
+  const double TILTER_EXTEND_THRESHOLD = Transmission::TILTER_EXTEND_THRESHOLD.convert(degree);
+  const double MAX_LOCK = Lift::MAX_LOCK.convert(degree);
+
+  struct Context {
+    double m_tilter = 0;
+    double m_lift = 30;
+    double m_bias = 0;
+    uint64_t m_work = 0; ///< Stands in for the motor commands each state's update sends
+  };
+
+  // the transmission's guards, actions and updates
+  bool retract_done(const Context& context) { return context.m_tilter <= TILTER_RETRACT_THRESHOLD || context.m_lift < MAX_LOCK; }
+  bool extend_done(const Context& context) { return context.m_tilter >= TILTER_EXTEND_THRESHOLD || context.m_lift < MAX_LOCK; }
+  bool can_release(const Context& context) { return context.m_tilter <= TILTER_RETRACT_THRESHOLD && context.m_lift > MAX_LOCK; }
+  bool must_hold(const Context& context) { return context.m_lift <= MAX_LOCK; }
+  void hold_retracted(Context& context) { context.m_bias = 0; }
+  void hold_at_threshold(Context& context) { context.m_bias = 1; }
+  void update_passive(Context& context) { context.m_work += 1; }
+  void update_holding(Context& context) { context.m_work += 2; }
+  void update_retracting(Context& context) { context.m_work += 3; }
+  void update_extending(Context& context) { context.m_work += 4; }
+  void update_locked(Context& context) { context.m_work += 5; }
+
+  struct Traits {
+    using State = ::State;
+    using Context = ::Context;
+    static constexpr size_t NUM_STATES = 5;
+    static constexpr StateBehavior<Context> BEHAVIORS[] = {
+      {nullptr, &update_passive},
+      {nullptr, &update_holding},
+      {nullptr, &update_retracting},
+      {nullptr, &update_extending},
+      {nullptr, &update_locked}
+    };
+    static constexpr Transition<State, Context> TRANSITIONS[] = {
+      {State::RETRACTING, State::HOLDING, &retract_done, &hold_retracted},
+      {State::EXTENDING,  State::HOLDING, &extend_done,  &hold_at_threshold},
+      {State::HOLDING,    State::PASSIVE, &can_release,  nullptr},
+      {State::PASSIVE,    State::HOLDING, &must_hold,    &hold_retracted}
+    };
+  };
+
+  /**
+   * Model of the old StateMachine<TState, TBehavior>.
+   */
+  class MapMachine {
+  public:
+    struct AbstractBehavior {
+      virtual ~AbstractBehavior() = default;
+      virtual void update() = 0;
+    };
+
+    struct StateEntry {
+      State m_identifier;
+      std::shared_ptr<AbstractBehavior> mp_behavior;
+      std::function<void()> m_enter;
+      std::function<void(State)> m_exit;
+    };
+
+    explicit MapMachine(State entry_state): m_current_state(entry_state), m_desired_state(entry_state) {}
+
+    void add_state(StateEntry state) {
+      m_map.emplace(state.m_identifier, std::move(state));
+    }
+
+    // what set_state() is to StateMachine: forced, running the new state's enter hook
+    void change_state(State state) {
+      m_current_state = state;
+      m_map.at(state).m_enter();
+    }
+
+    State get_state() const {
+      return m_current_state;
+    }
+
+    // the current state's exit check, then the (possibly new) state's behavior
+    void update() {
+      m_map.at(m_current_state).m_exit(m_desired_state);
+      m_map.at(m_current_state).mp_behavior->update();
+    }
+
+  private:
+    std::map<State, StateEntry> m_map;
+    State m_current_state;
+    State m_desired_state;
+  };
+
+  // a behavior calling one of the update functions
+  struct FunctionBehavior : MapMachine::AbstractBehavior {
+    FunctionBehavior(Context& context, void (*update)(Context&)): m_context(context), m_update(update) {}
+    void update() override { m_update(m_context); }
+    Context& m_context;
+    void (*m_update)(Context&);
+  };
+
+  // the transmission's machine, as it would have been written for the old design: each exit hook checks its state's
+  // transitions itself
+  void build_map_machine(MapMachine& machine, Context& context) {
+    auto behavior = [&](void (*update)(Context&)) { return std::make_shared<FunctionBehavior>(context, update); };
+    machine.add_state({State::PASSIVE, behavior(&update_passive), [] {}, [&machine, &context](State) {
+      if (must_hold(context)) { hold_retracted(context); machine.change_state(State::HOLDING); }
+    }});
+    machine.add_state({State::HOLDING, behavior(&update_holding), [] {}, [&machine, &context](State) {
+      if (can_release(context)) machine.change_state(State::PASSIVE);
+    }});
+    machine.add_state({State::RETRACTING, behavior(&update_retracting), [] {}, [&machine, &context](State) {
+      if (retract_done(context)) { hold_retracted(context); machine.change_state(State::HOLDING); }
+    }});
+    machine.add_state({State::EXTENDING, behavior(&update_extending), [] {}, [&machine, &context](State) {
+      if (extend_done(context)) { hold_at_threshold(context); machine.change_state(State::HOLDING); }
+    }});
+    machine.add_state({State::LOCKED_PASSTHROUGH, behavior(&update_locked), [] {}, [](State) {}});
+  }
+
+  // the script: the tilter extends and retracts while the lift goes up and down past the lock
+  void step_script(Context& context, uint64_t i) {
+    uint64_t phase = i % 400;
+    context.m_lift = phase < 200 ? 30 : 10;
+    context.m_tilter = phase % 200 < 100 ? double(phase % 100) : 100.0 - double(phase % 100);
+  }
+
+  // the state forced on the machine at points of the script, as commands do
+  bool forced_state(uint64_t i, State& state) {
+    uint64_t phase = i % 400;
+    if (phase == 10) state = State::EXTENDING;
+    else if (phase == 110) state = State::RETRACTING;
+    else if (phase == 300) state = State::LOCKED_PASSTHROUGH;
+    else if (phase == 350) state = State::PASSIVE;
+    else return false;
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  uint64_t updates = 20000000;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--updates") && has_value) updates = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--updates N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // build both
+  Context table_context, map_context;
+  size_t allocations = g_allocations;
+  StateMachine<Traits> table(State::PASSIVE);
+  size_t table_build = g_allocations - allocations;
+  allocations = g_allocations;
+  MapMachine map(State::PASSIVE);
+  build_map_machine(map, map_context);
+  size_t map_build = g_allocations - allocations;
+
+  // both visit the same states over the whole script
+  uint64_t transitions = 0;
+  for (uint64_t i = 0; i < 4000; ++i) {
+    step_script(table_context, i);
+    step_script(map_context, i);
+    State forced;
+    if (forced_state(i, forced)) {
+      table.set_state(forced, table_context);
+      map.change_state(forced);
+    }
+    transitions += table.update(table_context) != nullptr;
+    map.update();
+    if (table.get_state() != map.get_state() || table_context.m_work != map_context.m_work) {
+      std::printf("the machines differ at update %llu\n", (unsigned long long)i);
+      return 1;
+    }
+  }
+
+  // time each
+  auto run = [&](auto&& update, Context& context, size_t& update_allocations) {
+    size_t before = g_allocations;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < updates; ++i) {
+      step_script(context, i);
+      update(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    update_allocations = g_allocations - before;
+    return seconds / updates;
+  };
+  size_t table_allocations, map_allocations;
+  double table_time = run([&](uint64_t i) {
+    State forced;
+    if (forced_state(i, forced)) table.set_state(forced, table_context);
+    table.update(table_context);
+  }, table_context, table_allocations);
+  double map_time = run([&](uint64_t i) {
+    State forced;
+    if (forced_state(i, forced)) map.change_state(forced);
+    map.update();
+  }, map_context, map_allocations);
+
+  std::printf("%llu updates, %llu transitions per 4000\n", (unsigned long long)updates, (unsigned long long)transitions);
+  std::printf("%-10s %6.2f ns per update  %zu allocations to build  %zu while updating  sizeof %zu\n",
+    "table", table_time * 1e9, table_build, table_allocations, sizeof(table));
+  std::printf("%-10s %6.2f ns per update  %zu allocations to build  %zu while updating  sizeof %zu\n",
+    "std::map", map_time * 1e9, map_build, map_allocations, sizeof(map));
+  std::fprintf(stderr, "(%llu)\n", (unsigned long long)(table_context.m_work + map_context.m_work));
+}
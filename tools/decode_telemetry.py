@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Decode the binary telemetry stream written by Telemetry (include/lib/telemetry.hpp) into CSV.
+
+Each record is 24 little-endian bytes: sync (u16, 0xA55A), channel (u8), value count (u8),
+time in ms (u32) and four floats. Bytes that do not start a record, such as text printed
+to the same serial port, are skipped until the next sync word.
+
+Usage: tools/decode_telemetry.py [input [output]]
+  input defaults to stdin and output to stdout, so a capture can be piped straight through.
+"""
+
+import struct
+import sys
+
+RECORD = struct.Struct('<HBBI4f')
+SYNC = 0xA55A
+MAX_VALUES = 4
+
+CHANNELS = {
+  0: 'dropped',
+  1: 'tilter',
+  2: 'lift',
+  3: 'intake',
+}
+
+
+def records(stream):
+  """Yield (time, channel, values) for every valid record in a binary stream."""
+  buffer = b''
+  while True:
+    chunk = stream.read(4096)
+    if not chunk:
+      return
+    buffer += chunk
+    start = 0
+    while len(buffer) - start >= RECORD.size:
+      sync, channel, count, time, *values = RECORD.unpack_from(buffer, start)
+      if sync != SYNC or count > MAX_VALUES:
+        start += 1
+        continue
+      yield time, channel, values[:count]
+      start += RECORD.size
+    buffer = buffer[start:]
+
+
+def main():
+  source = open(sys.argv[1], 'rb') if len(sys.argv) > 1 else sys.stdin.buffer
+  sink = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+  sink.write('time_ms,channel,%s\n' % ','.join('value%d' % i for i in range(MAX_VALUES)))
+  for time, channel, values in records(source):
+    name = CHANNELS.get(channel, str(channel))
+    sink.write('%d,%s,%s\n' % (time, name, ','.join('%g' % v for v in values) + ',' * (MAX_VALUES - len(values))))
+    sink.flush()
+
+
+if __name__ == '__main__':
+  main()
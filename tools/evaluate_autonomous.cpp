@@ -0,0 +1,223 @@
+/**
+ * Host Monte-Carlo evaluator for the autonomous routine.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/evaluate_autonomous [--runs N] [--seed N] [--threads N]
+ *
+ * Each run plays autonomous() from src/autonomous.cpp, unchanged, on the host simulator (tools/sim/) with its own
+ * robot: battery sag, wheel slip, motors and friction that differ from the models, tracking wheel scale error,
+ * IMU scale error and bias, and the robot and cube placed slightly off; see sim::Robot::reset().
+ * As in a match, the routine starts after initialize() once the IMU has calibrated.
+ * Every robot also runs the timed routine autonomous() replaced, copied from its last version (8000 mV pushes of
+ * 750 ms around the intake's 500 ms), and both are reported side by side; the timed routine follows no trajectory,
+ * so it has no settled rate.
+ *
+ * The robot code keeps its state in globals (subsystems::, subsystem_controllers::), so every run is a child process
+ * forked before initialize() with its own copy of them, and sends its outcome back through a pipe.
+ * Every random number comes from the seed and the run's index,
+ * so the report does not depend on the thread count and runs scale across cores.
+ */
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "controllers/controllers.hpp"
+#include "subsystems/subsystems.hpp"
+#include "trajectories.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // the robot sits still this long after initialize() while the IMU calibrates, and the routine gets this long, in ms
+  constexpr uint32_t IDLE = 3000;
+  constexpr uint32_t AUTONOMOUS = 15000;
+
+  // the cube is scored if pushed past this far short of PUSH_CUBE_IN's end, and not too far to the side, in in
+  constexpr double SCORE_MARGIN = 1;
+  constexpr double SCORE_LATERAL = 2;
+
+  // where the cube is placed, short of PUSH_CUBE_IN's end, in in
+  constexpr double CUBE_DISTANCE = 3;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // the result of one run
+  struct Outcome {
+    bool m_ran;          ///< The child reported back
+    bool m_finished;     ///< The routine returned within the autonomous period
+    double m_time;       ///< s until the routine returns
+    double m_pose_error; ///< in between the true final pose and PUSH_CUBE_OUT's end
+    bool m_settled;      ///< Every trajectory settled
+    bool m_scored;       ///< The cube was pushed into the goal
+  };
+
+  // the routine autonomous() replaced, from its last version
+  void timed_autonomous() {
+    using namespace subsystems;
+    chassis->move_voltage(8000);
+    pros::delay(750);
+    chassis->move_voltage(0);
+    pros::delay(500);
+    intake->move_voltage(-12000);
+    pros::delay(500);
+    chassis->move_voltage(-8000);
+    pros::delay(750);
+    chassis->move_voltage(0);
+  }
+
+  // initialize() and a routine on a fresh robot; only call once per process
+  Outcome simulate(uint64_t seed, bool timed) {
+    sim::robot().reset(seed);
+    std::mt19937_64 rng(mix(seed));
+    double cube_placement = std::normal_distribution<double>(0, .75)(rng);
+
+    // the cube is pushed as far as the robot's front gets
+    Trajectory in(trajectories::PUSH_CUBE_IN);
+    TrajectoryPoint goal = in.sample(in.duration());
+    double goal_x = goal.m_x.convert(inch), goal_y = goal.m_y.convert(inch);
+    sim::Robot::Pose furthest = sim::robot().get_pose();
+
+    uint32_t start = 0, end = 0;
+    bool finished = sim::run([&]() {
+      initialize();
+      pros::delay(IDLE);
+      start = pros::millis();
+      if (timed) timed_autonomous();
+      else autonomous();
+      end = pros::millis();
+    }, IDLE + AUTONOMOUS, [&]() {
+      sim::Robot::Pose pose = sim::robot().get_pose();
+      if (pose.m_x > furthest.m_x) furthest = pose;
+    });
+
+    Trajectory out(trajectories::PUSH_CUBE_OUT);
+    TrajectoryPoint home = out.sample(out.duration());
+    sim::Robot::Pose pose = sim::robot().get_pose();
+    TrajectoryController::FollowStats follows = subsystem_controllers::trajectory_controller->get_follow_stats();
+    double cube = std::max(goal_x - CUBE_DISTANCE + cube_placement, furthest.m_x);
+    return {
+      true,
+      finished,
+      ((finished ? end : IDLE + AUTONOMOUS) - start) * .001,
+      std::hypot(pose.m_x - home.m_x.convert(inch), pose.m_y - home.m_y.convert(inch)),
+      follows.m_follows > 0 && follows.m_settled == follows.m_follows,
+      cube >= goal_x - SCORE_MARGIN && std::abs(furthest.m_y - goal_y) < SCORE_LATERAL
+    };
+  }
+
+  // one run in a child process
+  Outcome run(uint64_t seed, bool timed) {
+    Outcome outcome{};
+    int fds[2];
+    if (pipe(fds)) return outcome;
+    pid_t pid = fork();
+    if (pid == 0) {
+
+      // the robot's telemetry goes to stdout
+      int null = open("/dev/null", O_WRONLY);
+      dup2(null, STDOUT_FILENO);
+      close(fds[0]);
+      outcome = simulate(seed, timed);
+      ssize_t written = write(fds[1], &outcome, sizeof(outcome));
+      _exit(written == sizeof(outcome) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+      if (read(fds[0], &outcome, sizeof(outcome)) != sizeof(outcome)) outcome = Outcome{};
+      waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return outcome;
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, double scale, const char* unit) {
+    if (values.empty()) return;
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-12s mean %7.3f  sd %7.3f  p5 %7.3f  p50 %7.3f  p95 %7.3f  max %7.3f %s\n", name,
+      mean * scale, deviation * scale, percentile(values, .05) * scale, percentile(values, .5) * scale,
+      percentile(values, .95) * scale, values.back() * scale, unit
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 500;
+  uint64_t seed = 1;
+  size_t threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--threads") && has_value) threads = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N] [--threads N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  // children inherit unflushed output
+  std::fflush(stdout);
+  std::fflush(stderr);
+
+  // every robot runs both routines
+  WorkStealingPool pool(threads);
+  std::vector<Outcome> outcomes(runs * 2);
+  auto begin = std::chrono::steady_clock::now();
+  pool.run(outcomes.size(), [&](size_t index) {
+    outcomes[index] = run(mix(seed ^ mix(index % runs)), index >= runs);
+  });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::printf("%zu runs of each routine, seed %llu\n", runs, (unsigned long long)seed);
+  const char* names[] = {"trajectory", "timed"};
+  for (int timed = 0; timed < 2; ++timed) {
+    std::vector<double> times, errors;
+    size_t ran = 0, finished = 0, settled = 0, scored = 0;
+    for (size_t i = 0; i < runs; ++i) {
+      const Outcome& outcome = outcomes[timed * runs + i];
+      if (!outcome.m_ran) continue;
+      ++ran;
+      times.push_back(outcome.m_time);
+      errors.push_back(outcome.m_pose_error);
+      finished += outcome.m_finished;
+      settled += outcome.m_settled;
+      scored += outcome.m_scored;
+    }
+    std::printf("%s\n", names[timed]);
+    if (ran < runs) std::printf("failed       %zu runs\n", runs - ran);
+    if (!ran) return 1;
+    report("time", times, 1, "s");
+    report("pose error", errors, 1, "in");
+    std::printf("finished     %.1f%%\n", 100.0 * finished / ran);
+    if (!timed) std::printf("settled      %.1f%%\n", 100.0 * settled / ran);
+    std::printf("scored       %.1f%%\n", 100.0 * scored / ran);
+  }
+  std::fprintf(stderr, "%.2f s on %zu threads (%.0f runs/s)\n", seconds, pool.size(), outcomes.size() / seconds);
+}
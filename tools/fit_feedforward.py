@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Fit feedforward constants to characterization logs and write them to include/feedforward_gains.hpp.
+
+The logs are written to the SD card by CharacterizationController, one file per test, named
+characterize_<mechanism>_<test>_<direction>.csv with rows of time (ms), voltage (mV), position and velocity.
+Every log of a mechanism is fitted together by least squares to
+
+  voltage = kS * sign(velocity) + kV * velocity + kA * acceleration [+ kG * cos(position - horizontal)]
+
+where acceleration is the slope of the velocity over a short window, and the gravity term is only fitted
+for the tilter and lift. Samples at rest are dropped, as static friction makes them fit nothing.
+Mechanisms without logs keep the hand-tuned defaults below.
+
+Usage: tools/fit_feedforward.py [-o output] log.csv...
+"""
+
+import argparse
+import csv
+import math
+import os
+import re
+import sys
+
+MECHANISMS = ['DRIVE', 'TILTER', 'LIFT', 'INTAKE']
+GRAVITY = {'TILTER', 'LIFT'}
+
+# slower samples are treated as at rest, in m/s or deg/s
+MIN_VELOCITY = {'DRIVE': .01, 'TILTER': 2, 'LIFT': 2, 'INTAKE': 10}
+
+# half-width of the window acceleration is fitted over, in ms
+ACCELERATION_WINDOW = 50
+
+# hand-tuned constants used until a mechanism is characterized: (kS, kV, kA, kG, horizontal)
+DEFAULTS = {
+  'DRIVE':  (800, 22000, 3000, 0, 0),
+  'TILTER': (0, 60, 3, 0, 0),
+  'LIFT':   (0, 50, 4, 1500, 35),
+  'INTAKE': (0, 10, 0, 0, 0),
+}
+
+LOG_NAME = re.compile(r'characterize_([a-z]+)_')
+
+
+def read_log(path):
+  """Rows of (time, voltage, position, velocity), with acceleration appended."""
+  rows = []
+  with open(path) as f:
+    for row in csv.DictReader(f):
+      rows.append([float(row['time']), float(row['voltage']), float(row['position']), float(row['velocity'])])
+
+  # acceleration is the least-squares slope of the velocity around each sample
+  for i, row in enumerate(rows):
+    window = [r for r in rows[max(i - 20, 0):i + 21] if abs(r[0] - row[0]) <= ACCELERATION_WINDOW]
+    n = len(window)
+    mean_t = sum(r[0] for r in window) / n
+    mean_v = sum(r[3] for r in window) / n
+    stt = sum((r[0] - mean_t)**2 for r in window)
+    stv = sum((r[0] - mean_t) * (r[3] - mean_v) for r in window)
+    row.append(stv / stt * 1000 if stt > 0 else 0)
+  return rows
+
+
+def solve(a, b):
+  """Solve a x = b by Gaussian elimination with partial pivoting."""
+  n = len(b)
+  m = [a[i][:] + [b[i]] for i in range(n)]
+  for col in range(n):
+    pivot = max(range(col, n), key=lambda r: abs(m[r][col]))
+    if abs(m[pivot][col]) < 1e-12:
+      raise ValueError('the logs do not excite every term; run both directions of both tests')
+    m[col], m[pivot] = m[pivot], m[col]
+    for r in range(col + 1, n):
+      k = m[r][col] / m[col][col]
+      for c in range(col, n + 1):
+        m[r][c] -= k * m[col][c]
+  x = [0.0] * n
+  for r in range(n - 1, -1, -1):
+    x[r] = (m[r][n] - sum(m[r][c] * x[c] for c in range(r + 1, n))) / m[r][r]
+  return x
+
+
+def fit(mechanism, rows):
+  """Fitted (kS, kV, kA, kG, horizontal), the number of samples used, and r^2."""
+  gravity = mechanism in GRAVITY
+  features, targets = [], []
+  for time, voltage, position, velocity, acceleration in rows:
+    if abs(velocity) < MIN_VELOCITY[mechanism] or voltage == 0:
+      continue
+    x = [math.copysign(1, velocity), velocity, acceleration]
+    if gravity:
+      x += [math.cos(math.radians(position)), math.sin(math.radians(position))]
+    features.append(x)
+    targets.append(voltage)
+  if len(features) < 20:
+    raise ValueError('too few moving samples (%d)' % len(features))
+
+  # normal equations
+  n = len(features[0])
+  a = [[sum(x[i] * x[j] for x in features) for j in range(n)] for i in range(n)]
+  b = [sum(x[i] * y for x, y in zip(features, targets)) for i in range(n)]
+  k = solve(a, b)
+
+  predicted = [sum(ki * xi for ki, xi in zip(k, x)) for x in features]
+  mean = sum(targets) / len(targets)
+  total = sum((y - mean)**2 for y in targets)
+  residual = sum((y - p)**2 for y, p in zip(targets, predicted))
+  r2 = 1 - residual / total if total > 0 else 1
+
+  # kG cos(p - h) = kG cos(h) cos(p) + kG sin(h) sin(p)
+  kg, horizontal = 0, 0
+  if gravity:
+    kg = math.hypot(k[3], k[4])
+    horizontal = math.degrees(math.atan2(k[4], k[3]))
+  return (k[0], k[1], k[2], kg, horizontal), len(features), r2
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Fit feedforward constants to characterization logs.')
+  parser.add_argument('-o', '--output', default='include/feedforward_gains.hpp')
+  parser.add_argument('logs', nargs='*')
+  args = parser.parse_args()
+
+  rows = {m: [] for m in MECHANISMS}
+  for path in args.logs:
+    match = LOG_NAME.match(os.path.basename(path))
+    if not match or match.group(1).upper() not in rows:
+      sys.exit('%s is not named like a characterization log' % path)
+    rows[match.group(1).upper()] += read_log(path)
+
+  lines = [
+    '#pragma once',
+    '',
+    '// Generated by tools/fit_feedforward.py; do not edit.',
+    '',
+    '#include "lib/feedforward.hpp"',
+    '',
+    'namespace feedforward_gains {',
+  ]
+  for mechanism in MECHANISMS:
+    if rows[mechanism]:
+      gains, count, r2 = fit(mechanism, rows[mechanism])
+      note = 'fitted to %d samples, r^2 = %.3f' % (count, r2)
+    else:
+      gains = DEFAULTS[mechanism]
+      note = 'hand-tuned; not characterized'
+    print('%s: kS %.1f, kV %.2f, kA %.3f, kG %.1f at %.1f deg (%s)' % ((mechanism,) + tuple(gains) + (note,)), file=sys.stderr)
+    lines.append('')
+    lines.append('  // %s' % note)
+    lines.append('  inline constexpr Feedforward %s = {%s};' % (mechanism, ', '.join('%.6g' % g for g in gains)))
+  lines.append('}')
+
+  with open(args.output, 'w') as f:
+    f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""
+Generate the autonomous trajectories ahead of time and pack them into include/trajectories.hpp.
+
+Each path is fitted with cubic Hermite splines through its waypoints, velocity-limited by
+wheel speed and acceleration, time-parameterized, and quantized to the 16-bit PackedSegment
+format in include/lib/packed_trajectory.hpp. The robot reads the table in place, so nothing
+is generated or parsed in initialize().
+
+Coordinates are in the odom frame: x is forward, y is to the right, and heading is clockwise.
+
+Usage: tools/pack_trajectories.py [output]
+"""
+
+import math
+import sys
+
+# physical limits
+MAX_VELOCITY = .45      # m/s
+MAX_ACCELERATION = 1.0  # m/s^2
+TRACK_WIDTH = 14 * .0254  # m
+DT = .01                # s
+
+# quantization steps; must match PackedSegment
+POSITION_STEP = .000125
+HEADING_STEP = .001
+VELOCITY_STEP = .0001
+ACCELERATION_STEP = .001
+ANGULAR_VELOCITY_STEP = .001
+
+# paths: name -> (waypoints as (x in, y in, heading deg), reversed)
+PATHS = {
+  'PUSH_CUBE_IN':  ([(0, 0, 0), (10, 0, 0)], False),
+  'PUSH_CUBE_OUT': ([(10, 0, 0), (0, 0, 0)], True),
+}
+
+SAMPLES_PER_PIECE = 1000
+
+
+def hermite(p0, p1, t0, t1, u):
+  """Position, first and second derivative of a cubic Hermite spline at u."""
+  h00 = 2 * u**3 - 3 * u**2 + 1
+  h10 = u**3 - 2 * u**2 + u
+  h01 = -2 * u**3 + 3 * u**2
+  h11 = u**3 - u**2
+  d00 = 6 * u**2 - 6 * u
+  d10 = 3 * u**2 - 4 * u + 1
+  d01 = -6 * u**2 + 6 * u
+  d11 = 3 * u**2 - 2 * u
+  s00 = 12 * u - 6
+  s10 = 6 * u - 4
+  s01 = -12 * u + 6
+  s11 = 6 * u - 2
+  pos = [h00 * p0[i] + h10 * t0[i] + h01 * p1[i] + h11 * t1[i] for i in range(2)]
+  vel = [d00 * p0[i] + d10 * t0[i] + d01 * p1[i] + d11 * t1[i] for i in range(2)]
+  acc = [s00 * p0[i] + s10 * t0[i] + s01 * p1[i] + s11 * t1[i] for i in range(2)]
+  return pos, vel, acc
+
+
+def sample_path(waypoints, reverse):
+  """Densely sample the spline: lists of (x, y, tangent heading, curvature, arc length)."""
+  points = []
+  s = 0
+  for (x0, y0, h0), (x1, y1, h1) in zip(waypoints, waypoints[1:]):
+    p0 = (x0 * .0254, y0 * .0254)
+    p1 = (x1 * .0254, y1 * .0254)
+    if reverse:
+      h0, h1 = h0 + 180, h1 + 180
+    scale = 1.2 * math.hypot(p1[0] - p0[0], p1[1] - p0[1])
+    t0 = (scale * math.cos(math.radians(h0)), scale * math.sin(math.radians(h0)))
+    t1 = (scale * math.cos(math.radians(h1)), scale * math.sin(math.radians(h1)))
+    for i in range(SAMPLES_PER_PIECE + 1):
+      if points and i == 0:
+        continue
+      pos, vel, acc = hermite(p0, p1, t0, t1, i / SAMPLES_PER_PIECE)
+      speed = math.hypot(*vel)
+      curvature = (vel[0] * acc[1] - vel[1] * acc[0]) / speed**3 if speed > 1e-9 else 0
+      if points:
+        s += math.hypot(pos[0] - points[-1][0], pos[1] - points[-1][1])
+      points.append((pos[0], pos[1], math.atan2(vel[1], vel[0]), curvature, s))
+  return points
+
+
+def profile(points):
+  """Velocity at each sample, limited by wheel speed and acceleration, starting and ending at rest."""
+  limit = [MAX_VELOCITY / (1 + abs(p[3]) * TRACK_WIDTH / 2) for p in points]
+  v = [0.0] * len(points)
+  for i in range(1, len(points)):
+    ds = points[i][4] - points[i - 1][4]
+    v[i] = min(limit[i], math.sqrt(v[i - 1]**2 + 2 * MAX_ACCELERATION * ds))
+  v[-1] = 0
+  for i in range(len(points) - 2, -1, -1):
+    ds = points[i + 1][4] - points[i][4]
+    v[i] = min(v[i], math.sqrt(v[i + 1]**2 + 2 * MAX_ACCELERATION * ds))
+  return v
+
+
+def generate(waypoints, reverse):
+  """Trajectory segments as (x, y, heading, velocity, acceleration, angular velocity) at DT intervals."""
+  points = sample_path(waypoints, reverse)
+  v = profile(points)
+
+  # time of each sample
+  times = [0.0]
+  for i in range(1, len(points)):
+    ds = points[i][4] - points[i - 1][4]
+    times.append(times[-1] + (2 * ds / (v[i] + v[i - 1]) if v[i] + v[i - 1] > 1e-9 else 0))
+
+  # resample at fixed intervals, keeping headings unwrapped
+  segments = []
+  j = 0
+  last_heading = None
+  count = int(math.ceil(times[-1] / DT)) + 1
+  for n in range(count):
+    t = min(n * DT, times[-1])
+    while j < len(times) - 2 and times[j + 1] < t:
+      j += 1
+    span = times[j + 1] - times[j]
+    k = (t - times[j]) / span if span > 0 else 0
+    a, b = points[j], points[j + 1]
+    x = a[0] + (b[0] - a[0]) * k
+    y = a[1] + (b[1] - a[1]) * k
+    heading = a[2] + math.remainder(b[2] - a[2], 2 * math.pi) * k
+    curvature = a[3] + (b[3] - a[3]) * k
+    velocity = v[j] + (v[j + 1] - v[j]) * k
+    if last_heading is not None:
+      heading = last_heading + math.remainder(heading - last_heading, 2 * math.pi)
+    last_heading = heading
+    angular_velocity = curvature * velocity
+    if reverse:
+      heading -= math.pi
+      velocity = -velocity
+    segments.append([x, y, heading, velocity, 0.0, angular_velocity])
+
+  # acceleration by central difference
+  for n in range(len(segments)):
+    prev = segments[max(n - 1, 0)][3]
+    nxt = segments[min(n + 1, len(segments) - 1)][3]
+    steps = min(n + 1, len(segments) - 1) - max(n - 1, 0)
+    segments[n][4] = (nxt - prev) / (steps * DT) if steps else 0
+  segments[-1][4] = 0
+  return segments
+
+
+def quantize(value, step):
+  q = int(round(value / step))
+  if not -32768 <= q <= 32767:
+    raise ValueError('%f does not fit in 16 bits at a step of %f' % (value, step))
+  return q
+
+
+def csv_size(segments):
+  """Size of the same path stored as pathfinder CSV (one file per side of the chassis)."""
+  size = len('dt,x,y,position,velocity,acceleration,jerk,heading\n')
+  for s in segments:
+    size += len('%f,%f,%f,%f,%f,%f,%f,%f\n' % (DT, s[0], s[1], 0, s[3], s[4], 0, s[2]))
+  return 2 * size
+
+
+def main():
+  output = sys.argv[1] if len(sys.argv) > 1 else 'include/trajectories.hpp'
+  steps = (POSITION_STEP, POSITION_STEP, HEADING_STEP, VELOCITY_STEP, ACCELERATION_STEP, ANGULAR_VELOCITY_STEP)
+
+  lines = [
+    '#pragma once',
+    '',
+    '// Generated by tools/pack_trajectories.py; do not edit.',
+    '',
+    '#include "lib/packed_trajectory.hpp"',
+    '',
+    'namespace trajectories {',
+  ]
+  for name, (waypoints, reverse) in PATHS.items():
+    segments = generate(waypoints, reverse)
+    packed = [[quantize(value, step) for value, step in zip(s, steps)] for s in segments]
+    lines.append('')
+    lines.append('  inline constexpr PackedSegment %s_SEGMENTS[] = {' % name)
+    for p in packed:
+      lines.append('    {%s},' % ', '.join(str(q) for q in p))
+    lines.append('  };')
+    lines.append('  inline constexpr PackedTrajectory %s = {%s_SEGMENTS, %d, %d};' % (name, name, len(packed), round(DT * 1000)))
+    print('%s: %d segments, %.2f s, %d bytes packed (12 B/segment), %d bytes as pathfinder CSV (%.1f B/segment)' % (
+      name, len(packed), (len(packed) - 1) * DT, 12 * len(packed), csv_size(segments), csv_size(segments) / len(packed)
+    ), file=sys.stderr)
+  lines.append('}')
+
+  with open(output, 'w') as f:
+    f.write('\n'.join(lines) + '\n')
+
+
+if __name__ == '__main__':
+  main()
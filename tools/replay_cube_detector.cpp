@@ -0,0 +1,150 @@
+/**
+ * Host replay harness for CubeDetector.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/replay_cube_detector trace.csv labels.csv
+ *   bin/host/replay_cube_detector --synthetic [seed]
+ *
+ * trace.csv is tools/decode_telemetry.py output; only "intake" rows (voltage, velocity, current, count) are used.
+ * labels.csv holds the true events as "time_ms,in" or "time_ms,out" rows, marked by hand from video or by watching the intake.
+ * A detection matches a label of the same kind within MATCH_WINDOW ms; precision and recall are reported.
+ * --synthetic generates a trace with known events, including spin-ups and jams that are not cubes.
+ */
+
+#include "lib/cube_detector.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr uint32_t MATCH_WINDOW = 300;
+
+  struct Sample {
+    uint32_t m_time;
+    int m_voltage;
+    double m_velocity;
+    double m_current;
+  };
+
+  struct Label {
+    uint32_t m_time;
+    CubeEvent m_event;
+  };
+
+  // read intake rows of decoded telemetry
+  bool read_trace(const char* path, std::vector<Sample>& samples) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+    char line[256];
+    unsigned time;
+    char channel[32];
+    double voltage, velocity, current;
+    while (std::fgets(line, sizeof(line), file)) {
+      if (std::sscanf(line, "%u,%31[^,],%lf,%lf,%lf", &time, channel, &voltage, &velocity, &current) == 5 && std::strcmp(channel, "intake") == 0) {
+        samples.push_back({time, int(voltage), velocity, current});
+      }
+    }
+    std::fclose(file);
+    return true;
+  }
+
+  // read hand-marked events
+  bool read_labels(const char* path, std::vector<Label>& labels) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+    char line[64];
+    unsigned time;
+    char kind[8];
+    while (std::fgets(line, sizeof(line), file)) {
+      if (std::sscanf(line, "%u,%7s", &time, kind) == 2) labels.push_back({time, std::strcmp(kind, "out") == 0 ? CubeEvent::OUT : CubeEvent::IN});
+    }
+    std::fclose(file);
+    return true;
+  }
+
+  // a driver intaking and scoring cubes, sampled at 50 Hz, with noise
+  void synthesize(unsigned seed, std::vector<Sample>& samples, std::vector<Label>& labels) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0, 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    uint32_t time = 0;
+    auto run = [&](int voltage, uint32_t duration, int cubes, int jams) {
+      double free_speed = voltage / 12000.0 * 1200;
+      uint32_t start = time;
+
+      // cubes pass at random times after spin-up; jams are short loads that are not cubes
+      std::vector<std::pair<uint32_t, uint32_t>> loads;
+      for (int i = 0; i < cubes + jams; ++i) {
+        uint32_t at = start + 400 + uint32_t(uniform(rng) * (duration - 800));
+        bool cube = i < cubes;
+        loads.push_back({at, cube ? 150 + uint32_t(uniform(rng) * 150) : 20});
+        if (cube) labels.push_back({at, voltage > 0 ? CubeEvent::IN : CubeEvent::OUT});
+      }
+      for (; time < start + duration; time += 20) {
+        double spin_up = 1 - std::exp(-double(time - start) / 80);
+        double load = 0;
+        for (auto& l : loads) if (time >= l.first && time < l.first + l.second) load = .5;
+        double speed = free_speed * spin_up * (1 - load) + noise(rng) * 15;
+        double current = std::abs(voltage) / 12000.0 * (300 + 2000 * (1 - spin_up) + 1500 * load) + noise(rng) * 40;
+        samples.push_back({time, voltage, speed, current});
+      }
+    };
+    for (int i = 0; i < 30; ++i) {
+      run(12000, 3000, 1 + rng() % 2, rng() % 2);
+      run(0, 500, 0, 0);
+      if (i % 5 == 4) {
+        run(-12000, 2000, 1, 0);
+        run(0, 500, 0, 0);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<Sample> samples;
+  std::vector<Label> labels;
+  if (argc >= 2 && std::strcmp(argv[1], "--synthetic") == 0) {
+    synthesize(argc >= 3 ? std::atoi(argv[2]) : 1, samples, labels);
+  } else if (argc == 3) {
+    if (!read_trace(argv[1], samples) || !read_labels(argv[2], labels)) {
+      std::perror("read");
+      return 1;
+    }
+  } else {
+    std::fprintf(stderr, "usage: %s trace.csv labels.csv | --synthetic [seed]\n", argv[0]);
+    return 1;
+  }
+
+  // replay
+  CubeDetector detector;
+  std::vector<Label> detections;
+  for (const Sample& sample : samples) {
+    CubeEvent event = detector.step(sample.m_time, sample.m_voltage, sample.m_velocity, sample.m_current);
+    if (event != CubeEvent::NONE) detections.push_back({sample.m_time, event});
+  }
+
+  // match each label to at most one detection
+  std::vector<bool> used(detections.size(), false);
+  size_t matched = 0;
+  for (const Label& label : labels) {
+    for (size_t i = 0; i < detections.size(); ++i) {
+      if (used[i] || detections[i].m_event != label.m_event) continue;
+      if (detections[i].m_time + MATCH_WINDOW >= label.m_time && detections[i].m_time <= label.m_time + MATCH_WINDOW) {
+        used[i] = true;
+        ++matched;
+        break;
+      }
+    }
+  }
+
+  std::printf("%zu samples, %zu labelled events, %zu detections, %zu matched\n", samples.size(), labels.size(), detections.size(), matched);
+  std::printf("precision %.3f, recall %.3f\n",
+    detections.empty() ? 1.0 : double(matched) / detections.size(),
+    labels.empty() ? 1.0 : double(matched) / labels.size());
+}
@@ -0,0 +1,253 @@
+/**
+ * Host replay of Odom (lib/odom.hpp) through encoder outages.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/replay_odom [--runs N] [--seed N] [--threads N]
+ *
+ * Each run drives a simulated robot around for a match: drives, arcs, turns in place and stops.
+ * The tracking wheels are quantized like the ADI encoders and the drive's integrated encoders are the backups,
+ * each with its own scale error, read together at the odom rate. The same readings are replayed through two Odoms:
+ * one sees every reading, the other sees the tracking wheels drop out now and then (as an unplugged ADI cable does),
+ * including on the very first update, and the backups more rarely.
+ * Both run without the IMU, so every inch and degree comes from the encoders, and the outages should cost little
+ * beyond the backups' own error: travel that one source has counted must not be counted again by the other.
+ *
+ * Runs share nothing, and every random number comes from the seed and the run's index,
+ * so the report does not depend on the thread count and runs scale across cores.
+ */
+
+#include "lib/odom.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // rates and lengths, in s
+  constexpr double ODOM_DT = .005; // subsystems::ODOM_RATE
+  constexpr double MATCH = 105;    // driver control
+
+  // the robot, in in; see subsystems.cpp
+  constexpr double TRACKING_WIDTH = 8;
+  constexpr double TRACKING_RADIUS = 1.375;
+  constexpr double ENCODER_DEGREES = 1; // ADI encoders count 360 per revolution
+  constexpr double DRIVE_WIDTH = 14;
+  constexpr double DRIVE_RADIUS = 2;
+  constexpr double IME_DEGREES = .4;    // the drive's integrated encoders count 900 per revolution
+
+  // outages start with these chances per update, and last up to this many updates
+  constexpr double PRIMARY_OUTAGE = .002;
+  constexpr double BACKUP_OUTAGE = .0005;
+  constexpr int OUTAGE_UPDATES = 40;
+
+  constexpr double DEG = M_PI / 180;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // what the robot is doing, and for how long
+  struct Segment {
+    double m_duration; ///< s
+    double m_speed;    ///< in/s
+    double m_turn;     ///< rad/s, clockwise positive
+  };
+
+  Segment next_segment(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    double kind = uniform(rng);
+    double duration = .3 + 1.7 * uniform(rng);
+    double sign = uniform(rng) < .5 ? -1 : 1;
+    if (kind < .45) return {duration, sign * (10 + 40 * uniform(rng)), std::normal_distribution<double>(0, 40 * DEG)(rng)};
+    if (kind < .75) return {duration * .5, 0, sign * (90 + 180 * uniform(rng)) * DEG};
+    return {duration, 0, 0};
+  }
+
+  // a wheel's reading in degrees, quantized to its encoder's counts
+  double read_wheel(double distance, double radius, double resolution) {
+    return std::floor(distance / radius / DEG / resolution) * resolution;
+  }
+
+  // in between a pose and the true position
+  double position_error(const Odom::ChassisPose& pose, double x, double y) {
+    return std::hypot(pose.m_x.convert(inch) - x, pose.m_y.convert(inch) - y);
+  }
+
+  // the result of one run
+  struct Outcome {
+    double m_clean_error;   ///< in between the true final position and that of the Odom that saw every reading
+    double m_outage_error;  ///< in between the true final position and that of the Odom that saw outages
+    double m_outage_cost;   ///< in between the two Odoms' final positions
+    double m_heading_cost;  ///< rad between the two Odoms' final headings
+    double m_primary_lost;  ///< fraction of updates without the tracking wheels
+  };
+
+  // one match
+  Outcome run(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::mt19937_64 outages(mix(seed));
+    std::normal_distribution<double> normal(0, 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    // every wheel scales differently on every robot, and the drive's wheels slip
+    double scale_left = 1 + .005 * normal(rng), scale_right = 1 + .005 * normal(rng);
+    double scale_left_backup = 1 + .02 * normal(rng), scale_right_backup = 1 + .02 * normal(rng);
+    double slip = .02;
+
+    Odom clean(TRACKING_WIDTH * inch, DRIVE_WIDTH * inch, 0_in, TRACKING_RADIUS * inch, DRIVE_RADIUS * inch);
+    Odom outage(TRACKING_WIDTH * inch, DRIVE_WIDTH * inch, 0_in, TRACKING_RADIUS * inch, DRIVE_RADIUS * inch);
+    double x = 0, y = 0, heading = 0, speed = 0, turn = 0;
+    double left = 0, right = 0, left_backup = 0, right_backup = 0;
+    int primary_down = 1, backup_down = 0;
+    size_t primary_lost = 0, updates = 0;
+    Segment segment = next_segment(rng);
+    double segment_end = segment.m_duration;
+
+    for (double time = 0; time <= MATCH; time += ODOM_DT) {
+      if (time >= segment_end) {
+        segment = next_segment(rng);
+        segment_end = time + segment.m_duration;
+      }
+
+      // the robot eases towards the segment's speeds
+      speed += (segment.m_speed - speed) * .1;
+      turn += (segment.m_turn - turn) * .1;
+      double travel = speed * ODOM_DT;
+      double d_heading = turn * ODOM_DT;
+      x += travel * std::cos(heading + d_heading * .5);
+      y += travel * std::sin(heading + d_heading * .5);
+      heading += d_heading;
+
+      // the wheels follow the robot
+      left += (travel + d_heading * TRACKING_WIDTH * .5) * scale_left;
+      right += (travel - d_heading * TRACKING_WIDTH * .5) * scale_right;
+      double drive_slip = 1 + slip * std::abs(normal(rng));
+      left_backup += (travel + d_heading * DRIVE_WIDTH * .5) * scale_left_backup * drive_slip;
+      right_backup += (travel - d_heading * DRIVE_WIDTH * .5) * scale_right_backup * drive_slip;
+
+      Odom::Readings readings = {
+        uint32_t(std::lround(time * 1000)),
+        read_wheel(left, TRACKING_RADIUS, ENCODER_DEGREES), read_wheel(right, TRACKING_RADIUS, ENCODER_DEGREES), 0,
+        read_wheel(left_backup, DRIVE_RADIUS, IME_DEGREES), read_wheel(right_backup, DRIVE_RADIUS, IME_DEGREES),
+        PROS_ERR
+      };
+      clean.update(readings);
+
+      // a tracking wheel or a backup drops out for a while
+      if (!primary_down && uniform(outages) < PRIMARY_OUTAGE) primary_down = 1 + int(uniform(outages) * OUTAGE_UPDATES);
+      if (!backup_down && uniform(outages) < BACKUP_OUTAGE) backup_down = 1 + int(uniform(outages) * OUTAGE_UPDATES);
+      if (primary_down) {
+        --primary_down;
+        ++primary_lost;
+        (uniform(outages) < .5 ? readings.m_left : readings.m_right) = PROS_ERR;
+      }
+      if (backup_down) {
+        --backup_down;
+        readings.m_left_backup = PROS_ERR;
+      }
+      outage.update(readings);
+      ++updates;
+    }
+
+    Odom::ChassisPose clean_pose = clean.get_pose(), outage_pose = outage.get_pose();
+    return {
+      position_error(clean_pose, x, y), position_error(outage_pose, x, y),
+      position_error(outage_pose, clean_pose.m_x.convert(inch), clean_pose.m_y.convert(inch)),
+      std::abs((outage_pose.m_heading - clean_pose.m_heading).convert(radian)), double(primary_lost) / updates
+    };
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, double scale, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-14s mean %7.3f  sd %7.3f  p5 %7.3f  p50 %7.3f  p95 %7.3f  max %7.3f %s\n", name,
+      mean * scale, deviation * scale, percentile(values, .05) * scale, percentile(values, .5) * scale,
+      percentile(values, .95) * scale, values.back() * scale, unit
+    );
+  }
+
+  // the cost of one update, in s, with the tracking wheels or only the backups reading
+  double time_updates(bool primary, double& sink) {
+    constexpr size_t UPDATES = 2000000;
+    Odom odom(TRACKING_WIDTH * inch, DRIVE_WIDTH * inch);
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < UPDATES; ++i) {
+      double wheel = double(i % 7) + i * .5;
+      odom.update({
+        uint32_t(i * 5), primary ? wheel : PROS_ERR, primary ? wheel + i % 3 : PROS_ERR, 0, wheel * .7, wheel * .7 + i % 2,
+        PROS_ERR
+      });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    sink += odom.get_pose().m_x.convert(inch);
+    return seconds / UPDATES;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 2000;
+  uint64_t seed = 1;
+  size_t threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--threads") && has_value) threads = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N] [--threads N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  WorkStealingPool pool(threads);
+  std::vector<Outcome> outcomes(runs);
+  auto begin = std::chrono::steady_clock::now();
+  pool.run(runs, [&](size_t index) {
+    outcomes[index] = run(mix(seed ^ mix(index)));
+  });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  std::vector<double> clean, outage, cost, heading_cost, lost;
+  for (const Outcome& outcome : outcomes) {
+    clean.push_back(outcome.m_clean_error);
+    outage.push_back(outcome.m_outage_error);
+    cost.push_back(outcome.m_outage_cost);
+    heading_cost.push_back(outcome.m_heading_cost);
+    lost.push_back(outcome.m_primary_lost);
+  }
+  std::printf("%zu runs of %.0f s, seed %llu\n", runs, MATCH, (unsigned long long)seed);
+  report("no outages", clean, 1, "in");
+  report("outages", outage, 1, "in");
+  report("outage cost", cost, 1, "in");
+  report("heading cost", heading_cost, 1 / DEG, "deg");
+  report("wheels lost", lost, 100, "%");
+  std::fprintf(stderr, "%.2f s on %zu threads (%.0f runs/s)\n", seconds, pool.size(), runs / seconds);
+
+  // the cost of one update, which the odom job pays at the odom rate
+  double sink = 0;
+  double primary = time_updates(true, sink);
+  double backup = time_updates(false, sink);
+  std::fprintf(
+    stderr, "%.1f ns per update on the tracking wheels, %.1f ns on the backups (%g)\n", primary * 1e9, backup * 1e9, sink
+  );
+}
@@ -0,0 +1,486 @@
+#include "sim.hpp"
+#include "main.h"
+#include <algorithm>
+#include <cmath>
+
+// okapi's devices and PROS's IMU and serial port, on the simulated robot
+
+namespace {
+
+  // tares of the ADI encoders, by top port
+  int32_t g_adi_zero[9] = {};
+
+  // a motor that is plugged in, counting the access
+  sim::Motor* read_motor(uint8_t port) {
+    sim::Motor& motor = sim::robot().motor(port);
+    ++motor.m_reads;
+    return motor.m_connected ? &motor : nullptr;
+  }
+  sim::Motor* write_motor(uint8_t port) {
+    sim::Motor& motor = sim::robot().motor(port);
+    ++motor.m_writes;
+    return motor.m_connected ? &motor : nullptr;
+  }
+}
+
+namespace okapi {
+
+  // interfaces
+  AbstractMotor::~AbstractMotor() = default;
+  RotarySensor::~RotarySensor() = default;
+  AbstractButton::~AbstractButton() = default;
+  bool AbstractButton::controllerGet() {
+    return isPressed();
+  }
+
+  // motor
+  Motor::Motor(std::int8_t iport):
+    Motor(std::abs(iport), iport < 0, AbstractMotor::gearset::green, AbstractMotor::encoderUnits::degrees)
+  {}
+  Motor::Motor(
+    std::uint8_t iport, bool ireverse, AbstractMotor::gearset igearset, AbstractMotor::encoderUnits,
+    const std::shared_ptr<Logger>&
+  ):
+    port(iport), reversed(ireverse ? -1 : 1)
+  {
+    sim::robot().motor(port).m_gearset = static_cast<int32_t>(igearset);
+  }
+  std::int32_t Motor::moveAbsolute(double, std::int32_t) {
+    write_motor(port);
+    return PROS_ERR;
+  }
+  std::int32_t Motor::moveRelative(double, std::int32_t) {
+    write_motor(port);
+    return PROS_ERR;
+  }
+  std::int32_t Motor::moveVelocity(std::int16_t ivelocity) {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_mode = sim::Motor::Mode::VELOCITY;
+    motor->m_command = ivelocity * reversed;
+    return 1;
+  }
+  std::int32_t Motor::moveVoltage(std::int16_t ivoltage) {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_mode = sim::Motor::Mode::VOLTAGE;
+    motor->m_command = std::max(-12000, std::min(12000, int32_t(ivoltage))) * reversed;
+    return 1;
+  }
+  std::int32_t Motor::modifyProfiledVelocity(std::int32_t) {
+    write_motor(port);
+    return PROS_ERR;
+  }
+  double Motor::getTargetPosition() {
+    return read_motor(port) ? 0 : PROS_ERR_F;
+  }
+  double Motor::getPosition() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? (motor->m_position - motor->m_zero) * reversed : PROS_ERR_F;
+  }
+  std::int32_t Motor::tarePosition() {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_zero = motor->m_position;
+    return 1;
+  }
+  std::int32_t Motor::getTargetVelocity() {
+    sim::Motor* motor = read_motor(port);
+    if (!motor) return PROS_ERR;
+    return motor->m_mode == sim::Motor::Mode::VELOCITY ? motor->m_command * reversed : 0;
+  }
+  double Motor::getActualVelocity() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? motor->m_velocity / 6 * reversed : PROS_ERR_F;
+  }
+  std::int32_t Motor::getCurrentDraw() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? int32_t(motor->m_current) : PROS_ERR;
+  }
+  std::int32_t Motor::getDirection() {
+    sim::Motor* motor = read_motor(port);
+    if (!motor) return PROS_ERR;
+    return motor->m_velocity * reversed < 0 ? -1 : 1;
+  }
+  double Motor::getEfficiency() {
+    return read_motor(port) ? 100 : PROS_ERR_F;
+  }
+  std::int32_t Motor::isOverCurrent() {
+    return read_motor(port) ? 0 : PROS_ERR;
+  }
+  std::int32_t Motor::isOverTemp() {
+    return read_motor(port) ? 0 : PROS_ERR;
+  }
+  std::int32_t Motor::isStopped() {
+    sim::Motor* motor = read_motor(port);
+    if (!motor) return PROS_ERR;
+    return std::abs(motor->m_velocity) < 1;
+  }
+  std::int32_t Motor::getZeroPositionFlag() {
+    return read_motor(port) ? 0 : PROS_ERR;
+  }
+  uint32_t Motor::getFaults() {
+    return read_motor(port) ? 0 : PROS_ERR;
+  }
+  uint32_t Motor::getFlags() {
+    return read_motor(port) ? 0 : PROS_ERR;
+  }
+  std::int32_t Motor::getRawPosition(std::uint32_t* timestamp) {
+    sim::Motor* motor = read_motor(port);
+    if (!motor) return PROS_ERR;
+    if (timestamp) *timestamp = pros::millis();
+    return int32_t(motor->m_position);
+  }
+  double Motor::getPower() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? motor->m_voltage * motor->m_current * 1e-6 : PROS_ERR_F;
+  }
+  double Motor::getTemperature() {
+    return read_motor(port) ? 30 : PROS_ERR_F;
+  }
+  double Motor::getTorque() {
+    return read_motor(port) ? 0 : PROS_ERR_F;
+  }
+  std::int32_t Motor::getVoltage() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? int32_t(motor->m_voltage) * reversed : PROS_ERR;
+  }
+  std::int32_t Motor::setBrakeMode(AbstractMotor::brakeMode imode) {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_brake_mode = static_cast<int32_t>(imode);
+    return 1;
+  }
+  AbstractMotor::brakeMode Motor::getBrakeMode() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? static_cast<AbstractMotor::brakeMode>(motor->m_brake_mode) : AbstractMotor::brakeMode::invalid;
+  }
+  std::int32_t Motor::setCurrentLimit(std::int32_t) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::int32_t Motor::getCurrentLimit() {
+    return read_motor(port) ? 2500 : PROS_ERR;
+  }
+  std::int32_t Motor::setEncoderUnits(AbstractMotor::encoderUnits) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  AbstractMotor::encoderUnits Motor::getEncoderUnits() {
+    return read_motor(port) ? AbstractMotor::encoderUnits::degrees : AbstractMotor::encoderUnits::invalid;
+  }
+  std::int32_t Motor::setGearing(AbstractMotor::gearset igearset) {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_gearset = static_cast<int32_t>(igearset);
+    return 1;
+  }
+  AbstractMotor::gearset Motor::getGearing() {
+    sim::Motor* motor = read_motor(port);
+    return motor ? static_cast<AbstractMotor::gearset>(motor->m_gearset) : AbstractMotor::gearset::invalid;
+  }
+  std::int32_t Motor::setReversed(bool ireverse) {
+    reversed = ireverse ? -1 : 1;
+    return 1;
+  }
+  std::int32_t Motor::setVoltageLimit(std::int32_t) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::int32_t Motor::setPosPID(double, double, double, double) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::int32_t Motor::setPosPIDFull(double, double, double, double, double, double, double, double) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::int32_t Motor::setVelPID(double, double, double, double) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::int32_t Motor::setVelPIDFull(double, double, double, double, double, double, double, double) {
+    return write_motor(port) ? 1 : PROS_ERR;
+  }
+  std::shared_ptr<ContinuousRotarySensor> Motor::getEncoder() {
+    return std::make_shared<IntegratedEncoder>(*this);
+  }
+  void Motor::controllerSet(double ivalue) {
+    moveVoltage(int16_t(ivalue * 12000));
+  }
+  std::uint8_t Motor::getPort() const {
+    return port;
+  }
+  bool Motor::isReversed() const {
+    return reversed < 0;
+  }
+
+  // motor encoder
+  IntegratedEncoder::IntegratedEncoder(const okapi::Motor& imotor):
+    IntegratedEncoder(imotor.getPort(), imotor.isReversed())
+  {}
+  IntegratedEncoder::IntegratedEncoder(std::int8_t iport, bool ireversed):
+    port(std::abs(iport)), reversed(ireversed ? -1 : 1)
+  {}
+  double IntegratedEncoder::get() const {
+    sim::Motor* motor = read_motor(port);
+    return motor ? (motor->m_position - motor->m_zero) * reversed : PROS_ERR_F;
+  }
+  std::int32_t IntegratedEncoder::reset() {
+    sim::Motor* motor = write_motor(port);
+    if (!motor) return PROS_ERR;
+    motor->m_zero = motor->m_position;
+    return 1;
+  }
+  double IntegratedEncoder::controllerGet() {
+    return get();
+  }
+
+  // quadrature encoder; enc packs the top port and the direction
+  ADIEncoder::ADIEncoder(std::uint8_t iportTop, std::uint8_t, bool ireversed):
+    enc((iportTop >= 'a' ? iportTop - 'a' + 1 : iportTop >= 'A' ? iportTop - 'A' + 1 : iportTop) | (ireversed << 8))
+  {}
+  double ADIEncoder::get() const {
+    uint8_t port = enc & 0xff;
+    int32_t count = sim::robot().read_encoder(port);
+    if (count == PROS_ERR) return PROS_ERR;
+    return double(count - g_adi_zero[port]) * (enc >> 8 ? -1 : 1);
+  }
+  std::int32_t ADIEncoder::reset() {
+    uint8_t port = enc & 0xff;
+    int32_t count = sim::robot().read_encoder(port);
+    if (count == PROS_ERR) return PROS_ERR;
+    g_adi_zero[port] = count;
+    return 1;
+  }
+  double ADIEncoder::controllerGet() {
+    return get();
+  }
+
+  // buttons
+  ButtonBase::ButtonBase(bool iinverted): inverted(iinverted) {}
+  bool ButtonBase::isPressed() {
+    return currentlyPressed() != inverted;
+  }
+  bool ButtonBase::changed() {
+    return changedImpl(wasPressedLast_c);
+  }
+  bool ButtonBase::changedToPressed() {
+    return changedImpl(wasPressedLast_ctp) && wasPressedLast_ctp;
+  }
+  bool ButtonBase::changedToReleased() {
+    return changedImpl(wasPressedLast_ctr) && !wasPressedLast_ctr;
+  }
+  bool ButtonBase::changedImpl(bool& prevState) {
+    bool pressed = isPressed();
+    bool changed = pressed != prevState;
+    prevState = pressed;
+    return changed;
+  }
+  ControllerButton::ControllerButton(ControllerDigital ibtn, bool iinverted):
+    ControllerButton(ControllerId::master, ibtn, iinverted)
+  {}
+  ControllerButton::ControllerButton(ControllerId icontroller, ControllerDigital ibtn, bool iinverted):
+    ButtonBase(iinverted),
+    id(static_cast<pros::controller_id_e_t>(icontroller)),
+    btn(static_cast<pros::controller_digital_e_t>(ibtn))
+  {}
+  bool ControllerButton::currentlyPressed() {
+    return id == pros::E_CONTROLLER_MASTER && sim::robot().m_digital[btn];
+  }
+
+  // controller
+  Controller::Controller(ControllerId iid):
+    okapiId(iid), prosId(static_cast<pros::controller_id_e_t>(iid)), buttonArray{}
+  {}
+  Controller::~Controller() {
+    for (ControllerButton* button : buttonArray) delete button;
+  }
+  bool Controller::isConnected() {
+    return prosId == pros::E_CONTROLLER_MASTER;
+  }
+  float Controller::getAnalog(ControllerAnalog ichannel) {
+    return isConnected() ? sim::robot().m_analog[static_cast<int>(ichannel)] : 0;
+  }
+  bool Controller::getDigital(ControllerDigital ibutton) {
+    return operator[](ibutton).isPressed();
+  }
+  ControllerButton& Controller::operator[](ControllerDigital ibtn) {
+    size_t index = static_cast<size_t>(ibtn) - static_cast<size_t>(ControllerDigital::L1);
+    if (!buttonArray[index]) buttonArray[index] = new ControllerButton(okapiId, ibtn);
+    return *buttonArray[index];
+  }
+  std::int32_t Controller::setText(std::uint8_t, std::uint8_t, std::string) {
+    return 1;
+  }
+  std::int32_t Controller::clear() {
+    return 1;
+  }
+  std::int32_t Controller::clearLine(std::uint8_t) {
+    return 1;
+  }
+  std::int32_t Controller::rumble(std::string) {
+    return 1;
+  }
+  std::int32_t Controller::getBatteryCapacity() {
+    return 100;
+  }
+  std::int32_t Controller::getBatteryLevel() {
+    return 100;
+  }
+
+  // timers
+  AbstractTimer::AbstractTimer(QTime ifirstCalled):
+    firstCalled(ifirstCalled), lastCalled(ifirstCalled), mark(ifirstCalled), hardMark(0_ms), repeatMark(ifirstCalled)
+  {}
+  AbstractTimer::~AbstractTimer() = default;
+  QTime AbstractTimer::getDt() {
+    QTime now = millis();
+    QTime dt = now - lastCalled;
+    lastCalled = now;
+    return dt;
+  }
+  QTime AbstractTimer::readDt() const {
+    return millis() - lastCalled;
+  }
+  QTime AbstractTimer::getStartingTime() const {
+    return firstCalled;
+  }
+  QTime AbstractTimer::getDtFromStart() const {
+    return millis() - firstCalled;
+  }
+  void AbstractTimer::placeMark() {
+    mark = millis();
+  }
+  QTime AbstractTimer::clearMark() {
+    QTime old = mark;
+    mark = 0_ms;
+    return old;
+  }
+  void AbstractTimer::placeHardMark() {
+    if (hardMark == 0_ms) hardMark = millis();
+  }
+  QTime AbstractTimer::clearHardMark() {
+    QTime old = hardMark;
+    hardMark = 0_ms;
+    return old;
+  }
+  QTime AbstractTimer::getDtFromMark() const {
+    return mark != 0_ms ? millis() - mark : 0_ms;
+  }
+  QTime AbstractTimer::getDtFromHardMark() const {
+    return hardMark != 0_ms ? millis() - hardMark : 0_ms;
+  }
+  bool AbstractTimer::repeat(QTime time) {
+    if (repeatMark == 0_ms) {
+      repeatMark = millis();
+      return false;
+    }
+    if (millis() - repeatMark >= time) {
+      repeatMark = 0_ms;
+      return true;
+    }
+    return false;
+  }
+  bool AbstractTimer::repeat(QFrequency frequency) {
+    return repeat(QTime(1 / frequency.convert(Hz)));
+  }
+  Timer::Timer(): AbstractTimer(millis()) {}
+  QTime Timer::millis() const {
+    return pros::millis() * millisecond;
+  }
+
+  // logging is off
+  std::shared_ptr<Logger> defaultLogger;
+  int DefaultLoggerInitializer::count = 0;
+  Logger::Logger() noexcept: timer(nullptr), logLevel(LogLevel::off), logfile(nullptr) {}
+  Logger::Logger(std::unique_ptr<AbstractTimer> itimer, std::string_view, const LogLevel& ilevel) noexcept:
+    timer(std::move(itimer)), logLevel(ilevel), logfile(nullptr)
+  {}
+  Logger::Logger(std::unique_ptr<AbstractTimer> itimer, FILE*, const LogLevel& ilevel) noexcept:
+    timer(std::move(itimer)), logLevel(ilevel), logfile(nullptr)
+  {}
+  Logger::~Logger() = default;
+  std::shared_ptr<Logger> Logger::getDefaultLogger() {
+    return defaultLogger;
+  }
+  void Logger::setDefaultLogger(std::shared_ptr<Logger> ilogger) {
+    defaultLogger = std::move(ilogger);
+  }
+}
+
+namespace pros {
+
+  // IMU
+  std::int32_t Imu::reset() const {
+    sim::robot().reset_imu();
+    return 1;
+  }
+  double Imu::get_rotation() const {
+    return sim::robot().read_imu_rotation();
+  }
+  double Imu::get_heading() const {
+    double rotation = get_rotation();
+    return std::isfinite(rotation) ? rotation - 360 * std::floor(rotation / 360) : rotation;
+  }
+  c::quaternion_s_t Imu::get_quaternion() const {
+    return {0, 0, 0, 1};
+  }
+  c::euler_s_t Imu::get_euler() const {
+    return {0, 0, get_yaw()};
+  }
+  double Imu::get_pitch() const {
+    return 0;
+  }
+  double Imu::get_roll() const {
+    return 0;
+  }
+  double Imu::get_yaw() const {
+    double rotation = get_rotation();
+    return std::isfinite(rotation) ? std::remainder(rotation, 360) : rotation;
+  }
+  c::imu_gyro_s_t Imu::get_gyro_rate() const {
+    return {0, 0, 0};
+  }
+  c::imu_accel_s_t Imu::get_accel() const {
+    return {0, 0, 0};
+  }
+  c::imu_status_e_t Imu::get_status() const {
+    return is_calibrating() ? c::E_IMU_STATUS_CALIBRATING : static_cast<c::imu_status_e_t>(0);
+  }
+  bool Imu::is_calibrating() const {
+    return sim::robot().is_imu_calibrating();
+  }
+
+  // serial
+  Serial::Serial(std::uint8_t port, std::int32_t): _port(port) {}
+  Serial::Serial(std::uint8_t port): _port(port) {}
+  std::int32_t Serial::set_baudrate(std::int32_t) const {
+    return 1;
+  }
+  std::int32_t Serial::flush() const {
+    return 1;
+  }
+  std::int32_t Serial::get_read_avail() const {
+    return 0;
+  }
+  std::int32_t Serial::get_write_free() const {
+    return sim::robot().get_serial_free();
+  }
+  std::uint8_t Serial::get_port() const {
+    return _port;
+  }
+  std::int32_t Serial::peek_byte() const {
+    return -1;
+  }
+  std::int32_t Serial::read_byte() const {
+    return -1;
+  }
+  std::int32_t Serial::read(std::uint8_t*, std::int32_t) const {
+    return 0;
+  }
+  std::int32_t Serial::write_byte(std::uint8_t) const {
+    if (sim::robot().get_serial_free() < 1) return 0;
+    sim::robot().write_serial(1);
+    return 1;
+  }
+  std::int32_t Serial::write(std::uint8_t*, std::int32_t length) const {
+    std::int32_t written = std::max(0, std::min(length, sim::robot().get_serial_free()));
+    sim::robot().write_serial(written);
+    return written;
+  }
+}
@@ -0,0 +1,399 @@
+#include "sim.hpp"
+#include "api.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim {
+
+  namespace {
+
+    // what a blocked task waits for
+    enum class Wait { NONE, DELAY, NOTIFY, MUTEX };
+
+    struct Task {
+      std::string m_name;
+      uint32_t m_priority;
+      pros::task_fn_t m_function;
+      void* m_parameters;
+      std::condition_variable m_turn;
+
+      Wait m_wait = Wait::NONE;
+      bool m_timed = false;   ///< Whether m_wake applies
+      uint32_t m_wake = 0;
+      bool m_ready = false;
+      bool m_done = false;
+
+      uint32_t m_notify_value = 0;
+      bool m_notify_pending = false;
+    };
+
+    struct Mutex {
+      Task* m_owner = nullptr;
+      std::deque<Task*> m_waiters;
+    };
+
+    // kernel state; leaked, so that blocked tasks outlive static destructors
+    struct Kernel {
+      std::mutex m_lock;
+      std::condition_variable m_stopped;
+      std::vector<Task*> m_tasks;
+      std::deque<Task*> m_ready;  ///< In the order they became ready
+      Task* m_current = nullptr;
+      bool m_stop = false;
+      bool m_finished = false;
+      uint32_t m_limit = 0;
+      std::function<void()> m_tick;
+      uint64_t m_switches = 0;
+    };
+
+    Kernel& kernel() {
+      static Kernel* kernel = new Kernel;
+      return *kernel;
+    }
+
+    // the clock, readable from any thread
+    std::atomic<uint32_t> g_time{0};
+
+    // the task on this thread
+    thread_local Task* t_self = nullptr;
+
+    // wait for the CPU
+    void wait_turn(std::unique_lock<std::mutex>& lock, Task* task) {
+      task->m_turn.wait(lock, [task] { return kernel().m_current == task; });
+    }
+
+    // make a task ready; a mutex waiter may time out and be handed the mutex before it runs
+    void make_ready(Task* task) {
+      task->m_wait = Wait::NONE;
+      task->m_timed = false;
+      if (task->m_ready) return;
+      task->m_ready = true;
+      kernel().m_ready.push_back(task);
+    }
+
+    // take the highest priority ready task, the earliest of equals
+    Task* take_ready() {
+      std::deque<Task*>& ready = kernel().m_ready;
+      if (ready.empty()) return nullptr;
+      auto best = ready.begin();
+      for (auto it = ready.begin(); it != ready.end(); ++it) {
+        if ((*it)->m_priority > (*best)->m_priority) best = it;
+      }
+      Task* task = *best;
+      ready.erase(best);
+      task->m_ready = false;
+      return task;
+    }
+
+    // advance the clock until a task is ready
+    Task* advance() {
+      Kernel& k = kernel();
+      while (true) {
+        if (Task* task = take_ready()) return task;
+        if (g_time.load(std::memory_order_relaxed) >= k.m_limit) return nullptr;
+        uint32_t now = g_time.load(std::memory_order_relaxed) + 1;
+        g_time.store(now, std::memory_order_relaxed);
+        robot().step();
+        if (k.m_tick) k.m_tick();
+
+        // wake timed waits in the order they block
+        for (Task* task : k.m_tasks) {
+          if (task->m_wait == Wait::NONE || !task->m_timed || int32_t(now - task->m_wake) < 0) continue;
+          make_ready(task);
+        }
+      }
+    }
+
+    // give the CPU to the next task; the caller is already ready, blocked or done
+    void dispatch(std::unique_lock<std::mutex>& lock, Task* self) {
+      Kernel& k = kernel();
+      Task* next = advance();
+      if (!next) {
+        k.m_stop = true;
+        k.m_current = nullptr;
+        k.m_stopped.notify_all();
+      }
+      else {
+        if (next != k.m_current) ++k.m_switches;
+        k.m_current = next;
+        next->m_turn.notify_one();
+      }
+      if (self && !self->m_done) wait_turn(lock, self);
+    }
+
+    // let a higher priority task run
+    void preempt(std::unique_lock<std::mutex>& lock) {
+      Task* self = t_self;
+      if (!self || kernel().m_current != self) return;
+      for (Task* task : kernel().m_ready) {
+        if (task->m_priority > self->m_priority) {
+          make_ready(self);
+          dispatch(lock, self);
+          return;
+        }
+      }
+    }
+
+    // block the current task
+    void block(std::unique_lock<std::mutex>& lock, Wait wait, uint32_t timeout) {
+      Task* self = t_self;
+      self->m_wait = wait;
+      self->m_timed = timeout != TIMEOUT_MAX;
+      self->m_wake = g_time.load(std::memory_order_relaxed) + timeout;
+      dispatch(lock, self);
+    }
+
+    // body of a task's thread
+    void start(Task* task) {
+      std::unique_lock<std::mutex> lock(kernel().m_lock);
+      t_self = task;
+      wait_turn(lock, task);
+      lock.unlock();
+      task->m_function(task->m_parameters);
+      lock.lock();
+      task->m_done = true;
+      dispatch(lock, task);
+    }
+  }
+
+  // robot
+  Robot& robot() {
+    static Robot* robot = new Robot;
+    return *robot;
+  }
+
+  // run
+  bool run(std::function<void()> program, uint32_t limit, std::function<void()> tick) {
+    Kernel& k = kernel();
+    // the world stops when the program returns, with its task holding the CPU
+    std::function<void()>* main = new std::function<void()>([program = std::move(program)]() {
+      program();
+      Kernel& k = kernel();
+      std::unique_lock<std::mutex> lock(k.m_lock);
+      k.m_finished = true;
+      k.m_stopped.notify_all();
+      k.m_stopped.wait(lock, [] { return false; });
+    });
+    pros::c::task_create(
+      [](void* parameters) { (*static_cast<std::function<void()>*>(parameters))(); },
+      main, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "main"
+    );
+
+    std::unique_lock<std::mutex> lock(k.m_lock);
+    k.m_limit = limit;
+    k.m_tick = std::move(tick);
+    dispatch(lock, nullptr);
+    k.m_stopped.wait(lock, [&k] { return k.m_stop || k.m_finished; });
+    return k.m_finished;
+  }
+
+  // switches
+  uint64_t get_switch_count() {
+    std::lock_guard<std::mutex> lock(kernel().m_lock);
+    return kernel().m_switches;
+  }
+}
+
+using sim::kernel;
+using sim::t_self;
+using sim::g_time;
+
+namespace pros::c {
+
+  // clock
+  uint32_t millis() {
+    return g_time.load(std::memory_order_relaxed);
+  }
+
+  // tasks
+  task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t, const char* const name) {
+    sim::Task* task = new sim::Task;
+    task->m_name = name ? name : "";
+    task->m_priority = std::min<uint32_t>(std::max<uint32_t>(prio, TASK_PRIORITY_MIN), TASK_PRIORITY_MAX);
+    task->m_function = function;
+    task->m_parameters = parameters;
+
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    kernel().m_tasks.push_back(task);
+    sim::make_ready(task);
+    std::thread(sim::start, task).detach();
+    sim::preempt(lock);
+    return task;
+  }
+  void task_delay(const uint32_t milliseconds) {
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    if (!t_self) return;
+    if (milliseconds == 0) {
+      sim::make_ready(t_self);
+      sim::dispatch(lock, t_self);
+    }
+    else sim::block(lock, sim::Wait::DELAY, milliseconds);
+  }
+  void delay(const uint32_t milliseconds) {
+    task_delay(milliseconds);
+  }
+  void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+    *prev_time += delta;
+    int32_t remaining = int32_t(*prev_time - millis());
+    task_delay(remaining > 0 ? remaining : 0);
+  }
+  task_t task_get_current() {
+    return t_self;
+  }
+  uint32_t task_get_count() {
+    std::lock_guard<std::mutex> lock(kernel().m_lock);
+    return std::count_if(kernel().m_tasks.begin(), kernel().m_tasks.end(), [](sim::Task* task) { return !task->m_done; });
+  }
+  char* task_get_name(task_t task) {
+    return static_cast<sim::Task*>(task)->m_name.data();
+  }
+  uint32_t task_get_priority(task_t task) {
+    return static_cast<sim::Task*>(task)->m_priority;
+  }
+
+  // notifications
+  uint32_t task_notify_ext(task_t task, uint32_t value, notify_action_e_t action, uint32_t* prev_value) {
+    sim::Task* target = static_cast<sim::Task*>(task);
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    if (prev_value) *prev_value = target->m_notify_value;
+    switch (action) {
+      case E_NOTIFY_ACTION_NONE: break;
+      case E_NOTIFY_ACTION_BITS: target->m_notify_value |= value; break;
+      case E_NOTIFY_ACTION_INCR: ++target->m_notify_value; break;
+      case E_NOTIFY_ACTION_OWRITE: target->m_notify_value = value; break;
+      case E_NOTIFY_ACTION_NO_OWRITE:
+        if (target->m_notify_pending) return 0;
+        target->m_notify_value = value;
+        break;
+    }
+    target->m_notify_pending = true;
+    if (target->m_wait == sim::Wait::NOTIFY) {
+      sim::make_ready(target);
+      sim::preempt(lock);
+    }
+    return 1;
+  }
+  uint32_t task_notify(task_t task) {
+    return task_notify_ext(task, 0, E_NOTIFY_ACTION_INCR, nullptr);
+  }
+  uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    sim::Task* self = t_self;
+    if (!self) return 0;
+    if (self->m_notify_value == 0 && timeout) sim::block(lock, sim::Wait::NOTIFY, timeout);
+    uint32_t value = self->m_notify_value;
+    if (value) self->m_notify_value = clear_on_exit ? 0 : value - 1;
+    self->m_notify_pending = false;
+    return value;
+  }
+  bool task_notify_clear(task_t task) {
+    sim::Task* target = static_cast<sim::Task*>(task);
+    std::lock_guard<std::mutex> lock(kernel().m_lock);
+    bool pending = target->m_notify_pending;
+    target->m_notify_pending = false;
+    return pending;
+  }
+
+  // mutexes
+  mutex_t mutex_create() {
+    return new sim::Mutex;
+  }
+  bool mutex_take(mutex_t mutex, uint32_t timeout) {
+    sim::Mutex* m = static_cast<sim::Mutex*>(mutex);
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    sim::Task* self = t_self;
+    if (!m->m_owner) {
+      m->m_owner = self;
+      return true;
+    }
+    if (!self || !timeout) return false;
+    m->m_waiters.push_back(self);
+    sim::block(lock, sim::Wait::MUTEX, timeout);
+    if (m->m_owner == self) return true;
+    m->m_waiters.erase(std::find(m->m_waiters.begin(), m->m_waiters.end(), self));
+    return false;
+  }
+  bool mutex_give(mutex_t mutex) {
+    sim::Mutex* m = static_cast<sim::Mutex*>(mutex);
+    std::unique_lock<std::mutex> lock(kernel().m_lock);
+    if (m->m_owner != t_self) return false;
+    m->m_owner = nullptr;
+    if (m->m_waiters.empty()) return true;
+
+    // hand it to the highest priority waiter
+    auto next = m->m_waiters.begin();
+    for (auto it = m->m_waiters.begin(); it != m->m_waiters.end(); ++it) {
+      if ((*it)->m_priority > (*next)->m_priority) next = it;
+    }
+    m->m_owner = *next;
+    m->m_waiters.erase(next);
+    sim::make_ready(m->m_owner);
+    sim::preempt(lock);
+    return true;
+  }
+}
+
+// the V5's microsecond timer, for CpuMeter
+extern "C" uint64_t vexSystemHighResTimeGet(void) {
+  return uint64_t(pros::c::millis()) * 1000;
+}
+
+namespace pros {
+
+  // tasks
+  Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name):
+    task(c::task_create(function, parameters, prio, stack_depth, name))
+  {}
+  Task::Task(task_fn_t function, void* parameters, const char* name):
+    Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name)
+  {}
+  Task::Task(task_t task): task(task) {}
+  Task Task::current() {
+    return Task(c::task_get_current());
+  }
+  void Task::operator=(const task_t in) {
+    task = in;
+  }
+  std::uint32_t Task::get_priority() {
+    return c::task_get_priority(task);
+  }
+  const char* Task::get_name() {
+    return c::task_get_name(task);
+  }
+  std::uint32_t Task::notify() {
+    return c::task_notify(task);
+  }
+  std::uint32_t Task::notify_ext(std::uint32_t value, notify_action_e_t action, std::uint32_t* prev_value) {
+    return c::task_notify_ext(task, value, action, prev_value);
+  }
+  std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    return c::task_notify_take(clear_on_exit, timeout);
+  }
+  bool Task::notify_clear() {
+    return c::task_notify_clear(task);
+  }
+  void Task::delay(const std::uint32_t milliseconds) {
+    c::task_delay(milliseconds);
+  }
+  void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    c::task_delay_until(prev_time, delta);
+  }
+  std::uint32_t Task::get_count() {
+    return c::task_get_count();
+  }
+
+  // mutexes
+  Mutex::Mutex(): mutex(c::mutex_create()) {}
+  bool Mutex::take(std::uint32_t timeout) {
+    return c::mutex_take(mutex, timeout);
+  }
+  bool Mutex::give() {
+    return c::mutex_give(mutex);
+  }
+}
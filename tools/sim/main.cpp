@@ -0,0 +1,110 @@
+/**
+ * Host simulation of the robot code: runs initialize() and autonomous() from src/ unchanged on a simulated robot.
+ *
+ * Build and run from the repository root:
+ *   make sim
+ *   bin/host/sim [--seed N] [--idle MS] [--limit MS] [--telemetry FILE]
+ *
+ * The robot sits still for --idle ms after initialize() while the IMU calibrates, as it does before a match,
+ * then runs the autonomous routine until it returns or --limit ms have passed.
+ * Seed 0 is the nominal robot; any other seed perturbs it as in tools/sim/robot.hpp.
+ * The binary telemetry stream that the robot writes to stdout goes to --telemetry (default /dev/null),
+ * for tools/decode_telemetry.py; the report goes to the original stdout.
+ */
+
+#include "sim.hpp"
+#include "main.h"
+#include "subsystems/subsystems.hpp"
+#include "controllers/controllers.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+  uint64_t seed = 0;
+  uint32_t idle = 3000;
+  uint32_t limit = 30000;
+  const char* telemetry = "/dev/null";
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--seed")) seed = strtoull(argv[i + 1], nullptr, 10);
+    else if (!strcmp(argv[i], "--idle")) idle = strtoul(argv[i + 1], nullptr, 10);
+    else if (!strcmp(argv[i], "--limit")) limit = strtoul(argv[i + 1], nullptr, 10);
+    else if (!strcmp(argv[i], "--telemetry")) telemetry = argv[i + 1];
+    else {
+      fprintf(stderr, "usage: %s [--seed N] [--idle MS] [--limit MS] [--telemetry FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // the robot's stdout is the telemetry stream
+  FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+  int stream = open(telemetry, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (!report || stream < 0) {
+    perror(telemetry);
+    return 1;
+  }
+  fflush(stdout);
+  dup2(stream, STDOUT_FILENO);
+  close(stream);
+
+  sim::robot().reset(seed);
+  uint32_t start = 0;
+  uint32_t end = 0;
+  bool finished = sim::run([&]() {
+    initialize();
+    pros::delay(idle);
+    start = pros::millis();
+    autonomous();
+    end = pros::millis();
+  }, limit);
+
+  // report
+  using namespace subsystems;
+  sim::Robot::Pose truth = sim::robot().get_pose();
+  Odom::ChassisPose pose = chassis->get_pose();
+  fprintf(report, "seed %llu\n", (unsigned long long)seed);
+  if (finished) fprintf(report, "autonomous  %u ms\n", end - start);
+  else fprintf(report, "autonomous  did not finish within %u ms\n", limit);
+  fprintf(
+    report, "true pose   x %7.2f in  y %7.2f in  heading %7.2f deg\n", truth.m_x, truth.m_y, truth.m_heading
+  );
+  fprintf(
+    report, "odom pose   x %7.2f in  y %7.2f in  heading %7.2f deg\n",
+    pose.m_x.convert(inch), pose.m_y.convert(inch), pose.m_heading.convert(degree)
+  );
+  fprintf(
+    report, "mechanisms  tilter %.1f deg  lift %.1f deg  cubes %zu\n",
+    sim::robot().get_tilter_angle(), sim::robot().get_lift_angle(), sim::robot().get_cube_count()
+  );
+
+  Sensors::ReadStats reads = sensors->get_read_stats();
+  fprintf(report, "sensors     %u samples  %u reads  %u errors\n", reads.m_samples, reads.m_reads, reads.m_errors);
+  CachedMotor::WriteStats writes[] = {
+    transmission->get_write_stats(), lift->get_write_stats(), intake->get_write_stats()
+  };
+  const char* names[] = {"transmission", "lift", "intake"};
+  for (size_t i = 0; i < 3; ++i) {
+    fprintf(report, "writes      %-12s %u issued  %u suppressed\n", names[i], writes[i].m_issued, writes[i].m_suppressed);
+  }
+  for (size_t i = 0; i < scheduler->size(); ++i) {
+    Scheduler::JobStats stats = scheduler->get_stats(i);
+    fprintf(
+      report, "job         %-12s %u runs  %u overruns  %u skipped  max jitter %u ms\n",
+      scheduler->get_name(i), stats.m_runs, stats.m_overruns, stats.m_skipped, stats.m_max_jitter
+    );
+  }
+  sim::Traffic traffic = sim::robot().get_traffic();
+  fprintf(
+    report, "devices     %u motor reads  %u motor writes  %u encoder reads  %u IMU reads  %u serial bytes\n",
+    traffic.m_motor_reads, traffic.m_motor_writes, traffic.m_encoder_reads, traffic.m_imu_reads, traffic.m_serial_bytes
+  );
+  fprintf(report, "kernel      %llu task switches\n", (unsigned long long)sim::get_switch_count());
+
+  // the robot's tasks are still parked, so skip static destructors
+  fflush(report);
+  fflush(stdout);
+  std::_Exit(finished ? 0 : 2);
+}
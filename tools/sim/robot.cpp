@@ -0,0 +1,384 @@
+#include "robot.hpp"
+#include "feedforward_gains.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace sim {
+
+  namespace {
+
+    constexpr double DT = .001;
+    constexpr double DEG = M_PI / 180;
+
+    // a motor and the direction it turns its mechanism forwards
+    struct Wiring {
+      uint8_t m_port;
+      double m_sign;
+    };
+
+    // src/subsystems/subsystems.cpp; motors constructed reversed turn their mechanism backwards
+    constexpr Wiring DIRECT_MOTORS[2] = {{11, -1}, {20, 1}};
+    constexpr Wiring SHARED_MOTORS[2] = {{15, -1}, {16, 1}};
+    constexpr Wiring LIFT_MOTORS[2] = {{1, 1}, {18, -1}};
+    constexpr Wiring INTAKE_MOTORS[2] = {{12, 1}, {19, -1}};
+    constexpr uint8_t TRACKING_PORTS[3] = {'G', 'C', 'E'}; // left, right, side
+
+    // the chassis, in in
+    constexpr double DRIVE_WHEEL = 2 * M_PI * 2 / 360;        // per motor deg; 4 in wheels on the motors
+    constexpr double TRACK_WIDTH = 14;
+    constexpr double TRACKING_WHEEL = 2 * M_PI * 1.375 / 360; // per count
+    constexpr double TRACKING_WIDTH = 8;
+    constexpr double RED_RPM = 100;
+
+    // mechanisms
+    constexpr double TILTER_RATIO = 5; // motor deg per deg
+    constexpr double MAX_TILT = 95;    // deg
+    constexpr double LOCK_LIFT = 20;   // the lift locks the tray above this, in deg
+    constexpr double LOCK_TILT = 3.5;  // if the tray is behind this, in deg
+    constexpr double LIFT_RATIO = 5;   // motor deg per deg
+    constexpr double MAX_LIFT = 85;    // deg
+    constexpr double LIFT_COUPLING = 3000; // mV per deg of difference between the sides
+    constexpr double CUBE_MASS_RATIO = .08;
+
+    // cubes load the rollers while they pass, in mV, deg/s and ms
+    constexpr double CUBE_LOAD = 4000;
+    constexpr double CUBE_SPEED = 60;
+    constexpr uint32_t CUBE_TIME = 250;
+
+    // the motors' own controllers, in mV per deg and deg/s
+    constexpr double HOLD_KP = 300;
+    constexpr double HOLD_KD = 10;
+    constexpr double BRAKE_KD = 20;
+    constexpr double VELOCITY_KP = 30;
+    constexpr double STALL_CURRENT = 2500; // mA
+
+    // IMU
+    constexpr uint32_t IMU_CALIBRATION = 2000; // ms
+    constexpr uint32_t IMU_PERIOD = 10;        // ms
+    constexpr double IMU_NOISE = .01;          // deg
+
+    // serial link, in bytes
+    constexpr double SERIAL_BUFFER = 1024;
+    constexpr double SERIAL_RATE = 115200 / 10 * DT; // per ms
+
+    // move a joint, whose static friction holds it until overcome
+    void integrate(double& position, double& velocity, double force, double friction, double mass) {
+      if (std::abs(velocity) < 1e-3 && std::abs(force) <= friction) {
+        velocity = 0;
+        return;
+      }
+      double net = force - std::copysign(friction, std::abs(velocity) < 1e-3 ? force : velocity);
+      double next = velocity + net / mass * DT;
+
+      // friction stops the joint rather than reversing it
+      velocity = next * velocity < 0 ? 0 : next;
+      position += velocity * DT;
+    }
+
+    // hard stops
+    void stop(double& position, double& velocity, double min, double max) {
+      if (position < min) position = min, velocity = std::max(velocity, 0.0);
+      if (position > max) position = max, velocity = std::min(velocity, 0.0);
+    }
+  }
+
+  // constructor
+  Robot::Robot() {
+    reset(0);
+  }
+
+  // rebuild
+  void Robot::reset(uint64_t seed) {
+    m_rng.seed(seed);
+    m_time = 0;
+    for (Motor& motor : m_motors) {
+      int32_t gearset = motor.m_gearset;
+      motor = Motor();
+      motor.m_gearset = gearset;
+      motor.m_connected = false;
+    }
+    for (const Wiring* group : {DIRECT_MOTORS, SHARED_MOTORS, LIFT_MOTORS, INTAKE_MOTORS}) {
+      for (int i = 0; i < 2; ++i) m_motors[group[i].m_port].m_connected = true;
+    }
+    m_encoder_reads = 0;
+    m_imu_reads = 0;
+    m_serial_bytes = 0;
+
+    // the nominal robot matches its models
+    using feedforward_gains::DRIVE;
+    using feedforward_gains::TILTER;
+    using feedforward_gains::LIFT;
+    double drive_mass = 2 * DRIVE.m_ka * DRIVE_WHEEL * .0254;
+    m_battery = 1;
+    for (int i = 0; i < 2; ++i) {
+      m_drive_mass[i] = drive_mass;
+      m_drive_friction[i] = 2 * DRIVE.m_ks;
+      m_slip[i] = 0;
+      m_tracking_scale[i] = 1;
+      m_lift_gravity[i] = LIFT_RATIO * LIFT.m_kg;
+    }
+    m_tilter_friction = 2 * TILTER.m_ks + 200;
+    m_imu_scale = 0;
+    m_imu_bias = 0;
+    m_pose = {0, 0, 0};
+
+    // every other robot is off by a little
+    if (seed) {
+      std::uniform_real_distribution<double> model(.85, 1.15);
+      std::normal_distribution<double> normal;
+      m_battery = std::uniform_real_distribution<double>(.85, 1)(m_rng);
+      for (int i = 0; i < 2; ++i) {
+        m_drive_mass[i] *= model(m_rng);
+        m_drive_friction[i] *= model(m_rng);
+        m_slip[i] = std::uniform_real_distribution<double>(0, .05)(m_rng);
+        m_tracking_scale[i] = std::uniform_real_distribution<double>(.99, 1.01)(m_rng);
+        m_lift_gravity[i] *= model(m_rng);
+      }
+      m_tilter_friction *= model(m_rng);
+      m_imu_scale = .01 * normal(m_rng);
+      m_imu_bias = .03 * normal(m_rng);
+      m_pose = {.25 * normal(m_rng), .25 * normal(m_rng), normal(m_rng)};
+    }
+
+    for (int i = 0; i < 2; ++i) {
+      m_wheel[i] = m_wheel_velocity[i] = 0;
+      m_lift[i] = m_lift_velocity[i] = 0;
+      m_roller[i] = m_roller_velocity[i] = 0;
+    }
+    m_tracking[0] = m_tracking[1] = m_tracking[2] = 0;
+    m_tilter = m_tilter_velocity = 0;
+    m_cubes_waiting = 0;
+    m_cubes = 0;
+    m_cube_load_until = 0;
+    m_cube_direction = 0;
+    m_imu_calibrated_at = 0;
+    m_imu_reset = false;
+    m_imu_zero = m_pose.m_heading;
+    m_imu_reading = 0;
+    m_serial_queued = 0;
+  }
+
+  // the force of a motor, in mV, after its own controller and back-EMF
+  double Robot::push(Motor& motor) {
+
+    // act on the command sent COMMAND_DELAY ago
+    size_t slot = m_time % COMMAND_DELAY;
+    motor.m_applied_mode = motor.m_pending_mode[slot];
+    motor.m_applied_command = motor.m_pending_command[slot];
+    motor.m_pending_mode[slot] = motor.m_mode;
+    motor.m_pending_command[slot] = motor.m_command;
+    if (!motor.m_connected) {
+      motor.m_voltage = 0;
+      motor.m_current = 0;
+      return 0;
+    }
+
+    // stopped motors brake as their brake mode says
+    double back_emf = 12000 / (motor.m_gearset * 6.0);
+    double voltage;
+    if (motor.m_applied_command == 0 && motor.m_brake_mode == 2) {
+      if (!motor.m_holding) motor.m_hold = motor.m_position;
+      motor.m_holding = true;
+      voltage = -HOLD_KP * (motor.m_position - motor.m_hold) - HOLD_KD * motor.m_velocity;
+    }
+    else {
+      motor.m_holding = false;
+      if (motor.m_applied_command == 0 && motor.m_brake_mode == 1) voltage = -BRAKE_KD * motor.m_velocity;
+      else if (motor.m_applied_mode == Motor::Mode::VOLTAGE) voltage = motor.m_applied_command;
+      else {
+        double target = motor.m_applied_command * 6.0;
+        voltage = back_emf * target + VELOCITY_KP * (target - motor.m_velocity);
+      }
+    }
+
+    // the battery limits the voltage
+    double limit = 12000 * m_battery;
+    motor.m_voltage = std::max(-limit, std::min(limit, voltage));
+    double push = motor.m_voltage - back_emf * motor.m_velocity;
+    motor.m_current = std::min(STALL_CURRENT, std::abs(push) * STALL_CURRENT / 12000);
+    return push;
+  }
+
+  // update a motor's encoder
+  void Robot::sense(Motor& motor, double position, double velocity) {
+    motor.m_position = position;
+    motor.m_velocity = velocity;
+  }
+
+  // step
+  void Robot::step() {
+    ++m_time;
+    using feedforward_gains::TILTER;
+    using feedforward_gains::LIFT;
+    using feedforward_gains::INTAKE;
+
+    // forces of the motors, turned into the direction of their mechanisms
+    double direct[2], shared[2], lift[2], roller[2];
+    for (int i = 0; i < 2; ++i) {
+      direct[i] = DIRECT_MOTORS[i].m_sign * push(m_motors[DIRECT_MOTORS[i].m_port]);
+      shared[i] = SHARED_MOTORS[i].m_sign * push(m_motors[SHARED_MOTORS[i].m_port]);
+      lift[i] = LIFT_MOTORS[i].m_sign * push(m_motors[LIFT_MOTORS[i].m_port]);
+      roller[i] = INTAKE_MOTORS[i].m_sign * push(m_motors[INTAKE_MOTORS[i].m_port]);
+    }
+
+    // chassis sides; the shared motors push their side and, through the transmission, the tilter
+    // rolling resistance makes up the chassis' kv beyond the motors' back-EMF
+    double drive_damping = std::max(0.0, 2 * (feedforward_gains::DRIVE.m_kv * DRIVE_WHEEL * .0254 - 12000 / (RED_RPM * 6.0)));
+    for (int i = 0; i < 2; ++i) {
+      double force = direct[i] + shared[i] - drive_damping * m_wheel_velocity[i];
+      integrate(m_wheel[i], m_wheel_velocity[i], force, m_drive_friction[i], m_drive_mass[i]);
+    }
+
+    // the tilter moves the shared motors backwards from the direct ones, and is locked while the lift is up
+    double cube_ratio = 1 + CUBE_MASS_RATIO * m_cubes;
+    if (get_lift_angle() > LOCK_LIFT && get_tilter_angle() < LOCK_TILT) m_tilter_velocity = 0;
+    else {
+      double mass = 2 * TILTER.m_ka / TILTER_RATIO * cube_ratio;
+      integrate(m_tilter, m_tilter_velocity, shared[0] + shared[1], m_tilter_friction, mass);
+      stop(m_tilter, m_tilter_velocity, -MAX_TILT * TILTER_RATIO, 0);
+    }
+
+    // lift sides against gravity, pulled together by the frame
+    double lift_force[2];
+    for (int i = 0; i < 2; ++i) {
+      lift_force[i] =
+        LIFT_RATIO * lift[i] - m_lift_gravity[i] * std::cos((m_lift[i] - LIFT.m_horizontal) * DEG) +
+        LIFT_COUPLING * (m_lift[1 - i] - m_lift[i]);
+    }
+    for (int i = 0; i < 2; ++i) {
+      integrate(m_lift[i], m_lift_velocity[i], lift_force[i], LIFT_RATIO * LIFT.m_ks + 500, LIFT_RATIO * LIFT.m_ka);
+      stop(m_lift[i], m_lift_velocity[i], 0, MAX_LIFT);
+    }
+
+    // a cube loads the rollers while it is pulled in or pushed out
+    double roller_speed = (m_roller_velocity[0] + m_roller_velocity[1]) * .5;
+    if (m_time >= m_cube_load_until) {
+      if (m_cube_direction > 0) ++m_cubes;
+      if (m_cube_direction < 0) --m_cubes;
+      m_cube_direction = 0;
+      if (m_cubes_waiting && roller_speed > CUBE_SPEED) {
+        --m_cubes_waiting;
+        m_cube_direction = 1;
+      }
+      else if (m_cubes && roller_speed < -CUBE_SPEED) m_cube_direction = -1;
+      if (m_cube_direction) m_cube_load_until = m_time + CUBE_TIME;
+    }
+    for (int i = 0; i < 2; ++i) {
+      integrate(
+        m_roller[i], m_roller_velocity[i], roller[i] - CUBE_LOAD * m_cube_direction,
+        INTAKE.m_ks + 100, std::max(INTAKE.m_ka, .5)
+      );
+    }
+
+    // encoders
+    for (int i = 0; i < 2; ++i) {
+      double sign = DIRECT_MOTORS[i].m_sign;
+      sense(m_motors[DIRECT_MOTORS[i].m_port], sign * m_wheel[i], sign * m_wheel_velocity[i]);
+      sign = SHARED_MOTORS[i].m_sign;
+      sense(m_motors[SHARED_MOTORS[i].m_port], sign * (m_wheel[i] + m_tilter), sign * (m_wheel_velocity[i] + m_tilter_velocity));
+      sign = LIFT_MOTORS[i].m_sign;
+      sense(m_motors[LIFT_MOTORS[i].m_port], sign * LIFT_RATIO * m_lift[i], sign * LIFT_RATIO * m_lift_velocity[i]);
+      sign = INTAKE_MOTORS[i].m_sign;
+      sense(m_motors[INTAKE_MOTORS[i].m_port], sign * m_roller[i], sign * m_roller_velocity[i]);
+    }
+
+    // the chassis moves along an arc as far as its wheels grip
+    double ground[2];
+    for (int i = 0; i < 2; ++i) ground[i] = m_wheel_velocity[i] * DRIVE_WHEEL * (1 - m_slip[i]) * DT;
+    double distance = (ground[0] + ground[1]) * .5;
+    double turn = (ground[0] - ground[1]) / TRACK_WIDTH;
+    double mid = m_pose.m_heading * DEG + turn * .5;
+    m_pose.m_x += distance * std::cos(mid);
+    m_pose.m_y += distance * std::sin(mid);
+    m_pose.m_heading += turn / DEG;
+    m_tracking[0] += (distance + turn * TRACKING_WIDTH * .5) * m_tracking_scale[0];
+    m_tracking[1] += (distance - turn * TRACKING_WIDTH * .5) * m_tracking_scale[1];
+
+    // backing away from an extended tray leaves the stack behind
+    if (get_tilter_angle() > 80 && distance < -DT) m_cubes = 0;
+
+    // the IMU reports every 10ms once calibrated
+    if (m_imu_reset && m_time == m_imu_calibrated_at) m_imu_zero = m_pose.m_heading;
+    if (m_time >= m_imu_calibrated_at && m_time % IMU_PERIOD == 0) {
+      double seconds = (m_time - m_imu_calibrated_at) * DT;
+      m_imu_reading =
+        (m_pose.m_heading - m_imu_zero) * (1 + m_imu_scale) + m_imu_bias * seconds +
+        IMU_NOISE * std::normal_distribution<double>()(m_rng);
+    }
+
+    // the serial port drains
+    m_serial_queued = std::max(0.0, m_serial_queued - SERIAL_RATE);
+  }
+
+  // motors
+  Motor& Robot::motor(uint8_t port) {
+    return m_motors[port <= NUM_PORTS ? port : 0];
+  }
+
+  // quadrature encoders
+  int32_t Robot::read_encoder(uint8_t port) {
+    if (port >= 'a' && port <= 'h') port -= 'a' - 1;
+    if (port >= 'A' && port <= 'H') port -= 'A' - 1;
+    for (int i = 0; i < 3; ++i) {
+      if (port == TRACKING_PORTS[i] - 'A' + 1) {
+        ++m_encoder_reads;
+        return int32_t(std::floor(m_tracking[i] / TRACKING_WHEEL));
+      }
+    }
+    return INT32_MAX;
+  }
+
+  // IMU
+  void Robot::reset_imu() {
+    m_imu_reset = true;
+    m_imu_calibrated_at = m_time + IMU_CALIBRATION;
+  }
+  bool Robot::is_imu_calibrating() {
+    ++m_imu_reads;
+    return m_time < m_imu_calibrated_at;
+  }
+  double Robot::read_imu_rotation() {
+    ++m_imu_reads;
+    return m_time < m_imu_calibrated_at ? INFINITY : m_imu_reading;
+  }
+
+  // serial
+  int32_t Robot::get_serial_free() const {
+    return int32_t(SERIAL_BUFFER - m_serial_queued);
+  }
+  void Robot::write_serial(int32_t size) {
+    m_serial_queued += size;
+    m_serial_bytes += size;
+  }
+
+  // cubes
+  void Robot::feed_cube() {
+    ++m_cubes_waiting;
+  }
+
+  // true state
+  uint32_t Robot::get_time() const {
+    return m_time;
+  }
+  Robot::Pose Robot::get_pose() const {
+    return m_pose;
+  }
+  double Robot::get_tilter_angle() const {
+    return -m_tilter / TILTER_RATIO;
+  }
+  double Robot::get_lift_angle() const {
+    return (m_lift[0] + m_lift[1]) * .5;
+  }
+  size_t Robot::get_cube_count() const {
+    return m_cubes;
+  }
+  Traffic Robot::get_traffic() const {
+    Traffic traffic{0, 0, m_encoder_reads, m_imu_reads, m_serial_bytes};
+    for (const Motor& motor : m_motors) {
+      traffic.m_motor_reads += motor.m_reads;
+      traffic.m_motor_writes += motor.m_writes;
+    }
+    return traffic;
+  }
+}
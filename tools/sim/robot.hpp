@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace sim {
+
+  /**
+   * Smart ports are numbered 1 to 21.
+   */
+  constexpr size_t NUM_PORTS = 21;
+
+  /**
+   * Motors act on a command this long after it is sent, in ms.
+   */
+  constexpr size_t COMMAND_DELAY = 10;
+
+  /**
+   * A V5 smart motor.
+   * Positions are in deg, velocities in deg/s and voltages in mV, all in the motor's own direction;
+   * okapi applies reversal on top, as on the robot.
+   */
+  struct Motor {
+    enum class Mode { VOLTAGE, VELOCITY };
+
+    // last command sent, and the command being acted on
+    Mode m_mode = Mode::VOLTAGE;
+    int32_t m_command = 0;  ///< mV, or rpm of the gearset
+    Mode m_applied_mode = Mode::VOLTAGE;
+    int32_t m_applied_command = 0;
+    int32_t m_brake_mode = 0; ///< okapi::AbstractMotor::brakeMode
+    int32_t m_gearset = 200;  ///< Free speed, in rpm
+
+    // state
+    double m_position = 0;
+    double m_velocity = 0;
+    double m_voltage = 0;
+    double m_current = 0;    ///< mA
+    double m_zero = 0;       ///< Position of the last tare
+    double m_hold = 0;       ///< Position held while stopped with the hold brake mode
+    bool m_holding = false;
+    bool m_connected = true;
+
+    // traffic
+    uint32_t m_reads = 0;
+    uint32_t m_writes = 0;
+
+    // commands in flight
+    Mode m_pending_mode[COMMAND_DELAY] = {};
+    int32_t m_pending_command[COMMAND_DELAY] = {};
+  };
+
+  /**
+   * Counts of device traffic, summed over every device.
+   */
+  struct Traffic {
+    uint32_t m_motor_reads;
+    uint32_t m_motor_writes;
+    uint32_t m_encoder_reads;
+    uint32_t m_imu_reads;
+    uint32_t m_serial_bytes;
+  };
+
+  /**
+   * The robot, wired as src/subsystems/subsystems.cpp.
+   *
+   * Each mechanism follows the motors' physics: a motor pushes with its voltage less its back-EMF,
+   * scaled so that the mechanism matches its feedforward model in include/feedforward_gains.hpp:
+   * - each chassis side is driven by its direct and shared motors, which also drive the tilter through the transmission;
+   *   the tilter is locked while the lift is raised and the tray is retracted;
+   * - each lift side is geared 5:1 against gravity, with the sides coupled by the frame;
+   * - the intake rollers are loaded while a cube is pulled in or pushed out.
+   * The chassis moves as a differential drive with wheel slip, measured by quantized tracking wheels and an IMU.
+   *
+   * Positions of the chassis are in in and deg, in Odom's frame: x forwards, y to the right, heading clockwise.
+   * Steps in 1 ms; not thread safe, so only the simulated kernel steps it.
+   */
+  class Robot {
+
+  public:
+
+    struct Pose {
+      double m_x;       ///< in
+      double m_y;       ///< in
+      double m_heading; ///< deg, clockwise
+    };
+
+    /**
+     * The nominal robot, at rest at the origin.
+     */
+    Robot();
+
+    /**
+     * Rebuild the robot with its own disturbances: battery sag, motors and friction that differ from the models,
+     * wheel slip, tracking wheel scale error, IMU scale error and bias, and placement off the origin.
+     * Devices keep their gearsets; everything else starts over.
+     *
+     * \param seed
+     *        The random stream; 0 is the nominal robot
+     */
+    void reset(uint64_t seed);
+
+    /**
+     * Advance by 1 ms.
+     */
+    void step();
+
+    /**
+     * The motor on a port; ports without a motor are disconnected.
+     */
+    Motor& motor(uint8_t port);
+
+    /**
+     * Read a quadrature encoder by its top ADI port ('A' to 'H', or 1 to 8), in counts.
+     *
+     * \return The count, or INT32_MAX (PROS_ERR) if nothing is plugged in
+     */
+    int32_t read_encoder(uint8_t port);
+
+    /**
+     * The IMU.
+     * Calibration takes 2 s from reset(), during which it reads no rotation.
+     */
+    void reset_imu();
+    bool is_imu_calibrating();
+    double read_imu_rotation(); ///< deg, clockwise; INFINITY (PROS_ERR_F) while calibrating
+
+    /**
+     * The serial port, which drains at its baud rate.
+     */
+    int32_t get_serial_free() const;
+    void write_serial(int32_t size);
+
+    /**
+     * The master controller, as set by a simulated driver.
+     */
+    double m_analog[4] = {};        ///< -1 to 1, by pros::controller_analog_e_t
+    bool m_digital[18] = {};        ///< by pros::controller_digital_e_t
+
+    /**
+     * Add a cube at the intake; it is pulled in the next time the rollers run inwards.
+     */
+    void feed_cube();
+
+    /**
+     * The true state.
+     */
+    uint32_t get_time() const;
+    Pose get_pose() const;
+    double get_tilter_angle() const;  ///< deg; 0 is retracted
+    double get_lift_angle() const;    ///< deg, averaged over the sides
+    size_t get_cube_count() const;    ///< cubes in the tray
+    Traffic get_traffic() const;
+
+  private:
+
+    std::mt19937_64 m_rng;
+    uint32_t m_time;
+
+    Motor m_motors[NUM_PORTS + 1];
+    uint32_t m_encoder_reads;
+    uint32_t m_imu_reads;
+    uint32_t m_serial_bytes;
+
+    // disturbances
+    double m_battery;
+    double m_drive_mass[2], m_drive_friction[2], m_slip[2], m_tracking_scale[2];
+    double m_tilter_friction;
+    double m_lift_gravity[2];
+    double m_imu_scale, m_imu_bias;
+
+    // chassis sides, in motor deg, and the true pose
+    double m_wheel[2], m_wheel_velocity[2];
+    Pose m_pose;
+    double m_tracking[3]; ///< in
+
+    // tilter, as the shared motors' offset from the direct motors, in motor deg
+    double m_tilter, m_tilter_velocity;
+
+    // lift sides, in deg
+    double m_lift[2], m_lift_velocity[2];
+
+    // intake rollers, in deg, and cubes
+    double m_roller[2], m_roller_velocity[2];
+    size_t m_cubes_waiting, m_cubes;
+    uint32_t m_cube_load_until;
+    int m_cube_direction;
+
+    // IMU
+    uint32_t m_imu_calibrated_at;
+    bool m_imu_reset;
+    double m_imu_zero, m_imu_reading;
+
+    // serial, in bytes
+    double m_serial_queued;
+
+    // motor physics
+    double push(Motor& motor);
+    void sense(Motor& motor, double position, double velocity);
+  };
+}
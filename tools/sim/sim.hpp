@@ -0,0 +1,49 @@
+#pragma once
+
+#include "robot.hpp"
+#include <cstdint>
+#include <functional>
+
+/**
+ * Runs the robot code on the host, against a simulated robot.
+ *
+ * Linked in place of PROS and okapi: tools/sim/kernel.cpp implements the PROS tasks, notifications, mutexes and clock,
+ * and tools/sim/devices.cpp implements okapi's motors, encoders and controller and PROS's IMU and serial port
+ * on top of robot().
+ *
+ * The kernel runs one task at a time, like the V5's single core: the highest priority task that is ready runs until it
+ * blocks, and tasks of equal priority take turns in the order they became ready. Code takes no simulated time to run;
+ * the clock advances 1 ms at a time, stepping the robot, only once every task is blocked.
+ * Each task is a host thread, so the code runs unchanged, but only one thread holds the CPU at a time.
+ *
+ * Build with `make sim` (the simulator, tools/sim/main.cpp) or `make tools` (the tools in tools/, linked against it).
+ */
+namespace sim {
+
+  /**
+   * The simulated robot.
+   * Only touched by the running task, or by run()'s tick; safe to use from the caller of run() once it returns.
+   */
+  Robot& robot();
+
+  /**
+   * Run a program as the competition template's main task.
+   * May only be called once per process: tasks the program leaves blocked stay blocked, so exit with std::_Exit
+   * (or _exit in a forked child) rather than running static destructors under them.
+   *
+   * \param program
+   *        Runs at TASK_PRIORITY_DEFAULT, as initialize(), autonomous() and opcontrol() do on the robot
+   * \param limit
+   *        Stop once the clock reaches this, in ms
+   * \param tick
+   *        Called every ms, after the robot has stepped and before any task wakes
+   *
+   * \return Whether the program returned before the limit
+   */
+  bool run(std::function<void()> program, uint32_t limit, std::function<void()> tick = {});
+
+  /**
+   * Count of switches between tasks so far.
+   */
+  uint64_t get_switch_count();
+}
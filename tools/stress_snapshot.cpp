@@ -0,0 +1,185 @@
+/**
+ * Host stress test of Snapshot (lib/snapshot.hpp) and of Odom's tare, which hands its pose over through one.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/stress_snapshot [--seconds S] [--readers N]
+ *
+ * A writer thread publishes records whose fields all hold the same count, as fast as it can, while reader threads
+ * copy them out; a torn read has fields from two records, and a stale one goes back to an older count.
+ * Then one thread tares an Odom over and over to poses whose fields all hold the same count while another runs its
+ * update(), checking every published pose the same way. The tare is also replayed through the plain pose and flag
+ * Odom used before, which tears when the tare is preempted mid-copy.
+ * Host threads preempt each other far less often than the robot's tasks do, so a clean run is evidence, not proof;
+ * run it for longer, and on more cores, to look harder.
+ * Exits with 1 if Snapshot or Odom tore.
+ */
+
+#include "lib/odom.hpp"
+#include "lib/snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // a record whose fields must all agree
+  struct Record {
+    uint32_t m_fields[16];
+  };
+
+  // what the readers saw
+  struct Counts {
+    uint64_t m_reads = 0;
+    uint64_t m_torn = 0;
+    uint64_t m_stale = 0;
+  };
+
+  void print(const char* name, const Counts& counts, uint64_t writes, double seconds) {
+    std::printf(
+      "%-16s %10llu writes  %11llu reads  %llu torn  %llu stale\n", name, (unsigned long long)writes,
+      (unsigned long long)counts.m_reads, (unsigned long long)counts.m_torn, (unsigned long long)counts.m_stale
+    );
+    std::fprintf(stderr, "%-16s %.1f ns per write\n", name, seconds / std::max<uint64_t>(writes, 1) * 1e9);
+  }
+
+  // Snapshot on its own
+  Counts stress_snapshot(double seconds, size_t readers, uint64_t& writes) {
+    Snapshot<Record> snapshot;
+    std::atomic<bool> done(false);
+    std::vector<Counts> counts(readers);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < readers; ++i) threads.emplace_back([&, i]() {
+      uint32_t last = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        Record record = snapshot.read();
+        ++counts[i].m_reads;
+        for (uint32_t field : record.m_fields) counts[i].m_torn += field != record.m_fields[0];
+        counts[i].m_stale += record.m_fields[0] < last;
+        last = record.m_fields[0];
+      }
+    });
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    Record record{};
+    for (writes = 0; std::chrono::steady_clock::now() < end;) {
+      for (size_t i = 0; i < 64; ++i) {
+        ++writes;
+        for (uint32_t& field : record.m_fields) field = uint32_t(writes);
+        snapshot.write(record);
+      }
+    }
+    done = true;
+    Counts total;
+    for (size_t i = 0; i < readers; ++i) {
+      threads[i].join();
+      total.m_reads += counts[i].m_reads;
+      total.m_torn += counts[i].m_torn;
+      total.m_stale += counts[i].m_stale;
+    }
+    return total;
+  }
+
+  // the pose that the count-th tare requests
+  Odom::ChassisPose tare_pose(uint32_t count) {
+    QLength length = count * inch;
+    return Odom::ChassisPose(length, length, count * degree, length, length, length);
+  }
+
+  // whether every field of a pose holds the same count, which is returned
+  bool check_pose(const Odom::ChassisPose& pose, double& count) {
+    count = pose.m_x.convert(inch);
+    return pose.m_y.convert(inch) == count && std::abs(pose.m_heading.convert(degree) - count) < 1e-6 &&
+      pose.m_encoder_dist_left.convert(inch) == count && pose.m_encoder_dist_right.convert(inch) == count &&
+      pose.m_encoder_dist_side.convert(inch) == count;
+  }
+
+  /**
+   * The tare handover Odom used before: a plain pose, then a flag.
+   */
+  struct PlainTare {
+    Odom::ChassisPose m_pending;
+    std::atomic<bool> m_requested{false};
+
+    void tare(const Odom::ChassisPose& pose) {
+      m_pending = pose;
+      m_requested.store(true, std::memory_order_release);
+    }
+
+    bool take(Odom::ChassisPose& pose) {
+      if (!m_requested.load(std::memory_order_acquire)) return false;
+      pose = m_pending;
+      m_requested.store(false, std::memory_order_release);
+      return true;
+    }
+  };
+
+  // Odom's tare against its update(), or the plain handover if given one
+  Counts stress_tare(double seconds, PlainTare* plain, uint64_t& writes) {
+    Odom odom;
+    std::atomic<bool> done(false);
+    Counts counts;
+
+    // the robot sits still, so the tared pose is published unchanged
+    std::thread updater([&]() {
+      double last = 0;
+      for (uint32_t time = 0; !done.load(std::memory_order_relaxed); time += 5) {
+        Odom::ChassisPose pose;
+        if (plain) {
+          if (!plain->take(pose)) continue;
+        }
+        else {
+          odom.update({time, 0, 0, 0, 0, 0, PROS_ERR});
+          pose = odom.get_pose();
+        }
+        double count;
+        ++counts.m_reads;
+        counts.m_torn += !check_pose(pose, count);
+        counts.m_stale += count < last;
+        last = count;
+      }
+    });
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    for (writes = 0; std::chrono::steady_clock::now() < end;) {
+      for (size_t i = 0; i < 64; ++i) {
+        Odom::ChassisPose pose = tare_pose(uint32_t(++writes));
+        if (plain) plain->tare(pose);
+        else odom.tare(&pose);
+      }
+    }
+    done = true;
+    updater.join();
+    return counts;
+  }
+}
+
+int main(int argc, char** argv) {
+  double seconds = 2;
+  size_t readers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--seconds") && has_value) seconds = std::strtod(argv[++i], nullptr);
+    else if (!std::strcmp(argv[i], "--readers") && has_value) readers = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--seconds S] [--readers N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  uint64_t writes;
+  std::printf("%.1f s each, %zu readers\n", seconds, readers);
+  Counts snapshot = stress_snapshot(seconds, readers, writes);
+  print("snapshot", snapshot, writes, seconds);
+  Counts tare = stress_tare(seconds, nullptr, writes);
+  print("odom tare", tare, writes, seconds);
+  PlainTare plain;
+  Counts plain_tare = stress_tare(seconds, &plain, writes);
+  print("plain pose, flag", plain_tare, writes, seconds);
+  return snapshot.m_torn || snapshot.m_stale || tare.m_torn || tare.m_stale ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+Decode the serial telemetry link sent by TelemetryLink (include/lib/telemetry_link.hpp) into CSV.
+
+Frames are COBS-encoded and separated by zero bytes. Each decoded frame holds flags, a sequence
+number, the time and every field as zigzag varints, and a CRC-16/CCITT-FALSE. Keyframes carry
+values; other frames carry the change since the previous frame. Frames with a bad CRC are
+dropped, and after a sequence gap nothing is written until the next keyframe.
+
+Usage:
+  tools/telemetry_link.py [input [output]]
+      Decode a capture file, a serial device or a pty (default stdin) into CSV (default stdout).
+  tools/telemetry_link.py --loopback [frames]
+      Send synthetic frames through a pty pair and check they decode; needs no robot.
+"""
+
+import os
+import random
+import select
+import sys
+import threading
+
+# must match subsystems::TelemetryField
+FIELDS = [
+  'x_mm', 'y_mm', 'heading_mrad', 'transmission_state', 'tilter_ddeg', 'lift_ddeg', 'intake_ddeg',
+  'direct_left_mv', 'direct_right_mv', 'shared_left_mv', 'shared_right_mv',
+  'lift_left_mv', 'lift_right_mv', 'intake_left_mv', 'intake_right_mv',
+]
+
+KEYFRAME_INTERVAL = 50
+
+
+def crc16(data):
+  """CRC-16/CCITT-FALSE."""
+  crc = 0xFFFF
+  for byte in data:
+    crc ^= byte << 8
+    for _ in range(8):
+      crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+      crc &= 0xFFFF
+  return crc
+
+
+def cobs_encode(data):
+  out = bytearray()
+  block = bytearray()
+  for byte in data:
+    if byte == 0:
+      out += bytes([len(block) + 1]) + block
+      block = bytearray()
+    else:
+      block.append(byte)
+      if len(block) == 254:
+        out += b'\xff' + block
+        block = bytearray()
+  out += bytes([len(block) + 1]) + block
+  return bytes(out) + b'\x00'
+
+
+def cobs_decode(data):
+  out = bytearray()
+  i = 0
+  while i < len(data):
+    code = data[i]
+    if code == 0 or i + code > len(data):
+      raise ValueError('bad COBS block')
+    out += data[i + 1:i + code]
+    i += code
+    if code < 0xFF and i < len(data):
+      out.append(0)
+  return bytes(out)
+
+
+def put_varint(value):
+  zigzag = ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+  out = bytearray()
+  while zigzag >= 0x80:
+    out.append((zigzag & 0x7F) | 0x80)
+    zigzag >>= 7
+  out.append(zigzag)
+  return bytes(out)
+
+
+def get_varint(data, i):
+  zigzag = 0
+  shift = 0
+  while True:
+    if i >= len(data) or shift > 28:
+      raise ValueError('bad varint')
+    byte = data[i]
+    zigzag |= (byte & 0x7F) << shift
+    shift += 7
+    i += 1
+    if not byte & 0x80:
+      break
+  return (zigzag >> 1) ^ -(zigzag & 1), i
+
+
+def encode(keyframe, sequence, time, fields):
+  """Encode one frame, as TelemetryLink::encode() does."""
+  frame = bytes([1 if keyframe else 0, sequence & 0xFF]) + put_varint(time) + b''.join(put_varint(f) for f in fields)
+  crc = crc16(frame)
+  return cobs_encode(frame + bytes([crc & 0xFF, crc >> 8]))
+
+
+def parse(frame, num_fields):
+  """(keyframe, sequence, time, fields) of a COBS-decoded frame; raises ValueError if it is corrupt."""
+  if len(frame) < 4 or crc16(frame[:-2]) != frame[-2] | frame[-1] << 8:
+    raise ValueError('bad CRC')
+  keyframe, sequence = bool(frame[0] & 1), frame[1]
+  time, i = get_varint(frame, 2)
+  fields = []
+  for _ in range(num_fields):
+    value, i = get_varint(frame, i)
+    fields.append(value)
+  if i != len(frame) - 2:
+    raise ValueError('bad length')
+  return keyframe, sequence, time, fields
+
+
+class Decoder:
+  """Turns a byte stream into (time, fields) rows, undoing the delta encoding."""
+
+  def __init__(self, num_fields=len(FIELDS)):
+    self.num_fields = num_fields
+    self.buffer = bytearray()
+    self.time = None
+    self.fields = None
+    self.sequence = None
+    self.frames = 0
+    self.corrupt = 0
+    self.lost = 0
+
+  def feed(self, data):
+    self.buffer += data
+    while True:
+      end = self.buffer.find(0)
+      if end < 0:
+        return
+      chunk = bytes(self.buffer[:end])
+      del self.buffer[:end + 1]
+      if not chunk:
+        continue
+      try:
+        keyframe, sequence, time, fields = parse(cobs_decode(chunk), self.num_fields)
+      except ValueError:
+        self.corrupt += 1
+        self.fields = None
+        continue
+      if self.sequence is not None and sequence != (self.sequence + 1) & 0xFF:
+        self.lost += (sequence - self.sequence - 1) & 0xFF
+        self.fields = None
+      self.sequence = sequence
+      self.frames += 1
+      if keyframe:
+        self.time, self.fields = time, fields
+      elif self.fields is not None:
+        self.time += time
+        self.fields = [a + b for a, b in zip(self.fields, fields)]
+      else:
+        continue
+      yield self.time, list(self.fields)
+
+
+def open_input(path):
+  """Open a file, serial device or pty for reading raw bytes."""
+  fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+  if os.isatty(fd):
+    import termios
+    import tty
+    tty.setraw(fd, termios.TCSANOW)
+  return fd
+
+
+def decode(fd, sink):
+  decoder = Decoder()
+  sink.write('time_ms,%s\n' % ','.join(FIELDS))
+  while True:
+    try:
+      data = os.read(fd, 4096)
+    except OSError:
+      break
+    if not data:
+      break
+    for time, fields in decoder.feed(data):
+      sink.write('%d,%s\n' % (time, ','.join(str(f) for f in fields)))
+    sink.flush()
+  sys.stderr.write('%d frames, %d corrupt, %d lost\n' % (decoder.frames, decoder.corrupt, decoder.lost))
+
+
+def loopback(count):
+  """Send synthetic frames, some corrupted, through a pty pair and check every good one decodes."""
+  import pty
+  import tty
+  master, slave = pty.openpty()
+  tty.setraw(slave)
+  rng = random.Random(0)
+
+  sent = []
+  def writer():
+    fields = [0] * len(FIELDS)
+    last = None
+    since_keyframe = KEYFRAME_INTERVAL
+    for n in range(count):
+      time = n * 10
+      fields = [f + rng.randint(-300, 300) for f in fields]
+      keyframe = since_keyframe >= KEYFRAME_INTERVAL
+      values = fields if keyframe else [a - b for a, b in zip(fields, last)]
+      frame = encode(keyframe, n, time if keyframe else 10, values)
+      if n % 97 == 13:
+        frame = frame[:3] + bytes([frame[3] ^ 0x55 or 1]) + frame[4:]
+      else:
+        sent.append((time, list(fields)))
+      os.write(master, frame)
+      last = fields
+      since_keyframe = 1 if keyframe else since_keyframe + 1
+    os.write(master, b'\x00')
+
+  thread = threading.Thread(target=writer)
+  thread.start()
+  decoder = Decoder()
+  received = []
+  while True:
+    ready, _, _ = select.select([slave], [], [], .5)
+    if not ready:
+      break
+    received += list(decoder.feed(os.read(slave, 4096)))
+  thread.join()
+
+  # every received row must be a row that was sent uncorrupted
+  expected = dict(sent)
+  wrong = sum(1 for time, fields in received if expected.get(time) != fields)
+  print('%d sent, %d corrupted, %d decoded, %d wrong, %d corrupt frames detected' % (
+    count, count - len(sent), len(received), wrong, decoder.corrupt))
+  return 0 if wrong == 0 and received and decoder.corrupt == count - len(sent) else 1
+
+
+def main():
+  if len(sys.argv) > 1 and sys.argv[1] == '--loopback':
+    sys.exit(loopback(int(sys.argv[2]) if len(sys.argv) > 2 else 1000))
+  fd = open_input(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin.fileno()
+  sink = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+  decode(fd, sink)
+
+
+if __name__ == '__main__':
+  main()
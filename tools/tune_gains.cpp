@@ -0,0 +1,518 @@
+/**
+ * Host auto-tuner for the feedback gains in include/controller_gains.hpp.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/tune_gains [--seed N] [--threads N] [--generations N] [--output include/controller_gains.hpp]
+ *
+ * Each trial runs the robot code with one candidate's gains on a fresh simulated robot (tools/sim/) with its own
+ * disturbances, through one randomized scenario:
+ *   tilter  initialize(), a random stack pulled in by the intake, then a deposit by TilterController, as in bench_deposit.cpp
+ *   hold    initialize(), a random stack, the tray raised to a random angle and handed to Transmission's hold,
+ *           then a jolt from the drive at full voltage, straight or on the spot
+ *   lift    a move of Lift between two random presets, with its synchronized sides, as in bench_lift.cpp
+ * Costs are taken from the simulator's true state, not the robot's sensors.
+ * host.mk builds tune_gains against a copy of the robot code compiled with TUNE_GAINS, which turns the gains into
+ * variables it sets before each trial; the robot's build and the other tools keep them constant.
+ * The robot code keeps its state in globals, so every trial is a child process, as in evaluate_autonomous.cpp.
+ * The simulator's tray and lift are built from the fitted models of include/feedforward_gains.hpp; re-run after
+ * tools/fit_feedforward.py updates them.
+ *
+ * Gains are searched by the cross-entropy method in log space, starting from the current header.
+ * Each generation evaluates every candidate on the same scenarios, spread across threads by a work-stealing pool.
+ * Every random number comes from the seed and the trial's index, so results do not depend on the thread count.
+ * The chosen gains are checked against the starting gains on separate validation scenarios,
+ * and the starting gains are kept if nothing beats them. --generations 0 rewrites the current gains.
+ */
+
+#ifndef TUNE_GAINS
+#error "tune_gains sets the gains at run time; build it with TUNE_GAINS, as host.mk does"
+#endif
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "controllers/controllers.hpp"
+#include "subsystems/subsystems.hpp"
+#include "controller_gains.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // the robot settles this long after initialize(), each cube takes this long to pull in, the tray is given this
+  // long to rise, and trials run this long past the end of their profile, in ms
+  constexpr uint32_t SETTLE = 500;
+  constexpr uint32_t CUBE_LOAD = 350;
+  constexpr uint32_t RAISE = 1500;
+  constexpr uint32_t TAIL = 1000;
+
+  // costs are sampled at the controllers' period, in ms
+  constexpr uint32_t PERIOD = 10;
+
+  // the hold is jolted from JOLT to JOLT + JOLT_LENGTH, and watched for HOLD, in ms after it starts
+  constexpr uint32_t JOLT = 300;
+  constexpr uint32_t JOLT_LENGTH = 200;
+  constexpr uint32_t HOLD = 1500;
+
+  // the lift's moves time out after this, in ms
+  constexpr uint32_t MOVE_TIMEOUT = 3000;
+
+  // the lift's motors, as subsystems.cpp wires them
+  constexpr uint8_t LIFT_LEFT_PORT = 1;
+  constexpr uint8_t LIFT_RIGHT_PORT = 18;
+
+  constexpr Lift::Preset PRESETS[] = {
+    Lift::Preset::DOWN, Lift::Preset::LOCK, Lift::Preset::LOW_TOWER, Lift::Preset::MID_TOWER, Lift::Preset::MAX
+  };
+
+  // search settings; every trial is a whole simulated robot, so the search is smaller than the gains alone would need
+  constexpr size_t POPULATION = 24;
+  constexpr size_t ELITES = 6;
+  constexpr size_t SCENARIOS = 8;
+  constexpr size_t VALIDATION_SCENARIOS = 48;
+  constexpr double INITIAL_SPREAD = .7;  // in log units
+  constexpr double MIN_SPREAD = .02;
+
+  // cost weights
+  constexpr double WEIGHT_TRACKING = 1;   // per deg RMS of tracking error
+  constexpr double WEIGHT_OVERSHOOT = 3;  // per deg past the target
+  constexpr double WEIGHT_SETTLE = 2;     // per s to settle after the profile ends
+  constexpr double WEIGHT_VOLTAGE = 1;    // per 12 V of mean voltage
+  constexpr double WEIGHT_CHATTER = 1;    // per V of mean change in voltage between updates
+  constexpr double WEIGHT_SYNC = 2;       // per deg of largest difference between lift sides
+
+  // settled within these
+  constexpr double SETTLE_ANGLE = 2;   // deg
+  constexpr double SETTLE_SPEED = 5;   // deg/s
+
+  // the tunable gains, in header order
+  enum GainIndex { TILTER_KP, TILTER_KD, HOLD_KP, HOLD_KD, LIFT_KP, LIFT_KD, SYNC_KP, SYNC_KD, NUM_GAINS };
+  const char* const GAIN_NAMES[] = {"TILTER_KP", "TILTER_KD", "HOLD_KP", "HOLD_KD", "LIFT_KP", "LIFT_KD", "SYNC_KP", "SYNC_KD"};
+  double* const GAINS[] = {
+    &controller_gains::TILTER_KP, &controller_gains::TILTER_KD,
+    &controller_gains::HOLD_KP, &controller_gains::HOLD_KD,
+    &controller_gains::LIFT_KP, &controller_gains::LIFT_KD,
+    &controller_gains::SYNC_KP, &controller_gains::SYNC_KD
+  };
+
+  // search range of each gain; the search is in log space, so ranges start above zero
+  const double MIN_GAINS[] = {10, .1, 20, .1, 20, .1, 5, .1};
+  const double MAX_GAINS[] = {2000, 100, 4000, 100, 4000, 100, 2000, 100};
+
+  // independent random streams from a seed and indices
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+  uint64_t stream(uint64_t seed, uint64_t a, uint64_t b = 0, uint64_t c = 0) {
+    return mix(mix(mix(seed ^ mix(a)) ^ b) ^ c);
+  }
+
+  // accumulates the cost terms of one trial
+  struct Cost {
+    double m_error_squared = 0;
+    double m_voltage = 0;
+    double m_chatter = 0;
+    double m_last_voltage = 0;
+    size_t m_updates = 0;
+
+    void control(double error, double voltage) {
+      m_error_squared += error * error;
+      m_voltage += std::abs(voltage);
+      if (m_updates) m_chatter += std::abs(voltage - m_last_voltage);
+      m_last_voltage = voltage;
+      ++m_updates;
+    }
+
+    double total(double overshoot, double settle_time) const {
+      if (!m_updates) return HUGE_VAL;
+      return
+        WEIGHT_TRACKING * std::sqrt(m_error_squared / m_updates) +
+        WEIGHT_OVERSHOOT * std::max(overshoot, 0.0) +
+        WEIGHT_SETTLE * settle_time +
+        WEIGHT_VOLTAGE * m_voltage / m_updates / 12000 +
+        WEIGHT_CHATTER * m_chatter / m_updates / 1000;
+    }
+  };
+
+  // tracks when a joint settles on its target after its profile ends, in s
+  struct Settle {
+    double m_end;
+    double m_at = -1;
+
+    void step(double time, double error, double speed) {
+      bool settled = std::abs(error) < SETTLE_ANGLE && std::abs(speed) < SETTLE_SPEED;
+      if (time >= m_end && settled && m_at < 0) m_at = time;
+      if (!settled) m_at = -1;
+    }
+
+    double get() const {
+      return m_at < 0 ? TAIL / 1000.0 : m_at - m_end;
+    }
+  };
+
+  // initialize(), then pull in a stack and tell the intake its size; runs in sim::run()
+  void load(size_t cubes) {
+    using namespace subsystems;
+    initialize();
+    pros::delay(SETTLE);
+    for (size_t i = 0; i < cubes; ++i) sim::robot().feed_cube();
+    intake->move_voltage(12000);
+    pros::delay(cubes * CUBE_LOAD + SETTLE);
+    intake->lock();
+    intake->set_cube_count(cubes);
+    pros::delay(SETTLE);
+  }
+
+  // the part of the shared motors' commands that drives the tilter, in mV
+  double tilter_voltage() {
+    auto voltages = subsystems::transmission->get_voltages();
+    return (std::get<2>(voltages) - std::get<0>(voltages) + std::get<3>(voltages) - std::get<1>(voltages)) * .5;
+  }
+
+  // a deposit by TilterController with a random stack
+  double tilter_trial(uint64_t seed) {
+    using namespace subsystems;
+    std::mt19937_64 rng(seed);
+    size_t cubes = rng() % 11;
+    sim::robot().reset(mix(seed));
+
+    double target = Tilter::MAX_EXTENDED.convert(degree);
+    SCurveProfile profile = TilterController::plan(0_deg, cubes);
+    Cost cost;
+    Settle settle{0};
+    uint32_t start = 0;
+    double overshoot = 0, last_angle = 0;
+    sim::run([&]() {
+      load(cubes);
+
+      // the controller plans from the encoders as the command starts
+      profile = TilterController::plan(tilter->get_angle(), cubes);
+      settle.m_end = profile.duration().convert(second);
+      start = pros::millis();
+      subsystem_controllers::tilter_controller->enable();
+      pros::delay(profile.duration().convert(millisecond) + TAIL);
+    }, SETTLE * 3 + cubes * CUBE_LOAD + 20000, [&]() {
+      double angle = sim::robot().get_tilter_angle();
+      double speed = (angle - last_angle) * 1000;
+      last_angle = angle;
+      if (!start) return;
+      uint32_t time = pros::millis() - start;
+      if (time % PERIOD == 0) cost.control(profile.sample(time * millisecond).m_position.convert(degree) - angle, tilter_voltage());
+      overshoot = std::max(overshoot, angle - target);
+      settle.step(time / 1000.0, angle - target, speed);
+    });
+    return cost.total(overshoot, settle.get());
+  }
+
+  // Transmission's hold of a loaded or empty tray against a jolt from the drive
+  double hold_trial(uint64_t seed) {
+    using namespace subsystems;
+    std::mt19937_64 rng(seed);
+    size_t cubes = rng() % 11;
+    double target = std::uniform_real_distribution<double>(10, 60)(rng);
+    int jolt = int(std::uniform_real_distribution<double>(6000, 12000)(rng)) * (rng() % 2 ? 1 : -1);
+    bool turn = rng() % 2;
+    sim::robot().reset(mix(seed));
+
+    Cost cost;
+    uint32_t start = 0;
+    double held = 0, worst = 0;
+    sim::run([&]() {
+      load(cubes);
+
+      // raise the tray, then let the transmission hold it where it stops
+      Command raise("raise", RESOURCE_TRANSMISSION, PRIORITY_MACRO, true, nullptr, [](bool) { tilter->hold(); });
+      arbiter->schedule(raise);
+      for (uint32_t time = 0; time < RAISE; time += PERIOD) {
+        arbiter->run(raise, [&]() {
+          double error = target - tilter->get_angle().convert(degree);
+          tilter->move_voltage(-int(std::max(-8000.0, std::min(8000.0, 400 * error))));
+          transmission->update();
+          return true;
+        });
+        pros::delay(PERIOD);
+      }
+      arbiter->cancel(raise);
+      held = sim::robot().get_tilter_angle();
+      start = pros::millis();
+
+      // jolt the chassis while the transmission's job holds the tray
+      for (uint32_t time = 0; time < HOLD; time += PERIOD) {
+        int voltage = time >= JOLT && time < JOLT + JOLT_LENGTH ? jolt : 0;
+        arbiter->run_default(RESOURCE_TRANSMISSION, [=]() { chassis->move_voltage(voltage, turn ? -voltage : voltage); });
+        pros::delay(PERIOD);
+      }
+    }, SETTLE * 3 + cubes * CUBE_LOAD + RAISE + HOLD + 1000, [&]() {
+      if (!start) return;
+      double error = held - sim::robot().get_tilter_angle();
+      if ((pros::millis() - start) % PERIOD == 0) cost.control(error, tilter_voltage());
+      worst = std::max(worst, std::abs(error));
+    });
+    return cost.total(worst, 0);
+  }
+
+  // a move of Lift between two presets, with the sides loaded differently by the robot's disturbances
+  double lift_trial(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    Lift::Preset from = PRESETS[rng() % 5], to = PRESETS[rng() % 5];
+    if (to == from) to = from == Lift::Preset::DOWN ? Lift::Preset::MID_TOWER : Lift::Preset::DOWN;
+    double target = Lift::get_preset(to).convert(degree);
+    sim::robot().reset(mix(seed));
+
+    TrapezoidProfile profile(0_deg, 0_deg, Lift::PROFILE_VELOCITY, Lift::PROFILE_ACCELERATION);
+    Cost cost;
+    Settle settle{0};
+    uint32_t start = 0;
+    double direction = 1, overshoot = 0, worst_sync = 0;
+    sim::run([&]() {
+
+      // the lift job's reads, as Sensors makes them
+      Lift lift(LIFT_LEFT_PORT, LIFT_RIGHT_PORT);
+      Motor left(LIFT_LEFT_PORT, false, Motor::gearset::green, Motor::encoderUnits::degrees);
+      Motor right(LIFT_RIGHT_PORT, true, Motor::gearset::green, Motor::encoderUnits::degrees);
+      SensorFrame frame{};
+      auto tick = [&]() {
+        frame.m_lift_left = left.getPosition();
+        frame.m_lift_right = right.getPosition();
+        frame.m_lift_time = pros::millis();
+        lift.update_angles(frame);
+        lift.update();
+        pros::delay(PERIOD);
+      };
+      frame.m_lift_left = left.getPosition();
+      frame.m_lift_right = right.getPosition();
+      frame.m_lift_time = pros::millis();
+      lift.update_angles(frame);
+      lift.tare_angle(0_deg);
+      lift.lock();
+      pros::delay(PERIOD);
+
+      // get to the first preset, then make the move
+      lift.move_to(from);
+      for (uint32_t time = 0; time < MOVE_TIMEOUT && !lift.is_settled(); time += PERIOD) tick();
+      profile = TrapezoidProfile(std::get<2>(lift.get_angle()), target * degree,
+        Lift::PROFILE_VELOCITY, Lift::PROFILE_ACCELERATION, std::get<2>(lift.get_velocity())
+      );
+      direction = target > std::get<2>(lift.get_angle()).convert(degree) ? 1 : -1;
+      settle.m_end = profile.duration().convert(second);
+      lift.move_to(to);
+      start = pros::millis();
+      for (uint32_t time = 0; time < profile.duration().convert(millisecond) + TAIL; time += PERIOD) tick();
+    }, MOVE_TIMEOUT + 20000, [&]() {
+      if (!start) return;
+      sim::Robot& robot = sim::robot();
+      const sim::Motor& left = robot.motor(LIFT_LEFT_PORT);
+      const sim::Motor& right = robot.motor(LIFT_RIGHT_PORT);
+      double angle = robot.get_lift_angle();
+      double speed = (left.m_velocity - right.m_velocity) * .5 / 5.0;
+      uint32_t time = pros::millis() - start;
+      if (time % PERIOD == 0) {
+        cost.control(profile.sample(time * millisecond).m_position.convert(degree) - angle, (std::abs(left.m_voltage) + std::abs(right.m_voltage)) * .5);
+      }
+      overshoot = std::max(overshoot, (angle - target) * direction);
+      worst_sync = std::max(worst_sync, std::abs(left.m_position + right.m_position) / 5.0);
+      settle.step(time / 1000.0, angle - target, speed);
+    });
+    return cost.total(overshoot, settle.get()) + WEIGHT_SYNC * worst_sync;
+  }
+
+  // a controller and the gains it uses
+  struct Problem {
+    const char* m_name;
+    double (*m_trial)(uint64_t);
+    std::vector<int> m_gains;
+  };
+
+  const Problem PROBLEMS[] = {
+    {"tilter", tilter_trial, {TILTER_KP, TILTER_KD}},
+    {"hold", hold_trial, {HOLD_KP, HOLD_KD}},
+    {"lift", lift_trial, {LIFT_KP, LIFT_KD, SYNC_KP, SYNC_KD}}
+  };
+
+  // one trial with a candidate's gains, in a child process; infinite if the child fails
+  double run(const Problem& problem, const std::vector<double>& gains, uint64_t seed) {
+    double cost = HUGE_VAL;
+    int fds[2];
+    if (pipe(fds)) return cost;
+    pid_t pid = fork();
+    if (pid == 0) {
+
+      // the robot's telemetry goes to stdout
+      int null = open("/dev/null", O_WRONLY);
+      dup2(null, STDOUT_FILENO);
+      close(fds[0]);
+      for (size_t g = 0; g < NUM_GAINS; ++g) *GAINS[g] = gains[g];
+      cost = problem.m_trial(seed);
+      ssize_t written = write(fds[1], &cost, sizeof(cost));
+      _exit(written == sizeof(cost) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+      if (read(fds[0], &cost, sizeof(cost)) != sizeof(cost)) cost = HUGE_VAL;
+      waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return cost;
+  }
+
+  // mean cost of each candidate over the same scenarios
+  std::vector<double> evaluate(
+    WorkStealingPool& pool, const Problem& problem, const std::vector<std::vector<double>>& candidates,
+    uint64_t seed, uint64_t generation, size_t scenarios
+  ) {
+    std::vector<double> costs(candidates.size() * scenarios);
+    pool.run(costs.size(), [&](size_t index) {
+      size_t candidate = index / scenarios, scenario = index % scenarios;
+      costs[index] = run(problem, candidates[candidate], stream(seed, generation, scenario));
+    });
+    std::vector<double> means(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      double sum = 0;
+      for (size_t j = 0; j < scenarios; ++j) sum += costs[i * scenarios + j];
+      means[i] = sum / scenarios;
+    }
+    return means;
+  }
+
+  // tuning result of a problem
+  struct Result {
+    std::vector<double> m_gains;
+    double m_start_cost;
+    double m_cost;
+    size_t m_trials;
+    double m_seconds;
+  };
+
+  Result tune(WorkStealingPool& pool, const Problem& problem, const std::vector<double>& start, uint64_t seed, size_t generations) {
+    auto begin = std::chrono::steady_clock::now();
+    size_t dims = problem.m_gains.size();
+    auto gains_of = [&](const std::vector<double>& point) {
+      std::vector<double> gains = start;
+      for (size_t d = 0; d < dims; ++d) gains[problem.m_gains[d]] = std::exp(point[d]);
+      return gains;
+    };
+
+    // search in log space from the current gains
+    std::vector<double> mean(dims), spread(dims, INITIAL_SPREAD);
+    for (size_t d = 0; d < dims; ++d) {
+      int g = problem.m_gains[d];
+      mean[d] = std::log(std::max(MIN_GAINS[g], std::min(MAX_GAINS[g], start[g])));
+    }
+    size_t trials = 0;
+    std::vector<double> best_point = mean;
+    for (size_t generation = 0; generation < generations; ++generation) {
+      std::mt19937_64 rng(stream(seed, generation, 1u << 31));
+      std::vector<std::vector<double>> points(POPULATION, mean), candidates;
+      for (size_t i = 1; i < POPULATION; ++i) {
+        for (size_t d = 0; d < dims; ++d) {
+          int g = problem.m_gains[d];
+          points[i][d] = std::max(std::log(MIN_GAINS[g]), std::min(std::log(MAX_GAINS[g]), mean[d] + spread[d] * std::normal_distribution<double>()(rng)));
+        }
+      }
+      for (auto& point : points) candidates.push_back(gains_of(point));
+      std::vector<double> costs = evaluate(pool, problem, candidates, seed, generation, SCENARIOS);
+      trials += POPULATION * SCENARIOS;
+
+      // refit to the elites
+      std::vector<size_t> order(POPULATION);
+      for (size_t i = 0; i < POPULATION; ++i) order[i] = i;
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return costs[a] < costs[b] || (costs[a] == costs[b] && a < b); });
+      best_point = points[order[0]];
+      for (size_t d = 0; d < dims; ++d) {
+        double sum = 0, sum_squared = 0;
+        for (size_t e = 0; e < ELITES; ++e) sum += points[order[e]][d];
+        double elite_mean = sum / ELITES;
+        for (size_t e = 0; e < ELITES; ++e) sum_squared += (points[order[e]][d] - elite_mean) * (points[order[e]][d] - elite_mean);
+        mean[d] = elite_mean;
+        spread[d] = std::max(MIN_SPREAD, std::sqrt(sum_squared / ELITES));
+      }
+    }
+
+    // validate on scenarios the search never saw
+    std::vector<std::vector<double>> finalists = {start, gains_of(mean), gains_of(best_point)};
+    std::vector<double> costs = evaluate(pool, problem, finalists, seed, ~0ull, VALIDATION_SCENARIOS);
+    trials += finalists.size() * VALIDATION_SCENARIOS;
+    size_t chosen = std::min_element(costs.begin(), costs.end()) - costs.begin();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return {finalists[chosen], costs[0], costs[chosen], trials, seconds};
+  }
+}
+
+int main(int argc, char** argv) {
+  uint64_t seed = 1;
+  size_t threads = std::thread::hardware_concurrency();
+  size_t generations = 10;
+  std::string output = "include/controller_gains.hpp";
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--threads") && has_value) threads = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--generations") && has_value) generations = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--output") && has_value) output = argv[++i];
+    else {
+      std::fprintf(stderr, "usage: %s [--seed N] [--threads N] [--generations N] [--output path]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // children inherit unflushed output
+  std::fflush(stdout);
+  std::fflush(stderr);
+
+  WorkStealingPool pool(threads);
+  std::vector<double> start(NUM_GAINS);
+  for (size_t g = 0; g < NUM_GAINS; ++g) start[g] = *GAINS[g];
+  std::vector<double> gains = start;
+  std::vector<std::string> notes;
+  for (const Problem& problem : PROBLEMS) {
+    if (generations == 0) {
+      notes.push_back("hand-tuned starting point");
+      continue;
+    }
+    Result result = tune(pool, problem, start, seed, generations);
+    for (int g : problem.m_gains) gains[g] = result.m_gains[g];
+    char note[160];
+    std::snprintf(note, sizeof(note), "tuned with seed %llu: cost %.3f -> %.3f over %zu validation scenarios",
+      (unsigned long long)seed, result.m_start_cost, result.m_cost, VALIDATION_SCENARIOS
+    );
+    notes.push_back(note);
+    std::fprintf(stderr, "%s: %s; %zu trials in %.2f s on %zu threads (%.0f trials/s)\n",
+      problem.m_name, note, result.m_trials, result.m_seconds, pool.size(), result.m_trials / result.m_seconds
+    );
+  }
+
+  FILE* file = std::fopen(output.c_str(), "w");
+  if (!file) {
+    std::perror(output.c_str());
+    return 1;
+  }
+  std::fputs(
+    "#pragma once\n\n"
+    "// Generated by tools/tune_gains.cpp; do not edit.\n"
+    "// tune_gains builds the robot code with TUNE_GAINS, which makes these variables it sets for each trial.\n\n"
+    "#ifdef TUNE_GAINS\n#define CONTROLLER_GAIN inline double\n#else\n#define CONTROLLER_GAIN inline constexpr double\n#endif\n\n"
+    "namespace controller_gains {\n", file
+  );
+  for (size_t p = 0; p < sizeof(PROBLEMS) / sizeof(PROBLEMS[0]); ++p) {
+    std::fprintf(file, "\n  // %s\n", notes[p].c_str());
+    for (int g : PROBLEMS[p].m_gains) std::fprintf(file, "  CONTROLLER_GAIN %s = %.4g;\n", GAIN_NAMES[g], gains[g]);
+  }
+  std::fputs("}\n\n#undef CONTROLLER_GAIN\n", file);
+  return std::fclose(file) != 0;
+}
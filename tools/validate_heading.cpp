@@ -0,0 +1,244 @@
+/**
+ * Host validation of the fused heading in Odom (lib/heading_filter.hpp).
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/validate_heading [--runs N] [--seed N] [--threads N]
+ *
+ * Each run drives a simulated robot around for a match: drives, arcs, turns in place and stops, with the tracking wheels
+ * scrubbing in proportion to travel, and with wall contact and tilter deposits that make the wheels report turns the
+ * robot never made. The wheels are quantized like the ADI encoders and read at the odom rate; the IMU reports every
+ * 10ms with its own bias, bias drift, random walk, noise and scale error, after calibrating while the robot is still.
+ * The final heading error of the wheels alone, the IMU alone and the filter are compared, and the filter's variance is
+ * checked against its actual error.
+ *
+ * Runs share nothing, and every random number comes from the seed and the run's index,
+ * so the report does not depend on the thread count and runs scale across cores.
+ */
+
+#include "lib/heading_filter.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // rates and lengths, in s
+  constexpr double ODOM_DT = .005;     // subsystems::ODOM_RATE
+  constexpr double IMU_DT = .01;       // the V5 inertial sensor's report period
+  constexpr double CALIBRATION = 2;    // the IMU calibrates while the robot is still
+  constexpr double MATCH = 105;        // driver control
+
+  // the robot, in in; see subsystems.cpp
+  constexpr double TRACKING_WIDTH = 8;
+  constexpr double TRACKING_RADIUS = 1.375;
+  constexpr double ENCODER_DEGREES = 1; // ADI encoders count 360 per revolution
+
+  constexpr double DEG = M_PI / 180;
+
+  // independent random streams from a seed and an index
+  uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * What the robot is doing, and for how long.
+   * Wall contact and deposits hold the robot still while its wheels rock.
+   */
+  struct Segment {
+    double m_duration; ///< s
+    double m_speed;    ///< in/s
+    double m_turn;     ///< rad/s, clockwise positive
+    double m_rock;     ///< false turn rate of the wheels while rocking, in rad/s
+  };
+
+  Segment next_segment(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    double kind = uniform(rng);
+    double duration = .3 + 1.7 * uniform(rng);
+    double sign = uniform(rng) < .5 ? -1 : 1;
+    if (kind < .35) return {duration, sign * (10 + 40 * uniform(rng)), std::normal_distribution<double>(0, 40 * DEG)(rng), 0};
+    if (kind < .6) return {duration * .5, 0, sign * (90 + 180 * uniform(rng)) * DEG, 0};
+    if (kind < .8) return {duration, 0, 0, 0};
+    if (kind < .92) return {duration * .5, 0, 0, std::normal_distribution<double>(0, 20 * DEG)(rng)};
+    return {.5, 0, 0, std::normal_distribution<double>(0, 8 * DEG)(rng) / .5};
+  }
+
+  // the result of one run
+  struct Outcome {
+    double m_wheels_error;   ///< rad between the true final heading and the wheels'
+    double m_imu_error;      ///< rad between the true final heading and the IMU's
+    double m_fused_error;    ///< rad between the true final heading and the filter's
+    double m_fused_max;      ///< largest error of the filter during the run, in rad
+    double m_deviation;      ///< the filter's final standard deviation, in rad
+    double m_rejected;       ///< fraction of IMU samples whose wheel changes were dropped
+  };
+
+  // one match
+  Outcome run(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> normal(0, 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    // tracking wheels scale and scrub differently on every robot
+    double scale_left = 1 + .005 * normal(rng);
+    double scale_right = 1 + .005 * normal(rng);
+    double scrub = .15 * DEG; // rad of false turn per sqrt(in) of travel
+
+    // the IMU
+    double imu_scale = 1 + .01 * normal(rng);
+    double imu_bias = .03 * DEG * normal(rng); // rad/s
+    double imu_bias_drift = .002 * DEG;        // rad/s per sqrt(s)
+    double imu_walk = .03 * DEG;               // rad per sqrt(s)
+    double imu_noise = .01 * DEG;              // rad
+    double imu_phase = IMU_DT * uniform(rng);
+
+    HeadingFilter filter;
+    double heading = 0, speed = 0, turn = 0;
+    double wheel_left = 0, wheel_right = 0, last_left = 0, last_right = 0;
+    double imu_drift = 0, imu_reading = NAN, imu_start = NAN, next_imu = imu_phase;
+    double wheels = 0, fused_max = 0;
+    Segment segment = {CALIBRATION, 0, 0, 0};
+    double segment_end = CALIBRATION;
+    size_t fused_updates = 0, rejected = 0;
+
+    for (double time = ODOM_DT; time <= CALIBRATION + MATCH; time += ODOM_DT) {
+      if (time >= segment_end) {
+        segment = next_segment(rng);
+        segment_end = time + segment.m_duration;
+      }
+
+      // the robot eases towards the segment's speeds
+      speed += (segment.m_speed - speed) * .1;
+      turn += (segment.m_turn - turn) * .1;
+      heading += turn * ODOM_DT;
+
+      // the wheels follow the robot, scrub, and rock against walls and during deposits
+      double travel = speed * ODOM_DT;
+      double false_turn = scrub * std::sqrt(std::abs(travel) + std::abs(turn) * ODOM_DT * TRACKING_WIDTH) * normal(rng);
+      false_turn += segment.m_rock * ODOM_DT * (1 + normal(rng));
+      double arc = (turn * ODOM_DT + false_turn) * TRACKING_WIDTH * .5;
+      wheel_left += (travel + arc) * scale_left;
+      wheel_right += (travel - arc) * scale_right;
+      double degrees_per_in = 180 / M_PI / TRACKING_RADIUS;
+      double left = std::floor(wheel_left * degrees_per_in / ENCODER_DEGREES) * ENCODER_DEGREES / degrees_per_in;
+      double right = std::floor(wheel_right * degrees_per_in / ENCODER_DEGREES) * ENCODER_DEGREES / degrees_per_in;
+      double d_left = left - last_left, d_right = right - last_right;
+      last_left = left;
+      last_right = right;
+
+      // the IMU drifts and reports at its own rate, and has no reading until calibrated
+      imu_bias += imu_bias_drift * std::sqrt(ODOM_DT) * normal(rng);
+      imu_drift += imu_bias * ODOM_DT + imu_walk * std::sqrt(ODOM_DT) * normal(rng);
+      if (time >= next_imu) {
+        next_imu += IMU_DT;
+        if (time >= CALIBRATION) {
+          imu_reading = heading * imu_scale + imu_drift + imu_noise * normal(rng);
+          if (std::isnan(imu_start)) imu_start = imu_reading;
+        }
+      }
+
+      // Odom's update
+      double d_wheels = (d_left - d_right) / TRACKING_WIDTH;
+      wheels += d_wheels;
+      uint32_t fused = filter.get_fused_count(), dropped = filter.get_rejected_count();
+      filter.update(d_wheels, std::abs(d_left) + std::abs(d_right), ODOM_DT, imu_reading);
+      fused_updates += filter.get_fused_count() - fused + filter.get_rejected_count() - dropped;
+      rejected += filter.get_rejected_count() - dropped;
+
+      // the heading is tared once the match starts
+      if (time < CALIBRATION) filter.reset_variance();
+      fused_max = std::max(fused_max, std::abs(filter.get_heading() - heading));
+    }
+
+    double imu = std::isnan(imu_start) ? NAN : imu_reading - imu_start;
+    return {
+      wheels - heading, imu - heading, filter.get_heading() - heading, fused_max,
+      std::sqrt(std::max(0.0, filter.get_variance())), fused_updates ? double(rejected) / fused_updates : 0
+    };
+  }
+
+  // a percentile of sorted values
+  double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + .5))];
+  }
+
+  void report(const char* name, std::vector<double> values, double scale, const char* unit) {
+    std::sort(values.begin(), values.end());
+    double sum = 0, sum_squared = 0;
+    for (double value : values) sum += value, sum_squared += value * value;
+    double mean = sum / values.size();
+    double deviation = std::sqrt(std::max(0.0, sum_squared / values.size() - mean * mean));
+    std::printf("%-14s mean %7.3f  sd %7.3f  p5 %7.3f  p50 %7.3f  p95 %7.3f  max %7.3f %s\n", name,
+      mean * scale, deviation * scale, percentile(values, .05) * scale, percentile(values, .5) * scale,
+      percentile(values, .95) * scale, values.back() * scale, unit
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t runs = 2000;
+  uint64_t seed = 1;
+  size_t threads = std::thread::hardware_concurrency();
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--runs") && has_value) runs = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--threads") && has_value) threads = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--runs N] [--seed N] [--threads N]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (runs == 0) return 0;
+
+  WorkStealingPool pool(threads);
+  std::vector<Outcome> outcomes(runs);
+  auto begin = std::chrono::steady_clock::now();
+  pool.run(runs, [&](size_t index) {
+    outcomes[index] = run(mix(seed ^ mix(index)));
+  });
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  // absolute final errors, and how many the filter's deviation covers
+  std::vector<double> wheels, imu, fused, fused_max, deviations, rejected;
+  size_t within_one = 0, within_two = 0;
+  for (const Outcome& outcome : outcomes) {
+    wheels.push_back(std::abs(outcome.m_wheels_error));
+    imu.push_back(std::abs(outcome.m_imu_error));
+    fused.push_back(std::abs(outcome.m_fused_error));
+    fused_max.push_back(outcome.m_fused_max);
+    deviations.push_back(outcome.m_deviation);
+    rejected.push_back(outcome.m_rejected);
+    within_one += std::abs(outcome.m_fused_error) <= outcome.m_deviation;
+    within_two += std::abs(outcome.m_fused_error) <= 2 * outcome.m_deviation;
+  }
+  std::printf("%zu runs of %.0f s, seed %llu\n", runs, MATCH, (unsigned long long)seed);
+  report("wheels", wheels, 1 / DEG, "deg");
+  report("imu", imu, 1 / DEG, "deg");
+  report("fused", fused, 1 / DEG, "deg");
+  report("fused max", fused_max, 1 / DEG, "deg");
+  report("fused sd", deviations, 1 / DEG, "deg");
+  report("slip dropped", rejected, 100, "%");
+  std::printf("within 1 sd   %.1f%% (68%% if consistent)\n", 100.0 * within_one / runs);
+  std::printf("within 2 sd   %.1f%% (95%% if consistent)\n", 100.0 * within_two / runs);
+  std::fprintf(stderr, "%.2f s on %zu threads (%.0f runs/s)\n", seconds, pool.size(), runs / seconds);
+
+  // the cost of one update, which Odom pays at the odom rate
+  HeadingFilter filter;
+  constexpr size_t UPDATES = 10000000;
+  double sink = 0;
+  begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < UPDATES; ++i) sink += filter.update(1e-4 * (i % 7), .01 * (i % 3), ODOM_DT, 1e-4 * (i / 2));
+  double update = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / UPDATES;
+  std::fprintf(stderr, "%.1f ns per update (%g)\n", update * 1e9, sink);
+}
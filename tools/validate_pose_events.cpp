@@ -0,0 +1,216 @@
+/**
+ * Host validation of the pose-update events (subsystems::subscribe_poses()) and of the device reads behind them.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/validate_pose_events [--duration MS] [--subscribers N]
+ *
+ * First runs a model of the polling the pose events replaced, for --duration ms on the host simulator (tools/sim/):
+ * an updater task reads every sensor Sensors reads every 10 ms, as the old update_poses() did, and --subscribers controller
+ * tasks each read the drive sensors themselves every 10 ms, as the tilter and pull-out controllers did. The old odom
+ * read nothing (its update was a stub), so the model reads the sensors the current odom does, to compare like with like.
+ * Then runs initialize() and lets the updater run for --duration ms twice: once with no subscribers of its own, and
+ * once with --subscribers tasks waiting on pose events while another task subscribes and unsubscribes a further task
+ * every few ms. Every subscriber must wake once per odom update, and the subscribers must not cost a single device
+ * read: the updater is the only task that reads the sensors.
+ * Reports device reads per simulated second and per pose update in each phase. Exits with 1 if either check fails.
+ */
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "subsystems/subsystems.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+  // the robot settles this long after initialize() before counting, in ms
+  constexpr uint32_t SETTLE = 500;
+
+  // the churning task subscribes and unsubscribes this often, in ms
+  constexpr uint32_t CHURN_PERIOD = 3;
+
+  // the polling loops' period, in ms
+  constexpr uint32_t POLL_PERIOD = 10;
+
+  /**
+   * Model of the polling before pose events: every task that needed a pose read the sensors behind it itself.
+   * Reads the devices on the ports subsystems.cpp wires them to.
+   */
+  struct PollingModel {
+    ADIEncoder m_tracking_left{'G', 'H', false};
+    ADIEncoder m_tracking_right{'C', 'D', false};
+    ADIEncoder m_tracking_side{'E', 'F', false};
+    pros::Imu m_imu{subsystems::IMU_PORT};
+    IntegratedEncoder m_direct_left{11, true};
+    IntegratedEncoder m_direct_right{20, false};
+    IntegratedEncoder m_shared_left{15, true};
+    IntegratedEncoder m_shared_right{16, false};
+    IntegratedEncoder m_lift_left{1, false};
+    IntegratedEncoder m_lift_right{18, true};
+    IntegratedEncoder m_intake_left{12, false};
+    IntegratedEncoder m_intake_right{19, true};
+    Motor m_intake_motor_left{12, false, Motor::gearset::green, Motor::encoderUnits::degrees};
+    Motor m_intake_motor_right{19, true, Motor::gearset::green, Motor::encoderUnits::degrees};
+
+    // what the chassis and tilter poses need, as each controller read it
+    double read_drive() {
+      return m_tracking_left.get() + m_tracking_right.get() + m_tracking_side.get() + m_imu.get_rotation() +
+        m_direct_left.get() + m_direct_right.get() + m_shared_left.get() + m_shared_right.get();
+    }
+
+    // everything, as the old update_poses() read it
+    double read_all() {
+      return read_drive() + m_lift_left.get() + m_lift_right.get() + m_intake_left.get() + m_intake_right.get() +
+        m_intake_motor_left.getCurrentDraw() + m_intake_motor_right.getCurrentDraw();
+    }
+  };
+
+  // device reads and odom updates over a phase
+  struct Counts {
+    uint32_t m_updates;
+    uint32_t m_device_reads;
+    uint32_t m_sensor_reads;
+  };
+
+  Counts count() {
+    using namespace subsystems;
+    uint32_t updates = 0;
+    for (size_t i = 0; i < scheduler->size(); ++i) {
+      if (!std::strcmp(scheduler->get_name(i), "odom")) updates = scheduler->get_stats(i).m_runs;
+    }
+    sim::Traffic traffic = sim::robot().get_traffic();
+    return {
+      updates, traffic.m_motor_reads + traffic.m_encoder_reads + traffic.m_imu_reads,
+      sensors->get_read_stats().m_reads
+    };
+  }
+
+  Counts difference(const Counts& end, const Counts& start) {
+    return {
+      end.m_updates - start.m_updates, end.m_device_reads - start.m_device_reads, end.m_sensor_reads - start.m_sensor_reads
+    };
+  }
+
+  void print(FILE* report, const char* name, const Counts& counts, uint32_t duration) {
+    std::fprintf(
+      report, "%-14s %6u pose updates  %7u device reads  %7u through Sensors  %7.0f reads/s  %5.2f reads per update\n",
+      name, counts.m_updates, counts.m_device_reads, counts.m_sensor_reads,
+      counts.m_device_reads * 1000.0 / duration, double(counts.m_device_reads) / counts.m_updates
+    );
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t duration = 5000;
+  size_t subscribers = 4;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--duration") && has_value) duration = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--subscribers") && has_value) subscribers = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--duration MS] [--subscribers N]\n", argv[0]);
+      return 1;
+    }
+  }
+  subscribers = std::min(subscribers, subsystems::MAX_POSE_SUBSCRIBERS - 1);
+
+  // the robot's stdout is the telemetry stream
+  FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+  std::freopen("/dev/null", "w", stdout);
+
+  Counts polling{}, alone{}, subscribed{};
+  std::vector<uint32_t> wakes(subscribers, 0), wakes_start(subscribers, 0);
+  uint32_t churns = 0, refused = 0;
+  std::vector<std::unique_ptr<pros::Task>> tasks;
+  sim::robot().reset(0);
+  sim::run([&]() {
+
+    // the old polling, before the updater exists; its updates are the updater loop's
+    {
+      auto model = std::make_shared<PollingModel>();
+      auto updates = std::make_shared<uint32_t>(0);
+      auto stop = std::make_shared<bool>(false);
+      auto sink = std::make_shared<double>(0);
+      tasks.push_back(std::make_unique<pros::Task>([=]() {
+        while (!*stop) {
+          *sink += model->read_all();
+          ++*updates;
+          pros::delay(POLL_PERIOD);
+        }
+      }));
+      for (size_t i = 0; i < subscribers; ++i) {
+        tasks.push_back(std::make_unique<pros::Task>([=]() {
+          while (!*stop) {
+            *sink += model->read_drive();
+            pros::delay(POLL_PERIOD);
+          }
+        }));
+      }
+      sim::Traffic traffic = sim::robot().get_traffic();
+      uint32_t start = traffic.m_motor_reads + traffic.m_encoder_reads + traffic.m_imu_reads, start_updates = *updates;
+      pros::delay(duration);
+      traffic = sim::robot().get_traffic();
+      polling = {*updates - start_updates, traffic.m_motor_reads + traffic.m_encoder_reads + traffic.m_imu_reads - start, 0};
+      *stop = true;
+      pros::delay(POLL_PERIOD * 2);
+    }
+
+    initialize();
+    pros::delay(SETTLE);
+
+    // the updater alone
+    Counts start = count();
+    pros::delay(duration);
+    alone = difference(count(), start);
+
+    // subscribers wait above the updater, so each wakes as soon as it is notified
+    for (size_t i = 0; i < subscribers; ++i) {
+      tasks.push_back(std::make_unique<pros::Task>([&, i]() {
+        if (!subsystems::subscribe_poses(pros::c::task_get_current())) ++refused;
+        while (true) {
+          pros::c::task_notify_take(true, TIMEOUT_MAX);
+          ++wakes[i];
+        }
+      }, TASK_PRIORITY_DEFAULT + 1));
+    }
+    pros::task_t idle = pros::c::task_get_current();
+    tasks.push_back(std::make_unique<pros::Task>([&]() {
+      while (true) {
+        if (!subsystems::subscribe_poses(idle)) ++refused;
+        pros::delay(CHURN_PERIOD);
+        subsystems::unsubscribe_poses(idle);
+        pros::delay(CHURN_PERIOD);
+        ++churns;
+      }
+    }));
+    pros::delay(SETTLE);
+    start = count();
+    wakes_start = wakes;
+    pros::delay(duration);
+    subscribed = difference(count(), start);
+    for (size_t i = 0; i < subscribers; ++i) wakes[i] -= wakes_start[i];
+  }, SETTLE * 2 + duration * 3 + POLL_PERIOD * 2 + 100);
+
+  std::fprintf(report, "%u ms each, %zu subscribers, %u churns\n", duration, subscribers, churns);
+  print(report, "polling", polling, duration);
+  print(report, "alone", alone, duration);
+  print(report, "subscribed", subscribed, duration);
+  bool passed = !refused && subscribed.m_device_reads <= alone.m_device_reads + alone.m_device_reads / alone.m_updates;
+  for (size_t i = 0; i < subscribers; ++i) {
+    bool woke = wakes[i] + 1 >= subscribed.m_updates && wakes[i] <= subscribed.m_updates + 1;
+    passed &= woke;
+    std::fprintf(report, "subscriber %zu   %6u wakes  %s\n", i, wakes[i], woke ? "ok" : "FAILED");
+  }
+  if (refused) std::fprintf(report, "refused        %u subscriptions\n", refused);
+  std::fprintf(report, "%s\n", passed ? "ok" : "FAILED");
+
+  // the robot's tasks are still parked, so skip static destructors
+  std::fflush(report);
+  std::_Exit(passed ? 0 : 1);
+}
@@ -0,0 +1,118 @@
+/**
+ * Host validation of Scheduler's (lib/scheduler.hpp) deadlines and overrun accounting on a simulated clock.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/validate_scheduler [--duration MS]
+ *
+ * Every case runs its own scheduler in its own task on the host simulator (tools/sim/), with one 10 ms job that
+ * blocks for a fixed time, and compares the job's statistics with what its duration implies. A job that finishes
+ * exactly at its next deadline has not overrun: it runs again straight away, without skipping a deadline.
+ * A last scheduler runs a job that blocks for QUEUED ms ahead of an instant job with the same deadlines; the second job
+ * starts QUEUED ms late every time, and must report it.
+ * Exits with 1 if any case differs.
+ */
+
+#include "sim/sim.hpp"
+#include "lib/scheduler.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+  // every job's period, in ms
+  constexpr uint32_t PERIOD = 10;
+
+  // a job that blocks for a fixed time, and the statistics it should have after a number of periods
+  struct Case {
+    const char* m_name;
+    uint32_t m_duration; ///< ms the job blocks for
+    uint32_t m_runs_per; ///< Periods each run takes up
+  };
+
+  const Case CASES[] = {
+    {"instant", 0, 1},
+    {"half period", PERIOD / 2, 1},
+    {"one period", PERIOD, 1},
+    {"one period + 1", PERIOD + 1, 2},
+    {"two periods", 2 * PERIOD, 2},
+    {"two periods + 1", 2 * PERIOD + 1, 3},
+  };
+
+  // how long the job ahead of the queued job blocks, in ms
+  constexpr uint32_t QUEUED = 3;
+}
+
+int main(int argc, char** argv) {
+  uint32_t duration = 10000;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--duration") && has_value) duration = std::strtoul(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--duration MS]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // a whole number of runs for every case
+  duration -= duration % (6 * PERIOD);
+
+  constexpr size_t COUNT = sizeof(CASES) / sizeof(CASES[0]);
+  std::vector<std::unique_ptr<Scheduler>> schedulers;
+  std::vector<std::unique_ptr<pros::Task>> tasks;
+  Scheduler queued;
+  sim::run([&]() {
+    for (const Case& test : CASES) {
+      schedulers.push_back(std::make_unique<Scheduler>());
+      Scheduler* scheduler = schedulers.back().get();
+      uint32_t blocked = test.m_duration;
+      scheduler->add(test.m_name, 1000_Hz / PERIOD, [blocked]() {
+        if (blocked) pros::delay(blocked);
+      });
+      tasks.push_back(std::make_unique<pros::Task>([scheduler]() {
+        scheduler->run();
+      }));
+    }
+    queued.add("ahead", 1000_Hz / PERIOD, []() { pros::delay(QUEUED); });
+    queued.add("queued", 1000_Hz / PERIOD, []() {});
+    tasks.push_back(std::make_unique<pros::Task>([&queued]() {
+      queued.run();
+    }));
+    pros::delay(duration);
+  }, duration);
+
+  // every run but those still going when the program returned
+  bool passed = true;
+  std::printf("%u ms, %u ms period\n", duration, PERIOD);
+  for (size_t i = 0; i < COUNT; ++i) {
+    const Case& test = CASES[i];
+    Scheduler::JobStats stats = schedulers[i]->get_stats(0);
+    uint32_t runs = duration / (PERIOD * test.m_runs_per);
+    uint32_t overruns = test.m_runs_per > 1 ? runs : 0;
+    uint32_t skipped = overruns * (test.m_runs_per - 1);
+    bool ok = stats.m_runs + 1 >= runs && stats.m_runs <= runs && stats.m_max_jitter == 0 &&
+      stats.m_overruns + 1 >= overruns && stats.m_overruns <= overruns &&
+      stats.m_skipped + test.m_runs_per >= skipped && stats.m_skipped <= skipped;
+    passed &= ok;
+    std::printf(
+      "%-16s %5u runs (%5u)  %5u overruns (%5u)  %5u skipped (%5u)  max jitter %u ms  %s\n", test.m_name,
+      stats.m_runs, runs, stats.m_overruns, overruns, stats.m_skipped, skipped, stats.m_max_jitter, ok ? "ok" : "FAILED"
+    );
+  }
+
+  // the queued job starts late by the time the job ahead of it ran, every run
+  Scheduler::JobStats stats = queued.get_stats(1);
+  bool ok = stats.m_max_jitter == QUEUED && stats.m_jitter_histogram[QUEUED] == stats.m_runs && stats.m_runs + 1 >= duration / PERIOD;
+  passed &= ok;
+  std::printf(
+    "%-16s %5u runs (%5u)  %5u started %u ms late  max jitter %u ms  %s\n", "queued",
+    stats.m_runs, duration / PERIOD, stats.m_jitter_histogram[QUEUED], QUEUED, stats.m_max_jitter, ok ? "ok" : "FAILED"
+  );
+
+  // the schedulers' tasks are still parked, so skip static destructors
+  std::fflush(stdout);
+  std::_Exit(passed ? 0 : 1);
+}
@@ -0,0 +1,166 @@
+/**
+ * Host unit tests of StateMachine (state_machine.hpp).
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/validate_state_machine
+ *
+ * Each test drives a small machine whose hooks log what they run, and checks the log and the state against the
+ * contract in state_machine.hpp: the entry state is not entered, set_state() enters, an update takes at most the
+ * first open transition leaving the current state, runs its action, then the new state's enter, then its update,
+ * and never evaluates a guard of a transition leaving another state.
+ * Exits with 1 if any test fails.
+ */
+
+#include "state_machine.hpp"
+#include <cstdio>
+#include <string>
+
+namespace {
+
+  enum class State { A, B, C, D };
+
+  // what the machine controls: which guards are open, and a log of every hook run
+  struct Context {
+    bool m_open_ab = false;
+    bool m_open_ac = false;
+    bool m_open_bc = false;
+    mutable int m_guard_calls_c = 0;
+    std::string m_log;
+  };
+
+  // hooks; each logs a letter pair
+  void enter_a(Context& context) { context.m_log += "eA "; }
+  void enter_b(Context& context) { context.m_log += "eB "; }
+  void enter_c(Context& context) { context.m_log += "eC "; }
+  void update_a(Context& context) { context.m_log += "uA "; }
+  void update_b(Context& context) { context.m_log += "uB "; }
+  void update_d(Context& context) { context.m_log += "uD "; }
+  bool open_ab(const Context& context) { return context.m_open_ab; }
+  bool open_ac(const Context& context) { return context.m_open_ac; }
+  bool open_bc(const Context& context) { return context.m_open_bc; }
+  bool counted_c(const Context& context) { ++context.m_guard_calls_c; return false; }
+  void act_ab(Context& context) { context.m_log += "aAB "; }
+  void act_ac(Context& context) { context.m_log += "aAC "; }
+  void act_dd(Context& context) { context.m_log += "aDD "; }
+
+  /**
+   * A: both B and C are open from A, B first; listed out of state order.
+   * B: goes to C when open; C: always to A via a null guard after a counted one that never opens; D: loops to itself.
+   */
+  struct Traits {
+    using State = ::State;
+    using Context = ::Context;
+    static constexpr size_t NUM_STATES = 4;
+    static constexpr StateBehavior<Context> BEHAVIORS[] = {
+      {&enter_a, &update_a},
+      {&enter_b, &update_b},
+      {&enter_c, nullptr},
+      {nullptr, &update_d}
+    };
+    static constexpr Transition<State, Context> TRANSITIONS[] = {
+      {State::C, State::D, &counted_c, nullptr},
+      {State::A, State::B, &open_ab, &act_ab},
+      {State::B, State::C, &open_bc, nullptr},
+      {State::A, State::C, &open_ac, &act_ac},
+      {State::C, State::A, nullptr, nullptr},
+      {State::D, State::D, nullptr, &act_dd}
+    };
+  };
+
+  using Machine = StateMachine<Traits>;
+
+  // the machine works in constant expressions
+  static_assert(Machine(State::C).get_state() == State::C, "get_state() is constexpr");
+
+  int g_failures = 0;
+
+  void check(bool passed, const char* test, const char* what) {
+    if (!passed) ++g_failures;
+    std::printf("%-24s %-52s %s\n", test, what, passed ? "ok" : "FAILED");
+  }
+
+  void check_log(const Context& context, const char* expected, const char* test) {
+    bool passed = context.m_log == expected;
+    check(passed, test, (std::string("log \"") + expected + "\"").c_str());
+    if (!passed) std::printf("  got \"%s\"\n", context.m_log.c_str());
+  }
+}
+
+int main() {
+  {
+    Context context;
+    Machine machine(State::A);
+    check(machine.get_state() == State::A, "construct", "starts in the entry state");
+    check_log(context, "", "construct");
+  }
+  {
+    Context context;
+    Machine machine(State::A);
+    machine.set_state(State::B, context);
+    check(machine.get_state() == State::B, "set_state", "moves to the state");
+    check_log(context, "eB ", "set_state");
+    machine.set_state(State::D, context);
+    check_log(context, "eB ", "set_state null enter");
+  }
+  {
+    Context context;
+    Machine machine(State::A);
+    check(machine.update(context) == nullptr, "closed guards", "takes no transition");
+    check(machine.get_state() == State::A, "closed guards", "stays put");
+    check_log(context, "uA ", "closed guards");
+  }
+  {
+    Context context;
+    context.m_open_ab = true;
+    Machine machine(State::A);
+    const Transition<State, Context>* taken = machine.update(context);
+    check(taken == &Traits::TRANSITIONS[1], "open guard", "returns the transition taken");
+    check(machine.get_state() == State::B, "open guard", "moves to its target");
+    check_log(context, "aAB eB uB ", "open guard");
+  }
+  {
+    Context context;
+    context.m_open_ab = context.m_open_ac = true;
+    Machine machine(State::A);
+    machine.update(context);
+    check(machine.get_state() == State::B, "priority", "the earlier of two open transitions wins");
+    check_log(context, "aAB eB uB ", "priority");
+    context.m_open_ab = false;
+    context.m_log.clear();
+    machine.set_state(State::A, context);
+    machine.update(context);
+    check(machine.get_state() == State::C, "priority", "the later is taken once the earlier closes");
+    check_log(context, "eA aAC eC ", "priority");
+  }
+  {
+    Context context;
+    context.m_open_ab = context.m_open_bc = true;
+    Machine machine(State::A);
+    machine.update(context);
+    check(machine.get_state() == State::B, "one per update", "a chain of open transitions takes one step");
+    machine.update(context);
+    check(machine.get_state() == State::C, "one per update", "and the next on the next update");
+    check_log(context, "aAB eB uB eC ", "one per update");
+  }
+  {
+    Context context;
+    Machine machine(State::C);
+    machine.update(context);
+    check(machine.get_state() == State::A, "null guard", "is always open");
+    check(context.m_guard_calls_c == 1, "null guard", "after the earlier guard is checked once");
+    check_log(context, "eA uA ", "null guard");
+  }
+  {
+    Context context;
+    context.m_open_ab = context.m_open_ac = context.m_open_bc = true;
+    Machine machine(State::D);
+    for (int i = 0; i < 3; ++i) machine.update(context);
+    check(machine.get_state() == State::D, "self transition", "is taken every update");
+    check(context.m_guard_calls_c == 0, "other states", "guards leaving other states are never checked");
+    check_log(context, "aDD uD aDD uD aDD uD ", "self transition");
+  }
+
+  std::printf("%s\n", g_failures ? "FAILED" : "ok");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * Host validation of the transmission's transition trace (Transmission::get_trace()) on a simulated robot.
+ *
+ * Build and run from the repository root:
+ *   make tools
+ *   bin/host/validate_transmission_trace [--duration MS] [--seed N]
+ *
+ * Runs initialize() on the host simulator (tools/sim/), then for --duration ms a command task forces the
+ * transmission's state through the tilter (extend, retract, hold, move) at random, while the updater takes the guarded
+ * transitions whenever the command lets go and the lift moves between presets; both write the trace. A reader task
+ * above both copies the trace every ms and checks that it chains: each record leaves the state the one before it
+ * entered, no later than it. At the end, the trace must hold every transition the command made and end in the
+ * current state.
+ * The simulator only switches tasks where they block, so this checks the trace's bookkeeping with both writers,
+ * not the preemption the mutex guards against on the robot.
+ * Exits with 1 if the trace breaks.
+ */
+
+#include "sim/sim.hpp"
+#include "main.h"
+#include "subsystems/subsystems.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+  // the robot settles this long after initialize(), in ms
+  constexpr uint32_t SETTLE = 500;
+
+  // the command acts every so often, in ms
+  constexpr uint32_t MIN_GAP = 10;
+  constexpr uint32_t MAX_GAP = 200;
+
+  // what the reader found
+  struct Checks {
+    uint32_t m_reads = 0;
+    uint32_t m_records = 0;
+    uint32_t m_broken = 0;
+  };
+
+  void check_trace(Checks& checks) {
+    Transmission::TransitionRecord records[Transmission::TRACE_LENGTH];
+    size_t count = subsystems::transmission->get_trace(records, Transmission::TRACE_LENGTH);
+    ++checks.m_reads;
+    checks.m_records += count;
+    for (size_t i = 0; i < count; ++i) {
+      checks.m_broken += records[i].m_from == records[i].m_to;
+      if (i + 1 < count) checks.m_broken += records[i].m_from != records[i + 1].m_to || records[i].m_time < records[i + 1].m_time;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t duration = 60000;
+  uint64_t seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    bool has_value = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--duration") && has_value) duration = std::strtoul(argv[++i], nullptr, 10);
+    else if (!std::strcmp(argv[i], "--seed") && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+    else {
+      std::fprintf(stderr, "usage: %s [--duration MS] [--seed N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // the robot's stdout is the telemetry stream
+  FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+  std::freopen("/dev/null", "w", stdout);
+
+  using namespace subsystems;
+  Checks checks;
+  uint32_t forced = 0, total = 0, actions = 0;
+  Transmission::State final_state = Transmission::State::PASSIVE, traced_state = Transmission::State::PASSIVE;
+  std::unique_ptr<pros::Task> reader;
+  sim::robot().reset(seed);
+  sim::run([&]() {
+    initialize();
+    pros::delay(SETTLE);
+    uint32_t start = transmission->get_transition_count();
+
+    reader = std::make_unique<pros::Task>([&]() {
+      while (true) {
+        check_trace(checks);
+        pros::delay(1);
+      }
+    }, TASK_PRIORITY_DEFAULT + 2);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint32_t> gap(MIN_GAP, MAX_GAP);
+    std::uniform_int_distribution<int> action(0, 6);
+    Command command("trace", RESOURCE_TRANSMISSION, PRIORITY_MACRO, true);
+    uint32_t end = pros::millis() + duration;
+    while (pros::millis() < end) {
+      int kind = action(rng);
+      ++actions;
+      if (kind < 4) {
+
+        // force a state, as the tilter's commands do
+        arbiter->schedule(command);
+        arbiter->run(command, [&]() {
+          Transmission::State from = transmission->get_state();
+          if (kind == 0) tilter->extend_passive();
+          else if (kind == 1) tilter->retract_passive();
+          else if (kind == 2) tilter->hold(1000, Transmission::HoldPriority::TILTER);
+          else tilter->move_voltage(int(rng() % 12001) - 6000);
+          forced += transmission->get_state() != from;
+          return true;
+        });
+      }
+      else if (kind == 4) arbiter->cancel(command);
+      else {
+
+        // move the lift across the lock, as its presets do
+        QAngle target = kind == 5 ? 10_deg : 40_deg;
+        arbiter->run_default(RESOURCE_LIFT, [&]() { lift->move_to(target); });
+      }
+      pros::delay(gap(rng));
+    }
+
+    // let the updater finish, with no command
+    arbiter->cancel(command);
+    pros::delay(MAX_GAP);
+    total = transmission->get_transition_count() - start;
+    final_state = transmission->get_state();
+    Transmission::TransitionRecord last;
+    if (transmission->get_trace(&last, 1)) traced_state = last.m_to;
+    check_trace(checks);
+  }, SETTLE + duration + MAX_GAP * 2 + 100);
+
+  bool passed = !checks.m_broken && total >= forced && final_state == traced_state;
+  std::fprintf(report, "%u ms, seed %llu, %u command actions\n", duration, (unsigned long long)seed, actions);
+  std::fprintf(report, "transitions    %u (%u forced by the command, %u taken by the updater)\n", total, forced, total - forced);
+  std::fprintf(report, "trace reads    %u, %u records checked, %u broken links\n", checks.m_reads, checks.m_records, checks.m_broken);
+  std::fprintf(report, "final state    %s the trace\n", final_state == traced_state ? "matches" : "does not match");
+  std::fprintf(report, "%s\n", passed ? "ok" : "FAILED");
+
+  // the robot's tasks are still parked, so skip static destructors
+  std::fflush(report);
+  std::_Exit(passed ? 0 : 1);
+}
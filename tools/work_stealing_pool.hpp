@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs tasks on a fixed number of threads.
+ * Each thread starts with an even share of the indices and, when it runs out,
+ * steals the upper half of the remaining indices of another thread, so slow tasks do not leave threads idle.
+ * Shared by the host tools; tasks must not share mutable state.
+ */
+class WorkStealingPool {
+
+public:
+
+  explicit WorkStealingPool(size_t threads): m_threads(std::max<size_t>(threads, 1)) {}
+
+  size_t size() const {
+    return m_threads;
+  }
+
+  // run task(i) for every i below count; returns once all are done
+  void run(size_t count, const std::function<void(size_t)>& task) {
+    std::vector<Range> ranges(m_threads);
+    for (size_t i = 0; i < m_threads; ++i) {
+      ranges[i].m_begin = count * i / m_threads;
+      ranges[i].m_end = count * (i + 1) / m_threads;
+    }
+    auto work = [&](size_t self) {
+      while (true) {
+        size_t index;
+        if (take(ranges[self], index)) {
+          task(index);
+          continue;
+        }
+        if (!steal(ranges, self)) return;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < m_threads; ++i) threads.emplace_back(work, i);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+  }
+
+private:
+
+  struct Range {
+    std::mutex m_mutex;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+  };
+
+  size_t m_threads;
+
+  static bool take(Range& range, size_t& index) {
+    std::lock_guard<std::mutex> lock(range.m_mutex);
+    if (range.m_begin >= range.m_end) return false;
+    index = range.m_begin++;
+    return true;
+  }
+
+  // move the upper half of another thread's range to this thread's
+  static bool steal(std::vector<Range>& ranges, size_t self) {
+    for (size_t offset = 1; offset < ranges.size(); ++offset) {
+      Range& victim = ranges[(self + offset) % ranges.size()];
+      size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.m_mutex);
+        if (victim.m_begin >= victim.m_end) continue;
+        begin = victim.m_begin + (victim.m_end - victim.m_begin) / 2;
+        end = victim.m_end;
+        victim.m_end = begin;
+      }
+      std::lock_guard<std::mutex> lock(ranges[self].m_mutex);
+      ranges[self].m_begin = begin;
+      ranges[self].m_end = end;
+      return true;
+    }
+    return false;
+  }
+};